@@ -10,7 +10,8 @@
         'has_glfw': '<!(pkg-config glfw3 --libs --silence-errors | grep glfw || true)',
         'has_nexus': '<!(pkg-config glesv2 egl --libs --silence-errors | grep nexus || true)',
         'has_bcm': '<!(pkg-config glesv2 egl --libs --silence-errors | grep bcm || true)',
-        'has_raspbian': '<!(PKG_CONFIG_PATH=/opt/vc/lib/pkgconfig/ pkg-config brcmglesv2 brcmegl --libs --silence-errors | grep bcm || true)'
+        'has_raspbian': '<!(PKG_CONFIG_PATH=/opt/vc/lib/pkgconfig/ pkg-config brcmglesv2 brcmegl --libs --silence-errors | grep bcm || true)',
+        'has_freetype': '<!(pkg-config freetype2 --libs --silence-errors | grep freetype || true)'
       },
       'include_dirs': [
         "<!(node -e \"require('nan')\")",
@@ -23,7 +24,33 @@
             'src/glew/gles2glewimpl.cc',
             'src/bindings.cc',
             'src/gles2platform.cc',
-            'src/interface/webgl.cc'
+            'src/framepacer.cc',
+            'src/interface/webgl.cc',
+            'src/interface/glext.cc',
+            'src/interface/programcache.cc',
+            'src/interface/shadercompiler.cc',
+            'src/interface/shaderlibrary.cc',
+            'src/interface/vertexarrays.cc',
+            'src/interface/instancebatch.cc',
+            'src/interface/gl3.cc',
+            'src/interface/webgl2.cc',
+            'src/interface/streamingbuffer.cc',
+            'src/interface/buffermappings.cc',
+            'src/interface/mirroredbuffer.cc',
+            'src/interface/textureuploader.cc',
+            'src/interface/uploadscheduler.cc',
+            'src/interface/dynamicresolution.cc',
+            'src/interface/framefingerprint.cc',
+            'src/interface/spritebatch.cc',
+            'src/interface/glyphatlas.cc',
+            'src/interface/textrenderer.cc',
+            'src/interface/pathtessellator.cc',
+            'src/interface/pathrenderer.cc',
+            'src/interface/textureatlas.cc',
+            'src/interface/desktopshaders.cc',
+            'src/interface/glprogram.cc',
+            'src/interface/unpackstate.cc',
+            'src/interface/drawstate.cc'
           ],
           'libraries': ['<!@(pkg-config --libs glfw3 glew xcursor xrandr x11 xinerama)'],
           'defines': ['IS_GLEW']
@@ -32,9 +59,37 @@
           'sources': [
             'src/nexus/Nexus.cc',
             'src/nexus/gles2nexusimpl.cc',
+            'src/eglconfig.cc',
+            'src/eglsurface.cc',
             'src/bindings.cc',
             'src/gles2platform.cc',
-            'src/interface/webgl.cc'
+            'src/framepacer.cc',
+            'src/interface/webgl.cc',
+            'src/interface/glext.cc',
+            'src/interface/programcache.cc',
+            'src/interface/shadercompiler.cc',
+            'src/interface/shaderlibrary.cc',
+            'src/interface/vertexarrays.cc',
+            'src/interface/instancebatch.cc',
+            'src/interface/gl3.cc',
+            'src/interface/webgl2.cc',
+            'src/interface/streamingbuffer.cc',
+            'src/interface/buffermappings.cc',
+            'src/interface/mirroredbuffer.cc',
+            'src/interface/textureuploader.cc',
+            'src/interface/uploadscheduler.cc',
+            'src/interface/dynamicresolution.cc',
+            'src/interface/framefingerprint.cc',
+            'src/interface/spritebatch.cc',
+            'src/interface/glyphatlas.cc',
+            'src/interface/textrenderer.cc',
+            'src/interface/pathtessellator.cc',
+            'src/interface/pathrenderer.cc',
+            'src/interface/textureatlas.cc',
+            'src/interface/desktopshaders.cc',
+            'src/interface/glprogram.cc',
+            'src/interface/unpackstate.cc',
+            'src/interface/drawstate.cc'
           ],
           'libraries': ['<!@(pkg-config --libs egl glesv2)'],
           'include_dirs': [ '<!@(pkg-config egl glesv2 --cflags-only-I | sed s/-I//g)' ],
@@ -44,9 +99,37 @@
         ['OS=="linux" and has_glfw=="" and has_nexus=="" and has_bcm!=""', {
           'sources': [
             'src/rpi/gles2rpiimpl.cc',
+            'src/eglconfig.cc',
+            'src/eglsurface.cc',
             'src/bindings.cc',
             'src/gles2platform.cc',
-            'src/interface/webgl.cc'
+            'src/framepacer.cc',
+            'src/interface/webgl.cc',
+            'src/interface/glext.cc',
+            'src/interface/programcache.cc',
+            'src/interface/shadercompiler.cc',
+            'src/interface/shaderlibrary.cc',
+            'src/interface/vertexarrays.cc',
+            'src/interface/instancebatch.cc',
+            'src/interface/gl3.cc',
+            'src/interface/webgl2.cc',
+            'src/interface/streamingbuffer.cc',
+            'src/interface/buffermappings.cc',
+            'src/interface/mirroredbuffer.cc',
+            'src/interface/textureuploader.cc',
+            'src/interface/uploadscheduler.cc',
+            'src/interface/dynamicresolution.cc',
+            'src/interface/framefingerprint.cc',
+            'src/interface/spritebatch.cc',
+            'src/interface/glyphatlas.cc',
+            'src/interface/textrenderer.cc',
+            'src/interface/pathtessellator.cc',
+            'src/interface/pathrenderer.cc',
+            'src/interface/textureatlas.cc',
+            'src/interface/desktopshaders.cc',
+            'src/interface/glprogram.cc',
+            'src/interface/unpackstate.cc',
+            'src/interface/drawstate.cc'
           ],
           'libraries': ['<!@(pkg-config --libs egl glesv2)'],
           'include_dirs': [ '<!@(pkg-config egl glesv2 --cflags-only-I | sed s/-I//g)']
@@ -54,9 +137,37 @@
         ['OS=="linux" and has_glfw=="" and has_nexus=="" and has_raspbian!=""', {
           'sources': [
             'src/rpi/gles2rpiimpl.cc',
+            'src/eglconfig.cc',
+            'src/eglsurface.cc',
             'src/bindings.cc',
             'src/gles2platform.cc',
-            'src/interface/webgl.cc'
+            'src/framepacer.cc',
+            'src/interface/webgl.cc',
+            'src/interface/glext.cc',
+            'src/interface/programcache.cc',
+            'src/interface/shadercompiler.cc',
+            'src/interface/shaderlibrary.cc',
+            'src/interface/vertexarrays.cc',
+            'src/interface/instancebatch.cc',
+            'src/interface/gl3.cc',
+            'src/interface/webgl2.cc',
+            'src/interface/streamingbuffer.cc',
+            'src/interface/buffermappings.cc',
+            'src/interface/mirroredbuffer.cc',
+            'src/interface/textureuploader.cc',
+            'src/interface/uploadscheduler.cc',
+            'src/interface/dynamicresolution.cc',
+            'src/interface/framefingerprint.cc',
+            'src/interface/spritebatch.cc',
+            'src/interface/glyphatlas.cc',
+            'src/interface/textrenderer.cc',
+            'src/interface/pathtessellator.cc',
+            'src/interface/pathrenderer.cc',
+            'src/interface/textureatlas.cc',
+            'src/interface/desktopshaders.cc',
+            'src/interface/glprogram.cc',
+            'src/interface/unpackstate.cc',
+            'src/interface/drawstate.cc'
           ],
           'libraries': ['<!@(PKG_CONFIG_PATH=/opt/vc/lib/pkgconfig pkg-config --libs brcmegl brcmglesv2)'],
           'include_dirs': [ '<!@(PKG_CONFIG_PATH=/opt/vc/lib/pkgconfig pkg-config brcmegl brcmglesv2 --cflags-only-I | sed s/-I//g)']
@@ -66,7 +177,33 @@
             'src/glew/gles2glewimpl.cc',
             'src/bindings.cc',
             'src/gles2platform.cc',
-            'src/interface/webgl.cc'
+            'src/framepacer.cc',
+            'src/interface/webgl.cc',
+            'src/interface/glext.cc',
+            'src/interface/programcache.cc',
+            'src/interface/shadercompiler.cc',
+            'src/interface/shaderlibrary.cc',
+            'src/interface/vertexarrays.cc',
+            'src/interface/instancebatch.cc',
+            'src/interface/gl3.cc',
+            'src/interface/webgl2.cc',
+            'src/interface/streamingbuffer.cc',
+            'src/interface/buffermappings.cc',
+            'src/interface/mirroredbuffer.cc',
+            'src/interface/textureuploader.cc',
+            'src/interface/uploadscheduler.cc',
+            'src/interface/dynamicresolution.cc',
+            'src/interface/framefingerprint.cc',
+            'src/interface/spritebatch.cc',
+            'src/interface/glyphatlas.cc',
+            'src/interface/textrenderer.cc',
+            'src/interface/pathtessellator.cc',
+            'src/interface/pathrenderer.cc',
+            'src/interface/textureatlas.cc',
+            'src/interface/desktopshaders.cc',
+            'src/interface/glprogram.cc',
+            'src/interface/unpackstate.cc',
+            'src/interface/drawstate.cc'
           ],
           'include_dirs': [ '<!@(pkg-config glfw3 glew --cflags-only-I | sed s/-I//g)'],
           'libraries': [ '<!@(pkg-config --libs glfw3 glew)', '-framework OpenGL'],
@@ -78,7 +215,33 @@
             'src/glew/gles2glewimpl.cc',
             'src/bindings.cc',
             'src/gles2platform.cc',
-            'src/interface/webgl.cc'
+            'src/framepacer.cc',
+            'src/interface/webgl.cc',
+            'src/interface/glext.cc',
+            'src/interface/programcache.cc',
+            'src/interface/shadercompiler.cc',
+            'src/interface/shaderlibrary.cc',
+            'src/interface/vertexarrays.cc',
+            'src/interface/instancebatch.cc',
+            'src/interface/gl3.cc',
+            'src/interface/webgl2.cc',
+            'src/interface/streamingbuffer.cc',
+            'src/interface/buffermappings.cc',
+            'src/interface/mirroredbuffer.cc',
+            'src/interface/textureuploader.cc',
+            'src/interface/uploadscheduler.cc',
+            'src/interface/dynamicresolution.cc',
+            'src/interface/framefingerprint.cc',
+            'src/interface/spritebatch.cc',
+            'src/interface/glyphatlas.cc',
+            'src/interface/textrenderer.cc',
+            'src/interface/pathtessellator.cc',
+            'src/interface/pathrenderer.cc',
+            'src/interface/textureatlas.cc',
+            'src/interface/desktopshaders.cc',
+            'src/interface/glprogram.cc',
+            'src/interface/unpackstate.cc',
+            'src/interface/drawstate.cc'
           ],
           'include_dirs': ['<(module_root_dir)/deps/include'],
           'library_dirs': ['<(module_root_dir)/deps/windows/lib/<(target_arch)'],
@@ -92,6 +255,11 @@
               'AdditionalOptions' : ['/OPT:REF','/OPT:ICF','/LTCG']
             },
           }
+        }],
+        ['OS!="win" and has_freetype!=""', {
+          'libraries': ['<!@(pkg-config --libs freetype2)'],
+          'include_dirs': [ '<!@(pkg-config freetype2 --cflags-only-I | sed s/-I//g)'],
+          'defines': ['HAVE_FREETYPE']
         }]
       ]
     }
@@ -0,0 +1,292 @@
+// Runs representative rendering scenes for a fixed number of frames and
+// reports frame time percentiles, GL calls per frame and an estimate of the
+// GPU memory allocated by the scene.
+//
+// Usage: node benchmark.js [--frames=300] [--warmup=30] [--scenes=quads,meshes]
+//                          [--width=1280] [--height=720] [--fullscreen]
+//                          [--out=results.json]
+
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
+var childProcess = require('child_process');
+var gles2 = require('../../gles2');
+
+var availableScenes = {
+    quads: require('./scenes/quads.js'),
+    meshes: require('./scenes/meshes.js'),
+    textures: require('./scenes/textures.js'),
+    postprocess: require('./scenes/postprocess.js'),
+    instances: require('./scenes/instances.js')
+};
+
+function parseArguments(argv) {
+    var args = {};
+    argv.forEach(function(arg) {
+        var match = /^--([^=]+)(?:=(.*))?$/.exec(arg);
+        if (match) {
+            args[match[1]] = (match[2] === undefined ? true : match[2]);
+        }
+    });
+    return args;
+}
+
+var args = parseArguments(process.argv.slice(2));
+
+var options = {
+    width: parseInt(args.width || 1280, 10),
+    height: parseInt(args.height || 720, 10),
+    fullscreen: !!args.fullscreen,
+    title: "Benchmark",
+    frames: parseInt(args.frames || 300, 10),
+    warmup: parseInt(args.warmup || 30, 10),
+    scenes: (args.scenes ? args.scenes.split(",") : Object.keys(availableScenes)),
+    out: args.out || "results.json"
+};
+
+options.scenes.forEach(function(name) {
+    if (!availableScenes[name]) {
+        throw new Error("Unknown scene '" + name + "', available: " + Object.keys(availableScenes).join(", "));
+    }
+});
+
+var gl = gles2.init(options);
+
+// Counts every call that crosses into the WebGL layer and keeps track of the
+// memory of the buffers, textures and renderbuffers that are allocated.
+function instrument(gl) {
+    var stats = {
+        calls: 0,
+        callsByName: {},
+        memory: 0,
+        peakMemory: 0
+    };
+
+    var sizes = new Map();
+    var boundBuffers = {};
+    var boundTextures = {};
+    var activeTexture = gl.TEXTURE0;
+    var boundRenderbuffer = null;
+
+    function setSize(object, level, bytes) {
+        if (!object) {
+            return;
+        }
+        var levels = sizes.get(object);
+        if (!levels) {
+            levels = [];
+            sizes.set(object, levels);
+        }
+        stats.memory += bytes - (levels[level] || 0);
+        levels[level] = bytes;
+        stats.peakMemory = Math.max(stats.peakMemory, stats.memory);
+    }
+
+    function release(object) {
+        var levels = object && sizes.get(object);
+        if (levels) {
+            levels.forEach(function(bytes) {
+                stats.memory -= bytes;
+            });
+            sizes.delete(object);
+        }
+    }
+
+    function bytesPerPixel(format, type) {
+        if (type === gl.UNSIGNED_SHORT_5_6_5 || type === gl.UNSIGNED_SHORT_4_4_4_4 || type === gl.UNSIGNED_SHORT_5_5_5_1) {
+            return 2;
+        }
+        switch (format) {
+        case gl.RGBA: return 4;
+        case gl.RGB: return 3;
+        case gl.LUMINANCE_ALPHA: return 2;
+        default: return 1;
+        }
+    }
+
+    function renderbufferBytesPerPixel(internalformat) {
+        switch (internalformat) {
+        case gl.STENCIL_INDEX8: return 1;
+        case gl.RGBA4:
+        case gl.RGB565:
+        case gl.RGB5_A1:
+        case gl.DEPTH_COMPONENT16: return 2;
+        default: return 4;
+        }
+    }
+
+    var hooks = {
+        activeTexture: function(texture) {
+            activeTexture = texture;
+        },
+        bindBuffer: function(target, buffer) {
+            boundBuffers[target] = buffer;
+        },
+        bindTexture: function(target, texture) {
+            boundTextures[activeTexture + ":" + target] = texture;
+        },
+        bindRenderbuffer: function(target, renderbuffer) {
+            boundRenderbuffer = renderbuffer;
+        },
+        bufferData: function(target, data) {
+            setSize(boundBuffers[target], 0, typeof data === "number" ? data : data.byteLength);
+        },
+        texImage2D: function(target, level, internalformat, width, height, border, format, type) {
+            // Cube map faces are accounted as separate levels of the same texture.
+            var texture = boundTextures[activeTexture + ":" + (target === gl.TEXTURE_2D ? target : gl.TEXTURE_CUBE_MAP)];
+            var face = (target === gl.TEXTURE_2D ? 0 : target - gl.TEXTURE_CUBE_MAP_POSITIVE_X);
+            setSize(texture, face * 32 + level, width * height * bytesPerPixel(format, type));
+        },
+        renderbufferStorage: function(target, internalformat, width, height) {
+            setSize(boundRenderbuffer, 0, width * height * renderbufferBytesPerPixel(internalformat));
+        },
+        deleteBuffer: release,
+        deleteTexture: release,
+        deleteRenderbuffer: release
+    };
+
+    Object.getOwnPropertyNames(Object.getPrototypeOf(gl)).forEach(function(name) {
+        var method = gl[name];
+        if (typeof method !== "function" || name === "constructor") {
+            return;
+        }
+
+        var hook = hooks[name];
+        stats.callsByName[name] = 0;
+        gl[name] = function() {
+            stats.calls++;
+            stats.callsByName[name]++;
+            if (hook) {
+                hook.apply(null, arguments);
+            }
+            return method.apply(this, arguments);
+        };
+    });
+
+    return stats;
+}
+
+function percentile(sorted, p) {
+    if (!sorted.length) {
+        return 0;
+    }
+    var index = Math.ceil(p / 100 * sorted.length) - 1;
+    return sorted[Math.min(sorted.length - 1, Math.max(0, index))];
+}
+
+function summarize(values) {
+    var sorted = values.slice().sort(function(a, b) {
+        return a - b;
+    });
+    var total = values.reduce(function(sum, value) {
+        return sum + value;
+    }, 0);
+    return {
+        mean: values.length ? total / values.length : 0,
+        min: sorted.length ? sorted[0] : 0,
+        max: sorted.length ? sorted[sorted.length - 1] : 0,
+        p50: percentile(sorted, 50),
+        p95: percentile(sorted, 95),
+        p99: percentile(sorted, 99)
+    };
+}
+
+function now() {
+    var t = process.hrtime();
+    return t[0] * 1e3 + t[1] / 1e6;
+}
+
+function runScene(scene, stats) {
+    gl.viewport(0, 0, options.width, options.height);
+    gl.clearColor(0.0, 0.0, 0.0, 1.0);
+
+    stats.memory = 0;
+    stats.peakMemory = 0;
+
+    var state = scene.setup(gl, options);
+    var frameTimes = [];
+    var callCounts = [];
+
+    for (var i = 0; i < options.warmup + options.frames; i++) {
+        var calls = stats.calls;
+        var start = now();
+
+        scene.frame(gl, state, i);
+        gles2.nextFrame(true);
+
+        if (i >= options.warmup) {
+            frameTimes.push(now() - start);
+            callCounts.push(stats.calls - calls);
+        }
+    }
+
+    scene.teardown(gl, state);
+
+    var error = gl.getError();
+    if (error !== gl.NO_ERROR) {
+        console.warn("Scene '" + scene.name + "' left GL error 0x" + error.toString(16));
+    }
+
+    return {
+        name: scene.name,
+        description: scene.description,
+        frames: options.frames,
+        frameTime: summarize(frameTimes),
+        glCallsPerFrame: summarize(callCounts),
+        peakGpuMemoryBytes: stats.peakMemory
+    };
+}
+
+function gitCommit() {
+    try {
+        return childProcess.execSync("git rev-parse HEAD", {cwd: __dirname, stdio: ["ignore", "pipe", "ignore"]}).toString().trim();
+    } catch(e) {
+        return null;
+    }
+}
+
+var stats = instrument(gl);
+
+var results = {
+    date: new Date().toISOString(),
+    commit: gitCommit(),
+    device: {
+        platform: os.platform(),
+        arch: os.arch(),
+        cpu: (os.cpus()[0] || {}).model,
+        node: process.version,
+        vendor: gl.getParameter(gl.VENDOR),
+        renderer: gl.getParameter(gl.RENDERER),
+        version: gl.getParameter(gl.VERSION)
+    },
+    options: {
+        width: options.width,
+        height: options.height,
+        fullscreen: options.fullscreen,
+        frames: options.frames,
+        warmup: options.warmup
+    },
+    // Estimate of the default framebuffer: double buffered RGBA.
+    framebufferBytes: options.width * options.height * 4 * 2,
+    scenes: []
+};
+
+options.scenes.forEach(function(name) {
+    var scene = availableScenes[name];
+    if (scene.supported && !scene.supported(gl)) {
+        console.log(name + ": not supported by this context, skipped");
+        return;
+    }
+
+    var result = runScene(scene, stats);
+    results.scenes.push(result);
+
+    console.log(name + ": p50 " + result.frameTime.p50.toFixed(2) + "ms, p95 " + result.frameTime.p95.toFixed(2) +
+        "ms, p99 " + result.frameTime.p99.toFixed(2) + "ms, " + Math.round(result.glCallsPerFrame.mean) + " calls/frame, " +
+        (result.peakGpuMemoryBytes / (1024 * 1024)).toFixed(1) + "MB");
+});
+
+fs.writeFileSync(path.resolve(options.out), JSON.stringify(results, null, 2));
+console.log("Results written to " + path.resolve(options.out));
+
+process.exit(0);
@@ -0,0 +1,126 @@
+// Instanced quads from two vertex array objects, whose per-instance attribute
+// has a different buffer and divisor, so that every switch between them
+// changes both (which emulated vertex array objects have to get right).
+
+var util = require('../util.js');
+
+var vertexSource = [
+    "attribute vec2 aPosition;",
+    "attribute vec4 aRect;",
+    "uniform float uShift;",
+    "varying vec2 vTexCoord;",
+    "void main(void) {",
+    "    vTexCoord = aPosition;",
+    "    vec2 origin = vec2(mod(aRect.x + uShift + 1.0, 2.0) - 1.0, aRect.y);",
+    "    gl_Position = vec4(origin + aPosition * aRect.zw, 0.0, 1.0);",
+    "}"
+].join("\n");
+
+var fragmentSource = [
+    "#ifdef GL_ES",
+    "precision mediump float;",
+    "#endif",
+    "uniform sampler2D uSampler;",
+    "varying vec2 vTexCoord;",
+    "void main(void) {",
+    "    gl_FragColor = texture2D(uSampler, vTexCoord) * 0.5;",
+    "}"
+].join("\n");
+
+function createRects(gl, count, rnd) {
+    var rects = new Float32Array(count * 4);
+    for (var i = 0; i < rects.length; i += 4) {
+        rects[i] = rnd() * 2 - 1;
+        rects[i + 1] = rnd() * 2 - 1;
+        rects[i + 2] = 0.02 + rnd() * 0.06;
+        rects[i + 3] = 0.02 + rnd() * 0.06;
+    }
+    var buffer = gl.createBuffer();
+    gl.bindBuffer(gl.ARRAY_BUFFER, buffer);
+    gl.bufferData(gl.ARRAY_BUFFER, rects, gl.STATIC_DRAW);
+    return buffer;
+}
+
+function createVertexArray(state, rectBuffer, divisor) {
+    var gl = state.gl;
+    var array = state.vao.createVertexArrayOES();
+    state.vao.bindVertexArrayOES(array);
+    gl.bindBuffer(gl.ARRAY_BUFFER, state.quadBuffer);
+    gl.enableVertexAttribArray(0);
+    gl.vertexAttribPointer(0, 2, gl.FLOAT, false, 0, 0);
+    gl.bindBuffer(gl.ARRAY_BUFFER, rectBuffer);
+    gl.enableVertexAttribArray(1);
+    gl.vertexAttribPointer(1, 4, gl.FLOAT, false, 0, 0);
+    state.instancing.vertexAttribDivisorANGLE(1, divisor);
+    state.vao.bindVertexArrayOES(null);
+    return array;
+}
+
+function supported(gl) {
+    return !!(gl.getExtension("OES_vertex_array_object") && gl.getExtension("ANGLE_instanced_arrays"));
+}
+
+function setup(gl, options) {
+    var count = options.instances || 20000;
+    var rnd = util.random(3);
+
+    var state = {
+        gl: gl,
+        vao: gl.getExtension("OES_vertex_array_object"),
+        instancing: gl.getExtension("ANGLE_instanced_arrays"),
+        program: util.createProgram(gl, vertexSource, fragmentSource, ["aPosition", "aRect"]),
+        quadBuffer: util.createQuadBuffer(gl),
+        texture: util.createTexture(gl, 64, 64, 5),
+        count: count
+    };
+
+    // Each rect of the second array is drawn by two instances.
+    state.rectBuffers = [createRects(gl, count, rnd), createRects(gl, count / 2, rnd)];
+    state.arrays = [createVertexArray(state, state.rectBuffers[0], 1), createVertexArray(state, state.rectBuffers[1], 2)];
+
+    state.shiftLocation = gl.getUniformLocation(state.program, "uShift");
+    gl.useProgram(state.program);
+    gl.uniform1i(gl.getUniformLocation(state.program, "uSampler"), 0);
+
+    gl.enable(gl.BLEND);
+    gl.blendFunc(gl.ONE, gl.ONE_MINUS_SRC_ALPHA);
+
+    return state;
+}
+
+function frame(gl, state, index) {
+    gl.clear(gl.COLOR_BUFFER_BIT);
+
+    gl.useProgram(state.program);
+    gl.activeTexture(gl.TEXTURE0);
+    gl.bindTexture(gl.TEXTURE_2D, state.texture);
+
+    for (var i = 0; i < state.arrays.length; i++) {
+        state.vao.bindVertexArrayOES(state.arrays[i]);
+        gl.uniform1f(state.shiftLocation, index * 0.005 * (i + 1));
+        state.instancing.drawArraysInstancedANGLE(gl.TRIANGLE_STRIP, 0, 4, state.count);
+    }
+    state.vao.bindVertexArrayOES(null);
+}
+
+function teardown(gl, state) {
+    gl.disable(gl.BLEND);
+    state.arrays.forEach(function(array) {
+        state.vao.deleteVertexArrayOES(array);
+    });
+    state.rectBuffers.forEach(function(buffer) {
+        gl.deleteBuffer(buffer);
+    });
+    gl.deleteBuffer(state.quadBuffer);
+    gl.deleteTexture(state.texture);
+    gl.deleteProgram(state.program);
+}
+
+module.exports = {
+    name: "instances",
+    description: "Instanced quads from two vertex array objects with different instance buffers and divisors",
+    supported: supported,
+    setup: setup,
+    frame: frame,
+    teardown: teardown
+};
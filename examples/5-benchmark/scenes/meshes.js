@@ -0,0 +1,142 @@
+// Many small meshes, each with its own buffers and model matrix.
+
+var util = require('../util.js');
+var glMatrix = require('../../gl-matrix.js');
+var mat4 = glMatrix.mat4;
+
+var vertexSource = [
+    "attribute vec3 aPosition;",
+    "attribute vec3 aNormal;",
+    "uniform mat4 uPMatrix;",
+    "uniform mat4 uMVMatrix;",
+    "varying float vLight;",
+    "void main(void) {",
+    "    vec3 normal = normalize(mat3(uMVMatrix[0].xyz, uMVMatrix[1].xyz, uMVMatrix[2].xyz) * aNormal);",
+    "    vLight = 0.3 + 0.7 * max(dot(normal, vec3(0.0, 0.0, 1.0)), 0.0);",
+    "    gl_Position = uPMatrix * uMVMatrix * vec4(aPosition, 1.0);",
+    "}"
+].join("\n");
+
+var fragmentSource = [
+    "#ifdef GL_ES",
+    "precision mediump float;",
+    "#endif",
+    "uniform vec3 uColor;",
+    "varying float vLight;",
+    "void main(void) {",
+    "    gl_FragColor = vec4(uColor * vLight, 1.0);",
+    "}"
+].join("\n");
+
+// Builds a cube with per-face normals, slightly distorted per mesh so that
+// every mesh really has distinct vertex data.
+function createCube(gl, rnd) {
+    var faces = [
+        [[0, 0, 1], [-1, -1, 1], [1, -1, 1], [1, 1, 1], [-1, 1, 1]],
+        [[0, 0, -1], [-1, -1, -1], [-1, 1, -1], [1, 1, -1], [1, -1, -1]],
+        [[0, 1, 0], [-1, 1, -1], [-1, 1, 1], [1, 1, 1], [1, 1, -1]],
+        [[0, -1, 0], [-1, -1, -1], [1, -1, -1], [1, -1, 1], [-1, -1, 1]],
+        [[1, 0, 0], [1, -1, -1], [1, 1, -1], [1, 1, 1], [1, -1, 1]],
+        [[-1, 0, 0], [-1, -1, -1], [-1, -1, 1], [-1, 1, 1], [-1, 1, -1]]
+    ];
+
+    var scale = 0.5 + rnd() * 0.5;
+    var vertices = [];
+    var indices = [];
+    faces.forEach(function(face, f) {
+        for (var v = 1; v < 5; v++) {
+            vertices.push(face[v][0] * scale, face[v][1] * scale, face[v][2] * scale);
+            vertices.push(face[0][0], face[0][1], face[0][2]);
+        }
+        var o = f * 4;
+        indices.push(o, o + 1, o + 2, o, o + 2, o + 3);
+    });
+
+    var mesh = {
+        vertexBuffer: gl.createBuffer(),
+        indexBuffer: gl.createBuffer(),
+        count: indices.length
+    };
+
+    gl.bindBuffer(gl.ARRAY_BUFFER, mesh.vertexBuffer);
+    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(vertices), gl.STATIC_DRAW);
+    gl.bindBuffer(gl.ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+    gl.bufferData(gl.ELEMENT_ARRAY_BUFFER, new Uint16Array(indices), gl.STATIC_DRAW);
+
+    return mesh;
+}
+
+function setup(gl, options) {
+    var count = options.meshes || 500;
+    var rnd = util.random(2);
+
+    var state = {
+        program: util.createProgram(gl, vertexSource, fragmentSource, ["aPosition", "aNormal"]),
+        meshes: [],
+        pMatrix: mat4.create(),
+        mvMatrix: mat4.create()
+    };
+
+    for (var i = 0; i < count; i++) {
+        var mesh = createCube(gl, rnd);
+        mesh.position = [(rnd() - 0.5) * 40, (rnd() - 0.5) * 24, -20 - rnd() * 40];
+        mesh.axis = [rnd(), rnd(), rnd()];
+        mesh.color = [rnd(), rnd(), rnd()];
+        state.meshes.push(mesh);
+    }
+
+    state.pMatrixLocation = gl.getUniformLocation(state.program, "uPMatrix");
+    state.mvMatrixLocation = gl.getUniformLocation(state.program, "uMVMatrix");
+    state.colorLocation = gl.getUniformLocation(state.program, "uColor");
+
+    mat4.perspective(45, options.width / options.height, 0.1, 100.0, state.pMatrix);
+
+    gl.enable(gl.DEPTH_TEST);
+
+    return state;
+}
+
+function frame(gl, state, index) {
+    gl.clear(gl.COLOR_BUFFER_BIT | gl.DEPTH_BUFFER_BIT);
+
+    gl.useProgram(state.program);
+    gl.uniformMatrix4fv(state.pMatrixLocation, false, state.pMatrix);
+    gl.enableVertexAttribArray(0);
+    gl.enableVertexAttribArray(1);
+
+    for (var i = 0, n = state.meshes.length; i < n; i++) {
+        var mesh = state.meshes[i];
+
+        mat4.identity(state.mvMatrix);
+        mat4.translate(state.mvMatrix, mesh.position);
+        mat4.rotate(state.mvMatrix, index * 0.02 + i, mesh.axis);
+
+        gl.bindBuffer(gl.ARRAY_BUFFER, mesh.vertexBuffer);
+        gl.vertexAttribPointer(0, 3, gl.FLOAT, false, 24, 0);
+        gl.vertexAttribPointer(1, 3, gl.FLOAT, false, 24, 12);
+        gl.bindBuffer(gl.ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+
+        gl.uniformMatrix4fv(state.mvMatrixLocation, false, state.mvMatrix);
+        gl.uniform3f(state.colorLocation, mesh.color[0], mesh.color[1], mesh.color[2]);
+        gl.drawElements(gl.TRIANGLES, mesh.count, gl.UNSIGNED_SHORT, 0);
+    }
+}
+
+function teardown(gl, state) {
+    gl.disable(gl.DEPTH_TEST);
+    gl.disableVertexAttribArray(0);
+    gl.disableVertexAttribArray(1);
+    state.meshes.forEach(function(mesh) {
+        gl.deleteBuffer(mesh.vertexBuffer);
+        gl.deleteBuffer(mesh.indexBuffer);
+    });
+    gl.deleteProgram(state.program);
+}
+
+module.exports = {
+    name: "meshes",
+    description: "Hundreds of small meshes with their own buffers and matrices",
+    setup: setup,
+    frame: frame,
+    teardown: teardown
+};
@@ -0,0 +1,172 @@
+// Post-processing: the scene is rendered into an offscreen texture and then
+// passed through a separable blur and a composite pass.
+
+var util = require('../util.js');
+
+var quadVertexSource = [
+    "attribute vec2 aPosition;",
+    "varying vec2 vTexCoord;",
+    "void main(void) {",
+    "    vTexCoord = aPosition;",
+    "    gl_Position = vec4(aPosition * 2.0 - 1.0, 0.0, 1.0);",
+    "}"
+].join("\n");
+
+var sceneFragmentSource = [
+    "#ifdef GL_ES",
+    "precision mediump float;",
+    "#endif",
+    "uniform float uTime;",
+    "varying vec2 vTexCoord;",
+    "void main(void) {",
+    "    vec2 p = vTexCoord * 8.0;",
+    "    float v = sin(p.x + uTime) * cos(p.y - uTime * 0.7);",
+    "    gl_FragColor = vec4(0.5 + 0.5 * v, vTexCoord, 1.0);",
+    "}"
+].join("\n");
+
+var blurFragmentSource = [
+    "#ifdef GL_ES",
+    "precision mediump float;",
+    "#endif",
+    "uniform sampler2D uSampler;",
+    "uniform vec2 uDirection;",
+    "varying vec2 vTexCoord;",
+    "void main(void) {",
+    "    vec4 sum = texture2D(uSampler, vTexCoord) * 0.2270270270;",
+    "    sum += texture2D(uSampler, vTexCoord + uDirection * 1.3846153846) * 0.3162162162;",
+    "    sum += texture2D(uSampler, vTexCoord - uDirection * 1.3846153846) * 0.3162162162;",
+    "    sum += texture2D(uSampler, vTexCoord + uDirection * 3.2307692308) * 0.0702702703;",
+    "    sum += texture2D(uSampler, vTexCoord - uDirection * 3.2307692308) * 0.0702702703;",
+    "    gl_FragColor = sum;",
+    "}"
+].join("\n");
+
+var compositeFragmentSource = [
+    "#ifdef GL_ES",
+    "precision mediump float;",
+    "#endif",
+    "uniform sampler2D uScene;",
+    "uniform sampler2D uBlur;",
+    "varying vec2 vTexCoord;",
+    "void main(void) {",
+    "    gl_FragColor = texture2D(uScene, vTexCoord) * 0.6 + texture2D(uBlur, vTexCoord) * 0.6;",
+    "}"
+].join("\n");
+
+function createTarget(gl, width, height) {
+    var target = {
+        texture: gl.createTexture(),
+        framebuffer: gl.createFramebuffer()
+    };
+
+    gl.bindTexture(gl.TEXTURE_2D, target.texture);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.LINEAR);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.LINEAR);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+    gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, width, height, 0, gl.RGBA, gl.UNSIGNED_BYTE, null);
+
+    gl.bindFramebuffer(gl.FRAMEBUFFER, target.framebuffer);
+    gl.framebufferTexture2D(gl.FRAMEBUFFER, gl.COLOR_ATTACHMENT0, gl.TEXTURE_2D, target.texture, 0);
+    if (gl.checkFramebufferStatus(gl.FRAMEBUFFER) !== gl.FRAMEBUFFER_COMPLETE) {
+        throw new Error("Offscreen target is not complete");
+    }
+    gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+
+    return target;
+}
+
+function setup(gl, options) {
+    var width = options.width;
+    var height = options.height;
+    // The blur runs at half resolution, as most real post-processing chains do.
+    var blurWidth = width >> 1;
+    var blurHeight = height >> 1;
+
+    var state = {
+        width: width,
+        height: height,
+        blurWidth: blurWidth,
+        blurHeight: blurHeight,
+        buffer: util.createQuadBuffer(gl),
+        sceneProgram: util.createProgram(gl, quadVertexSource, sceneFragmentSource, ["aPosition"]),
+        blurProgram: util.createProgram(gl, quadVertexSource, blurFragmentSource, ["aPosition"]),
+        compositeProgram: util.createProgram(gl, quadVertexSource, compositeFragmentSource, ["aPosition"]),
+        scene: createTarget(gl, width, height),
+        ping: createTarget(gl, blurWidth, blurHeight),
+        pong: createTarget(gl, blurWidth, blurHeight)
+    };
+
+    state.timeLocation = gl.getUniformLocation(state.sceneProgram, "uTime");
+    state.directionLocation = gl.getUniformLocation(state.blurProgram, "uDirection");
+
+    gl.useProgram(state.blurProgram);
+    gl.uniform1i(gl.getUniformLocation(state.blurProgram, "uSampler"), 0);
+    gl.useProgram(state.compositeProgram);
+    gl.uniform1i(gl.getUniformLocation(state.compositeProgram, "uScene"), 0);
+    gl.uniform1i(gl.getUniformLocation(state.compositeProgram, "uBlur"), 1);
+
+    return state;
+}
+
+// Draws a full screen quad with the current program into the given target.
+function pass(gl, target, width, height) {
+    gl.bindFramebuffer(gl.FRAMEBUFFER, target ? target.framebuffer : null);
+    gl.viewport(0, 0, width, height);
+    gl.drawArrays(gl.TRIANGLE_STRIP, 0, 4);
+}
+
+function frame(gl, state, index) {
+    gl.bindBuffer(gl.ARRAY_BUFFER, state.buffer);
+    gl.enableVertexAttribArray(0);
+    gl.vertexAttribPointer(0, 2, gl.FLOAT, false, 0, 0);
+
+    gl.useProgram(state.sceneProgram);
+    gl.uniform1f(state.timeLocation, index * 0.05);
+    pass(gl, state.scene, state.width, state.height);
+
+    // Two iterations of a horizontal and vertical blur.
+    gl.activeTexture(gl.TEXTURE0);
+    var source = state.scene;
+    for (var i = 0; i < 2; i++) {
+        gl.useProgram(state.blurProgram);
+
+        gl.bindTexture(gl.TEXTURE_2D, source.texture);
+        gl.uniform2f(state.directionLocation, 1 / state.blurWidth, 0);
+        pass(gl, state.ping, state.blurWidth, state.blurHeight);
+
+        gl.bindTexture(gl.TEXTURE_2D, state.ping.texture);
+        gl.uniform2f(state.directionLocation, 0, 1 / state.blurHeight);
+        pass(gl, state.pong, state.blurWidth, state.blurHeight);
+
+        source = state.pong;
+    }
+
+    gl.useProgram(state.compositeProgram);
+    gl.activeTexture(gl.TEXTURE1);
+    gl.bindTexture(gl.TEXTURE_2D, state.pong.texture);
+    gl.activeTexture(gl.TEXTURE0);
+    gl.bindTexture(gl.TEXTURE_2D, state.scene.texture);
+    pass(gl, null, state.width, state.height);
+}
+
+function teardown(gl, state) {
+    gl.disableVertexAttribArray(0);
+    [state.scene, state.ping, state.pong].forEach(function(target) {
+        gl.deleteFramebuffer(target.framebuffer);
+        gl.deleteTexture(target.texture);
+    });
+    gl.deleteBuffer(state.buffer);
+    gl.deleteProgram(state.sceneProgram);
+    gl.deleteProgram(state.blurProgram);
+    gl.deleteProgram(state.compositeProgram);
+}
+
+module.exports = {
+    name: "postprocess",
+    description: "Offscreen scene, two-pass separable blur and composite",
+    setup: setup,
+    frame: frame,
+    teardown: teardown
+};
@@ -0,0 +1,106 @@
+// Thousands of individually drawn textured quads, the typical UI workload.
+
+var util = require('../util.js');
+
+var vertexSource = [
+    "attribute vec2 aPosition;",
+    "uniform vec4 uRect;",
+    "varying vec2 vTexCoord;",
+    "void main(void) {",
+    "    vTexCoord = aPosition;",
+    "    gl_Position = vec4(uRect.xy + aPosition * uRect.zw, 0.0, 1.0);",
+    "}"
+].join("\n");
+
+var fragmentSource = [
+    "#ifdef GL_ES",
+    "precision mediump float;",
+    "#endif",
+    "uniform sampler2D uSampler;",
+    "uniform float uAlpha;",
+    "varying vec2 vTexCoord;",
+    "void main(void) {",
+    "    gl_FragColor = texture2D(uSampler, vTexCoord) * uAlpha;",
+    "}"
+].join("\n");
+
+function setup(gl, options) {
+    var count = options.quads || 3000;
+    var rnd = util.random(1);
+
+    var state = {
+        program: util.createProgram(gl, vertexSource, fragmentSource, ["aPosition"]),
+        buffer: util.createQuadBuffer(gl),
+        textures: [],
+        quads: []
+    };
+
+    for (var i = 0; i < 8; i++) {
+        state.textures.push(util.createTexture(gl, 128, 128, i));
+    }
+
+    for (i = 0; i < count; i++) {
+        state.quads.push({
+            x: rnd() * 2 - 1,
+            y: rnd() * 2 - 1,
+            w: 0.02 + rnd() * 0.08,
+            h: 0.02 + rnd() * 0.08,
+            speed: rnd() * 0.01,
+            // Quads are grouped by texture, like a sorted UI would do.
+            texture: state.textures[Math.floor(i * state.textures.length / count)]
+        });
+    }
+
+    state.rectLocation = gl.getUniformLocation(state.program, "uRect");
+    state.alphaLocation = gl.getUniformLocation(state.program, "uAlpha");
+
+    gl.useProgram(state.program);
+    gl.uniform1i(gl.getUniformLocation(state.program, "uSampler"), 0);
+
+    gl.enable(gl.BLEND);
+    gl.blendFunc(gl.ONE, gl.ONE_MINUS_SRC_ALPHA);
+
+    return state;
+}
+
+function frame(gl, state, index) {
+    gl.clear(gl.COLOR_BUFFER_BIT);
+
+    gl.useProgram(state.program);
+    gl.bindBuffer(gl.ARRAY_BUFFER, state.buffer);
+    gl.enableVertexAttribArray(0);
+    gl.vertexAttribPointer(0, 2, gl.FLOAT, false, 0, 0);
+    gl.activeTexture(gl.TEXTURE0);
+
+    var texture = null;
+    for (var i = 0, n = state.quads.length; i < n; i++) {
+        var quad = state.quads[i];
+        if (quad.texture !== texture) {
+            texture = quad.texture;
+            gl.bindTexture(gl.TEXTURE_2D, texture);
+        }
+
+        var x = ((quad.x + quad.speed * index + 1) % 2) - 1;
+        gl.uniform4f(state.rectLocation, x, quad.y, quad.w, quad.h);
+        gl.uniform1f(state.alphaLocation, 0.75);
+        gl.drawArrays(gl.TRIANGLE_STRIP, 0, 4);
+    }
+}
+
+function teardown(gl, state) {
+    gl.disable(gl.BLEND);
+    gl.disableVertexAttribArray(0);
+    state.textures.forEach(function(texture) {
+        gl.deleteTexture(texture);
+    });
+    gl.deleteBuffer(state.buffer);
+    gl.deleteProgram(state.program);
+}
+
+module.exports = {
+    name: "quads",
+    description: "Thousands of textured quads, one draw call each",
+    setup: setup,
+    frame: frame,
+    teardown: teardown
+};
@@ -0,0 +1,121 @@
+// Heavy texture streaming: a grid of tiles whose contents are re-uploaded
+// every frame, plus one texture that is fully re-specified each frame.
+
+var util = require('../util.js');
+
+var vertexSource = [
+    "attribute vec2 aPosition;",
+    "uniform vec4 uRect;",
+    "varying vec2 vTexCoord;",
+    "void main(void) {",
+    "    vTexCoord = aPosition;",
+    "    gl_Position = vec4(uRect.xy + aPosition * uRect.zw, 0.0, 1.0);",
+    "}"
+].join("\n");
+
+var fragmentSource = [
+    "#ifdef GL_ES",
+    "precision mediump float;",
+    "#endif",
+    "uniform sampler2D uSampler;",
+    "varying vec2 vTexCoord;",
+    "void main(void) {",
+    "    gl_FragColor = texture2D(uSampler, vTexCoord);",
+    "}"
+].join("\n");
+
+function setup(gl, options) {
+    var columns = 6;
+    var rows = 4;
+    var size = options.tileSize || 256;
+
+    var state = {
+        program: util.createProgram(gl, vertexSource, fragmentSource, ["aPosition"]),
+        buffer: util.createQuadBuffer(gl),
+        size: size,
+        tiles: [],
+        // Number of tiles updated per frame.
+        updates: options.textureUpdates || 8,
+        // Pre-generated contents, so that pixel generation isn't measured.
+        pixels: [],
+        poster: null,
+        posterSize: options.posterSize || 1024
+    };
+
+    for (var i = 0; i < 4; i++) {
+        var pixels = new Uint8Array(size * size * 4);
+        util.fillPixels(pixels, size, size, i);
+        state.pixels.push(pixels);
+    }
+
+    state.posterPixels = new Uint8Array(state.posterSize * state.posterSize * 4);
+    util.fillPixels(state.posterPixels, state.posterSize, state.posterSize, 5);
+
+    for (var y = 0; y < rows; y++) {
+        for (var x = 0; x < columns; x++) {
+            state.tiles.push({
+                texture: util.createTexture(gl, size, size, x + y),
+                rect: [-1 + x * 2 / columns, -1 + y * 2 / rows, 2 / columns, 2 / rows]
+            });
+        }
+    }
+
+    state.poster = util.createTexture(gl, state.posterSize, state.posterSize, 6);
+
+    state.rectLocation = gl.getUniformLocation(state.program, "uRect");
+    gl.useProgram(state.program);
+    gl.uniform1i(gl.getUniformLocation(state.program, "uSampler"), 0);
+
+    return state;
+}
+
+function frame(gl, state, index) {
+    var size = state.size;
+    var tiles = state.tiles;
+
+    gl.activeTexture(gl.TEXTURE0);
+
+    for (var i = 0; i < state.updates; i++) {
+        var tile = tiles[(index * state.updates + i) % tiles.length];
+        gl.bindTexture(gl.TEXTURE_2D, tile.texture);
+        gl.texSubImage2D(gl.TEXTURE_2D, 0, 0, 0, size, size, gl.RGBA, gl.UNSIGNED_BYTE, state.pixels[(index + i) % state.pixels.length]);
+    }
+
+    // Full re-specification, as done when a new poster replaces an old one.
+    gl.bindTexture(gl.TEXTURE_2D, state.poster);
+    gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, state.posterSize, state.posterSize, 0, gl.RGBA, gl.UNSIGNED_BYTE, state.posterPixels);
+
+    gl.clear(gl.COLOR_BUFFER_BIT);
+    gl.useProgram(state.program);
+    gl.bindBuffer(gl.ARRAY_BUFFER, state.buffer);
+    gl.enableVertexAttribArray(0);
+    gl.vertexAttribPointer(0, 2, gl.FLOAT, false, 0, 0);
+
+    for (i = 0; i < tiles.length; i++) {
+        gl.bindTexture(gl.TEXTURE_2D, tiles[i].texture);
+        gl.uniform4f(state.rectLocation, tiles[i].rect[0], tiles[i].rect[1], tiles[i].rect[2], tiles[i].rect[3]);
+        gl.drawArrays(gl.TRIANGLE_STRIP, 0, 4);
+    }
+
+    gl.bindTexture(gl.TEXTURE_2D, state.poster);
+    gl.uniform4f(state.rectLocation, -0.25, -0.25, 0.5, 0.5);
+    gl.drawArrays(gl.TRIANGLE_STRIP, 0, 4);
+}
+
+function teardown(gl, state) {
+    gl.disableVertexAttribArray(0);
+    state.tiles.forEach(function(tile) {
+        gl.deleteTexture(tile.texture);
+    });
+    gl.deleteTexture(state.poster);
+    gl.deleteBuffer(state.buffer);
+    gl.deleteProgram(state.program);
+}
+
+module.exports = {
+    name: "textures",
+    description: "Texture streaming with texSubImage2D and texImage2D every frame",
+    setup: setup,
+    frame: frame,
+    teardown: teardown
+};
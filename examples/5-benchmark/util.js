@@ -0,0 +1,93 @@
+// Helpers shared by the benchmark scenes.
+
+function compileShader(gl, type, source) {
+    var shader = gl.createShader(type);
+    gl.shaderSource(shader, source);
+    gl.compileShader(shader);
+
+    if (!gl.getShaderParameter(shader, gl.COMPILE_STATUS)) {
+        throw new Error('shader error: ' + gl.getShaderInfoLog(shader));
+    }
+
+    return shader;
+}
+
+function createProgram(gl, vertexSource, fragmentSource, attributes) {
+    var vertexShader = compileShader(gl, gl.VERTEX_SHADER, vertexSource);
+    var fragmentShader = compileShader(gl, gl.FRAGMENT_SHADER, fragmentSource);
+
+    var program = gl.createProgram();
+    gl.attachShader(program, vertexShader);
+    gl.attachShader(program, fragmentShader);
+
+    // Bind attributes to fixed locations so scenes don't have to look them up.
+    (attributes || []).forEach(function(name, index) {
+        gl.bindAttribLocation(program, index, name);
+    });
+
+    gl.linkProgram(program);
+
+    if (!gl.getProgramParameter(program, gl.LINK_STATUS)) {
+        throw new Error('link error: ' + gl.getProgramInfoLog(program));
+    }
+
+    // The shaders are owned by the program from now on.
+    gl.deleteShader(vertexShader);
+    gl.deleteShader(fragmentShader);
+
+    return program;
+}
+
+function createTexture(gl, width, height, seed) {
+    var pixels = new Uint8Array(width * height * 4);
+    fillPixels(pixels, width, height, seed || 0);
+
+    var texture = gl.createTexture();
+    gl.bindTexture(gl.TEXTURE_2D, texture);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.LINEAR);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.LINEAR);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+    gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, width, height, 0, gl.RGBA, gl.UNSIGNED_BYTE, pixels);
+
+    return texture;
+}
+
+// Fills an RGBA buffer with a cheap, seed-dependent pattern.
+function fillPixels(pixels, width, height, seed) {
+    var o = 0;
+    for (var y = 0; y < height; y++) {
+        for (var x = 0; x < width; x++) {
+            pixels[o++] = (x + seed * 37) & 0xff;
+            pixels[o++] = (y + seed * 71) & 0xff;
+            pixels[o++] = ((x ^ y) + seed * 13) & 0xff;
+            pixels[o++] = 0xff;
+        }
+    }
+}
+
+// Unit quad as a triangle strip, used by most scenes.
+function createQuadBuffer(gl) {
+    var buffer = gl.createBuffer();
+    gl.bindBuffer(gl.ARRAY_BUFFER, buffer);
+    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array([0, 0, 1, 0, 0, 1, 1, 1]), gl.STATIC_DRAW);
+    return buffer;
+}
+
+// Deterministic pseudo random numbers, so every run draws the same scene.
+function random(seed) {
+    var state = seed || 1;
+    return function() {
+        state = (state * 1103515245 + 12345) & 0x7fffffff;
+        return state / 0x7fffffff;
+    };
+}
+
+module.exports = {
+    compileShader: compileShader,
+    createProgram: createProgram,
+    createTexture: createTexture,
+    fillPixels: fillPixels,
+    createQuadBuffer: createQuadBuffer,
+    random: random
+};
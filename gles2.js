@@ -1,5 +1,9 @@
+var fs = require('fs');
 var gles2 = require('./build/Release/gles2');
 
+// The context that receives GL calls, for settling its queued uploads at the end of the frame.
+var current = null;
+
 var init = function(options) {
     options = options || {};
 
@@ -8,19 +12,289 @@ var init = function(options) {
     var fullscreen = !!options.fullscreen;
     var title = options.title || "";
     var layer = options.layer || 0;
+    var version = (options.version === 2 ? 2 : 1);
+    var offscreen = !!options.offscreen;
+    var share = (options.share ? options.share._context : 0);
+
+    // The buffers to ask for; the closest configuration that the platform offers is taken.
+    var bits = function(value, otherwise, enabled) {
+        return (typeof value === "number" ? value : (value === undefined ? otherwise : (value ? enabled : 0)));
+    };
+    var rgb565 = (options.colorBits === 16);
+    var config = {
+        redBits: rgb565 ? 5 : 8,
+        greenBits: rgb565 ? 6 : 8,
+        blueBits: rgb565 ? 5 : 8,
+        alphaBits: bits(options.alpha, rgb565 ? 0 : 8, 8),
+        depthBits: bits(options.depth, 24, 24),
+        stencilBits: bits(options.stencil, 0, 8),
+        samples: bits(options.antialias, 0, 4),
+        preserved: !!options.preserveDrawingBuffer
+    };
+
+    // WebGL 2 needs an OpenGL ES 3.0 context.
+    var context = gles2.init(width, height, fullscreen, title, layer, version === 2 ? 3 : 2, offscreen, share, config);
+
+    var webgl = require('./lib/webgl');
+    var gl = (version === 2 ? new webgl.WebGL2RenderingContext() : new webgl.WebGLRenderingContext());
+    gl._context = context;
+    gl._surfaceConfig = gles2.getSurfaceConfig(context);
+    current = gl;
+
+    if (options.dynamicResolution) {
+        var dynamic = (typeof options.dynamicResolution === "object" ? options.dynamicResolution : {});
+        var enabled = gl.gl.enableDynamicResolution(width, height,
+            typeof dynamic.minScale === "number" ? dynamic.minScale : 0.5,
+            typeof dynamic.maxScale === "number" ? dynamic.maxScale : 1,
+            typeof dynamic.targetFrameTime === "number" ? dynamic.targetFrameTime : 1000 / 60,
+            dynamic.filter === "sharpen");
+        // The upscale redraws the whole window every frame.
+        gl._dynamicResolution = enabled;
+        if (!enabled) {
+            console.warn("Dynamic resolution is not available; rendering at full resolution.");
+        }
+    }
+
+    if (options.skipRedundantFrames) {
+        gl.enableFrameSkipping(options.skipRedundantFrames);
+    }
+
+    if (options.programCache) {
+        try {
+            fs.mkdirSync(options.programCache);
+        } catch(e) {
+            if (e.code !== 'EEXIST') throw e;
+        }
+        gl.enableProgramCache(options.programCache);
+    }
+
+    return gl;
+};
+
+// The context of gl receives the GL calls from now on, and nextFrame ends its frames; null releases the current one.
+var makeCurrent = function(gl) {
+    var result = gles2.makeCurrent(gl ? gl._context : 0);
+    if (result) {
+        current = gl || null;
+    }
+    return result;
+};
+
+// Closes the window or surface of gl. Objects created with it can't be used anymore.
+var destroy = function(gl) {
+    gles2.destroyContext(gl._context);
+    gl._context = 0;
+    if (current === gl) {
+        current = null;
+    }
+};
+
+// Flattens [x, y, width, height] rects for the native side.
+var flattenRects = function(rects, usage) {
+    if (!Array.isArray(rects)) {
+        throw new TypeError('Expected ' + usage);
+    }
+    var flat = [];
+    for (var i = 0; i < rects.length; i++) {
+        var rect = rects[i];
+        if (!rect || rect.length !== 4) {
+            throw new TypeError('Expected ' + usage);
+        }
+        flat.push(rect[0] | 0, rect[1] | 0, rect[2] | 0, rect[3] | 0);
+    }
+    return flat;
+};
 
-    gles2.init(width, height, fullscreen, title, layer);
+// Ends the frame. false doesn't show it. With {damage: rects}, only the given [x, y, width, height] rects (window
+// coordinates, origin at the bottom left) changed since the last frame; with no rects, nothing is shown.
+var nextFrame = function(options) {
+    var swapBuffers = (options !== false);
+    var damage;
+    if (options && typeof options === "object") {
+        swapBuffers = (options.swapBuffers !== false);
+        if (options.damage !== undefined) {
+            damage = flattenRects(options.damage, 'nextFrame({array damage})');
+            if (!damage.length) {
+                swapBuffers = false;
+            }
+        }
+        if (current && current._dynamicResolution) {
+            damage = undefined;
+        }
+    }
+    var result = gles2.nextFrame(swapBuffers, damage);
+    frameDue = now() + result.delay;
+    if (current) {
+        current._settleUploads();
+    }
+    scheduleIdle(result.idle);
+};
+
+// How many frames ago the contents of the back buffer were drawn, so that only the damage of those frames has to be
+// redrawn; 0 when they are undefined and the whole frame has to be redrawn.
+var bufferAge = function() {
+    if (current && current._dynamicResolution) {
+        return 0;
+    }
+    return gles2.bufferAge();
+};
+
+// Limits the rendering of this frame to the given rects, before drawing anything. Returns false when not supported.
+var setDamageRegion = function(rects) {
+    return gles2.setDamageRegion(flattenRects(rects, 'setDamageRegion(array rects)'));
+};
+
+// Idle callbacks run after the code that called nextFrame, for as long as the frame pacer predicts that the next
+// frame doesn't have to be started yet. Without frames, they run in idle periods of IDLE_WITHOUT_FRAMES ms.
+var IDLE_WITHOUT_FRAMES = 50;
+var idleCallbacks = [];
+var idleEntries = {};
+var nextIdleHandle = 1;
+var idleImmediate = null;
+var idleTimer = null;
+
+var now = function() {
+    var t = process.hrtime();
+    return t[0] * 1e3 + t[1] / 1e6;
+};
+
+var scheduleIdle = function(idle) {
+    if (idleTimer) {
+        clearTimeout(idleTimer);
+        idleTimer = null;
+    }
+    if (!idleCallbacks.length || idleImmediate) {
+        return;
+    }
+    var deadline = now() + idle;
+    idleImmediate = setImmediate(function() {
+        idleImmediate = null;
+        runIdle(deadline);
+    });
+};
+
+var runIdle = function(deadline) {
+    // Callbacks requested from now on wait for the next idle period.
+    var callbacks = idleCallbacks;
+    idleCallbacks = [];
+
+    var time = now();
+    for (var i = 0; i < callbacks.length; i++) {
+        var entry = callbacks[i];
+        if (entry.cancelled) {
+            continue;
+        }
+        var didTimeout = (entry.timeout !== undefined && time >= entry.timeout);
+        if (!didTimeout && now() >= deadline) {
+            idleCallbacks.push(entry);
+            continue;
+        }
+        delete idleEntries[entry.handle];
+        entry.callback({
+            didTimeout: didTimeout,
+            timeRemaining: function() {
+                return Math.max(0, deadline - now());
+            }
+        });
+    }
+
+    if (idleCallbacks.length && !idleTimer) {
+        idleTimer = setTimeout(idleWithoutFrames, IDLE_WITHOUT_FRAMES);
+    }
+};
+
+var idleWithoutFrames = function() {
+    idleTimer = null;
+    runIdle(now() + IDLE_WITHOUT_FRAMES);
+};
+
+// Calls callback with an IdleDeadline ({didTimeout, timeRemaining()}) when there is time left between frames.
+// options.timeout: milliseconds after which it is called even if there isn't.
+var requestIdleCallback = function(callback, options) {
+    if (typeof callback !== "function") {
+        throw new TypeError('Expected requestIdleCallback(function callback, object options)');
+    }
+    var handle = nextIdleHandle++;
+    var timeout = (options && typeof options.timeout === "number" ? now() + options.timeout : undefined);
+    var entry = {handle: handle, callback: callback, timeout: timeout, cancelled: false};
+    idleCallbacks.push(entry);
+    idleEntries[handle] = entry;
+    if (!idleTimer) {
+        idleTimer = setTimeout(idleWithoutFrames, IDLE_WITHOUT_FRAMES);
+    }
+    return handle;
+};
+
+var cancelIdleCallback = function(handle) {
+    var entry = idleEntries[handle];
+    if (entry) {
+        entry.cancelled = true;
+        delete idleEntries[handle];
+    }
+};
+
+// Animation frame callbacks start the next frame. While skipped frames are throttled, nextFrame asks for the next one
+// to be delayed, and they wait for that with a timer instead of blocking the event loop.
+var frameDue = 0;
+var frameCallbacks = [];
+var frameEntries = {};
+var nextFrameHandle = 1;
+var frameScheduled = false;
+
+var runFrameCallbacks = function() {
+    frameScheduled = false;
+    var callbacks = frameCallbacks;
+    frameCallbacks = [];
+    frameEntries = {};
+
+    var time = now();
+    for (var i = 0; i < callbacks.length; i++) {
+        if (!callbacks[i].cancelled) {
+            callbacks[i].callback(time);
+        }
+    }
+};
 
-    return require('./lib/webgl').instance;
+// Calls callback with the current time in ms once the next frame can be started.
+var requestAnimationFrame = function(callback) {
+    if (typeof callback !== "function") {
+        throw new TypeError('Expected requestAnimationFrame(function callback)');
+    }
+    var handle = nextFrameHandle++;
+    var entry = {callback: callback, cancelled: false};
+    frameCallbacks.push(entry);
+    frameEntries[handle] = entry;
+    if (!frameScheduled) {
+        frameScheduled = true;
+        var wait = frameDue - now();
+        if (wait > 0) {
+            setTimeout(runFrameCallbacks, wait);
+        } else {
+            setImmediate(runFrameCallbacks);
+        }
+    }
+    return handle;
 };
 
-var nextFrame = function(swapBuffers) {
-    gles2.nextFrame((swapBuffers !== false));
+var cancelAnimationFrame = function(handle) {
+    var entry = frameEntries[handle];
+    if (entry) {
+        entry.cancelled = true;
+        delete frameEntries[handle];
+    }
 };
 
 module.exports = {
     init: init,
-    nextFrame: nextFrame
+    makeCurrent: makeCurrent,
+    destroy: destroy,
+    nextFrame: nextFrame,
+    bufferAge: bufferAge,
+    setDamageRegion: setDamageRegion,
+    requestIdleCallback: requestIdleCallback,
+    cancelIdleCallback: cancelIdleCallback,
+    requestAnimationFrame: requestAnimationFrame,
+    cancelAnimationFrame: cancelAnimationFrame
 };
 
 
@@ -5,6 +5,14 @@ function WebGLRenderingContext() {
     this.gl = new gles2.WebGLRenderingContext();
 }
 
+// WebGL 2 context, created by init({version: 2}).
+function WebGL2RenderingContext() {
+    this.gl = new gles2.WebGL2RenderingContext();
+    this._vertexArray = null;
+}
+WebGL2RenderingContext.prototype = Object.create(WebGLRenderingContext.prototype);
+WebGL2RenderingContext.prototype.constructor = WebGL2RenderingContext;
+
 // Support objects.
 function WebGLProgram(_) { this._ = _; };
 function WebGLShader(_) { this._ = _; };
@@ -14,8 +22,27 @@ function WebGLRenderbuffer(_) { this._ = _; };
 function WebGLTexture(_) { this._ = _; };
 function WebGLActiveInfo(_) { this._=_; this.size=_.size; this.type=_.type; this.name=_.name; };
 function WebGLUniformLocation(_) { this._ = _; };
+function ShaderLibrary(ctx) { this._ctx = ctx; };
+function WebGLVertexArrayObjectOES(_) { this._ = _; };
+function WebGLVertexArrayObject(_) { this._ = _; };
+function WebGLSampler(_) { this._ = _; };
+function WebGLSync(_) { this._ = _; };
+function WebGLInstanceBatch(ctx, _) { this._ctx = ctx; this._ = _; this.instancesPerDraw = ctx.gl.getInstanceBatchSize(_); };
+function WebGLMirroredBuffer(ctx, _, data) { this._ctx = ctx; this._ = _; this.data = data; this.buffer = new WebGLBuffer(ctx.gl.getMirroredBufferObject(_)); };
+function WebGLTextureUpload(ctx, _) { this._ctx = ctx; this._ = _; };
+function WebGLSpriteBatch(ctx, _, maxSprites) {
+    this._ctx = ctx; this._ = _; this.textureUnits = ctx.gl.getSpriteBatchUnits(_);
+    this.records = new Float32Array(maxSprites * this.FIELDS); this.colors = new Uint32Array(this.records.buffer); this.count = 0;
+};
+function WebGLTextRenderer(ctx, _) { this._ctx = ctx; this._ = _; };
+function WebGLFont(_) { this._ = _; };
+function WebGLPathRenderer(ctx, _) { this._ctx = ctx; this._ = _; this._paint = new Float32Array(10); };
+function WebGLPath(renderer, _) { this._renderer = renderer; this._ = _; this._commands = []; this._dirty = false; };
+function WebGLTextureAtlas(ctx, _) { this._ctx = ctx; this._ = _; this.generation = 0; this._regions = {}; };
+function WebGLStreamingBuffer(ctx, _, size) { this._ctx = ctx; this._ = _; this.size = size; this.buffer = new WebGLBuffer(ctx.gl.getStreamingBufferObject(_)); };
 
 exports.WebGLRenderingContext = WebGLRenderingContext;
+exports.WebGL2RenderingContext = WebGL2RenderingContext;
 exports.WebGLProgram = WebGLProgram;
 exports.WebGLShader = WebGLShader;
 exports.WebGLBuffer = WebGLBuffer;
@@ -24,9 +51,30 @@ exports.WebGLRenderbuffer = WebGLRenderbuffer;
 exports.WebGLTexture = WebGLTexture;
 exports.WebGLActiveInfo = WebGLActiveInfo;
 exports.WebGLUniformLocation = WebGLUniformLocation;
-
-// The singleton webgl render context.
-exports.instance = new WebGLRenderingContext();
+exports.ShaderLibrary = ShaderLibrary;
+exports.WebGLVertexArrayObjectOES = WebGLVertexArrayObjectOES;
+exports.WebGLInstanceBatch = WebGLInstanceBatch;
+exports.WebGLStreamingBuffer = WebGLStreamingBuffer;
+exports.WebGLSpriteBatch = WebGLSpriteBatch;
+exports.WebGLTextRenderer = WebGLTextRenderer;
+exports.WebGLFont = WebGLFont;
+exports.WebGLPathRenderer = WebGLPathRenderer;
+exports.WebGLPath = WebGLPath;
+exports.WebGLTextureAtlas = WebGLTextureAtlas;
+exports.WebGLMirroredBuffer = WebGLMirroredBuffer;
+exports.WebGLTextureUpload = WebGLTextureUpload;
+exports.WebGLVertexArrayObject = WebGLVertexArrayObject;
+exports.WebGLSampler = WebGLSampler;
+exports.WebGLSync = WebGLSync;
+
+// A webgl render context for the current GL context, created on first use. init() returns one for every context it
+// creates; this is kept for code that predates that.
+var instance = null;
+Object.defineProperty(exports, 'instance', {
+    get: function() {
+        return instance || (instance = new WebGLRenderingContext());
+    }
+});
 
 // The following constants were extracted from the Broadcom's gl2.h file.
 
@@ -380,23 +428,864 @@ WebGLRenderingContext.prototype.UNPACK_PREMULTIPLY_ALPHA_WEBGL = 0x9241;
 /* Non-WebGL enums: pixel format that switches B and R values; handy when using cairo canvas. */
 WebGLRenderingContext.prototype.UNPACK_FLIP_BLUE_RED = 0x9245;
 
+/* Non-WebGL enums: mapBuffer access flags. */
+WebGLRenderingContext.prototype.MAP_READ_BIT = 0x0001;
+WebGLRenderingContext.prototype.MAP_WRITE_BIT = 0x0002;
+WebGLRenderingContext.prototype.MAP_INVALIDATE_RANGE_BIT = 0x0004;
+WebGLRenderingContext.prototype.MAP_INVALIDATE_BUFFER_BIT = 0x0008;
+WebGLRenderingContext.prototype.MAP_UNSYNCHRONIZED_BIT = 0x0020;
+
 /* WebGL-specific not supported enums */
 //WebGLRenderingContext.prototype.CONTEXT_LOST_WEBGL = 0x9242;
 //WebGLRenderingContext.prototype.UNPACK_COLORSPACE_CONVERSION_WEBGL = 0x9243;
 //WebGLRenderingContext.prototype.BROWSER_DEFAULT_WEBGL = 0x9244;
 
 
+// Extensions implemented by this module, on top of what the driver offers.
+// Each factory returns the extension object, or null if it is unavailable.
+var extensions = {};
+
+function KHR_parallel_shader_compile(ctx) { this._ctx = ctx; };
+KHR_parallel_shader_compile.prototype.COMPLETION_STATUS_KHR = 0x91B1;
+KHR_parallel_shader_compile.prototype.maxShaderCompilerThreadsKHR = function maxShaderCompilerThreadsKHR(count) {
+    if (!(arguments.length === 1 && typeof count === "number")) {
+        throw new TypeError('Expected maxShaderCompilerThreadsKHR(number count)');
+    }
+    return this._ctx.gl.maxShaderCompilerThreads(count);
+};
+extensions.KHR_parallel_shader_compile = function(ctx) {
+    return ctx.gl.enableParallelShaderCompile() ? new KHR_parallel_shader_compile(ctx) : null;
+};
+
+// Emulated natively where the driver lacks it.
+function OES_vertex_array_object(ctx) { this._ctx = ctx; this._bound = null; };
+OES_vertex_array_object.prototype.VERTEX_ARRAY_BINDING_OES = 0x85B5;
+OES_vertex_array_object.prototype.createVertexArrayOES = function createVertexArrayOES() {
+    return new WebGLVertexArrayObjectOES(this._ctx.gl.createVertexArray());
+};
+OES_vertex_array_object.prototype.deleteVertexArrayOES = function deleteVertexArrayOES(arrayObject) {
+    if (!(arguments.length === 1 && (arrayObject === null || arrayObject instanceof WebGLVertexArrayObjectOES))) {
+        throw new TypeError('Expected deleteVertexArrayOES(WebGLVertexArrayObjectOES arrayObject)');
+    }
+    if (arrayObject && arrayObject === this._bound) {
+        this._bound = null;
+    }
+    return this._ctx.gl.deleteVertexArray(arrayObject ? arrayObject._ : 0);
+};
+OES_vertex_array_object.prototype.isVertexArrayOES = function isVertexArrayOES(arrayObject) {
+    if (!(arguments.length === 1 && (arrayObject === null || arrayObject instanceof WebGLVertexArrayObjectOES))) {
+        throw new TypeError('Expected isVertexArrayOES(WebGLVertexArrayObjectOES arrayObject)');
+    }
+    return this._ctx.gl.isVertexArray(arrayObject ? arrayObject._ : 0);
+};
+OES_vertex_array_object.prototype.bindVertexArrayOES = function bindVertexArrayOES(arrayObject) {
+    if (!(arguments.length === 1 && (arrayObject === null || arrayObject instanceof WebGLVertexArrayObjectOES))) {
+        throw new TypeError('Expected bindVertexArrayOES(WebGLVertexArrayObjectOES arrayObject)');
+    }
+    this._bound = arrayObject;
+    return this._ctx.gl.bindVertexArray(arrayObject ? arrayObject._ : 0);
+};
+extensions.OES_vertex_array_object = function(ctx) {
+    return new OES_vertex_array_object(ctx);
+};
+
+function ANGLE_instanced_arrays(ctx) { this._ctx = ctx; };
+ANGLE_instanced_arrays.prototype.VERTEX_ATTRIB_ARRAY_DIVISOR_ANGLE = 0x88FE;
+ANGLE_instanced_arrays.prototype.drawArraysInstancedANGLE = function drawArraysInstancedANGLE(mode, first, count, primcount) {
+    if (!(arguments.length === 4 && typeof mode === "number" && typeof first === "number" && typeof count === "number" && typeof primcount === "number")) {
+        throw new TypeError('Expected drawArraysInstancedANGLE(number mode, number first, number count, number primcount)');
+    }
+    return this._ctx.gl.drawArraysInstanced(mode, first, count, primcount);
+};
+ANGLE_instanced_arrays.prototype.drawElementsInstancedANGLE = function drawElementsInstancedANGLE(mode, count, type, offset, primcount) {
+    if (!(arguments.length === 5 && typeof mode === "number" && typeof count === "number" && typeof type === "number" && typeof offset === "number" && typeof primcount === "number")) {
+        throw new TypeError('Expected drawElementsInstancedANGLE(number mode, number count, number type, number offset, number primcount)');
+    }
+    return this._ctx.gl.drawElementsInstanced(mode, count, type, offset, primcount);
+};
+ANGLE_instanced_arrays.prototype.vertexAttribDivisorANGLE = function vertexAttribDivisorANGLE(index, divisor) {
+    if (!(arguments.length === 2 && typeof index === "number" && typeof divisor === "number")) {
+        throw new TypeError('Expected vertexAttribDivisorANGLE(number index, number divisor)');
+    }
+    return this._ctx.gl.vertexAttribDivisor(index, divisor);
+};
+extensions.ANGLE_instanced_arrays = function(ctx) {
+    return ctx.gl.hasInstancedArrays() ? new ANGLE_instanced_arrays(ctx) : null;
+};
+
 WebGLRenderingContext.prototype.getSupportedExtensions = function getSupportedExtensions() {
-    return this.gl.getSupportedExtensions().split(" ");
+    return this.gl.getSupportedExtensions().split(" ").concat(Object.keys(extensions));
 };
 
 WebGLRenderingContext.prototype.getExtension = function getExtension(name) {
     if (!(arguments.length === 1 && typeof name === "string")) {
         throw new TypeError('Expected getExtension(string name)');
     }
+    if (extensions.hasOwnProperty(name)) {
+        // Repeated calls return the same object.
+        this._extensions = this._extensions || {};
+        if (!this._extensions.hasOwnProperty(name)) {
+            this._extensions[name] = extensions[name](this);
+        }
+        return this._extensions[name];
+    }
     return this.gl.getExtension(name);
 };
 
+/* Non-WebGL: stores linked program binaries in the given directory and reuses them on later runs.
+   Returns false if the driver can't load program binaries. */
+WebGLRenderingContext.prototype.enableProgramCache = function enableProgramCache(directory) {
+    if (!(arguments.length === 1 && typeof directory === "string")) {
+        throw new TypeError('Expected enableProgramCache(string directory)');
+    }
+    return this.gl.enableProgramCache(directory);
+};
+
+/* Non-WebGL: the shader variant library of this context (see ShaderLibrary.getProgram). */
+WebGLRenderingContext.prototype.getShaderLibrary = function getShaderLibrary() {
+    if (!this._shaderLibrary) {
+        this._shaderLibrary = new ShaderLibrary(this);
+    }
+    return this._shaderLibrary;
+};
+
+/* Returns the program for one variant of a shader pair. Identical variants are shared and
+   compiled on first use; deleteProgram releases one reference.
+   options.defines: { NAME: value } (true for a define without value) or [ 'NAME', 'NAME value' ]
+   options.attributes: attribute names, bound to locations 0, 1, ... */
+ShaderLibrary.prototype.getProgram = function getProgram(vertexSource, fragmentSource, options) {
+    if (!((arguments.length === 2 || arguments.length === 3) && typeof vertexSource === "string" && typeof fragmentSource === "string" && (options === undefined || typeof options === "object"))) {
+        throw new TypeError('Expected getProgram(string vertexSource, string fragmentSource, object options)');
+    }
+    options = options || {};
+
+    var defines = [];
+    if (Array.isArray(options.defines)) {
+        defines = options.defines.map(String);
+    } else if (options.defines) {
+        Object.keys(options.defines).forEach(function(name) {
+            var value = options.defines[name];
+            if (value === true) {
+                defines.push(name);
+            } else if (value !== false && value !== undefined && value !== null) {
+                defines.push(name + " " + value);
+            }
+        });
+    }
+    var attributes = (options.attributes || []).map(String);
+
+    return new WebGLProgram(this._ctx.gl.getLibraryProgram(vertexSource, fragmentSource, defines, attributes));
+};
+
+/* Non-WebGL: pseudo-instancing for drivers without ANGLE_instanced_arrays (see README).
+   options.vertices: interleaved mesh vertices, options.stride: their stride in bytes
+   options.indices: Uint16Array with the mesh indices
+   options.attributes: [ { index, size, type, normalized, offset } ] describing the vertices
+   options.instanceAttribute: location of the float attribute that receives the instance index
+   options.vectorsPerInstance: vec4 uniforms per instance
+   options.reservedVectors: vertex uniform vectors the shader uses otherwise (default 16)
+   Returns null if an index is past the vertices, or if not even one instance fits in the uniforms. */
+WebGLRenderingContext.prototype.createInstanceBatch = function createInstanceBatch(options) {
+    if (!(arguments.length === 1 && typeof options === "object" && typeof options.vertices === "object" && typeof options.indices === "object" && typeof options.stride === "number" && typeof options.instanceAttribute === "number" && typeof options.vectorsPerInstance === "number")) {
+        throw new TypeError('Expected createInstanceBatch(object options)');
+    }
+    var attributes = [];
+    (options.attributes || []).forEach(function(a) {
+        attributes.push(a.index, a.size, a.type === undefined ? this.FLOAT : a.type, !!a.normalized, a.offset || 0);
+    }, this);
+    var reserved = options.reservedVectors === undefined ? 16 : options.reservedVectors;
+
+    var id = this.gl.createInstanceBatch(options.vertices, options.stride, options.indices, attributes, options.instanceAttribute, options.vectorsPerInstance, reserved);
+    return id ? new WebGLInstanceBatch(this, id) : null;
+};
+
+/* Draws primcount instances with the program in use. data holds vectorsPerInstance vec4s per instance, which are
+   uploaded to the uniform array at location, instancesPerDraw instances at a time. */
+WebGLInstanceBatch.prototype.drawElementsInstanced = function drawElementsInstanced(mode, location, data, primcount) {
+    if (!(arguments.length === 4 && typeof mode === "number" && location instanceof WebGLUniformLocation && data instanceof Float32Array && typeof primcount === "number")) {
+        throw new TypeError('Expected drawElementsInstanced(number mode, WebGLUniformLocation location, Float32Array data, number primcount)');
+    }
+    return this._ctx.gl.drawInstanceBatch(this._, mode, location._, data, primcount);
+};
+
+WebGLInstanceBatch.prototype.delete = function() {
+    this._ctx.gl.deleteInstanceBatch(this._);
+    this._ = 0;
+};
+
+/* The floats of a sprite record in records. COLOR is written through colors, as 0xAABBGGRR. */
+WebGLSpriteBatch.prototype.TEXTURE = 0;
+WebGLSpriteBatch.prototype.BLEND = 1;
+WebGLSpriteBatch.prototype.LAYER = 2;
+WebGLSpriteBatch.prototype.COLOR = 3;
+WebGLSpriteBatch.prototype.X = 4;
+WebGLSpriteBatch.prototype.Y = 5;
+WebGLSpriteBatch.prototype.WIDTH = 6;
+WebGLSpriteBatch.prototype.HEIGHT = 7;
+WebGLSpriteBatch.prototype.U0 = 8;
+WebGLSpriteBatch.prototype.V0 = 9;
+WebGLSpriteBatch.prototype.U1 = 10;
+WebGLSpriteBatch.prototype.V1 = 11;
+WebGLSpriteBatch.prototype.A = 12;
+WebGLSpriteBatch.prototype.B = 13;
+WebGLSpriteBatch.prototype.C = 14;
+WebGLSpriteBatch.prototype.D = 15;
+WebGLSpriteBatch.prototype.TX = 16;
+WebGLSpriteBatch.prototype.TY = 17;
+WebGLSpriteBatch.prototype.FIELDS = 18;
+
+/* Blend modes of sprites. */
+WebGLSpriteBatch.prototype.BLEND_ALPHA = 0;
+WebGLSpriteBatch.prototype.BLEND_ADD = 1;
+WebGLSpriteBatch.prototype.BLEND_OPAQUE = 2;
+WebGLSpriteBatch.prototype.BLEND_PREMULTIPLIED = 3;
+
+/* Non-WebGL: draws 2D sprites from records in a typed array, sorted and batched natively (see README).
+   options.maxSprites: the records the batch holds (default 16384)
+   options.spritesPerDraw: the most sprites in one draw call, at most 16384 (default 4096)
+   Returns null if the program or buffers can't be created. */
+WebGLRenderingContext.prototype.createSpriteBatch = function createSpriteBatch(options) {
+    if (!(arguments.length <= 1 && (options === undefined || typeof options === "object"))) {
+        throw new TypeError('Expected createSpriteBatch(object options)');
+    }
+    options = options || {};
+    var maxSprites = options.maxSprites === undefined ? 16384 : options.maxSprites;
+    var spritesPerDraw = options.spritesPerDraw === undefined ? 4096 : options.spritesPerDraw;
+
+    var id = this.gl.createSpriteBatch(spritesPerDraw, maxSprites);
+    return id ? new WebGLSpriteBatch(this, id, maxSprites) : null;
+};
+
+/* Appends a sprite showing all of texture in the rect x, y, width, height, with an identity transform, alpha
+   blending and layer 0. color defaults to opaque white. Returns the index of its record, for changing the other
+   fields, or -1 if the batch is full. */
+WebGLSpriteBatch.prototype.add = function add(texture, x, y, width, height, color) {
+    if (!(arguments.length >= 5 && arguments.length <= 6 && (texture === null || texture instanceof WebGLTexture) && typeof x === "number" && typeof y === "number" && typeof width === "number" && typeof height === "number" && (color === undefined || typeof color === "number"))) {
+        throw new TypeError('Expected add(WebGLTexture texture, number x, number y, number width, number height, number color)');
+    }
+    var index = this.count;
+    if ((index + 1) * this.FIELDS > this.records.length) {
+        return -1;
+    }
+    var r = this.records, o = index * this.FIELDS;
+    r[o] = texture ? texture._ : 0; r[o + 1] = this.BLEND_ALPHA; r[o + 2] = 0;
+    this.colors[o + 3] = color === undefined ? 0xFFFFFFFF : color;
+    r[o + 4] = x; r[o + 5] = y; r[o + 6] = width; r[o + 7] = height;
+    r[o + 8] = 0; r[o + 9] = 0; r[o + 10] = 1; r[o + 11] = 1;
+    r[o + 12] = 1; r[o + 13] = 0; r[o + 14] = 0; r[o + 15] = 1; r[o + 16] = 0; r[o + 17] = 0;
+    this.count = index + 1;
+    return index;
+};
+
+WebGLSpriteBatch.prototype.clear = function clear() {
+    this.count = 0;
+};
+
+/* Draws the first count records (default this.count) into the current framebuffer, whose viewport covers width x
+   height pixels. Returns the number of draw calls it took. */
+WebGLSpriteBatch.prototype.draw = function draw(width, height, count) {
+    if (!(arguments.length >= 2 && arguments.length <= 3 && typeof width === "number" && typeof height === "number" && (count === undefined || typeof count === "number"))) {
+        throw new TypeError('Expected draw(number width, number height, number count)');
+    }
+    return this._ctx.gl.drawSpriteBatch(this._, this.records, count === undefined ? this.count : count, width, height);
+};
+
+WebGLSpriteBatch.prototype.delete = function() {
+    this._ctx.gl.deleteSpriteBatch(this._);
+    this._ = 0;
+};
+
+/* Non-WebGL: draws text with FreeType fonts from glyphs in an atlas (see README).
+   options.pageSize: the size of the atlas textures (default 1024)
+   options.maxPages: the atlas textures, after which the least recently used one is reused (default 4)
+   options.distanceField: rasterize glyphs once as signed distance fields and scale them (default false)
+   options.glyphsPerFrame: the glyphs expected per frame, which sizes the vertex buffer (default 8192)
+   Returns null if the program or buffers can't be created. */
+WebGLRenderingContext.prototype.createTextRenderer = function createTextRenderer(options) {
+    if (!(arguments.length <= 1 && (options === undefined || typeof options === "object"))) {
+        throw new TypeError('Expected createTextRenderer(object options)');
+    }
+    options = options || {};
+    var id = this.gl.createTextRenderer(
+        options.pageSize === undefined ? 1024 : options.pageSize,
+        options.maxPages === undefined ? 4 : options.maxPages,
+        !!options.distanceField,
+        options.glyphsPerFrame === undefined ? 8192 : options.glyphsPerFrame);
+    return id ? new WebGLTextRenderer(this, id) : null;
+};
+
+/* Loads a font file (TrueType, OpenType, ...) from a Buffer or typed array. Returns null if it can't be read, or if
+   the module was built without FreeType. */
+WebGLTextRenderer.prototype.loadFont = function loadFont(data) {
+    if (!(arguments.length === 1 && ArrayBuffer.isView(data))) {
+        throw new TypeError('Expected loadFont(ArrayBufferView data)');
+    }
+    var id = this._ctx.gl.loadFont(this._, data);
+    return id ? new WebGLFont(id) : null;
+};
+
+WebGLTextRenderer.prototype.deleteFont = function deleteFont(font) {
+    if (!(arguments.length === 1 && font instanceof WebGLFont)) {
+        throw new TypeError('Expected deleteFont(WebGLFont font)');
+    }
+    this._ctx.gl.deleteFont(this._, font._);
+};
+
+var TEXT_ALIGN = { left: 0, center: 1, right: 2 };
+
+// Checks a text style and fills in its defaults.
+function textStyle(style) {
+    if (!(typeof style === "object" && style.font instanceof WebGLFont && (style.align === undefined || TEXT_ALIGN.hasOwnProperty(style.align)))) {
+        return null;
+    }
+    return {
+        font: style.font._,
+        size: style.size === undefined ? 16 : style.size,
+        color: style.color || [0, 0, 0, 1],
+        maxWidth: style.maxWidth || 0,
+        lineHeight: style.lineHeight || 1,
+        align: TEXT_ALIGN[style.align || 'left']
+    };
+}
+
+/* The size of the box that drawText fills with text in style (see drawText). */
+WebGLTextRenderer.prototype.measureText = function measureText(text, style) {
+    var s = arguments.length === 2 && typeof text === "string" && textStyle(style);
+    if (!s) {
+        throw new TypeError('Expected measureText(string text, object style)');
+    }
+    return this._ctx.gl.measureText(this._, text, s.font, s.size, s.maxWidth, s.lineHeight, s.align, 0, 0, 0, 0);
+};
+
+/* Draws text with the top left of its box at x, y into the current framebuffer, whose viewport covers width x
+   height pixels.
+   style.font: a WebGLFont of this renderer
+   style.size: the em size in pixels (default 16)
+   style.color: [r, g, b, a] (default opaque black)
+   style.maxWidth: breaks lines at spaces to fit, if set
+   style.lineHeight: the distance between baselines, as a multiple of the font's (default 1)
+   style.align: 'left', 'center' or 'right', within the widest line (default 'left') */
+WebGLTextRenderer.prototype.drawText = function drawText(text, x, y, style, width, height) {
+    var s = arguments.length === 6 && typeof text === "string" && typeof x === "number" && typeof y === "number" && typeof width === "number" && typeof height === "number" && textStyle(style);
+    if (!s) {
+        throw new TypeError('Expected drawText(string text, number x, number y, object style, number width, number height)');
+    }
+    var c = s.color;
+    this._ctx.gl.drawText(this._, text, x, y, s.font, s.size, s.maxWidth, s.lineHeight, s.align, c[0], c[1], c[2], c[3], width, height);
+};
+
+WebGLTextRenderer.prototype.delete = function() {
+    this._ctx.gl.deleteTextRenderer(this._);
+    this._ = 0;
+};
+
+/* Non-WebGL: fills, strokes and clips to 2D paths, tessellated natively into cached vertex buffers (see README).
+   Returns null if the program can't be created. */
+WebGLRenderingContext.prototype.createPathRenderer = function createPathRenderer() {
+    var id = this.gl.createPathRenderer();
+    return id ? new WebGLPathRenderer(this, id) : null;
+};
+
+/* An empty path, built like a canvas Path2D and drawn by this renderer. */
+WebGLPathRenderer.prototype.createPath = function createPath() {
+    var id = this._ctx.gl.createPath(this._);
+    return id ? new WebGLPath(this, id) : null;
+};
+
+/* Path commands, as the native tessellator takes them. */
+var PATH_MOVE_TO = 0, PATH_LINE_TO = 1, PATH_QUADRATIC_TO = 2, PATH_CUBIC_TO = 3, PATH_CLOSE = 4, PATH_ARC = 5,
+    PATH_RECT = 6, PATH_ROUND_RECT = 7;
+
+// Appends a command and its arguments, which must all be numbers.
+function pathCommand(path, command, args, count, name) {
+    var valid = args.length === count;
+    for (var i = 0; i < count && valid; i++) {
+        valid = typeof args[i] === "number";
+    }
+    if (!valid) {
+        throw new TypeError('Expected ' + name);
+    }
+    path._commands.push(command);
+    for (var i = 0; i < count; i++) {
+        path._commands.push(args[i]);
+    }
+    path._dirty = true;
+}
+
+WebGLPath.prototype.moveTo = function moveTo(x, y) {
+    pathCommand(this, PATH_MOVE_TO, arguments, 2, 'moveTo(number x, number y)');
+};
+
+WebGLPath.prototype.lineTo = function lineTo(x, y) {
+    pathCommand(this, PATH_LINE_TO, arguments, 2, 'lineTo(number x, number y)');
+};
+
+WebGLPath.prototype.quadraticCurveTo = function quadraticCurveTo(cpx, cpy, x, y) {
+    pathCommand(this, PATH_QUADRATIC_TO, arguments, 4, 'quadraticCurveTo(number cpx, number cpy, number x, number y)');
+};
+
+WebGLPath.prototype.bezierCurveTo = function bezierCurveTo(cp1x, cp1y, cp2x, cp2y, x, y) {
+    pathCommand(this, PATH_CUBIC_TO, arguments, 6, 'bezierCurveTo(number cp1x, number cp1y, number cp2x, number cp2y, number x, number y)');
+};
+
+WebGLPath.prototype.arc = function arc(x, y, radius, startAngle, endAngle, counterclockwise) {
+    if (!(arguments.length >= 5 && arguments.length <= 6 && typeof x === "number" && typeof y === "number" && typeof radius === "number" && typeof startAngle === "number" && typeof endAngle === "number")) {
+        throw new TypeError('Expected arc(number x, number y, number radius, number startAngle, number endAngle, boolean counterclockwise)');
+    }
+    pathCommand(this, PATH_ARC, [x, y, radius, startAngle, endAngle, counterclockwise ? 1 : 0], 6, 'arc');
+};
+
+WebGLPath.prototype.rect = function rect(x, y, width, height) {
+    pathCommand(this, PATH_RECT, arguments, 4, 'rect(number x, number y, number width, number height)');
+};
+
+/* A rectangle with corners rounded by radius, which is limited to half the shorter side. */
+WebGLPath.prototype.roundRect = function roundRect(x, y, width, height, radius) {
+    pathCommand(this, PATH_ROUND_RECT, arguments, 5, 'roundRect(number x, number y, number width, number height, number radius)');
+};
+
+WebGLPath.prototype.closePath = function closePath() {
+    pathCommand(this, PATH_CLOSE, arguments, 0, 'closePath()');
+};
+
+/* Empties the path, for building it again. */
+WebGLPath.prototype.reset = function reset() {
+    this._commands.length = 0;
+    this._dirty = true;
+};
+
+// Hands changed commands to the renderer, which tessellates them when the path is next drawn.
+WebGLPath.prototype._sync = function() {
+    if (this._dirty) {
+        this._renderer._ctx.gl.setPath(this._renderer._, this._, new Float32Array(this._commands));
+        this._dirty = false;
+    }
+};
+
+WebGLPath.prototype.delete = function() {
+    this._renderer._ctx.gl.deletePath(this._renderer._, this._);
+    this._ = 0;
+};
+
+var LINE_JOIN = { miter: 0, round: 1, bevel: 2 };
+var LINE_CAP = { butt: 0, round: 1, square: 2 };
+
+// Writes the colour and transform of a style into the renderer's paint array, or returns null if they are invalid.
+function pathPaint(renderer, style) {
+    if (!(typeof style === "object" && style !== null && (style.color === undefined || style.color.length === 4) && (style.transform == null || style.transform.length === 6))) {
+        return null;
+    }
+    var paint = renderer._paint;
+    paint.set(style.color || [0, 0, 0, 1]);
+    paint.set(style.transform || [1, 0, 0, 1, 0, 0], 4);
+    return paint;
+}
+
+/* Fills path into the current framebuffer, whose viewport covers width x height pixels, inside the clip.
+   style.color: [r, g, b, a] (default opaque black)
+   style.transform: [a, b, c, d, e, f] from path to pixel coordinates, as in canvas transform() (default identity)
+   style.feather: the pixels over which the edges fade out, for soft shadows (at least and by default 1) */
+WebGLPathRenderer.prototype.fill = function fill(path, style, width, height) {
+    var paint = arguments.length === 4 && path instanceof WebGLPath && path._renderer === this && typeof width === "number" && typeof height === "number" && pathPaint(this, style);
+    if (!paint) {
+        throw new TypeError('Expected fill(WebGLPath path, object style, number width, number height)');
+    }
+    path._sync();
+    return this._ctx.gl.fillPath(this._, path._, paint, style.feather || 0, width, height);
+};
+
+/* Strokes path like fill fills it.
+   style.lineWidth: in path units (default 1)
+   style.lineJoin: 'miter', 'round' or 'bevel' (default 'miter')
+   style.lineCap: 'butt', 'round' or 'square' (default 'butt')
+   style.miterLimit: the longest miter, relative to the line width, as in canvas (default 10) */
+WebGLPathRenderer.prototype.stroke = function stroke(path, style, width, height) {
+    var paint = arguments.length === 4 && path instanceof WebGLPath && path._renderer === this && typeof width === "number" && typeof height === "number" && pathPaint(this, style);
+    if (!paint || (style.lineJoin !== undefined && !LINE_JOIN.hasOwnProperty(style.lineJoin)) || (style.lineCap !== undefined && !LINE_CAP.hasOwnProperty(style.lineCap))) {
+        throw new TypeError('Expected stroke(WebGLPath path, object style, number width, number height)');
+    }
+    path._sync();
+    return this._ctx.gl.strokePath(this._, path._, paint, style.lineWidth === undefined ? 1 : style.lineWidth,
+        LINE_JOIN[style.lineJoin || 'miter'], LINE_CAP[style.lineCap || 'butt'], style.miterLimit === undefined ? 10 : style.miterLimit,
+        width, height);
+};
+
+/* Intersects the clip with path, placed by transform (default identity). Needs a stencil buffer that was cleared to
+   0; clips nest up to 15 deep. Returns false if the clip can't be pushed. */
+WebGLPathRenderer.prototype.pushClip = function pushClip(path, width, height, transform) {
+    var paint = arguments.length >= 3 && arguments.length <= 4 && path instanceof WebGLPath && path._renderer === this && typeof width === "number" && typeof height === "number" && pathPaint(this, { transform: transform });
+    if (!paint) {
+        throw new TypeError('Expected pushClip(WebGLPath path, number width, number height, Array transform)');
+    }
+    path._sync();
+    return this._ctx.gl.pushClip(this._, path._, paint, width, height);
+};
+
+/* Goes back to the clip before the last pushClip. */
+WebGLPathRenderer.prototype.popClip = function popClip(width, height) {
+    if (!(arguments.length === 2 && typeof width === "number" && typeof height === "number")) {
+        throw new TypeError('Expected popClip(number width, number height)');
+    }
+    this._ctx.gl.popClip(this._, width, height);
+};
+
+/* Forgets all clips; to be called when the stencil buffer was cleared. */
+WebGLPathRenderer.prototype.resetClip = function resetClip() {
+    this._ctx.gl.resetClip(this._);
+};
+
+WebGLPathRenderer.prototype.delete = function() {
+    this._ctx.gl.deletePathRenderer(this._);
+    this._ = 0;
+};
+
+/* Non-WebGL: packs small RGBA images into a few large textures at runtime, for drawing them in one sprite batch
+   (see README).
+   options.pageSize: the size of the atlas textures, at most MAX_TEXTURE_SIZE (default 2048)
+   options.maxPages: the atlas textures, after which the images are repacked to make room (default 4)
+   options.padding: the pixels around each image that repeat its edges, for filtering (default 1) */
+WebGLRenderingContext.prototype.createTextureAtlas = function createTextureAtlas(options) {
+    if (!(arguments.length <= 1 && (options === undefined || typeof options === "object"))) {
+        throw new TypeError('Expected createTextureAtlas(object options)');
+    }
+    options = options || {};
+    var pageSize = options.pageSize === undefined ? 2048 : options.pageSize;
+    var maxPages = options.maxPages === undefined ? 4 : options.maxPages;
+    var padding = options.padding === undefined ? 1 : options.padding;
+
+    return new WebGLTextureAtlas(this, this.gl.createTextureAtlas(pageSize, maxPages, padding));
+};
+
+/* Uploads width x height RGBA pixels, rows tightly packed, into the atlas. Returns a handle to the image, or 0 if it
+   is larger than a page or doesn't fit even after repacking. Repacking moves all images to new textures and bumps
+   this.generation; look them up again after it changes. */
+WebGLTextureAtlas.prototype.add = function add(pixels, width, height) {
+    if (!(arguments.length === 3 && (pixels instanceof Uint8Array || pixels instanceof Uint8ClampedArray) && typeof width === "number" && typeof height === "number")) {
+        throw new TypeError('Expected add(Uint8Array pixels, number width, number height)');
+    }
+    var handle = this._ctx.gl.addAtlasImage(this._, pixels, width, height);
+    var generation = this._ctx.gl.getAtlasGeneration(this._);
+    if (generation !== this.generation) {
+        this.generation = generation;
+        this._regions = {};
+    }
+    return handle;
+};
+
+/* Frees the space of the image, which is reused once its page is empty or the atlas is repacked. */
+WebGLTextureAtlas.prototype.remove = function remove(handle) {
+    if (!(arguments.length === 1 && typeof handle === "number")) {
+        throw new TypeError('Expected remove(number handle)');
+    }
+    delete this._regions[handle];
+    return this._ctx.gl.removeAtlasImage(this._, handle);
+};
+
+/* Returns {texture, u0, v0, u1, v1, width, height} for the image: the texture it is in (which the atlas owns), its
+   texture coordinates and its size, or null if there is no such image. Valid until this.generation changes. */
+WebGLTextureAtlas.prototype.lookup = function lookup(handle) {
+    if (!(arguments.length === 1 && typeof handle === "number")) {
+        throw new TypeError('Expected lookup(number handle)');
+    }
+    var region = this._regions[handle];
+    if (region === undefined) {
+        region = this._ctx.gl.lookupAtlasImage(this._, handle);
+        if (region) {
+            region.texture = new WebGLTexture(region.texture);
+            this._regions[handle] = region;
+        }
+    }
+    return region || null;
+};
+
+/* Appends a sprite showing the image to batch, like batch.add(), in the rect x, y, width, height (default the size
+   of the image). Returns the index of its record, or -1 if the batch is full or there is no such image. */
+WebGLTextureAtlas.prototype.addSprite = function addSprite(batch, handle, x, y, width, height, color) {
+    if (!(arguments.length >= 4 && arguments.length <= 7 && batch instanceof WebGLSpriteBatch && typeof handle === "number" && typeof x === "number" && typeof y === "number" && (width === undefined || typeof width === "number") && (height === undefined || typeof height === "number") && (color === undefined || typeof color === "number"))) {
+        throw new TypeError('Expected addSprite(WebGLSpriteBatch batch, number handle, number x, number y, number width, number height, number color)');
+    }
+    var region = this.lookup(handle);
+    if (!region) {
+        return -1;
+    }
+    var index = batch.add(region.texture, x, y, width === undefined ? region.width : width,
+        height === undefined ? region.height : height, color);
+    if (index >= 0) {
+        var r = batch.records, o = index * batch.FIELDS;
+        r[o + batch.U0] = region.u0; r[o + batch.V0] = region.v0; r[o + batch.U1] = region.u1; r[o + batch.V1] = region.v1;
+    }
+    return index;
+};
+
+/* Deletes the atlas and its textures. */
+WebGLTextureAtlas.prototype.delete = function() {
+    this._ctx.gl.deleteTextureAtlas(this._);
+    this._ = 0;
+    this._regions = {};
+};
+
+/* Non-WebGL: maps length bytes from offset of the buffer bound to target into an ArrayBuffer (see README).
+   access: MAP_*_BIT flags, MAP_WRITE_BIT | MAP_INVALIDATE_RANGE_BIT by default
+   Returns null if the range can't be mapped. The ArrayBuffer is detached by unmapBuffer. */
+WebGLRenderingContext.prototype.mapBuffer = function mapBuffer(target, offset, length, access) {
+    if (!(arguments.length >= 3 && arguments.length <= 4 && typeof target === "number" && typeof offset === "number" && typeof length === "number" && (access === undefined || typeof access === "number"))) {
+        throw new TypeError('Expected mapBuffer(number target, number offset, number length, number access)');
+    }
+    return this.gl.mapBuffer(target, offset, length, access === undefined ? this.MAP_WRITE_BIT | this.MAP_INVALIDATE_RANGE_BIT : access);
+};
+
+/* Returns false if the buffer's contents got lost while it was mapped, and have to be specified again. */
+WebGLRenderingContext.prototype.unmapBuffer = function unmapBuffer(target) {
+    if (!(arguments.length === 1 && typeof target === "number")) {
+        throw new TypeError('Expected unmapBuffer(number target)');
+    }
+    return this.gl.unmapBuffer(target);
+};
+
+/* Non-WebGL: a vertex buffer for geometry that is rebuilt every frame (see README).
+   size: the buffer size in bytes, enough for frames frames of geometry
+   frames: the frames that may be in flight (default 3)
+   Returns null if the buffer can't be created. */
+WebGLRenderingContext.prototype.createStreamingBuffer = function createStreamingBuffer(size, frames) {
+    if (!(arguments.length >= 1 && arguments.length <= 2 && typeof size === "number" && (frames === undefined || typeof frames === "number"))) {
+        throw new TypeError('Expected createStreamingBuffer(number size, number frames)');
+    }
+    var id = this.gl.createStreamingBuffer(size, frames === undefined ? 3 : frames);
+    return id ? new WebGLStreamingBuffer(this, id, size) : null;
+};
+
+/* Returns the offset of bytes that are free for this frame, aligned to alignment bytes (default 4), or -1 if
+   bytes is more than a frame's share of the buffer. */
+WebGLStreamingBuffer.prototype.allocate = function allocate(bytes, alignment) {
+    if (!(arguments.length >= 1 && arguments.length <= 2 && typeof bytes === "number" && (alignment === undefined || typeof alignment === "number"))) {
+        throw new TypeError('Expected allocate(number bytes, number alignment)');
+    }
+    return this._ctx.gl.streamingBufferAllocate(this._, bytes, alignment === undefined ? 4 : alignment);
+};
+
+/* Writes data at an offset returned by allocate. Leaves the buffer bound to ARRAY_BUFFER. */
+WebGLStreamingBuffer.prototype.write = function write(offset, data) {
+    if (!(arguments.length === 2 && typeof offset === "number" && ArrayBuffer.isView(data))) {
+        throw new TypeError('Expected write(number offset, ArrayBufferView data)');
+    }
+    return this._ctx.gl.streamingBufferWrite(this._, offset, data);
+};
+
+/* allocate followed by write. Returns the offset of the data, or -1. */
+WebGLStreamingBuffer.prototype.upload = function upload(data, alignment) {
+    if (!(arguments.length >= 1 && arguments.length <= 2 && ArrayBuffer.isView(data) && (alignment === undefined || typeof alignment === "number"))) {
+        throw new TypeError('Expected upload(ArrayBufferView data, number alignment)');
+    }
+    var offset = this._ctx.gl.streamingBufferAllocate(this._, data.byteLength, alignment === undefined ? 4 : alignment);
+    if (offset >= 0) {
+        this._ctx.gl.streamingBufferWrite(this._, offset, data);
+    }
+    return offset;
+};
+
+WebGLStreamingBuffer.prototype.delete = function() {
+    this._ctx.gl.deleteStreamingBuffer(this._);
+    this._ = 0;
+};
+
+/* Non-WebGL: a GL buffer that follows the typed array data (see README). The changed parts of data are uploaded
+   when nextFrame ends the frame.
+   options.usage: the bufferData usage, DYNAMIC_DRAW by default
+   options.pageSize: if set, changes are also found by comparing data with what was uploaded, in pages of this
+   many bytes, so that markDirty isn't needed
+   Returns null if data is empty. */
+WebGLRenderingContext.prototype.createMirroredBuffer = function createMirroredBuffer(data, options) {
+    if (!(arguments.length >= 1 && arguments.length <= 2 && ArrayBuffer.isView(data) && (options === undefined || typeof options === "object"))) {
+        throw new TypeError('Expected createMirroredBuffer(ArrayBufferView data, object options)');
+    }
+    options = options || {};
+    var id = this.gl.createMirroredBuffer(data, options.usage === undefined ? this.DYNAMIC_DRAW : options.usage, options.pageSize || 0);
+    return id ? new WebGLMirroredBuffer(this, id, data) : null;
+};
+
+/* offset and length are counted in elements of data. */
+WebGLMirroredBuffer.prototype.markDirty = function markDirty(offset, length) {
+    if (!(arguments.length === 2 && typeof offset === "number" && typeof length === "number")) {
+        throw new TypeError('Expected markDirty(number offset, number length)');
+    }
+    var size = this.data.BYTES_PER_ELEMENT || 1;
+    return this._ctx.gl.mirroredBufferMarkDirty(this._, offset * size, length * size);
+};
+
+/* Uploads the changes right away, for drawing with them in this frame. */
+WebGLMirroredBuffer.prototype.flush = function flush() {
+    return this._ctx.gl.flushMirroredBuffer(this._);
+};
+
+WebGLMirroredBuffer.prototype.delete = function() {
+    this._ctx.gl.deleteMirroredBuffer(this._);
+    this._ = 0;
+};
+
+/* Non-WebGL: texImage2D for texture on a background thread (see README). The texture has to be bound again once the
+   upload is complete to see the new contents, and pixels must not be modified until then. */
+WebGLRenderingContext.prototype.uploadTexture = function uploadTexture(texture, target, level, internalformat, width, height, format, type, pixels) {
+    if (!(arguments.length === 9 && texture instanceof WebGLTexture && typeof target === "number" && typeof level === "number" &&
+        typeof internalformat === "number" && typeof width === "number" && typeof height === "number" &&
+        typeof format === "number" && typeof type === "number" && ArrayBuffer.isView(pixels))) {
+        throw new TypeError('Expected uploadTexture(WebGLTexture texture, number target, number level, number internalformat, number width, number height, number format, number type, ArrayBufferView pixels)');
+    }
+    var id = this.gl.uploadTexture(texture._, target, level, internalformat, false, 0, 0, width, height, format, type, pixels);
+    return new WebGLTextureUpload(this, id);
+};
+
+/* Non-WebGL: texSubImage2D for texture on a background thread, like uploadTexture. */
+WebGLRenderingContext.prototype.uploadTextureSubImage = function uploadTextureSubImage(texture, target, level, xoffset, yoffset, width, height, format, type, pixels) {
+    if (!(arguments.length === 10 && texture instanceof WebGLTexture && typeof target === "number" && typeof level === "number" &&
+        typeof xoffset === "number" && typeof yoffset === "number" && typeof width === "number" && typeof height === "number" &&
+        typeof format === "number" && typeof type === "number" && ArrayBuffer.isView(pixels))) {
+        throw new TypeError('Expected uploadTextureSubImage(WebGLTexture texture, number target, number level, number xoffset, number yoffset, number width, number height, number format, number type, ArrayBufferView pixels)');
+    }
+    var id = this.gl.uploadTexture(texture._, target, level, 0, true, xoffset, yoffset, width, height, format, type, pixels);
+    return new WebGLTextureUpload(this, id);
+};
+
+/* Doesn't block. */
+WebGLTextureUpload.prototype.isComplete = function isComplete() {
+    return this._ctx.gl.isTextureUploadComplete(this._);
+};
+
+/* Blocks until the upload is complete. */
+WebGLTextureUpload.prototype.finish = function finish() {
+    return this._ctx.gl.finishTextureUpload(this._);
+};
+
+/* The attributes of the buffers that init got, which may differ from what was asked for. Besides the WebGL ones, the
+   bits of every buffer and the number of samples are given. */
+WebGLRenderingContext.prototype.getContextAttributes = function getContextAttributes() {
+    var config = this._surfaceConfig;
+    if (!config) {
+        return null;
+    }
+    return {
+        alpha: config.alphaBits > 0,
+        depth: config.depthBits > 0,
+        stencil: config.stencilBits > 0,
+        antialias: config.samples > 0,
+        preserveDrawingBuffer: config.preserved,
+        redBits: config.redBits,
+        greenBits: config.greenBits,
+        blueBits: config.blueBits,
+        alphaBits: config.alphaBits,
+        depthBits: config.depthBits,
+        stencilBits: config.stencilBits,
+        samples: config.samples
+    };
+};
+
+/* Non-WebGL: the fraction of the window's resolution that frames are rendered at, with the dynamicResolution option
+   of init. 1 without it. */
+WebGLRenderingContext.prototype.getResolutionScale = function getResolutionScale() {
+    return this.gl.getResolutionScale();
+};
+
+/* Non-WebGL: leaves out frames that repeat the last one that was shown (see README). options.throttleAfter: repeated
+   frames after which the frame rate is lowered (default 60); options.maxInterval: the longest interval between frames
+   then, in ms (default 100). false turns it off. */
+WebGLRenderingContext.prototype.enableFrameSkipping = function enableFrameSkipping(options) {
+    if (options === false) {
+        return this.gl.enableFrameSkipping(false, 0, 0);
+    }
+    options = (options && typeof options === "object" ? options : {});
+    if ((options.throttleAfter !== undefined && typeof options.throttleAfter !== "number") ||
+        (options.maxInterval !== undefined && typeof options.maxInterval !== "number")) {
+        throw new TypeError('Expected enableFrameSkipping({number throttleAfter, number maxInterval})');
+    }
+    return this.gl.enableFrameSkipping(true,
+        options.throttleAfter !== undefined ? options.throttleAfter : 60,
+        options.maxInterval !== undefined ? options.maxInterval : 100);
+};
+
+/* Non-WebGL: makes the current frame count as changed, for frames that draw on top of what their render targets held
+   before. */
+WebGLRenderingContext.prototype.invalidateFrame = function invalidateFrame() {
+    return this.gl.invalidateFrame();
+};
+
+/* Non-WebGL: uploads spread over frames (see README). The queue functions return a Promise that is resolved once the
+   upload is done, or rejected if the object was deleted before. priority: higher goes first, 0 by default. */
+WebGLRenderingContext.prototype._queueUpload = function _queueUpload(id) {
+    if (!id) {
+        return Promise.reject(new RangeError('Unsupported format, or data out of range'));
+    }
+    var uploads = this._uploads || (this._uploads = {});
+    return new Promise(function(resolve, reject) {
+        uploads[id] = {resolve: resolve, reject: reject};
+    });
+};
+
+/* Called by nextFrame. */
+WebGLRenderingContext.prototype._settleUploads = function _settleUploads() {
+    if (!this._uploads) {
+        return;
+    }
+    var completed = this.gl.takeCompletedUploads();
+    for (var i = 0; i < completed.length; i += 2) {
+        var upload = this._uploads[completed[i]];
+        delete this._uploads[completed[i]];
+        if (completed[i + 1]) {
+            upload.resolve();
+        } else {
+            upload.reject(new Error('Upload cancelled'));
+        }
+    }
+};
+
+WebGLRenderingContext.prototype.queueTexImage2D = function queueTexImage2D(texture, target, level, internalformat, width, height, format, type, pixels, priority) {
+    if (!(arguments.length >= 9 && arguments.length <= 10 && texture instanceof WebGLTexture && typeof target === "number" &&
+        typeof level === "number" && typeof internalformat === "number" && typeof width === "number" && typeof height === "number" &&
+        typeof format === "number" && typeof type === "number" && ArrayBuffer.isView(pixels) && (priority === undefined || typeof priority === "number"))) {
+        throw new TypeError('Expected queueTexImage2D(WebGLTexture texture, number target, number level, number internalformat, number width, number height, number format, number type, ArrayBufferView pixels, number priority)');
+    }
+    return this._queueUpload(this.gl.queueTextureUpload(texture._, target, level, true, internalformat, 0, 0, width, height, format, type, pixels, priority || 0));
+};
+
+WebGLRenderingContext.prototype.queueTexSubImage2D = function queueTexSubImage2D(texture, target, level, xoffset, yoffset, width, height, format, type, pixels, priority) {
+    if (!(arguments.length >= 10 && arguments.length <= 11 && texture instanceof WebGLTexture && typeof target === "number" &&
+        typeof level === "number" && typeof xoffset === "number" && typeof yoffset === "number" && typeof width === "number" &&
+        typeof height === "number" && typeof format === "number" && typeof type === "number" && ArrayBuffer.isView(pixels) &&
+        (priority === undefined || typeof priority === "number"))) {
+        throw new TypeError('Expected queueTexSubImage2D(WebGLTexture texture, number target, number level, number xoffset, number yoffset, number width, number height, number format, number type, ArrayBufferView pixels, number priority)');
+    }
+    return this._queueUpload(this.gl.queueTextureUpload(texture._, target, level, false, 0, xoffset, yoffset, width, height, format, type, pixels, priority || 0));
+};
+
+WebGLRenderingContext.prototype.queueBufferData = function queueBufferData(buffer, data, usage, priority) {
+    if (!(arguments.length >= 3 && arguments.length <= 4 && buffer instanceof WebGLBuffer && ArrayBuffer.isView(data) &&
+        typeof usage === "number" && (priority === undefined || typeof priority === "number"))) {
+        throw new TypeError('Expected queueBufferData(WebGLBuffer buffer, ArrayBufferView data, number usage, number priority)');
+    }
+    return this._queueUpload(this.gl.queueBufferUpload(buffer._, usage, data.byteLength, 0, data, priority || 0));
+};
+
+/* offset is in bytes. */
+WebGLRenderingContext.prototype.queueBufferSubData = function queueBufferSubData(buffer, offset, data, priority) {
+    if (!(arguments.length >= 3 && arguments.length <= 4 && buffer instanceof WebGLBuffer && typeof offset === "number" &&
+        ArrayBuffer.isView(data) && (priority === undefined || typeof priority === "number"))) {
+        throw new TypeError('Expected queueBufferSubData(WebGLBuffer buffer, number offset, ArrayBufferView data, number priority)');
+    }
+    return this._queueUpload(this.gl.queueBufferUpload(buffer._, 0, 0, offset, data, priority || 0));
+};
+
+/* The time and bytes that queued uploads may take per frame; 0 doesn't limit. 4 ms and no byte limit by default. */
+WebGLRenderingContext.prototype.setUploadBudget = function setUploadBudget(milliseconds, bytes) {
+    if (!(arguments.length >= 1 && arguments.length <= 2 && typeof milliseconds === "number" && (bytes === undefined || typeof bytes === "number"))) {
+        throw new TypeError('Expected setUploadBudget(number milliseconds, number bytes)');
+    }
+    return this.gl.setUploadBudget(milliseconds, bytes || 0);
+};
+
+/* Performs all queued uploads now. */
+WebGLRenderingContext.prototype.flushUploads = function flushUploads() {
+    this.gl.flushUploads();
+    this._settleUploads();
+};
+
 WebGLRenderingContext.prototype.activeTexture = function activeTexture(texture) {
     if (!(arguments.length === 1 && typeof texture === "number")) {
         throw new TypeError('Expected activeTexture(number texture)');
@@ -481,19 +1370,33 @@ WebGLRenderingContext.prototype.blendFuncSeparate = function blendFuncSeparate(s
     return this.gl.blendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
 };
 
-WebGLRenderingContext.prototype.bufferData = function bufferData(target, data, usage) {
-    if (!(arguments.length === 3 && typeof target === "number" &&
-        (typeof data === "object" || typeof data === "number") && typeof usage === "number")) {
-        throw new TypeError('Expected bufferData(number target, ArrayBuffer data, number usage) or bufferData(number target, number size, number usage)');
+// srcOffset and length select a part of a view, counted in its elements like in WebGL 2. They are passed on in
+// bytes, so that uploading part of a view doesn't need a subarray.
+function bufferSourceBytes(data, srcOffset, length) {
+    var size = ArrayBuffer.isView(data) && data.BYTES_PER_ELEMENT ? data.BYTES_PER_ELEMENT : 1;
+    return [srcOffset === undefined ? undefined : srcOffset * size, length === undefined || length === 0 ? undefined : length * size];
+}
+
+WebGLRenderingContext.prototype.bufferData = function bufferData(target, data, usage, srcOffset, length) {
+    if (!(arguments.length >= 3 && arguments.length <= 5 && typeof target === "number" &&
+        (typeof data === "object" || typeof data === "number") && typeof usage === "number" &&
+        (srcOffset === undefined || typeof srcOffset === "number") && (length === undefined || typeof length === "number"))) {
+        throw new TypeError('Expected bufferData(number target, ArrayBuffer data, number usage, number srcOffset, number length) or bufferData(number target, number size, number usage)');
+    }
+    if (typeof data === "number") {
+        return this.gl.bufferData(target, data, usage);
     }
-    return this.gl.bufferData(target, data, usage);
+    var bytes = bufferSourceBytes(data, srcOffset, length);
+    return this.gl.bufferData(target, data, usage, bytes[0], bytes[1]);
 };
 
-WebGLRenderingContext.prototype.bufferSubData = function bufferSubData(target, offset, data) {
-    if (!(arguments.length === 3 && typeof target === "number" && typeof offset === "number" && typeof data === "object")) {
-        throw new TypeError('Expected bufferSubData(number target, number offset, ArrayBuffer data)');
+WebGLRenderingContext.prototype.bufferSubData = function bufferSubData(target, offset, data, srcOffset, length) {
+    if (!(arguments.length >= 3 && arguments.length <= 5 && typeof target === "number" && typeof offset === "number" && typeof data === "object" &&
+        (srcOffset === undefined || typeof srcOffset === "number") && (length === undefined || typeof length === "number"))) {
+        throw new TypeError('Expected bufferSubData(number target, number offset, ArrayBuffer data, number srcOffset, number length)');
     }
-    return this.gl.bufferSubData(target, offset, data);
+    var bytes = bufferSourceBytes(data, srcOffset, length);
+    return this.gl.bufferSubData(target, offset, data, bytes[0], bytes[1]);
 };
 
 WebGLRenderingContext.prototype.checkFramebufferStatus = function checkFramebufferStatus(target) {
@@ -794,6 +1697,10 @@ WebGLRenderingContext.prototype.getParameter = function getParameter(pname) {
     if (!(arguments.length === 1 && typeof pname === "number")) {
         throw new TypeError('Expected getParameter(number pname)');
     }
+    if (pname === OES_vertex_array_object.prototype.VERTEX_ARRAY_BINDING_OES) {
+        var vao = this._extensions && this._extensions.OES_vertex_array_object;
+        return vao ? vao._bound : null;
+    }
     return this.gl.getParameter(pname);
 };
 
@@ -1323,3 +2230,593 @@ WebGLRenderingContext.prototype.viewport = function viewport(x, y, width, height
     }
     return this.gl.viewport(x, y, width, height);
 };
+
+
+// WebGL 2 (OpenGL ES 3.0). The WebGL 1 methods are inherited; the additions below
+// start with the features that matter most for performance.
+
+/* WebGL 2 constants */
+WebGL2RenderingContext.prototype.READ_BUFFER = 0x0C02;
+WebGL2RenderingContext.prototype.UNPACK_ROW_LENGTH = 0x0CF2;
+WebGL2RenderingContext.prototype.UNPACK_SKIP_ROWS = 0x0CF3;
+WebGL2RenderingContext.prototype.UNPACK_SKIP_PIXELS = 0x0CF4;
+WebGL2RenderingContext.prototype.PACK_ROW_LENGTH = 0x0D02;
+WebGL2RenderingContext.prototype.PACK_SKIP_ROWS = 0x0D03;
+WebGL2RenderingContext.prototype.PACK_SKIP_PIXELS = 0x0D04;
+WebGL2RenderingContext.prototype.UNPACK_SKIP_IMAGES = 0x806D;
+WebGL2RenderingContext.prototype.UNPACK_IMAGE_HEIGHT = 0x806E;
+WebGL2RenderingContext.prototype.MIN = 0x8007;
+WebGL2RenderingContext.prototype.MAX = 0x8008;
+WebGL2RenderingContext.prototype.MAX_ELEMENTS_VERTICES = 0x80E8;
+WebGL2RenderingContext.prototype.MAX_ELEMENTS_INDICES = 0x80E9;
+/* Buffer objects */
+WebGL2RenderingContext.prototype.STREAM_READ = 0x88E1;
+WebGL2RenderingContext.prototype.STREAM_COPY = 0x88E2;
+WebGL2RenderingContext.prototype.STATIC_READ = 0x88E5;
+WebGL2RenderingContext.prototype.STATIC_COPY = 0x88E6;
+WebGL2RenderingContext.prototype.DYNAMIC_READ = 0x88E9;
+WebGL2RenderingContext.prototype.DYNAMIC_COPY = 0x88EA;
+WebGL2RenderingContext.prototype.PIXEL_PACK_BUFFER = 0x88EB;
+WebGL2RenderingContext.prototype.PIXEL_UNPACK_BUFFER = 0x88EC;
+WebGL2RenderingContext.prototype.PIXEL_PACK_BUFFER_BINDING = 0x88ED;
+WebGL2RenderingContext.prototype.PIXEL_UNPACK_BUFFER_BINDING = 0x88EF;
+WebGL2RenderingContext.prototype.COPY_READ_BUFFER = 0x8F36;
+WebGL2RenderingContext.prototype.COPY_WRITE_BUFFER = 0x8F37;
+WebGL2RenderingContext.prototype.COPY_READ_BUFFER_BINDING = 0x8F36;
+WebGL2RenderingContext.prototype.COPY_WRITE_BUFFER_BINDING = 0x8F37;
+/* Uniform buffers */
+WebGL2RenderingContext.prototype.UNIFORM_BUFFER = 0x8A11;
+WebGL2RenderingContext.prototype.UNIFORM_BUFFER_BINDING = 0x8A28;
+WebGL2RenderingContext.prototype.UNIFORM_BUFFER_START = 0x8A29;
+WebGL2RenderingContext.prototype.UNIFORM_BUFFER_SIZE = 0x8A2A;
+WebGL2RenderingContext.prototype.MAX_VERTEX_UNIFORM_BLOCKS = 0x8A2B;
+WebGL2RenderingContext.prototype.MAX_FRAGMENT_UNIFORM_BLOCKS = 0x8A2D;
+WebGL2RenderingContext.prototype.MAX_COMBINED_UNIFORM_BLOCKS = 0x8A2E;
+WebGL2RenderingContext.prototype.MAX_UNIFORM_BUFFER_BINDINGS = 0x8A2F;
+WebGL2RenderingContext.prototype.MAX_UNIFORM_BLOCK_SIZE = 0x8A30;
+WebGL2RenderingContext.prototype.UNIFORM_BUFFER_OFFSET_ALIGNMENT = 0x8A34;
+WebGL2RenderingContext.prototype.UNIFORM_BLOCK_BINDING = 0x8A3F;
+WebGL2RenderingContext.prototype.UNIFORM_BLOCK_DATA_SIZE = 0x8A40;
+WebGL2RenderingContext.prototype.UNIFORM_BLOCK_ACTIVE_UNIFORMS = 0x8A42;
+WebGL2RenderingContext.prototype.UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES = 0x8A43;
+WebGL2RenderingContext.prototype.UNIFORM_BLOCK_REFERENCED_BY_VERTEX_SHADER = 0x8A44;
+WebGL2RenderingContext.prototype.UNIFORM_BLOCK_REFERENCED_BY_FRAGMENT_SHADER = 0x8A46;
+WebGL2RenderingContext.prototype.INVALID_INDEX = 0xFFFFFFFF;
+/* Vertex arrays and instancing */
+WebGL2RenderingContext.prototype.VERTEX_ARRAY_BINDING = 0x85B5;
+WebGL2RenderingContext.prototype.VERTEX_ATTRIB_ARRAY_INTEGER = 0x88FD;
+WebGL2RenderingContext.prototype.VERTEX_ATTRIB_ARRAY_DIVISOR = 0x88FE;
+WebGL2RenderingContext.prototype.UNSIGNED_INT_VEC2 = 0x8DC6;
+WebGL2RenderingContext.prototype.UNSIGNED_INT_VEC3 = 0x8DC7;
+WebGL2RenderingContext.prototype.UNSIGNED_INT_VEC4 = 0x8DC8;
+/* Textures */
+WebGL2RenderingContext.prototype.TEXTURE_3D = 0x806F;
+WebGL2RenderingContext.prototype.TEXTURE_2D_ARRAY = 0x8C1A;
+WebGL2RenderingContext.prototype.TEXTURE_BINDING_3D = 0x806A;
+WebGL2RenderingContext.prototype.TEXTURE_BINDING_2D_ARRAY = 0x8C1D;
+WebGL2RenderingContext.prototype.TEXTURE_WRAP_R = 0x8072;
+WebGL2RenderingContext.prototype.TEXTURE_MIN_LOD = 0x813A;
+WebGL2RenderingContext.prototype.TEXTURE_MAX_LOD = 0x813B;
+WebGL2RenderingContext.prototype.TEXTURE_BASE_LEVEL = 0x813C;
+WebGL2RenderingContext.prototype.TEXTURE_MAX_LEVEL = 0x813D;
+WebGL2RenderingContext.prototype.TEXTURE_COMPARE_MODE = 0x884C;
+WebGL2RenderingContext.prototype.TEXTURE_COMPARE_FUNC = 0x884D;
+WebGL2RenderingContext.prototype.COMPARE_REF_TO_TEXTURE = 0x884E;
+WebGL2RenderingContext.prototype.TEXTURE_IMMUTABLE_FORMAT = 0x912F;
+WebGL2RenderingContext.prototype.TEXTURE_IMMUTABLE_LEVELS = 0x82DF;
+WebGL2RenderingContext.prototype.MAX_3D_TEXTURE_SIZE = 0x8073;
+WebGL2RenderingContext.prototype.MAX_ARRAY_TEXTURE_LAYERS = 0x88FF;
+WebGL2RenderingContext.prototype.SAMPLER_BINDING = 0x8919;
+/* Formats and types */
+WebGL2RenderingContext.prototype.RED = 0x1903;
+WebGL2RenderingContext.prototype.RG = 0x8227;
+WebGL2RenderingContext.prototype.RED_INTEGER = 0x8D94;
+WebGL2RenderingContext.prototype.RG_INTEGER = 0x8228;
+WebGL2RenderingContext.prototype.RGB_INTEGER = 0x8D98;
+WebGL2RenderingContext.prototype.RGBA_INTEGER = 0x8D99;
+WebGL2RenderingContext.prototype.R8 = 0x8229;
+WebGL2RenderingContext.prototype.RG8 = 0x822B;
+WebGL2RenderingContext.prototype.RGB8 = 0x8051;
+WebGL2RenderingContext.prototype.RGBA8 = 0x8058;
+WebGL2RenderingContext.prototype.SRGB8 = 0x8C41;
+WebGL2RenderingContext.prototype.SRGB8_ALPHA8 = 0x8C43;
+WebGL2RenderingContext.prototype.RGB10_A2 = 0x8059;
+WebGL2RenderingContext.prototype.R11F_G11F_B10F = 0x8C3A;
+WebGL2RenderingContext.prototype.RGB9_E5 = 0x8C3D;
+WebGL2RenderingContext.prototype.R16F = 0x822D;
+WebGL2RenderingContext.prototype.RG16F = 0x822F;
+WebGL2RenderingContext.prototype.RGB16F = 0x881B;
+WebGL2RenderingContext.prototype.RGBA16F = 0x881A;
+WebGL2RenderingContext.prototype.R32F = 0x822E;
+WebGL2RenderingContext.prototype.RG32F = 0x8230;
+WebGL2RenderingContext.prototype.RGB32F = 0x8815;
+WebGL2RenderingContext.prototype.RGBA32F = 0x8814;
+WebGL2RenderingContext.prototype.R8I = 0x8231;
+WebGL2RenderingContext.prototype.R8UI = 0x8232;
+WebGL2RenderingContext.prototype.R16I = 0x8233;
+WebGL2RenderingContext.prototype.R16UI = 0x8234;
+WebGL2RenderingContext.prototype.R32I = 0x8235;
+WebGL2RenderingContext.prototype.R32UI = 0x8236;
+WebGL2RenderingContext.prototype.RGBA8I = 0x8D8E;
+WebGL2RenderingContext.prototype.RGBA8UI = 0x8D7C;
+WebGL2RenderingContext.prototype.RGBA32I = 0x8D82;
+WebGL2RenderingContext.prototype.RGBA32UI = 0x8D70;
+WebGL2RenderingContext.prototype.DEPTH_COMPONENT24 = 0x81A6;
+WebGL2RenderingContext.prototype.DEPTH_COMPONENT32F = 0x8CAC;
+WebGL2RenderingContext.prototype.DEPTH24_STENCIL8 = 0x88F0;
+WebGL2RenderingContext.prototype.DEPTH32F_STENCIL8 = 0x8CAD;
+WebGL2RenderingContext.prototype.HALF_FLOAT = 0x140B;
+WebGL2RenderingContext.prototype.UNSIGNED_INT_2_10_10_10_REV = 0x8368;
+WebGL2RenderingContext.prototype.UNSIGNED_INT_10F_11F_11F_REV = 0x8C3B;
+WebGL2RenderingContext.prototype.UNSIGNED_INT_24_8 = 0x84FA;
+WebGL2RenderingContext.prototype.FLOAT_32_UNSIGNED_INT_24_8_REV = 0x8DAD;
+/* Framebuffers */
+WebGL2RenderingContext.prototype.READ_FRAMEBUFFER = 0x8CA8;
+WebGL2RenderingContext.prototype.DRAW_FRAMEBUFFER = 0x8CA9;
+WebGL2RenderingContext.prototype.READ_FRAMEBUFFER_BINDING = 0x8CAA;
+WebGL2RenderingContext.prototype.DRAW_FRAMEBUFFER_BINDING = 0x8CA6;
+WebGL2RenderingContext.prototype.RENDERBUFFER_SAMPLES = 0x8CAB;
+WebGL2RenderingContext.prototype.MAX_SAMPLES = 0x8D57;
+WebGL2RenderingContext.prototype.MAX_DRAW_BUFFERS = 0x8824;
+WebGL2RenderingContext.prototype.MAX_COLOR_ATTACHMENTS = 0x8CDF;
+WebGL2RenderingContext.prototype.DRAW_BUFFER0 = 0x8825;
+WebGL2RenderingContext.prototype.DRAW_BUFFER1 = 0x8826;
+WebGL2RenderingContext.prototype.DRAW_BUFFER2 = 0x8827;
+WebGL2RenderingContext.prototype.DRAW_BUFFER3 = 0x8828;
+WebGL2RenderingContext.prototype.COLOR_ATTACHMENT1 = 0x8CE1;
+WebGL2RenderingContext.prototype.COLOR_ATTACHMENT2 = 0x8CE2;
+WebGL2RenderingContext.prototype.COLOR_ATTACHMENT3 = 0x8CE3;
+WebGL2RenderingContext.prototype.COLOR_ATTACHMENT4 = 0x8CE4;
+WebGL2RenderingContext.prototype.COLOR_ATTACHMENT5 = 0x8CE5;
+WebGL2RenderingContext.prototype.COLOR_ATTACHMENT6 = 0x8CE6;
+WebGL2RenderingContext.prototype.COLOR_ATTACHMENT7 = 0x8CE7;
+WebGL2RenderingContext.prototype.DEPTH_STENCIL_ATTACHMENT = 0x821A;
+WebGL2RenderingContext.prototype.COLOR = 0x1800;
+WebGL2RenderingContext.prototype.DEPTH = 0x1801;
+WebGL2RenderingContext.prototype.STENCIL = 0x1802;
+/* Sync objects */
+WebGL2RenderingContext.prototype.OBJECT_TYPE = 0x9112;
+WebGL2RenderingContext.prototype.SYNC_CONDITION = 0x9113;
+WebGL2RenderingContext.prototype.SYNC_STATUS = 0x9114;
+WebGL2RenderingContext.prototype.SYNC_FLAGS = 0x9115;
+WebGL2RenderingContext.prototype.SYNC_FENCE = 0x9116;
+WebGL2RenderingContext.prototype.SYNC_GPU_COMMANDS_COMPLETE = 0x9117;
+WebGL2RenderingContext.prototype.UNSIGNALED = 0x9118;
+WebGL2RenderingContext.prototype.SIGNALED = 0x9119;
+WebGL2RenderingContext.prototype.ALREADY_SIGNALED = 0x911A;
+WebGL2RenderingContext.prototype.TIMEOUT_EXPIRED = 0x911B;
+WebGL2RenderingContext.prototype.CONDITION_SATISFIED = 0x911C;
+WebGL2RenderingContext.prototype.WAIT_FAILED = 0x911D;
+WebGL2RenderingContext.prototype.SYNC_FLUSH_COMMANDS_BIT = 0x00000001;
+WebGL2RenderingContext.prototype.TIMEOUT_IGNORED = -1;
+
+/* Buffers */
+WebGL2RenderingContext.prototype.bindBufferBase = function bindBufferBase(target, index, buffer) {
+    if (!(arguments.length === 3 && typeof target === "number" && typeof index === "number" && (buffer === null || buffer instanceof WebGLBuffer))) {
+        throw new TypeError('Expected bindBufferBase(number target, number index, WebGLBuffer buffer)');
+    }
+    return this.gl.bindBufferBase(target, index, buffer ? buffer._ : 0);
+};
+
+WebGL2RenderingContext.prototype.bindBufferRange = function bindBufferRange(target, index, buffer, offset, size) {
+    if (!(arguments.length === 5 && typeof target === "number" && typeof index === "number" && (buffer === null || buffer instanceof WebGLBuffer) && typeof offset === "number" && typeof size === "number")) {
+        throw new TypeError('Expected bindBufferRange(number target, number index, WebGLBuffer buffer, number offset, number size)');
+    }
+    return this.gl.bindBufferRange(target, index, buffer ? buffer._ : 0, offset, size);
+};
+
+WebGL2RenderingContext.prototype.copyBufferSubData = function copyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size) {
+    if (!(arguments.length === 5 && typeof readTarget === "number" && typeof writeTarget === "number" && typeof readOffset === "number" && typeof writeOffset === "number" && typeof size === "number")) {
+        throw new TypeError('Expected copyBufferSubData(number readTarget, number writeTarget, number readOffset, number writeOffset, number size)');
+    }
+    return this.gl.copyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+};
+
+// Reading back a PIXEL_PACK_BUFFER only avoids a stall once a fence placed after readPixels has signalled.
+WebGL2RenderingContext.prototype.getBufferSubData = function getBufferSubData(target, srcByteOffset, dstBuffer, dstOffset, length) {
+    if (!(arguments.length >= 3 && arguments.length <= 5 && typeof target === "number" && typeof srcByteOffset === "number" && ArrayBuffer.isView(dstBuffer) && (dstOffset === undefined || typeof dstOffset === "number") && (length === undefined || typeof length === "number"))) {
+        throw new TypeError('Expected getBufferSubData(number target, number srcByteOffset, ArrayBufferView dstBuffer, number dstOffset = 0, number length = 0)');
+    }
+    // dstOffset and length count elements of dstBuffer; a length of 0 reads up to its end.
+    var size = dstBuffer.BYTES_PER_ELEMENT || 1;
+    var elements = dstBuffer.byteLength / size;
+    dstOffset = dstOffset || 0;
+    length = length || (elements - dstOffset);
+    if (dstOffset < 0 || length < 0 || dstOffset + length > elements) {
+        throw new RangeError('dstOffset and length are outside of dstBuffer');
+    }
+    return this.gl.getBufferSubData(target, srcByteOffset, dstBuffer, dstOffset * size, length * size);
+};
+
+/* Uniform buffers */
+WebGL2RenderingContext.prototype.getUniformBlockIndex = function getUniformBlockIndex(program, uniformBlockName) {
+    if (!(arguments.length === 2 && program instanceof WebGLProgram && typeof uniformBlockName === "string")) {
+        throw new TypeError('Expected getUniformBlockIndex(WebGLProgram program, string uniformBlockName)');
+    }
+    return this.gl.getUniformBlockIndex(program._, uniformBlockName);
+};
+
+WebGL2RenderingContext.prototype.uniformBlockBinding = function uniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding) {
+    if (!(arguments.length === 3 && program instanceof WebGLProgram && typeof uniformBlockIndex === "number" && typeof uniformBlockBinding === "number")) {
+        throw new TypeError('Expected uniformBlockBinding(WebGLProgram program, number uniformBlockIndex, number uniformBlockBinding)');
+    }
+    return this.gl.uniformBlockBinding(program._, uniformBlockIndex, uniformBlockBinding);
+};
+
+WebGL2RenderingContext.prototype.getActiveUniformBlockParameter = function getActiveUniformBlockParameter(program, uniformBlockIndex, pname) {
+    if (!(arguments.length === 3 && program instanceof WebGLProgram && typeof uniformBlockIndex === "number" && typeof pname === "number")) {
+        throw new TypeError('Expected getActiveUniformBlockParameter(WebGLProgram program, number uniformBlockIndex, number pname)');
+    }
+    var value = this.gl.getActiveUniformBlockParameter(program._, uniformBlockIndex, pname);
+    return pname === this.UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES ? new Uint32Array(value) : value;
+};
+
+WebGL2RenderingContext.prototype.getActiveUniformBlockName = function getActiveUniformBlockName(program, uniformBlockIndex) {
+    if (!(arguments.length === 2 && program instanceof WebGLProgram && typeof uniformBlockIndex === "number")) {
+        throw new TypeError('Expected getActiveUniformBlockName(WebGLProgram program, number uniformBlockIndex)');
+    }
+    return this.gl.getActiveUniformBlockName(program._, uniformBlockIndex);
+};
+
+/* Vertex attributes and uniforms */
+WebGL2RenderingContext.prototype.vertexAttribIPointer = function vertexAttribIPointer(index, size, type, stride, offset) {
+    if (!(arguments.length === 5 && typeof index === "number" && typeof size === "number" && typeof type === "number" && typeof stride === "number" && typeof offset === "number")) {
+        throw new TypeError('Expected vertexAttribIPointer(number index, number size, number type, number stride, number offset)');
+    }
+    return this.gl.vertexAttribIPointer(index, size, type, stride, offset);
+};
+
+WebGL2RenderingContext.prototype.vertexAttribI4i = function vertexAttribI4i(index, x, y, z, w) {
+    if (!(arguments.length === 5 && typeof index === "number" && typeof x === "number" && typeof y === "number" && typeof z === "number" && typeof w === "number")) {
+        throw new TypeError('Expected vertexAttribI4i(number index, number x, number y, number z, number w)');
+    }
+    return this.gl.vertexAttribI4i(index, x, y, z, w);
+};
+
+WebGL2RenderingContext.prototype.vertexAttribI4ui = function vertexAttribI4ui(index, x, y, z, w) {
+    if (!(arguments.length === 5 && typeof index === "number" && typeof x === "number" && typeof y === "number" && typeof z === "number" && typeof w === "number")) {
+        throw new TypeError('Expected vertexAttribI4ui(number index, number x, number y, number z, number w)');
+    }
+    return this.gl.vertexAttribI4ui(index, x, y, z, w);
+};
+
+WebGL2RenderingContext.prototype.uniform1ui = function uniform1ui(location, x) {
+    if (!(arguments.length === 2 && (location === null || location instanceof WebGLUniformLocation) && typeof x === "number")) {
+        throw new TypeError('Expected uniform1ui(WebGLUniformLocation location, number x)');
+    }
+    return this.gl.uniformui(location ? location._ : 0, x);
+};
+
+WebGL2RenderingContext.prototype.uniform2ui = function uniform2ui(location, x, y) {
+    if (!(arguments.length === 3 && (location === null || location instanceof WebGLUniformLocation) && typeof x === "number" && typeof y === "number")) {
+        throw new TypeError('Expected uniform2ui(WebGLUniformLocation location, number x, number y)');
+    }
+    return this.gl.uniformui(location ? location._ : 0, x, y);
+};
+
+WebGL2RenderingContext.prototype.uniform3ui = function uniform3ui(location, x, y, z) {
+    if (!(arguments.length === 4 && (location === null || location instanceof WebGLUniformLocation) && typeof x === "number" && typeof y === "number" && typeof z === "number")) {
+        throw new TypeError('Expected uniform3ui(WebGLUniformLocation location, number x, number y, number z)');
+    }
+    return this.gl.uniformui(location ? location._ : 0, x, y, z);
+};
+
+WebGL2RenderingContext.prototype.uniform4ui = function uniform4ui(location, x, y, z, w) {
+    if (!(arguments.length === 5 && (location === null || location instanceof WebGLUniformLocation) && typeof x === "number" && typeof y === "number" && typeof z === "number" && typeof w === "number")) {
+        throw new TypeError('Expected uniform4ui(WebGLUniformLocation location, number x, number y, number z, number w)');
+    }
+    return this.gl.uniformui(location ? location._ : 0, x, y, z, w);
+};
+
+WebGL2RenderingContext.prototype.uniform1uiv = function uniform1uiv(location, data) {
+    if (!(arguments.length === 2 && (location === null || location instanceof WebGLUniformLocation) && data instanceof Uint32Array)) {
+        throw new TypeError('Expected uniform1uiv(WebGLUniformLocation location, Uint32Array data)');
+    }
+    return this.gl.uniformuiv(location ? location._ : 0, data, 1);
+};
+
+WebGL2RenderingContext.prototype.uniform2uiv = function uniform2uiv(location, data) {
+    if (!(arguments.length === 2 && (location === null || location instanceof WebGLUniformLocation) && data instanceof Uint32Array)) {
+        throw new TypeError('Expected uniform2uiv(WebGLUniformLocation location, Uint32Array data)');
+    }
+    return this.gl.uniformuiv(location ? location._ : 0, data, 2);
+};
+
+WebGL2RenderingContext.prototype.uniform3uiv = function uniform3uiv(location, data) {
+    if (!(arguments.length === 2 && (location === null || location instanceof WebGLUniformLocation) && data instanceof Uint32Array)) {
+        throw new TypeError('Expected uniform3uiv(WebGLUniformLocation location, Uint32Array data)');
+    }
+    return this.gl.uniformuiv(location ? location._ : 0, data, 3);
+};
+
+WebGL2RenderingContext.prototype.uniform4uiv = function uniform4uiv(location, data) {
+    if (!(arguments.length === 2 && (location === null || location instanceof WebGLUniformLocation) && data instanceof Uint32Array)) {
+        throw new TypeError('Expected uniform4uiv(WebGLUniformLocation location, Uint32Array data)');
+    }
+    return this.gl.uniformuiv(location ? location._ : 0, data, 4);
+};
+
+/* Drawing */
+WebGL2RenderingContext.prototype.drawArraysInstanced = function drawArraysInstanced(mode, first, count, instanceCount) {
+    if (!(arguments.length === 4 && typeof mode === "number" && typeof first === "number" && typeof count === "number" && typeof instanceCount === "number")) {
+        throw new TypeError('Expected drawArraysInstanced(number mode, number first, number count, number instanceCount)');
+    }
+    return this.gl.drawArraysInstanced(mode, first, count, instanceCount);
+};
+
+WebGL2RenderingContext.prototype.drawElementsInstanced = function drawElementsInstanced(mode, count, type, offset, instanceCount) {
+    if (!(arguments.length === 5 && typeof mode === "number" && typeof count === "number" && typeof type === "number" && typeof offset === "number" && typeof instanceCount === "number")) {
+        throw new TypeError('Expected drawElementsInstanced(number mode, number count, number type, number offset, number instanceCount)');
+    }
+    return this.gl.drawElementsInstanced(mode, count, type, offset, instanceCount);
+};
+
+WebGL2RenderingContext.prototype.vertexAttribDivisor = function vertexAttribDivisor(index, divisor) {
+    if (!(arguments.length === 2 && typeof index === "number" && typeof divisor === "number")) {
+        throw new TypeError('Expected vertexAttribDivisor(number index, number divisor)');
+    }
+    return this.gl.vertexAttribDivisor(index, divisor);
+};
+
+WebGL2RenderingContext.prototype.drawRangeElements = function drawRangeElements(mode, start, end, count, type, offset) {
+    if (!(arguments.length === 6 && typeof mode === "number" && typeof start === "number" && typeof end === "number" && typeof count === "number" && typeof type === "number" && typeof offset === "number")) {
+        throw new TypeError('Expected drawRangeElements(number mode, number start, number end, number count, number type, number offset)');
+    }
+    return this.gl.drawRangeElements(mode, start, end, count, type, offset);
+};
+
+WebGL2RenderingContext.prototype.drawBuffers = function drawBuffers(buffers) {
+    if (!(arguments.length === 1 && Array.isArray(buffers))) {
+        throw new TypeError('Expected drawBuffers(Array buffers)');
+    }
+    return this.gl.drawBuffers(buffers);
+};
+
+WebGL2RenderingContext.prototype.readBuffer = function readBuffer(src) {
+    if (!(arguments.length === 1 && typeof src === "number")) {
+        throw new TypeError('Expected readBuffer(number src)');
+    }
+    return this.gl.readBuffer(src);
+};
+
+/* Vertex array objects */
+WebGL2RenderingContext.prototype.createVertexArray = function createVertexArray() {
+    return new WebGLVertexArrayObject(this.gl.createVertexArray());
+};
+
+WebGL2RenderingContext.prototype.deleteVertexArray = function deleteVertexArray(vertexArray) {
+    if (!(arguments.length === 1 && (vertexArray === null || vertexArray instanceof WebGLVertexArrayObject))) {
+        throw new TypeError('Expected deleteVertexArray(WebGLVertexArrayObject vertexArray)');
+    }
+    if (vertexArray && vertexArray === this._vertexArray) {
+        this._vertexArray = null;
+    }
+    return this.gl.deleteVertexArray(vertexArray ? vertexArray._ : 0);
+};
+
+WebGL2RenderingContext.prototype.isVertexArray = function isVertexArray(vertexArray) {
+    if (!(arguments.length === 1 && (vertexArray === null || vertexArray instanceof WebGLVertexArrayObject))) {
+        throw new TypeError('Expected isVertexArray(WebGLVertexArrayObject vertexArray)');
+    }
+    return this.gl.isVertexArray(vertexArray ? vertexArray._ : 0);
+};
+
+WebGL2RenderingContext.prototype.bindVertexArray = function bindVertexArray(vertexArray) {
+    if (!(arguments.length === 1 && (vertexArray === null || vertexArray instanceof WebGLVertexArrayObject))) {
+        throw new TypeError('Expected bindVertexArray(WebGLVertexArrayObject vertexArray)');
+    }
+    this._vertexArray = vertexArray;
+    return this.gl.bindVertexArray(vertexArray ? vertexArray._ : 0);
+};
+
+WebGL2RenderingContext.prototype.getParameter = function getParameter(pname) {
+    if (!(arguments.length === 1 && typeof pname === "number")) {
+        throw new TypeError('Expected getParameter(number pname)');
+    }
+    if (pname === this.VERTEX_ARRAY_BINDING) {
+        return this._vertexArray || null;
+    }
+    return this.gl.getParameter(pname);
+};
+
+/* Sync objects */
+WebGL2RenderingContext.prototype.fenceSync = function fenceSync(condition, flags) {
+    if (!(arguments.length === 2 && typeof condition === "number" && typeof flags === "number")) {
+        throw new TypeError('Expected fenceSync(number condition, number flags)');
+    }
+    var sync = this.gl.fenceSync(condition, flags);
+    return sync ? new WebGLSync(sync) : null;
+};
+
+WebGL2RenderingContext.prototype.deleteSync = function deleteSync(sync) {
+    if (!(arguments.length === 1 && (sync === null || sync instanceof WebGLSync))) {
+        throw new TypeError('Expected deleteSync(WebGLSync sync)');
+    }
+    return this.gl.deleteSync(sync ? sync._ : 0);
+};
+
+WebGL2RenderingContext.prototype.isSync = function isSync(sync) {
+    if (!(arguments.length === 1 && (sync === null || sync instanceof WebGLSync))) {
+        throw new TypeError('Expected isSync(WebGLSync sync)');
+    }
+    return this.gl.isSync(sync ? sync._ : 0);
+};
+
+WebGL2RenderingContext.prototype.clientWaitSync = function clientWaitSync(sync, flags, timeout) {
+    if (!(arguments.length === 3 && sync instanceof WebGLSync && typeof flags === "number" && typeof timeout === "number")) {
+        throw new TypeError('Expected clientWaitSync(WebGLSync sync, number flags, number timeout)');
+    }
+    return this.gl.clientWaitSync(sync._, flags, timeout);
+};
+
+WebGL2RenderingContext.prototype.waitSync = function waitSync(sync, flags, timeout) {
+    if (!(arguments.length === 3 && sync instanceof WebGLSync && typeof flags === "number" && typeof timeout === "number")) {
+        throw new TypeError('Expected waitSync(WebGLSync sync, number flags, number timeout)');
+    }
+    return this.gl.waitSync(sync._, flags);
+};
+
+WebGL2RenderingContext.prototype.getSyncParameter = function getSyncParameter(sync, pname) {
+    if (!(arguments.length === 2 && sync instanceof WebGLSync && typeof pname === "number")) {
+        throw new TypeError('Expected getSyncParameter(WebGLSync sync, number pname)');
+    }
+    return this.gl.getSyncParameter(sync._, pname);
+};
+
+/* Textures */
+WebGL2RenderingContext.prototype.texStorage2D = function texStorage2D(target, levels, internalformat, width, height) {
+    if (!(arguments.length === 5 && typeof target === "number" && typeof levels === "number" && typeof internalformat === "number" && typeof width === "number" && typeof height === "number")) {
+        throw new TypeError('Expected texStorage2D(number target, number levels, number internalformat, number width, number height)');
+    }
+    return this.gl.texStorage2D(target, levels, internalformat, width, height);
+};
+
+WebGL2RenderingContext.prototype.texStorage3D = function texStorage3D(target, levels, internalformat, width, height, depth) {
+    if (!(arguments.length === 6 && typeof target === "number" && typeof levels === "number" && typeof internalformat === "number" && typeof width === "number" && typeof height === "number" && typeof depth === "number")) {
+        throw new TypeError('Expected texStorage3D(number target, number levels, number internalformat, number width, number height, number depth)');
+    }
+    return this.gl.texStorage3D(target, levels, internalformat, width, height, depth);
+};
+
+WebGL2RenderingContext.prototype.texImage3D = function texImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels) {
+    if (!(arguments.length === 10 && typeof target === "number" && typeof level === "number" && typeof internalformat === "number" && typeof width === "number" && typeof height === "number" && typeof depth === "number" && typeof border === "number" && typeof format === "number" && typeof type === "number" && (pixels === null || typeof pixels === "number" || ArrayBuffer.isView(pixels)))) {
+        throw new TypeError('Expected texImage3D(number target, number level, number internalformat, number width, number height, number depth, number border, number format, number type, ArrayBufferView pixels)');
+    }
+    return this.gl.texImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
+};
+
+WebGL2RenderingContext.prototype.texSubImage3D = function texSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels) {
+    if (!(arguments.length === 11 && typeof target === "number" && typeof level === "number" && typeof xoffset === "number" && typeof yoffset === "number" && typeof zoffset === "number" && typeof width === "number" && typeof height === "number" && typeof depth === "number" && typeof format === "number" && typeof type === "number" && (pixels === null || typeof pixels === "number" || ArrayBuffer.isView(pixels)))) {
+        throw new TypeError('Expected texSubImage3D(number target, number level, number xoffset, number yoffset, number zoffset, number width, number height, number depth, number format, number type, ArrayBufferView pixels)');
+    }
+    return this.gl.texSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+};
+
+WebGL2RenderingContext.prototype.framebufferTextureLayer = function framebufferTextureLayer(target, attachment, texture, level, layer) {
+    if (!(arguments.length === 5 && typeof target === "number" && typeof attachment === "number" && (texture === null || texture instanceof WebGLTexture) && typeof level === "number" && typeof layer === "number")) {
+        throw new TypeError('Expected framebufferTextureLayer(number target, number attachment, WebGLTexture texture, number level, number layer)');
+    }
+    return this.gl.framebufferTextureLayer(target, attachment, texture ? texture._ : 0, level, layer);
+};
+
+// With a PIXEL_UNPACK_BUFFER or PIXEL_PACK_BUFFER bound, pixels is a byte offset into it.
+WebGL2RenderingContext.prototype.texImage2D = function texImage2D(target, level, internalformat, width, height, border, format, type, offset) {
+    if (typeof offset === "number") {
+        if (!(arguments.length === 9 && typeof target === "number" && typeof level === "number" && typeof internalformat === "number" && typeof width === "number" && typeof height === "number" && typeof border === "number" && typeof format === "number" && typeof type === "number")) {
+            throw new TypeError('Expected texImage2D(number target, number level, number internalformat, number width, number height, number border, number format, number type, number offset)');
+        }
+        return this.gl.texImage2D(target, level, internalformat, width, height, border, format, type, offset);
+    }
+    return WebGLRenderingContext.prototype.texImage2D.apply(this, arguments);
+};
+
+WebGL2RenderingContext.prototype.texSubImage2D = function texSubImage2D(target, level, xoffset, yoffset, width, height, format, type, offset) {
+    if (typeof offset === "number") {
+        if (!(arguments.length === 9 && typeof target === "number" && typeof level === "number" && typeof xoffset === "number" && typeof yoffset === "number" && typeof width === "number" && typeof height === "number" && typeof format === "number" && typeof type === "number")) {
+            throw new TypeError('Expected texSubImage2D(number target, number level, number xoffset, number yoffset, number width, number height, number format, number type, number offset)');
+        }
+        return this.gl.texSubImage2D(target, level, xoffset, yoffset, width, height, format, type, offset);
+    }
+    return WebGLRenderingContext.prototype.texSubImage2D.apply(this, arguments);
+};
+
+WebGL2RenderingContext.prototype.readPixels = function readPixels(x, y, width, height, format, type, offset) {
+    if (typeof offset === "number") {
+        if (!(arguments.length === 7 && typeof x === "number" && typeof y === "number" && typeof width === "number" && typeof height === "number" && typeof format === "number" && typeof type === "number")) {
+            throw new TypeError('Expected readPixels(number x, number y, number width, number height, number format, number type, number offset)');
+        }
+        return this.gl.readPixels(x, y, width, height, format, type, offset);
+    }
+    return WebGLRenderingContext.prototype.readPixels.apply(this, arguments);
+};
+
+/* Sampler objects */
+WebGL2RenderingContext.prototype.createSampler = function createSampler() {
+    return new WebGLSampler(this.gl.createSampler());
+};
+
+WebGL2RenderingContext.prototype.deleteSampler = function deleteSampler(sampler) {
+    if (!(arguments.length === 1 && (sampler === null || sampler instanceof WebGLSampler))) {
+        throw new TypeError('Expected deleteSampler(WebGLSampler sampler)');
+    }
+    return this.gl.deleteSampler(sampler ? sampler._ : 0);
+};
+
+WebGL2RenderingContext.prototype.isSampler = function isSampler(sampler) {
+    if (!(arguments.length === 1 && (sampler === null || sampler instanceof WebGLSampler))) {
+        throw new TypeError('Expected isSampler(WebGLSampler sampler)');
+    }
+    return this.gl.isSampler(sampler ? sampler._ : 0);
+};
+
+WebGL2RenderingContext.prototype.bindSampler = function bindSampler(unit, sampler) {
+    if (!(arguments.length === 2 && typeof unit === "number" && (sampler === null || sampler instanceof WebGLSampler))) {
+        throw new TypeError('Expected bindSampler(number unit, WebGLSampler sampler)');
+    }
+    return this.gl.bindSampler(unit, sampler ? sampler._ : 0);
+};
+
+WebGL2RenderingContext.prototype.samplerParameteri = function samplerParameteri(sampler, pname, param) {
+    if (!(arguments.length === 3 && sampler instanceof WebGLSampler && typeof pname === "number" && typeof param === "number")) {
+        throw new TypeError('Expected samplerParameteri(WebGLSampler sampler, number pname, number param)');
+    }
+    return this.gl.samplerParameteri(sampler._, pname, param);
+};
+
+WebGL2RenderingContext.prototype.samplerParameterf = function samplerParameterf(sampler, pname, param) {
+    if (!(arguments.length === 3 && sampler instanceof WebGLSampler && typeof pname === "number" && typeof param === "number")) {
+        throw new TypeError('Expected samplerParameterf(WebGLSampler sampler, number pname, number param)');
+    }
+    return this.gl.samplerParameterf(sampler._, pname, param);
+};
+
+/* Framebuffers */
+WebGL2RenderingContext.prototype.blitFramebuffer = function blitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter) {
+    if (!(arguments.length === 10 && typeof srcX0 === "number" && typeof srcY0 === "number" && typeof srcX1 === "number" && typeof srcY1 === "number" && typeof dstX0 === "number" && typeof dstY0 === "number" && typeof dstX1 === "number" && typeof dstY1 === "number" && typeof mask === "number" && typeof filter === "number")) {
+        throw new TypeError('Expected blitFramebuffer(number srcX0, number srcY0, number srcX1, number srcY1, number dstX0, number dstY0, number dstX1, number dstY1, number mask, number filter)');
+    }
+    return this.gl.blitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+};
+
+WebGL2RenderingContext.prototype.renderbufferStorageMultisample = function renderbufferStorageMultisample(target, samples, internalformat, width, height) {
+    if (!(arguments.length === 5 && typeof target === "number" && typeof samples === "number" && typeof internalformat === "number" && typeof width === "number" && typeof height === "number")) {
+        throw new TypeError('Expected renderbufferStorageMultisample(number target, number samples, number internalformat, number width, number height)');
+    }
+    return this.gl.renderbufferStorageMultisample(target, samples, internalformat, width, height);
+};
+
+// Lets tiled GPUs skip writing attachments back to memory that are not needed any more.
+WebGL2RenderingContext.prototype.invalidateFramebuffer = function invalidateFramebuffer(target, attachments) {
+    if (!(arguments.length === 2 && typeof target === "number" && Array.isArray(attachments))) {
+        throw new TypeError('Expected invalidateFramebuffer(number target, Array attachments)');
+    }
+    return this.gl.invalidateFramebuffer(target, attachments);
+};
+
+WebGL2RenderingContext.prototype.clearBufferfv = function clearBufferfv(buffer, drawbuffer, values) {
+    if (!(arguments.length === 3 && typeof buffer === "number" && typeof drawbuffer === "number" && (values instanceof Float32Array || Array.isArray(values)))) {
+        throw new TypeError('Expected clearBufferfv(number buffer, number drawbuffer, Float32Array values)');
+    }
+    return this.gl.clearBufferfv(buffer, drawbuffer, Array.isArray(values) ? new Float32Array(values) : values);
+};
+
+WebGL2RenderingContext.prototype.clearBufferiv = function clearBufferiv(buffer, drawbuffer, values) {
+    if (!(arguments.length === 3 && typeof buffer === "number" && typeof drawbuffer === "number" && (values instanceof Int32Array || Array.isArray(values)))) {
+        throw new TypeError('Expected clearBufferiv(number buffer, number drawbuffer, Int32Array values)');
+    }
+    return this.gl.clearBufferiv(buffer, drawbuffer, Array.isArray(values) ? new Int32Array(values) : values);
+};
+
+WebGL2RenderingContext.prototype.clearBufferuiv = function clearBufferuiv(buffer, drawbuffer, values) {
+    if (!(arguments.length === 3 && typeof buffer === "number" && typeof drawbuffer === "number" && (values instanceof Uint32Array || Array.isArray(values)))) {
+        throw new TypeError('Expected clearBufferuiv(number buffer, number drawbuffer, Uint32Array values)');
+    }
+    return this.gl.clearBufferuiv(buffer, drawbuffer, Array.isArray(values) ? new Uint32Array(values) : values);
+};
+
+WebGL2RenderingContext.prototype.clearBufferfi = function clearBufferfi(buffer, drawbuffer, depth, stencil) {
+    if (!(arguments.length === 4 && typeof buffer === "number" && typeof drawbuffer === "number" && typeof depth === "number" && typeof stencil === "number")) {
+        throw new TypeError('Expected clearBufferfi(number buffer, number drawbuffer, number depth, number stencil)');
+    }
+    return this.gl.clearBufferfi(buffer, drawbuffer, depth, stencil);
+};
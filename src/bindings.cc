@@ -1,19 +1,40 @@
 #include <cstdlib>
+#include <mutex>
 
 #include "gles2platform.h"
 #include "interface/webgl.h"
+#include "interface/webgl2.h"
+
+static std::once_flag registered;
+
+static void registerAtExit() {
+  atexit(gles2platform::AtExit);
+  atexit(webgl::WebGLRenderingContext::AtExit);
+}
 
 extern "C" {
+// Runs once for the main thread and once for every worker thread that loads
+// the module, each with its own isolate.
 void init(Handle<Object> target)
 {
-  atexit(gles2platform::AtExit);
-  atexit(webgl::WebGLRenderingContext::AtExit);
+  std::call_once(registered, registerAtExit);
+
+#if NODE_MODULE_VERSION >= 64
+  Isolate* isolate = Isolate::GetCurrent();
+  node::AddEnvironmentCleanupHook(isolate, gles2platform::Cleanup, isolate);
+#endif
 
   Nan::SetMethod(target, "init", gles2platform::init);
+  Nan::SetMethod(target, "getSurfaceConfig", gles2platform::getSurfaceConfig);
+  Nan::SetMethod(target, "makeCurrent", gles2platform::makeCurrent);
+  Nan::SetMethod(target, "destroyContext", gles2platform::destroyContext);
   Nan::SetMethod(target, "nextFrame", gles2platform::nextFrame);
+  Nan::SetMethod(target, "bufferAge", gles2platform::bufferAge);
+  Nan::SetMethod(target, "setDamageRegion", gles2platform::setDamageRegion);
 
-  webgl::WebGLRenderingContext::Initialize(target);
+  Local<FunctionTemplate> webgl1 = webgl::WebGLRenderingContext::Initialize(target);
+  webgl::WebGL2RenderingContext::Initialize(target, webgl1);
 }
 
-NODE_MODULE(gles2, init)
+NAN_MODULE_WORKER_ENABLED(gles2, init)
 } // extern "C"
@@ -0,0 +1,88 @@
+#include <vector>
+#include <climits>
+
+#include "eglconfig.h"
+
+namespace gles2impl {
+
+using namespace std;
+
+// Extra bits cost bandwidth; missing bits cost precision or a feature, which
+// is worse.
+static const int MISSING_WEIGHT = 8;
+
+// Slow configs are only taken when nothing else fits.
+static const int SLOW_PENALTY = 10000;
+
+// A wanted preserved swap that the config can't do.
+static const int PRESERVE_PENALTY = 16;
+
+static int distance(EGLint actual, int wanted) {
+  if (actual < wanted) {
+    return (wanted - actual) * MISSING_WEIGHT;
+  }
+  return actual - wanted;
+}
+
+static EGLint attrib(EGLDisplay display, EGLConfig config, EGLint name) {
+  EGLint value = 0;
+  eglGetConfigAttrib(display, config, name, &value);
+  return value;
+}
+
+bool chooseConfig(EGLDisplay display, EGLint surfaceType, EGLint renderableType, const SurfaceConfig& wanted,
+    EGLConfig& config, SurfaceConfig& chosen) {
+  EGLint count = 0;
+  if (!eglGetConfigs(display, NULL, 0, &count) || count <= 0) {
+    return false;
+  }
+  vector<EGLConfig> configs(count);
+  if (!eglGetConfigs(display, &configs[0], count, &count)) {
+    return false;
+  }
+
+  int best = INT_MAX;
+  for (EGLint i = 0; i < count; i++) {
+    EGLConfig candidate = configs[i];
+    EGLint surfaces = attrib(display, candidate, EGL_SURFACE_TYPE);
+    if ((surfaces & surfaceType) != surfaceType ||
+        (attrib(display, candidate, EGL_RENDERABLE_TYPE) & renderableType) != renderableType ||
+        attrib(display, candidate, EGL_COLOR_BUFFER_TYPE) != EGL_RGB_BUFFER) {
+      continue;
+    }
+
+    SurfaceConfig described;
+    described.redBits = attrib(display, candidate, EGL_RED_SIZE);
+    described.greenBits = attrib(display, candidate, EGL_GREEN_SIZE);
+    described.blueBits = attrib(display, candidate, EGL_BLUE_SIZE);
+    described.alphaBits = attrib(display, candidate, EGL_ALPHA_SIZE);
+    described.depthBits = attrib(display, candidate, EGL_DEPTH_SIZE);
+    described.stencilBits = attrib(display, candidate, EGL_STENCIL_SIZE);
+    described.samples = attrib(display, candidate, EGL_SAMPLES);
+    described.preserved = wanted.preserved && (surfaces & EGL_SWAP_BEHAVIOR_PRESERVED_BIT);
+
+    int score = distance(described.redBits, wanted.redBits)
+      + distance(described.greenBits, wanted.greenBits)
+      + distance(described.blueBits, wanted.blueBits)
+      + distance(described.alphaBits, wanted.alphaBits)
+      + distance(described.depthBits, wanted.depthBits)
+      + distance(described.stencilBits, wanted.stencilBits)
+      + distance(described.samples, wanted.samples);
+    if (wanted.preserved && !described.preserved) {
+      score += PRESERVE_PENALTY;
+    }
+    if (attrib(display, candidate, EGL_CONFIG_CAVEAT) == EGL_SLOW_CONFIG) {
+      score += SLOW_PENALTY;
+    }
+
+    if (score < best) {
+      best = score;
+      config = candidate;
+      chosen = described;
+    }
+  }
+
+  return best != INT_MAX;
+}
+
+} // end namespace gles2impl
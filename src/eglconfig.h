@@ -0,0 +1,23 @@
+#ifndef EGLCONFIG_H_
+#define EGLCONFIG_H_
+
+#include <EGL/egl.h>
+
+#include "gles2impl.h"
+
+namespace gles2impl {
+
+// Scores all configs of the display that support the surface and renderable
+// types against wanted, instead of taking the first match of eglChooseConfig,
+// whose sort order prefers deeper colour buffers and ignores what isn't
+// asked for. Bits that are missing weigh more than extra bits, so RGB565 is
+// taken when asked for but a 16 bit depth buffer only when there is no deeper
+// one. Describes the config in chosen, with preserved telling whether it
+// supports preserved swaps if they are wanted. Returns false if no config
+// has the types.
+bool chooseConfig(EGLDisplay display, EGLint surfaceType, EGLint renderableType, const SurfaceConfig& wanted,
+    EGLConfig& config, SurfaceConfig& chosen);
+
+}
+
+#endif /* EGLCONFIG_H_ */
@@ -0,0 +1,104 @@
+#include <cstring>
+#include <vector>
+
+#include "eglsurface.h"
+
+namespace gles2impl {
+
+using namespace std;
+
+SurfaceDamage::SurfaceDamage() {
+  display = EGL_NO_DISPLAY;
+  surface = EGL_NO_SURFACE;
+  swapWithDamage = NULL;
+  setRegion = NULL;
+  hasBufferAge = false;
+  canPreserve = false;
+  preserving = false;
+  preserved = false;
+}
+
+void SurfaceDamage::init(EGLDisplay display, EGLConfig config, EGLSurface surface, bool offscreen, bool preserved) {
+  this->display = display;
+  this->surface = surface;
+
+  const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+  if (!extensions) {
+    extensions = "";
+  }
+
+  swapWithDamage = NULL;
+  if (strstr(extensions, "EGL_KHR_swap_buffers_with_damage")) {
+    swapWithDamage = (SwapBuffersWithDamage) eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+  } else if (strstr(extensions, "EGL_EXT_swap_buffers_with_damage")) {
+    swapWithDamage = (SwapBuffersWithDamage) eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+  }
+
+  setRegion = NULL;
+  if (strstr(extensions, "EGL_KHR_partial_update")) {
+    setRegion = (SetDamageRegion) eglGetProcAddress("eglSetDamageRegionKHR");
+  }
+
+  // EGL_KHR_partial_update includes the buffer age query.
+  hasBufferAge = strstr(extensions, "EGL_EXT_buffer_age") || strstr(extensions, "EGL_KHR_partial_update");
+
+  EGLint surfaceType = 0;
+  eglGetConfigAttrib(display, config, EGL_SURFACE_TYPE, &surfaceType);
+  canPreserve = !offscreen && (surfaceType & EGL_SWAP_BEHAVIOR_PRESERVED_BIT);
+  // With a preserved swap behaviour from the start.
+  preserving = preserved;
+  this->preserved = false;
+}
+
+void SurfaceDamage::swapBuffers(const int* damage, int rects) {
+  if (damage && rects > 0 && swapWithDamage) {
+    vector<EGLint> region(damage, damage + rects * 4);
+    swapWithDamage(display, surface, &region[0], rects);
+  } else {
+    eglSwapBuffers(display, surface);
+  }
+
+  if (preserving) {
+    preserved = true;
+  }
+}
+
+int SurfaceDamage::bufferAge() {
+  if (hasBufferAge) {
+    EGLint age = 0;
+    if (!eglQuerySurface(display, surface, EGL_BUFFER_AGE_EXT, &age)) {
+      return 0;
+    }
+    return age;
+  }
+
+  if (!preserving && canPreserve) {
+    preserving = eglSurfaceAttrib(display, surface, EGL_SWAP_BEHAVIOR, EGL_BUFFER_PRESERVED);
+    canPreserve = preserving;
+  }
+  return preserved ? 1 : 0;
+}
+
+bool SurfaceDamage::setDamageRegion(const int* damage, int rects) {
+  if (!setRegion) {
+    return false;
+  }
+
+  // The age has to be queried in every frame before the region is set.
+  bufferAge();
+
+  vector<EGLint> region(damage, damage + rects * 4);
+  return setRegion(display, surface, region.empty() ? NULL : &region[0], rects);
+}
+
+bool makeCurrentES(EGLDisplay display, EGLSurface surface, EGLContext context) {
+  if (context == EGL_NO_CONTEXT) {
+    return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  }
+
+  // The bound API is per thread.
+  eglBindAPI(EGL_OPENGL_ES_API);
+  return eglMakeCurrent(display, surface, surface, context);
+}
+
+}
@@ -0,0 +1,53 @@
+#ifndef EGLSURFACE_H_
+#define EGLSURFACE_H_
+
+#include <EGL/egl.h>
+
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
+
+namespace gles2impl {
+
+// Partial updates of an EGL window surface, as the backends' nextFrame,
+// bufferAge and setDamageRegion offer them (see gles2impl.h): swaps with
+// damage, buffer age and damage regions where the display has the
+// extensions, and otherwise a preserved swap behaviour, which is requested
+// the first time the buffer age is asked for.
+class SurfaceDamage {
+public:
+  SurfaceDamage();
+
+  // Looks up what the display offers for partial updates of the surface.
+  // preserved tells whether the surface was created with a preserved swap
+  // behaviour.
+  void init(EGLDisplay display, EGLConfig config, EGLSurface surface, bool offscreen, bool preserved);
+
+  // rects is the number of damaged rects, if damage isn't NULL.
+  void swapBuffers(const int* damage, int rects);
+  int bufferAge();
+  bool setDamageRegion(const int* damage, int rects);
+
+private:
+  // EGL_KHR_swap_buffers_with_damage (or the EXT one) and EGL_KHR_partial_update.
+  typedef EGLBoolean (EGLAPIENTRYP SwapBuffersWithDamage)(EGLDisplay dpy, EGLSurface surface, EGLint* rects, EGLint n_rects);
+  typedef EGLBoolean (EGLAPIENTRYP SetDamageRegion)(EGLDisplay dpy, EGLSurface surface, EGLint* rects, EGLint n_rects);
+
+  EGLDisplay display;
+  EGLSurface surface;
+  SwapBuffersWithDamage swapWithDamage;
+  SetDamageRegion setRegion;
+  bool hasBufferAge;
+  bool canPreserve;
+  bool preserving;
+  // Whether a swap has preserved the buffer since preserving was requested.
+  bool preserved;
+};
+
+// Makes an OpenGL ES context current on the calling thread, or releases the
+// current one if context is EGL_NO_CONTEXT.
+bool makeCurrentES(EGLDisplay display, EGLSurface surface, EGLContext context);
+
+}
+
+#endif /* EGLSURFACE_H_ */
@@ -0,0 +1,77 @@
+#include <algorithm>
+
+#include "framepacer.h"
+
+namespace gles2platform {
+
+using namespace std;
+
+// Longer gaps are pauses of the application, not frames.
+static const double MAX_INTERVAL = 250;
+
+// Kept free before the predicted start of the next frame, since the
+// prediction is never exact.
+static const double MARGIN = 1;
+
+// Idle periods are never longer than this, as with requestIdleCallback in
+// browsers, so that input is handled in time.
+static const double MAX_IDLE = 50;
+
+// The weight of a new measurement in the averages.
+static const double SMOOTHING = 0.1;
+
+static double milliseconds(chrono::steady_clock::duration duration) {
+  return chrono::duration<double, milli>(duration).count();
+}
+
+FramePacer::FramePacer() {
+  measured = false;
+  frameInterval = 0;
+  frameWork = 0;
+}
+
+void FramePacer::beginSwap() {
+  swapBegin = Clock::now();
+}
+
+void FramePacer::endSwap() {
+  Clock::time_point now = Clock::now();
+
+  if (swapEnd != Clock::time_point()) {
+    double interval = milliseconds(now - swapEnd);
+    double work = milliseconds(swapBegin - swapEnd);
+    if (interval <= MAX_INTERVAL) {
+      if (!measured) {
+        frameInterval = interval;
+        frameWork = work;
+        measured = true;
+      } else {
+        frameInterval += (interval - frameInterval) * SMOOTHING;
+        // Rises at once, so that a heavy frame doesn't cut into the next one.
+        frameWork = max(work, frameWork + (work - frameWork) * SMOOTHING);
+      }
+    }
+  }
+
+  swapEnd = now;
+}
+
+void FramePacer::endSkipped() {
+  swapEnd = Clock::now();
+}
+
+double FramePacer::sinceFrame() const {
+  if (swapEnd == Clock::time_point()) {
+    return 0;
+  }
+  return milliseconds(Clock::now() - swapEnd);
+}
+
+double FramePacer::idleTime() const {
+  if (!measured) {
+    return 0;
+  }
+  return min(max(frameInterval - frameWork - MARGIN, 0.0), MAX_IDLE);
+}
+
+}
@@ -0,0 +1,44 @@
+#ifndef FRAMEPACER_H_
+#define FRAMEPACER_H_
+
+#include <chrono>
+
+namespace gles2platform {
+
+// Measures the frames of a context to predict the idle time after one: the
+// time from the end of a swap to the end of the next one is the frame
+// interval (the display's refresh period when swaps wait for vsync), and the
+// time from the end of a swap to the next nextFrame call is the work that JS
+// does to build a frame. Whatever remains of the interval is idle.
+class FramePacer {
+public:
+  FramePacer();
+
+  // Around the swap, or what takes its place when nextFrame doesn't swap.
+  void beginSwap();
+  void endSwap();
+  // Instead of endSwap for frames that weren't swapped to save work, which
+  // are not measured.
+  void endSkipped();
+
+  // Milliseconds since the last frame ended.
+  double sinceFrame() const;
+
+  // In milliseconds, after endSwap; 0 until two frames have been measured.
+  double idleTime() const;
+  double interval() const { return frameInterval; }
+  double workTime() const { return frameWork; }
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  Clock::time_point swapBegin;
+  Clock::time_point swapEnd;
+  bool measured;
+  double frameInterval;
+  double frameWork;
+};
+
+}
+
+#endif /* FRAMEPACER_H_ */
@@ -2,13 +2,84 @@
 #define GLES2_IMPL_H_
 
 #include <cstring>
+#include <string>
 
 namespace gles2impl {
 
-	std::string init(int width, int height, bool fullscreen, std::string title, unsigned int display);
-	void nextFrame(bool drawBuffers);
+	// A window, or a display layer on the Raspberry PI and Nexus, together with
+	// its GL context. Several may exist at once; GL calls go to the current one.
+	struct Context;
+
+	// The buffers of a window or offscreen surface. When creating one, the
+	// sizes are wishes: the closest configuration that the platform offers is
+	// taken, and can be read back.
+	struct SurfaceConfig {
+		int redBits;
+		int greenBits;
+		int blueBits;
+		int alphaBits;
+		int depthBits;
+		int stencilBits;
+		// 0 without multisampling.
+		int samples;
+		// Whether the back buffer keeps its contents across swaps
+		// (EGL_BUFFER_PRESERVED).
+		bool preserved;
+	};
+
+	// glesVersion is the OpenGL ES version to create a context for: 2, or 3 for
+	// WebGL 2 (OpenGL 3.3 core on desktop). An offscreen context renders to a
+	// pbuffer (a hidden window with GLFW) instead. The new context shares its
+	// objects with share unless that is NULL, and is made current. Returns NULL
+	// with the reason in error on failure.
+	Context* createContext(int width, int height, bool fullscreen, std::string title, unsigned int layer,
+		int glesVersion, bool offscreen, const SurfaceConfig& config, Context* share, std::string& error);
+	void destroyContext(Context* context);
+
+	// The configuration that the context's surface was created with.
+	SurfaceConfig surfaceConfig(Context* context);
+
+	// NULL releases the current context.
+	bool makeContextCurrent(Context* context);
+	Context* currentContext();
+
+	// damage lists the parts of the window that changed since the last frame
+	// as rects x, y, width, height quadruples in window coordinates (origin at
+	// the bottom left), or is NULL if all of it did. The backend passes it on
+	// with the swap when it can.
+	void nextFrame(Context* context, bool swapBuffers, const int* damage, int rects);
+
+	// The number of frames since the contents of the back buffer were drawn,
+	// which is how many frames of damage have to be redrawn; 0 if they are
+	// undefined and everything has to be redrawn. Without buffer age, the first
+	// call asks for the buffer to be preserved by the swaps, if the surface
+	// supports that, after which it is 1.
+	int bufferAge(Context* context);
+
+	// Limits the rendering of the current frame to the given rects (see
+	// nextFrame), before anything is drawn. Returns false if the driver can't.
+	bool setDamageRegion(Context* context, const int* damage, int rects);
+
+	// Destroys all contexts.
 	void cleanup();
 
+	// Whether windows and contexts can only be created and destroyed on the
+	// process' main thread, as with GLFW, rather than on any thread.
+	bool mainThreadOnly();
+
+	// Resolves a GL (extension) entry point for the current context.
+	void* getProcAddress(const char* name);
+
+	// An offscreen context that shares objects with a context, to be made
+	// current on another thread. Must be created and destroyed on the main
+	// thread.
+	struct SharedContext;
+	SharedContext* createSharedContext(Context* context);
+	void destroySharedContext(SharedContext* context);
+
+	// Makes the shared context current on the calling thread; NULL releases it.
+	bool makeCurrent(SharedContext* context);
+
 }
 
 #endif /* GLES2_IMPL_H_ */
@@ -1,9 +1,15 @@
 #include <cstring>
 #include <vector>
+#include <map>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <chrono>
 #include <iostream>
 
 #include "gles2platform.h"
 #include "gles2impl.h"
+#include "framepacer.h"
 
 namespace gles2platform {
 
@@ -11,6 +17,88 @@ using namespace node;
 using namespace v8;
 using namespace std;
 
+// Each worker thread that loads the module has its own isolate and creates
+// its own contexts, so the maps are shared between threads. Contexts remember
+// the isolate that created them so that they can be destroyed with it.
+struct ContextEntry {
+  gles2impl::Context* context;
+  Isolate* isolate;
+};
+
+static mutex contextsMutex;
+static map<uint32_t, ContextEntry> contexts;
+static uint32_t nextContext = 1;
+
+static map<gles2impl::Context*, vector<pair<FrameListener, void*> > > frameListeners;
+static map<gles2impl::Context*, FramePacer> pacers;
+
+// Set by skipSwap while the listeners of the frame that nextFrame ends run on
+// this thread; negative if the frame is swapped.
+static thread_local double skipInterval = -1;
+
+void addFrameListener(FrameListener listener, void* data) {
+  lock_guard<mutex> lock(contextsMutex);
+  frameListeners[gles2impl::currentContext()].push_back(make_pair(listener, data));
+}
+
+void removeFrameListener(FrameListener listener, void* data) {
+  lock_guard<mutex> lock(contextsMutex);
+  map<gles2impl::Context*, vector<pair<FrameListener, void*> > >::iterator it;
+  for (it = frameListeners.begin(); it != frameListeners.end(); ++it) {
+    vector<pair<FrameListener, void*> >& listeners = it->second;
+    vector<pair<FrameListener, void*> >::iterator found = find(listeners.begin(), listeners.end(), make_pair(listener, data));
+    if (found != listeners.end()) {
+      listeners.erase(found);
+      return;
+    }
+  }
+}
+
+void skipSwap(double interval) {
+  skipInterval = max(interval, 0.0);
+}
+
+double frameInterval() {
+  lock_guard<mutex> lock(contextsMutex);
+  map<gles2impl::Context*, FramePacer>::iterator it = pacers.find(gles2impl::currentContext());
+  return it != pacers.end() ? it->second.interval() : 0;
+}
+
+// Worker threads run their own event loops.
+static bool onMainThread() {
+  return Nan::GetCurrentEventLoop() == uv_default_loop();
+}
+
+// Only contexts of the calling isolate can be used.
+static gles2impl::Context* getContext(Local<Value> id) {
+  lock_guard<mutex> lock(contextsMutex);
+  map<uint32_t, ContextEntry>::iterator it = contexts.find(id->Uint32Value());
+  if (it == contexts.end() || it->second.isolate != Isolate::GetCurrent()) {
+    return NULL;
+  }
+  return it->second.context;
+}
+
+// Reads a flat array of x, y, width, height quadruples.
+static vector<int> getRects(Local<Value> value) {
+  vector<int> rects;
+  if (!value->IsArray()) {
+    return rects;
+  }
+  Local<Array> array = Local<Array>::Cast(value);
+  uint32_t length = array->Length() / 4 * 4;
+  rects.reserve(length);
+  for (uint32_t i = 0; i < length; i++) {
+    rects.push_back(Nan::Get(array, i).ToLocalChecked()->Int32Value());
+  }
+  return rects;
+}
+
+static int getInt(Local<Object> object, const char* name, int otherwise) {
+  Local<Value> value = Nan::Get(object, JS_STR(name)).ToLocalChecked();
+  return value->IsNumber() ? value->Int32Value() : otherwise;
+}
+
 NAN_METHOD(init) {
   Nan::HandleScope scope;
 
@@ -20,10 +108,88 @@ NAN_METHOD(init) {
 
   Nan::Utf8String title(info[3]->ToString());
   unsigned int layer = info[4]->Uint32Value();
+  int glesVersion = info[5]->IsUndefined() ? 2 : info[5]->Int32Value();
+  bool offscreen = info[6]->BooleanValue();
+  gles2impl::Context* share = getContext(info[7]);
 
-  std::string message = gles2impl::init(width, height, fullscreen, *title, layer);
-  if (message.size()) {
+  // RGBA8888 with a 24 bit depth buffer unless asked otherwise.
+  gles2impl::SurfaceConfig config = { 8, 8, 8, 8, 24, 0, 0, false };
+  if (info[8]->IsObject()) {
+    Local<Object> wanted = info[8]->ToObject();
+    config.redBits = getInt(wanted, "redBits", config.redBits);
+    config.greenBits = getInt(wanted, "greenBits", config.greenBits);
+    config.blueBits = getInt(wanted, "blueBits", config.blueBits);
+    config.alphaBits = getInt(wanted, "alphaBits", config.alphaBits);
+    config.depthBits = getInt(wanted, "depthBits", config.depthBits);
+    config.stencilBits = getInt(wanted, "stencilBits", config.stencilBits);
+    config.samples = getInt(wanted, "samples", config.samples);
+    config.preserved = Nan::Get(wanted, JS_STR("preserved")).ToLocalChecked()->BooleanValue();
+  }
+
+  if (gles2impl::mainThreadOnly() && !onMainThread()) {
+    Nan::ThrowError("Contexts can only be created on the main thread with this platform");
+    return;
+  }
+
+  std::string message;
+  gles2impl::Context* context = gles2impl::createContext(width, height, fullscreen, *title, layer, glesVersion, offscreen, config, share, message);
+  if (!context) {
     Nan::ThrowRangeError(message.c_str());
+    return;
+  }
+
+  ContextEntry entry = { context, Isolate::GetCurrent() };
+
+  lock_guard<mutex> lock(contextsMutex);
+  uint32_t id = nextContext++;
+  contexts[id] = entry;
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+NAN_METHOD(getSurfaceConfig) {
+  Nan::HandleScope scope;
+
+  gles2impl::Context* context = getContext(info[0]);
+  if (!context) {
+    info.GetReturnValue().Set(Nan::Null());
+    return;
+  }
+
+  gles2impl::SurfaceConfig config = gles2impl::surfaceConfig(context);
+  Local<Object> result = Nan::New<Object>();
+  Nan::Set(result, JS_STR("redBits"), JS_INT(config.redBits));
+  Nan::Set(result, JS_STR("greenBits"), JS_INT(config.greenBits));
+  Nan::Set(result, JS_STR("blueBits"), JS_INT(config.blueBits));
+  Nan::Set(result, JS_STR("alphaBits"), JS_INT(config.alphaBits));
+  Nan::Set(result, JS_STR("depthBits"), JS_INT(config.depthBits));
+  Nan::Set(result, JS_STR("stencilBits"), JS_INT(config.stencilBits));
+  Nan::Set(result, JS_STR("samples"), JS_INT(config.samples));
+  Nan::Set(result, JS_STR("preserved"), JS_BOOL(config.preserved));
+
+  info.GetReturnValue().Set(result);
+}
+
+NAN_METHOD(makeCurrent) {
+  Nan::HandleScope scope;
+
+  gles2impl::Context* context = getContext(info[0]);
+
+  info.GetReturnValue().Set(JS_BOOL(gles2impl::makeContextCurrent(context)));
+}
+
+NAN_METHOD(destroyContext) {
+  Nan::HandleScope scope;
+
+  gles2impl::Context* context = getContext(info[0]);
+  if (context) {
+    {
+      lock_guard<mutex> lock(contextsMutex);
+      frameListeners.erase(context);
+      pacers.erase(context);
+      contexts.erase(info[0]->Uint32Value());
+    }
+    gles2impl::destroyContext(context);
   }
 
   info.GetReturnValue().Set(Nan::Undefined());
@@ -33,13 +199,114 @@ NAN_METHOD(nextFrame) {
   Nan::HandleScope scope;
 
   bool swapBuffers = info[0]->BooleanValue();
+  bool damaged = info[1]->IsArray();
+  vector<int> damage = getRects(info[1]);
 
-  gles2impl::nextFrame(swapBuffers);
+  gles2impl::Context* context = gles2impl::currentContext();
+  if (!context) {
+    Nan::ThrowError("No current context");
+    return;
+  }
 
-  info.GetReturnValue().Set(Nan::Undefined());
+  // Listeners may remove themselves while they are called. Pacers are only
+  // used by the thread of their context, so they stay valid unlocked.
+  vector<pair<FrameListener, void*> > listeners;
+  FramePacer* pacer;
+  {
+    lock_guard<mutex> lock(contextsMutex);
+    listeners = frameListeners[context];
+    pacer = &pacers[context];
+  }
+  pacer->beginSwap();
+
+  skipInterval = -1;
+  for (size_t i = 0; i < listeners.size(); i++) {
+    listeners[i].first(listeners[i].second);
+  }
+  bool skipped = swapBuffers && skipInterval >= 0;
+
+  // Without a swap, events are still polled.
+  gles2impl::nextFrame(context, swapBuffers && !skipped, damaged ? damage.data() : NULL, damage.size() / 4);
+
+  // Throttled frames are spaced out by delaying the next one with a timer
+  // (requestAnimationFrame in gles2.js), not by blocking the event loop.
+  double delay = 0;
+  if (skipped) {
+    // In place of the wait for the display, which a swap would block for too.
+    double wait = pacer->interval() - pacer->sinceFrame();
+    if (wait > 0) {
+      this_thread::sleep_for(chrono::duration<double, milli>(wait));
+    }
+    delay = max(skipInterval - pacer->sinceFrame(), 0.0);
+    pacer->endSkipped();
+  } else {
+    pacer->endSwap();
+  }
+
+  Local<Object> result = Nan::New<Object>();
+  Nan::Set(result, JS_STR("idle"), Nan::New<Number>(pacer->idleTime() + delay));
+  Nan::Set(result, JS_STR("delay"), Nan::New<Number>(delay));
+  info.GetReturnValue().Set(result);
+}
+
+NAN_METHOD(bufferAge) {
+  Nan::HandleScope scope;
+
+  gles2impl::Context* context = gles2impl::currentContext();
+  if (!context) {
+    Nan::ThrowError("No current context");
+    return;
+  }
+
+  info.GetReturnValue().Set(JS_INT(gles2impl::bufferAge(context)));
+}
+
+NAN_METHOD(setDamageRegion) {
+  Nan::HandleScope scope;
+
+  gles2impl::Context* context = gles2impl::currentContext();
+  if (!context) {
+    Nan::ThrowError("No current context");
+    return;
+  }
+
+  vector<int> damage = getRects(info[0]);
+  info.GetReturnValue().Set(JS_BOOL(gles2impl::setDamageRegion(context, damage.data(), damage.size() / 4)));
+}
+
+void Cleanup(void* isolate) {
+  vector<gles2impl::Context*> owned;
+  {
+    lock_guard<mutex> lock(contextsMutex);
+    map<uint32_t, ContextEntry>::iterator it = contexts.begin();
+    while (it != contexts.end()) {
+      if (it->second.isolate == isolate) {
+        owned.push_back(it->second.context);
+        frameListeners.erase(it->second.context);
+        pacers.erase(it->second.context);
+        contexts.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+  // Such contexts can't exist on other threads; their windows are left to
+  // AtExit rather than destroyed on the wrong thread.
+  if (gles2impl::mainThreadOnly() && !onMainThread()) {
+    return;
+  }
+  for (size_t i = 0; i < owned.size(); i++) {
+    gles2impl::destroyContext(owned[i]);
+  }
 }
 
 void AtExit() {
+  {
+    lock_guard<mutex> lock(contextsMutex);
+    frameListeners.clear();
+    pacers.clear();
+    contexts.clear();
+  }
   gles2impl::cleanup();
 }
 
@@ -9,9 +9,45 @@ using namespace v8;
 namespace gles2platform {
 
 void AtExit();
+// Destroys the contexts created by the given isolate, when a worker thread
+// that loaded the module exits.
+void Cleanup(void* isolate);
 
+// Called by nextFrame at the end of every frame of the context that was current
+// when they were added, before the buffers are swapped, with the data pointer
+// they were added with.
+typedef void (*FrameListener)(void* data);
+void addFrameListener(FrameListener listener, void* data);
+void removeFrameListener(FrameListener listener, void* data);
+
+// Called by a frame listener to leave the window as it is: nextFrame doesn't
+// swap the frame that is ending. So that the frame rate doesn't rise,
+// nextFrame then returns no earlier than the measured frame interval after
+// the last frame ended. To lower it, the next frame is delayed until interval
+// ms after the last frame ended, if that is longer.
+void skipSwap(double interval);
+// The measured interval between the frames of the current context in ms; 0
+// until two frames were swapped.
+double frameInterval();
+
+// Creates a window or offscreen surface with its context, which is made
+// current, and returns its id. The last argument describes the wanted buffers
+// (see gles2impl::SurfaceConfig).
 NAN_METHOD(init);
+// The buffers that the surface of the context with the given id got.
+NAN_METHOD(getSurfaceConfig);
+// Makes the context with the given id current; 0 releases the current one.
+NAN_METHOD(makeCurrent);
+NAN_METHOD(destroyContext);
+// Ends the frame of the current context, optionally with a flat array of
+// damaged rects. Returns {idle, delay}: the milliseconds that are predicted to
+// be idle before the next frame has to be started, and those that the next
+// frame should be delayed by (see skipSwap).
 NAN_METHOD(nextFrame);
+// The age of the current context's back buffer, see gles2impl::bufferAge.
+NAN_METHOD(bufferAge);
+// Limits the rendering of the current frame to a flat array of rects.
+NAN_METHOD(setDamageRegion);
 
 }
 
@@ -1,5 +1,7 @@
 #include <cstring>
 #include <vector>
+#include <algorithm>
+#include <mutex>
 #include <iostream>
 #include <unistd.h>
 #include <stdio.h>
@@ -13,45 +15,215 @@ using namespace std;
 
 namespace gles2impl {
 
-GLFWwindow* window;
+struct Context {
+  GLFWwindow* window;
+  int version;
+  SurfaceConfig config;
+};
+
+// Worker threads create their own contexts, so the list is shared between
+// threads, while each thread has its own current context.
+static mutex contextsMutex;
+static bool initialized = false;
+static vector<Context*> contexts;
+static thread_local Context* current = NULL;
+
+// OpenGL ES 3.0 maps to OpenGL 3.3, which macOS only offers as a forward
+// compatible core profile. The other platforms get the same profile, so that
+// the behaviour is the same everywhere.
+static void contextHints(int version) {
+  if (version >= 3) {
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+  }
+}
+
+// Reads back what the window got for the hints.
+static void queryConfig(Context* context) {
+  SurfaceConfig& config = context->config;
+  // Left alone for buffers that don't exist.
+  config = SurfaceConfig();
+  if (context->version >= 3) {
+    // Core profiles don't have GL_RED_BITS and the like.
+    glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, GL_BACK_LEFT, GL_FRAMEBUFFER_ATTACHMENT_RED_SIZE, &config.redBits);
+    glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, GL_BACK_LEFT, GL_FRAMEBUFFER_ATTACHMENT_GREEN_SIZE, &config.greenBits);
+    glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, GL_BACK_LEFT, GL_FRAMEBUFFER_ATTACHMENT_BLUE_SIZE, &config.blueBits);
+    glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, GL_BACK_LEFT, GL_FRAMEBUFFER_ATTACHMENT_ALPHA_SIZE, &config.alphaBits);
+    glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, GL_DEPTH, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &config.depthBits);
+    glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, GL_STENCIL, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &config.stencilBits);
+  } else {
+    glGetIntegerv(GL_RED_BITS, &config.redBits);
+    glGetIntegerv(GL_GREEN_BITS, &config.greenBits);
+    glGetIntegerv(GL_BLUE_BITS, &config.blueBits);
+    glGetIntegerv(GL_ALPHA_BITS, &config.alphaBits);
+    glGetIntegerv(GL_DEPTH_BITS, &config.depthBits);
+    glGetIntegerv(GL_STENCIL_BITS, &config.stencilBits);
+  }
+  glGetIntegerv(GL_SAMPLES, &config.samples);
+  // GLFW has no say in the swap behaviour.
+  config.preserved = false;
+  glGetError();
+}
 
-string init(int width, int height, bool fullscreen, std::string title, unsigned int layer) {
-  printf("initializing GLEW\n");
+Context* createContext(int width, int height, bool fullscreen, std::string title, unsigned int layer,
+    int glesVersion, bool offscreen, const SurfaceConfig& config, Context* share, std::string& error) {
+  lock_guard<mutex> lock(contextsMutex);
+  if (!initialized) {
+    printf("initializing GLEW\n");
+
+    if (!glfwInit()) {
+      error = string("Can't init GLEW\n");
+      return NULL;
+    }
+    initialized = true;
+  }
 
-  if (!glfwInit()) {
-    return string("Can't init GLEW\n");
+  contextHints(glesVersion);
+  if (offscreen) {
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
   }
+  glfwWindowHint(GLFW_RED_BITS, config.redBits);
+  glfwWindowHint(GLFW_GREEN_BITS, config.greenBits);
+  glfwWindowHint(GLFW_BLUE_BITS, config.blueBits);
+  glfwWindowHint(GLFW_ALPHA_BITS, config.alphaBits);
+  glfwWindowHint(GLFW_DEPTH_BITS, config.depthBits);
+  glfwWindowHint(GLFW_STENCIL_BITS, config.stencilBits);
+  glfwWindowHint(GLFW_SAMPLES, config.samples);
 
   /* Create a windowed mode window and its OpenGL context */
-  window = glfwCreateWindow(width, height, title.c_str(), fullscreen ? glfwGetPrimaryMonitor() : NULL, NULL);
+  GLFWwindow* window = glfwCreateWindow(width, height, title.c_str(), fullscreen && !offscreen ? glfwGetPrimaryMonitor() : NULL,
+      share ? share->window : NULL);
+  glfwDefaultWindowHints();
   if (!window) {
-      return string("Can't create window.");
+    error = glesVersion >= 3 ? string("Can't create an OpenGL 3.3 window.") : string("Can't create window.");
+    return NULL;
   }
 
+  Context* context = new Context();
+  context->window = window;
+  context->version = glesVersion;
+  contexts.push_back(context);
+
   /* Make the window's context current */
-  glfwMakeContextCurrent(window);
+  makeContextCurrent(context);
 
+  // GLEW looks entry points up through GL_EXTENSIONS unless told otherwise,
+  // which core profiles don't have; the failed lookup leaves an error behind.
+  glewExperimental = GL_TRUE;
   glewInit();
+  glGetError();
+
+  queryConfig(context);
+
+  return context;
+}
 
-  return string("");
+void destroyContext(Context* context) {
+  if (context == current) {
+    makeContextCurrent(NULL);
+  }
+  {
+    lock_guard<mutex> lock(contextsMutex);
+    contexts.erase(find(contexts.begin(), contexts.end(), context));
+  }
+  glfwDestroyWindow(context->window);
+  delete context;
+}
+
+bool makeContextCurrent(Context* context) {
+  glfwMakeContextCurrent(context ? context->window : NULL);
+  current = context;
+  return true;
+}
+
+Context* currentContext() {
+  return current;
+}
+
+SurfaceConfig surfaceConfig(Context* context) {
+  return context->config;
 }
 
-void nextFrame(bool swapBuffers) {
-  if (glfwWindowShouldClose(window)) {
+// GLFW swaps the whole window and leaves the back buffer undefined.
+void nextFrame(Context* context, bool swapBuffers, const int* damage, int rects) {
+  if (glfwWindowShouldClose(context->window)) {
     exit(0);
   }
 
   if (swapBuffers) {
-    glfwSwapBuffers(window);
+    glfwSwapBuffers(context->window);
   }
 
   glfwPollEvents();
 }
 
+int bufferAge(Context* context) {
+  return 0;
+}
+
+bool setDamageRegion(Context* context, const int* damage, int rects) {
+  return false;
+}
+
 void cleanup() {
+  vector<Context*> remaining;
+  {
+    lock_guard<mutex> lock(contextsMutex);
+    remaining = contexts;
+  }
+  while (!remaining.empty()) {
+    destroyContext(remaining.back());
+    remaining.pop_back();
+  }
   glfwTerminate();
 
   printf("cleanup\n");
 }
 
-} // end namespace gles2impl
\ No newline at end of file
+// glfwInit, glfwCreateWindow, glfwDestroyWindow and glfwPollEvents may only
+// be called on the main thread.
+bool mainThreadOnly() {
+  return true;
+}
+
+void* getProcAddress(const char* name) {
+  return (void*) glfwGetProcAddress(name);
+}
+
+struct SharedContext {
+  GLFWwindow* window;
+};
+
+SharedContext* createSharedContext(Context* context) {
+  if (!context) {
+    return NULL;
+  }
+
+  // GLFW contexts always belong to a window; use a hidden one.
+  glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+  contextHints(context->version);
+  GLFWwindow* shared = glfwCreateWindow(1, 1, "", NULL, context->window);
+  glfwDefaultWindowHints();
+
+  if (!shared) {
+    return NULL;
+  }
+
+  SharedContext* sharedContext = new SharedContext();
+  sharedContext->window = shared;
+  return sharedContext;
+}
+
+void destroySharedContext(SharedContext* context) {
+  glfwDestroyWindow(context->window);
+  delete context;
+}
+
+bool makeCurrent(SharedContext* context) {
+  glfwMakeContextCurrent(context ? context->window : NULL);
+  return true;
+}
+
+} // end namespace gles2impl
@@ -0,0 +1,130 @@
+#include <cstdlib>
+
+#include "buffermappings.h"
+#include "gl3.h"
+
+namespace webgl {
+
+using namespace std;
+
+static GLenum bindingOf(GLenum target) {
+  switch (target) {
+  case GL_ARRAY_BUFFER: return GL_ARRAY_BUFFER_BINDING;
+  case GL_ELEMENT_ARRAY_BUFFER: return GL_ELEMENT_ARRAY_BUFFER_BINDING;
+  case GL_PIXEL_PACK_BUFFER: return GL_PIXEL_PACK_BUFFER_BINDING;
+  case GL_PIXEL_UNPACK_BUFFER: return GL_PIXEL_UNPACK_BUFFER_BINDING;
+  case GL_UNIFORM_BUFFER: return GL_UNIFORM_BUFFER_BINDING;
+  case GL_COPY_READ_BUFFER: return GL_COPY_READ_BUFFER;
+  case GL_COPY_WRITE_BUFFER: return GL_COPY_WRITE_BUFFER;
+  default: return 0;
+  }
+}
+
+BufferMappings::BufferMappings(const GLExtensions& extensions) : extensions(extensions) {
+}
+
+BufferMappings::~BufferMappings() {
+  for (std::map<GLenum, Mapping>::iterator it = mappings.begin(); it != mappings.end(); ++it) {
+    free(it->second.shadow);
+  }
+}
+
+void* BufferMappings::map(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+  GLenum binding = bindingOf(target);
+  if (!binding || mapped(target) || offset < 0 || length <= 0) {
+    return NULL;
+  }
+
+  GLuint buffer = bound(target);
+  GLint size = 0;
+  glGetBufferParameteriv(target, GL_BUFFER_SIZE, &size);
+  if (!buffer || offset + length > size || !targets(buffer).empty()) {
+    return NULL;
+  }
+
+  Mapping mapping;
+  mapping.buffer = buffer;
+  mapping.offset = offset;
+  mapping.length = length;
+  mapping.shadow = NULL;
+
+  void* data = NULL;
+  if (extensions.bufferMapping) {
+    data = extensions.mapBufferRange(target, offset, length, access);
+  } else if (!(access & GL_MAP_READ_BIT)) {
+    if (extensions.wholeBufferMapping) {
+      char* base = static_cast<char*>(extensions.mapBuffer(target, GL_WRITE_ONLY));
+      data = base ? base + offset : NULL;
+    } else {
+      data = mapping.shadow = calloc(1, length);
+    }
+  }
+
+  if (data) {
+    mappings[target] = mapping;
+  }
+  return data;
+}
+
+bool BufferMappings::unmap(GLenum target) {
+  std::map<GLenum, Mapping>::iterator it = mappings.find(target);
+  if (it == mappings.end()) {
+    return false;
+  }
+
+  // GL unmaps whatever is bound to the target.
+  GLuint buffer = it->second.buffer;
+  GLuint current = bound(target);
+  if (current != buffer) {
+    glBindBuffer(target, buffer);
+  }
+
+  bool intact = true;
+  if (it->second.shadow) {
+    glBufferSubData(target, it->second.offset, it->second.length, it->second.shadow);
+    free(it->second.shadow);
+  } else {
+    intact = (extensions.unmapBuffer(target) == GL_TRUE);
+  }
+  mappings.erase(it);
+
+  if (current != buffer) {
+    glBindBuffer(target, current);
+  }
+  return intact;
+}
+
+vector<GLenum> BufferMappings::targets(GLuint buffer) const {
+  vector<GLenum> targets;
+  for (std::map<GLenum, Mapping>::const_iterator it = mappings.begin(); it != mappings.end(); ++it) {
+    if (it->second.buffer == buffer) {
+      targets.push_back(it->first);
+    }
+  }
+  return targets;
+}
+
+GLuint BufferMappings::bound(GLenum target) {
+  GLenum binding = bindingOf(target);
+  GLint buffer = 0;
+  if (binding) {
+    glGetIntegerv(binding, &buffer);
+  }
+  return buffer;
+}
+
+vector<GLenum> BufferMappings::forget(GLuint buffer) {
+  vector<GLenum> targets;
+  for (std::map<GLenum, Mapping>::iterator it = mappings.begin(); it != mappings.end(); ) {
+    if (it->second.buffer == buffer) {
+      targets.push_back(it->first);
+      free(it->second.shadow);
+      mappings.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  return targets;
+}
+
+} // end namespace webgl
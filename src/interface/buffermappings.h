@@ -0,0 +1,59 @@
+#ifndef BUFFERMAPPINGS_H_
+#define BUFFERMAPPINGS_H_
+
+#include <map>
+#include <vector>
+
+#include "glapi.h"
+#include "glext.h"
+
+namespace webgl {
+
+// The buffer ranges that mapBuffer hands out, at most one per target like in
+// GL. A range is mapped with glMapBufferRange when the context has it, or as
+// part of the whole buffer with GL_OES_mapbuffer for writing. Otherwise it is
+// a zeroed shadow allocation that unmap uploads with glBufferSubData, which
+// can't be read from.
+class BufferMappings {
+public:
+  explicit BufferMappings(const GLExtensions& extensions);
+  ~BufferMappings();
+
+  // Maps length bytes from offset of the buffer bound to target, with the
+  // GL_MAP_*_BIT access flags. Returns NULL if the range is not in the
+  // buffer, the target or the buffer is mapped already or mapping fails.
+  void* map(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+
+  // Unmaps the buffer that was mapped at target, even if another buffer is
+  // bound to it by now (which stays bound). Returns false if the target
+  // wasn't mapped, or if GL reports that the buffer's contents got lost
+  // while it was.
+  bool unmap(GLenum target);
+
+  bool mapped(GLenum target) const { return mappings.count(target) != 0; }
+
+  // The targets that a buffer is mapped at.
+  std::vector<GLenum> targets(GLuint buffer) const;
+
+  // The buffer bound to target, or 0.
+  static GLuint bound(GLenum target);
+
+  // Drops the mappings of a buffer that is being deleted, which GL unmaps
+  // itself. Returns the targets that it was mapped at.
+  std::vector<GLenum> forget(GLuint buffer);
+
+private:
+  struct Mapping {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr length;
+    void* shadow;
+  };
+
+  const GLExtensions& extensions;
+  std::map<GLenum, Mapping> mappings;
+};
+
+}
+
+#endif /* BUFFERMAPPINGS_H_ */
@@ -0,0 +1,276 @@
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "desktopshaders.h"
+
+namespace webgl {
+
+using namespace std;
+
+struct Replacement {
+  const char* from;
+  const char* to;
+};
+
+// Built-ins of GLSL ES 1.00 and its extensions that GLSL 3.30 names
+// differently.
+static const Replacement COMMON_REPLACEMENTS[] = {
+  { "texture2D", "texture" },
+  { "texture2DProj", "textureProj" },
+  { "texture2DLod", "textureLod" },
+  { "texture2DProjLod", "textureProjLod" },
+  { "textureCube", "texture" },
+  { "textureCubeLod", "textureLod" },
+  { "texture2DLodEXT", "textureLod" },
+  { "texture2DProjLodEXT", "textureProjLod" },
+  { "textureCubeLodEXT", "textureLod" },
+  { "texture2DGradEXT", "textureGrad" },
+  { "texture2DProjGradEXT", "textureProjGrad" },
+  { "textureCubeGradEXT", "textureGrad" },
+  { "gl_MaxVertexUniformVectors", "(gl_MaxVertexUniformComponents / 4)" },
+  { "gl_MaxFragmentUniformVectors", "(gl_MaxFragmentUniformComponents / 4)" },
+  { "gl_MaxVaryingVectors", "(gl_MaxVertexOutputComponents / 4)" },
+  { NULL, NULL }
+};
+
+static const Replacement VERTEX_REPLACEMENTS[] = {
+  { "attribute", "in" },
+  { "varying", "out" },
+  { NULL, NULL }
+};
+
+static const Replacement FRAGMENT_REPLACEMENTS[] = {
+  { "varying", "in" },
+  { "gl_FragColor", "webgl_FragColor" },
+  { "gl_FragData", "webgl_FragData" },
+  { "gl_FragDepthEXT", "gl_FragDepth" },
+  { NULL, NULL }
+};
+
+// Names that GLSL 3.30 reserves or gives to built-in functions, but that
+// GLSL ES 1.00 leaves to the application. They get the webgl_ prefix, which
+// WebGL reserves.
+static const char* RESERVED_NAMES[] = {
+  "texture", "textureProj", "textureLod", "textureProjLod", "textureGrad", "textureProjGrad",
+  "textureOffset", "textureSize", "texelFetch",
+  "layout", "centroid", "smooth", "noperspective", "case", "uint", "uvec2", "uvec3", "uvec4",
+  "mat2x2", "mat2x3", "mat2x4", "mat3x2", "mat3x3", "mat3x4", "mat4x2", "mat4x3", "mat4x4",
+  "isampler1D", "isampler2D", "isampler3D", "isamplerCube", "usampler1D", "usampler2D",
+  "usampler3D", "usamplerCube", "sampler1DArray", "sampler2DArray", "isampler1DArray",
+  "isampler2DArray", "usampler1DArray", "usampler2DArray", "samplerCubeShadow",
+  "sampler1DArrayShadow", "sampler2DArrayShadow", "samplerBuffer", "isamplerBuffer",
+  "usamplerBuffer", "sampler2DMS", "isampler2DMS", "usampler2DMS", "sampler2DMSArray",
+  "isampler2DMSArray", "usampler2DMSArray", "isampler2DRect", "usampler2DRect",
+  NULL
+};
+
+// Extensions of GLSL ES 1.00 whose features are core in GLSL 3.30. Their
+// #extension lines are dropped, and their macros stay defined so that #ifdef
+// checks keep working.
+static const char* CORE_EXTENSIONS[] = {
+  "GL_OES_standard_derivatives",
+  "GL_EXT_shader_texture_lod",
+  "GL_EXT_frag_depth",
+  "GL_EXT_draw_buffers",
+  NULL
+};
+
+static bool isIdentifierStart(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool isIdentifierChar(char c) {
+  return isIdentifierStart(c) || (c >= '0' && c <= '9');
+}
+
+static const char* replacement(const Replacement* table, const string& name) {
+  for (; table->from; table++) {
+    if (name == table->from) {
+      return table->to;
+    }
+  }
+  return NULL;
+}
+
+static bool contains(const char** names, const string& name) {
+  for (; *names; names++) {
+    if (name == *names) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The directive of a preprocessor line ("version", "extension", ...) and
+// where its arguments start; empty for other lines.
+static string directive(const string& line, size_t& args) {
+  size_t hash = line.find_first_not_of(" \t\r");
+  if (hash == string::npos || line[hash] != '#') {
+    return string();
+  }
+  size_t start = line.find_first_not_of(" \t", hash + 1);
+  if (start == string::npos) {
+    return string();
+  }
+  size_t end = start;
+  while (end < line.size() && isIdentifierChar(line[end])) {
+    end++;
+  }
+  args = line.find_first_not_of(" \t", end);
+  if (args == string::npos) {
+    args = line.size();
+  }
+  return line.substr(start, end - start);
+}
+
+// Whether a line can precede the first declaration: blank, a // comment, or
+// #version or #extension, which GLSL 3.30 wants before any code.
+static bool isHeaderLine(const string& line) {
+  size_t start = line.find_first_not_of(" \t\r");
+  if (start == string::npos || line.compare(start, 2, "//") == 0) {
+    return true;
+  }
+  size_t args;
+  string name = directive(line, args);
+  return name == "version" || name == "extension";
+}
+
+static string rewriteTokens(const string& line, GLenum type, bool& fragColor, bool& fragData) {
+  const Replacement* stage = (type == GL_VERTEX_SHADER) ? VERTEX_REPLACEMENTS : FRAGMENT_REPLACEMENTS;
+  string out;
+  size_t i = 0, n = line.size();
+  while (i < n) {
+    char c = line[i];
+    if (isIdentifierStart(c)) {
+      size_t start = i;
+      while (i < n && isIdentifierChar(line[i])) {
+        i++;
+      }
+      string name = line.substr(start, i - start);
+      const char* to = replacement(stage, name);
+      if (!to) {
+        to = replacement(COMMON_REPLACEMENTS, name);
+      }
+      if (to) {
+        fragColor = fragColor || strcmp(to, "webgl_FragColor") == 0;
+        fragData = fragData || strcmp(to, "webgl_FragData") == 0;
+        out += to;
+      } else if (contains(RESERVED_NAMES, name)) {
+        out += "webgl_" + name;
+      } else {
+        out += name;
+      }
+    } else if ((c >= '0' && c <= '9') || (c == '.' && i + 1 < n && line[i + 1] >= '0' && line[i + 1] <= '9')) {
+      // Numbers, with suffixes and exponents, aren't identifiers.
+      size_t start = i;
+      while (i < n && (isIdentifierChar(line[i]) || line[i] == '.')) {
+        i++;
+      }
+      out += line.substr(start, i - start);
+    } else {
+      out += c;
+      i++;
+    }
+  }
+  return out;
+}
+
+// GLSL ES 1.00 to GLSL 3.30, line by line, so that every line keeps its
+// number.
+static string translateEssl100(const string& source, GLenum type) {
+  vector<string> lines;
+  size_t pos = 0;
+  while (pos <= source.size()) {
+    size_t eol = source.find('\n', pos);
+    if (eol == string::npos) {
+      lines.push_back(source.substr(pos));
+      break;
+    }
+    lines.push_back(source.substr(pos, eol - pos));
+    pos = eol + 1;
+  }
+
+  bool fragColor = false, fragData = false;
+  size_t header = lines.size();
+  long number = 1, headerNumber = 1;
+  for (size_t i = 0; i < lines.size(); i++, number++) {
+    string& line = lines[i];
+    if (header == lines.size() && !isHeaderLine(line)) {
+      header = i;
+      headerNumber = number;
+    }
+
+    size_t args;
+    string name = directive(line, args);
+    if (name == "version") {
+      line.clear();
+    } else if (name == "extension") {
+      size_t end = args;
+      while (end < line.size() && isIdentifierChar(line[end])) {
+        end++;
+      }
+      if (contains(CORE_EXTENSIONS, line.substr(args, end - args))) {
+        line.clear();
+      }
+    } else if (name == "line") {
+      // GLSL ES 1.00 numbers the line of the directive, GLSL 3.30 the next.
+      char* end;
+      long next = strtol(line.c_str() + args, &end, 10);
+      if (end != line.c_str() + args) {
+        line = "#line " + to_string(next + 1) + string(end);
+        number = next;
+      }
+    } else {
+      line = rewriteTokens(line, type, fragColor, fragData);
+    }
+  }
+
+  string out = "#version 330 core\n";
+  for (const char** extension = CORE_EXTENSIONS; *extension; extension++) {
+    out += string("#define ") + *extension + " 1\n";
+  }
+  out += "#line 1\n";
+
+  for (size_t i = 0; i < lines.size(); i++) {
+    if (i == header && (fragColor || fragData)) {
+      out += fragData ? "out vec4 webgl_FragData[gl_MaxDrawBuffers];\n" : "out vec4 webgl_FragColor;\n";
+      out += "#line " + to_string(headerNumber) + "\n";
+    }
+    out += lines[i];
+    if (i + 1 < lines.size()) {
+      out += '\n';
+    }
+  }
+  return out;
+}
+
+string desktopShaderSource(const string& source, GLenum type, const GLExtensions& extensions) {
+  if (extensions.es) {
+    return source;
+  }
+
+  int version = 100;
+  bool es = false;
+  size_t start = source.find("#version");
+  size_t eol = string::npos;
+  if (start != string::npos) {
+    eol = source.find('\n', start);
+    string line = source.substr(start, eol == string::npos ? string::npos : eol - start);
+    version = atoi(line.c_str() + 8);
+    es = line.find(" es") != string::npos;
+  }
+
+  if (version == 300 && es) {
+    if (extensions.version >= 430 || extensions.has("GL_ARB_ES3_compatibility")) {
+      return source;
+    }
+    return source.substr(0, start) + "#version 330 core" + (eol == string::npos ? string() : source.substr(eol));
+  }
+  if (version == 100 && extensions.coreProfile) {
+    return translateEssl100(source, type);
+  }
+  return source;
+}
+
+}
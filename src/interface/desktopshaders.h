@@ -0,0 +1,28 @@
+#ifndef DESKTOPSHADERS_H_
+#define DESKTOPSHADERS_H_
+
+#include <string>
+
+#include "glapi.h"
+#include "glext.h"
+
+namespace webgl {
+
+// Rewrites WebGL shaders into a language the desktop context compiles.
+//
+// GLSL ES 3.00 is only accepted from OpenGL 4.3 on or with
+// GL_ARB_ES3_compatibility; otherwise #version 300 es becomes #version 330
+// core, which covers the same language. GLSL ES 1.00 (no #version, or
+// #version 100) compiles as GLSL 1.10 on compatibility profiles, but core
+// profiles need GLSL 3.30: attribute and varying become in and out,
+// texture2D and friends become texture, gl_FragColor and gl_FragData become
+// outputs, the ES extensions that are core in GLSL 3.30 are dropped, and
+// identifiers that GLSL 3.30 reserves (such as texture) are renamed. Line
+// numbers in compile errors stay those of the original source.
+//
+// Returns the source unchanged when the context takes it as it is.
+std::string desktopShaderSource(const std::string& source, GLenum type, const GLExtensions& extensions);
+
+}
+
+#endif /* DESKTOPSHADERS_H_ */
@@ -0,0 +1,94 @@
+#include <vector>
+#include <algorithm>
+
+#include "drawstate.h"
+
+namespace webgl {
+
+using namespace std;
+
+GLuint createQuadArray(VertexArrays& vertexArrays, GLuint quads, GLuint attributes, GLuint& indexBuffer) {
+  vector<GLushort> indices(quads * 6);
+  for (GLuint i = 0; i < quads; i++) {
+    GLushort first = (GLushort) (i * 4);
+    GLushort* quad = &indices[i * 6];
+    quad[0] = first;
+    quad[1] = first + 1;
+    quad[2] = first + 2;
+    quad[3] = first + 2;
+    quad[4] = first + 1;
+    quad[5] = first + 3;
+  }
+
+  GLuint previousArray = vertexArrays.bound();
+  GLuint vertexArray = vertexArrays.create();
+  vertexArrays.bind(vertexArray);
+  glGenBuffers(1, &indexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+  vertexArrays.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), &indices[0], GL_STATIC_DRAW);
+  for (GLuint i = 0; i < attributes; i++) {
+    glEnableVertexAttribArray(i);
+    vertexArrays.enableAttrib(i, true);
+  }
+  vertexArrays.bind(previousArray);
+  return vertexArray;
+}
+
+DrawState::DrawState(VertexArrays& vertexArrays, GLuint units) : vertexArrays(vertexArrays) {
+  this->units = min(units, (GLuint) MAX_UNITS);
+  program = 0;
+  activeTexture = GL_TEXTURE0;
+  arrayBuffer = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+  glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &arrayBuffer);
+  vertexArray = vertexArrays.bound();
+  for (GLuint i = 0; i < this->units; i++) {
+    glActiveTexture(GL_TEXTURE0 + i);
+    textures[i] = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &textures[i]);
+  }
+  glActiveTexture(GL_TEXTURE0);
+
+  blend = glIsEnabled(GL_BLEND);
+  glGetIntegerv(GL_BLEND_SRC_RGB, &blendFunc[0]);
+  glGetIntegerv(GL_BLEND_DST_RGB, &blendFunc[1]);
+  glGetIntegerv(GL_BLEND_SRC_ALPHA, &blendFunc[2]);
+  glGetIntegerv(GL_BLEND_DST_ALPHA, &blendFunc[3]);
+  glGetIntegerv(GL_BLEND_EQUATION_RGB, &blendEquation[0]);
+  glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &blendEquation[1]);
+  glBlendEquation(GL_FUNC_ADD);
+
+  depthTest = glIsEnabled(GL_DEPTH_TEST);
+  cullFace = glIsEnabled(GL_CULL_FACE);
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_CULL_FACE);
+}
+
+DrawState::~DrawState() {
+  vertexArrays.bind(vertexArray);
+  glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+  vertexArrays.bindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+  for (GLuint i = 0; i < units; i++) {
+    glActiveTexture(GL_TEXTURE0 + i);
+    glBindTexture(GL_TEXTURE_2D, textures[i]);
+  }
+  glActiveTexture(activeTexture);
+  glUseProgram(program);
+  glBlendEquationSeparate(blendEquation[0], blendEquation[1]);
+  glBlendFuncSeparate(blendFunc[0], blendFunc[1], blendFunc[2], blendFunc[3]);
+  if (blend) {
+    glEnable(GL_BLEND);
+  } else {
+    glDisable(GL_BLEND);
+  }
+  if (depthTest) {
+    glEnable(GL_DEPTH_TEST);
+  }
+  if (cullFace) {
+    glEnable(GL_CULL_FACE);
+  }
+}
+
+}
@@ -0,0 +1,47 @@
+#ifndef DRAWSTATE_H_
+#define DRAWSTATE_H_
+
+#include "glapi.h"
+#include "vertexarrays.h"
+
+namespace webgl {
+
+// Creates the vertex array that the helpers draw quads from, with attributes
+// 0 to attributes - 1 enabled and an index buffer for the given number of
+// quads: two triangles of 16 bit indices each, corners 0 1 2 and 2 1 3. The
+// indices live in a vertex array of their own, so that drawing doesn't
+// disturb the application's, which stays bound. Returns the vertex array and
+// sets indexBuffer.
+GLuint createQuadArray(VertexArrays& vertexArrays, GLuint quads, GLuint attributes, GLuint& indexBuffer);
+
+// The state that the helpers' draws change, saved while it is in scope: the
+// program, ARRAY_BUFFER, the vertex array, the TEXTURE_2D bindings of the
+// first units and the active unit (TEXTURE0 once saved), blending (with the
+// equation set to FUNC_ADD) and the depth test and face culling, which are
+// disabled, as quads are ordered by the helpers and either winding follows
+// from their transforms.
+class DrawState {
+public:
+  DrawState(VertexArrays& vertexArrays, GLuint units);
+  ~DrawState();
+
+  static const GLuint MAX_UNITS = 8;
+
+private:
+  VertexArrays& vertexArrays;
+  GLuint units;
+  GLint program;
+  GLint activeTexture;
+  GLint arrayBuffer;
+  GLuint vertexArray;
+  GLint textures[MAX_UNITS];
+  GLboolean blend;
+  GLint blendFunc[4];
+  GLint blendEquation[2];
+  GLboolean depthTest;
+  GLboolean cullFace;
+};
+
+}
+
+#endif /* DRAWSTATE_H_ */
@@ -0,0 +1,357 @@
+#include <cmath>
+#include <algorithm>
+
+#include "dynamicresolution.h"
+#include "glprogram.h"
+#include "gl3.h"
+#include "../gles2platform.h"
+
+#ifndef GL_DEPTH24_STENCIL8
+#define GL_DEPTH24_STENCIL8 0x88F0
+#endif
+
+namespace webgl {
+
+using namespace std;
+
+// Frames that are this much slower than the target lower the scale.
+static const double SLOW = 1.1;
+
+// A scale is raised after this many frames that met the target, and not
+// changed at all for SETTLE frames after it changed.
+static const unsigned int RAISE_AFTER = 120;
+static const unsigned int SETTLE = 10;
+static const float RAISE_STEP = 0.05f;
+
+// The weight of a new frame in the average frame time.
+static const double SMOOTHING = 0.1;
+
+static const char* VERTEX_SHADER =
+  "ATTRIBUTE vec2 position;\n"
+  "uniform vec2 extent;\n"
+  "VARYING vec2 uv;\n"
+  "void main() {\n"
+  "  uv = position * extent;\n"
+  "  gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);\n"
+  "}\n";
+
+// Samples are clamped to the rendered part of the framebuffer. Sharpening
+// adds the difference between a pixel and its neighbours (a Laplacian), which
+// restores some of the detail that bilinear filtering blurs.
+static const char* FRAGMENT_SHADER =
+  "uniform sampler2D frame;\n"
+  "uniform vec2 extent;\n"
+  "uniform vec2 texel;\n"
+  "VARYING vec2 uv;\n"
+  "vec4 tap(vec2 at) {\n"
+  "  return TEXTURE(frame, clamp(at, texel * 0.5, extent - texel * 0.5));\n"
+  "}\n"
+  "void main() {\n"
+  "  vec4 color = tap(uv);\n"
+  "#ifdef SHARPEN\n"
+  "  vec4 neighbours = tap(uv + vec2(texel.x, 0.0)) + tap(uv - vec2(texel.x, 0.0))\n"
+  "      + tap(uv + vec2(0.0, texel.y)) + tap(uv - vec2(0.0, texel.y));\n"
+  "  color = clamp(color + (color * 4.0 - neighbours) * 0.2, 0.0, 1.0);\n"
+  "#endif\n"
+  "  FRAG_COLOR = color;\n"
+  "}\n";
+
+static const GLfloat QUAD[] = { 0, 0, 1, 0, 0, 1, 1, 1 };
+
+DynamicResolution::DynamicResolution(const GLExtensions& extensions, VertexArrays& vertexArrays)
+    : extensions(extensions), vertexArrays(vertexArrays) {
+  width = 0;
+  height = 0;
+  bufferWidth = 0;
+  bufferHeight = 0;
+  currentScale = 1;
+  framebuffer = 0;
+  colorTexture = 0;
+  depthBuffer = 0;
+  program = 0;
+  extentLocation = -1;
+  texelLocation = -1;
+  vertexBuffer = 0;
+  vertexArray = 0;
+  defaultBound = true;
+  averageFrameTime = 0;
+  settled = 0;
+}
+
+DynamicResolution::~DynamicResolution() {
+  if (framebuffer) {
+    gles2platform::removeFrameListener(frameListener, this);
+    glDeleteFramebuffers(1, &framebuffer);
+  }
+  if (colorTexture) {
+    glDeleteTextures(1, &colorTexture);
+  }
+  if (depthBuffer) {
+    glDeleteRenderbuffers(1, &depthBuffer);
+  }
+  if (program) {
+    glDeleteProgram(program);
+  }
+  if (vertexBuffer) {
+    glDeleteBuffers(1, &vertexBuffer);
+    vertexArrays.deleteBuffer(vertexBuffer);
+  }
+  if (vertexArray) {
+    vertexArrays.destroy(vertexArray);
+  }
+}
+
+bool DynamicResolution::init(GLsizei width, GLsizei height, const Options& options) {
+  if (framebuffer || width <= 0 || height <= 0) {
+    return false;
+  }
+
+  this->options = options;
+  this->options.maxScale = min(max(options.maxScale, 0.1f), 1.0f);
+  this->options.minScale = min(max(options.minScale, 0.1f), this->options.maxScale);
+  this->width = width;
+  this->height = height;
+  bufferWidth = max((GLsizei) lround(width * this->options.maxScale), 1);
+  bufferHeight = max((GLsizei) lround(height * this->options.maxScale), 1);
+  currentScale = this->options.maxScale;
+
+  static const char* ATTRIBUTES[] = { "position", NULL };
+  program = createProgram(extensions, VERTEX_SHADER, FRAGMENT_SHADER, ATTRIBUTES,
+      this->options.sharpen ? "#define SHARPEN\n" : "");
+  if (!program) {
+    return false;
+  }
+  extentLocation = glGetUniformLocation(program, "extent");
+  texelLocation = glGetUniformLocation(program, "texel");
+
+  GLint previousProgram = 0, previousTexture = 0, previousBuffer = 0, previousRenderbuffer = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousBuffer);
+  glGetIntegerv(GL_RENDERBUFFER_BINDING, &previousRenderbuffer);
+
+  glUseProgram(program);
+  glUniform1i(glGetUniformLocation(program, "frame"), 0);
+  glUniform2f(texelLocation, 1.0f / bufferWidth, 1.0f / bufferHeight);
+  glUseProgram(previousProgram);
+
+  glGenTextures(1, &colorTexture);
+  glBindTexture(GL_TEXTURE_2D, colorTexture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bufferWidth, bufferHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+  // Depth and stencil like the default framebuffer, where the driver can.
+  bool packed = !extensions.es || extensions.version >= 300 || extensions.has("GL_OES_packed_depth_stencil");
+  glGenRenderbuffers(1, &depthBuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, packed ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT16, bufferWidth, bufferHeight);
+  glBindRenderbuffer(GL_RENDERBUFFER, previousRenderbuffer);
+
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+  if (packed) {
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+  }
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    framebuffer = 0;
+    return false;
+  }
+
+  // The quad lives in a vertex array of its own, so that presenting doesn't
+  // disturb the application's.
+  GLuint previousArray = vertexArrays.bound();
+  vertexArray = vertexArrays.create();
+  vertexArrays.bind(vertexArray);
+  glGenBuffers(1, &vertexBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  vertexArrays.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(QUAD), QUAD, GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+  vertexArrays.attribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+  glEnableVertexAttribArray(0);
+  vertexArrays.enableAttrib(0, true);
+  vertexArrays.bind(previousArray);
+  glBindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+  vertexArrays.bindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+
+  // The application starts out with the default framebuffer bound.
+  defaultBound = true;
+  viewportRect[0] = scissorRect[0] = 0;
+  viewportRect[1] = scissorRect[1] = 0;
+  viewportRect[2] = scissorRect[2] = width;
+  viewportRect[3] = scissorRect[3] = height;
+  applyRects();
+
+  gles2platform::addFrameListener(frameListener, this);
+  return true;
+}
+
+void DynamicResolution::bindFramebuffer(GLenum target, GLuint buffer) {
+  if (!framebuffer) {
+    glBindFramebuffer(target, buffer);
+    return;
+  }
+
+  glBindFramebuffer(target, buffer ? buffer : framebuffer);
+  if (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER) {
+    bool wasDefault = defaultBound;
+    defaultBound = (buffer == 0);
+    if (defaultBound != wasDefault) {
+      applyRects();
+    }
+  }
+}
+
+void DynamicResolution::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  viewportRect[0] = x;
+  viewportRect[1] = y;
+  viewportRect[2] = width;
+  viewportRect[3] = height;
+  if (framebuffer && defaultBound) {
+    applyRects();
+  } else {
+    glViewport(x, y, width, height);
+  }
+}
+
+void DynamicResolution::scissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+  scissorRect[0] = x;
+  scissorRect[1] = y;
+  scissorRect[2] = width;
+  scissorRect[3] = height;
+  if (framebuffer && defaultBound) {
+    applyRects();
+  } else {
+    glScissor(x, y, width, height);
+  }
+}
+
+void DynamicResolution::getViewport(GLint* rect) const {
+  copy(viewportRect, viewportRect + 4, rect);
+}
+
+void DynamicResolution::getScissor(GLint* rect) const {
+  copy(scissorRect, scissorRect + 4, rect);
+}
+
+// Scaled for the default framebuffer, as set for the others.
+void DynamicResolution::applyRects() {
+  float s = defaultBound ? currentScale : 1;
+  glViewport((GLint) lround(viewportRect[0] * s), (GLint) lround(viewportRect[1] * s),
+      (GLsizei) lround(viewportRect[2] * s), (GLsizei) lround(viewportRect[3] * s));
+  glScissor((GLint) lround(scissorRect[0] * s), (GLint) lround(scissorRect[1] * s),
+      (GLsizei) lround(scissorRect[2] * s), (GLsizei) lround(scissorRect[3] * s));
+}
+
+void DynamicResolution::frameListener(void* data) {
+  static_cast<DynamicResolution*>(data)->present();
+}
+
+void DynamicResolution::present() {
+  // OpenGL ES 3.0 and OpenGL 3.0 have separate read and draw framebuffers,
+  // which binding GL_FRAMEBUFFER sets both of.
+  bool separateFramebuffers = extensions.version >= 300;
+  GLint previousReadFramebuffer = 0, previousDrawFramebuffer = 0;
+  if (separateFramebuffers) {
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDrawFramebuffer);
+  } else {
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousDrawFramebuffer);
+  }
+  GLint previousProgram = 0, activeTexture = GL_TEXTURE0, previousTexture = 0, previousBuffer = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+  glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+  glActiveTexture(GL_TEXTURE0);
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousBuffer);
+  GLuint previousArray = vertexArrays.bound();
+
+  static const GLenum CAPABILITIES[] = { GL_SCISSOR_TEST, GL_DEPTH_TEST, GL_STENCIL_TEST, GL_BLEND, GL_CULL_FACE };
+  static const size_t CAPABILITY_COUNT = sizeof(CAPABILITIES) / sizeof(CAPABILITIES[0]);
+  GLboolean enabled[CAPABILITY_COUNT];
+  for (size_t i = 0; i < CAPABILITY_COUNT; i++) {
+    enabled[i] = glIsEnabled(CAPABILITIES[i]);
+    glDisable(CAPABILITIES[i]);
+  }
+  GLboolean colorMask[4];
+  glGetBooleanv(GL_COLOR_WRITEMASK, colorMask);
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+  GLsizei renderWidth = max((GLsizei) lround(width * currentScale), 1);
+  GLsizei renderHeight = max((GLsizei) lround(height * currentScale), 1);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glViewport(0, 0, width, height);
+  glUseProgram(program);
+  glUniform2f(extentLocation, (GLfloat) renderWidth / bufferWidth, (GLfloat) renderHeight / bufferHeight);
+  glBindTexture(GL_TEXTURE_2D, colorTexture);
+  vertexArrays.bind(vertexArray);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+  vertexArrays.bind(previousArray);
+  glBindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+  glBindTexture(GL_TEXTURE_2D, previousTexture);
+  glActiveTexture(activeTexture);
+  glUseProgram(previousProgram);
+  glColorMask(colorMask[0], colorMask[1], colorMask[2], colorMask[3]);
+  for (size_t i = 0; i < CAPABILITY_COUNT; i++) {
+    if (enabled[i]) {
+      glEnable(CAPABILITIES[i]);
+    }
+  }
+  if (separateFramebuffers) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousDrawFramebuffer);
+  } else {
+    glBindFramebuffer(GL_FRAMEBUFFER, previousDrawFramebuffer);
+  }
+
+  Clock::time_point now = Clock::now();
+  if (lastPresent != Clock::time_point()) {
+    adapt(chrono::duration<double, milli>(now - lastPresent).count());
+  }
+  lastPresent = now;
+
+  applyRects();
+}
+
+// Frame times scale with the number of pixels, so a slow frame lowers the
+// scale by the square root of how much too slow it is.
+void DynamicResolution::adapt(double frameTime) {
+  // Pauses of the application say nothing about its frames.
+  if (frameTime > options.targetFrameTime * 10) {
+    return;
+  }
+
+  averageFrameTime = averageFrameTime > 0 ? averageFrameTime + (frameTime - averageFrameTime) * SMOOTHING : frameTime;
+  settled++;
+  if (settled < SETTLE) {
+    return;
+  }
+
+  float scale = currentScale;
+  if (averageFrameTime > options.targetFrameTime * SLOW) {
+    scale = currentScale * (float) sqrt(options.targetFrameTime / averageFrameTime);
+  } else if (settled >= RAISE_AFTER) {
+    scale = currentScale + RAISE_STEP;
+  } else {
+    return;
+  }
+
+  scale = min(max(scale, options.minScale), options.maxScale);
+  if (scale != currentScale) {
+    currentScale = scale;
+    averageFrameTime = options.targetFrameTime;
+  }
+  settled = 0;
+}
+
+} // end namespace webgl
@@ -0,0 +1,99 @@
+#ifndef DYNAMICRESOLUTION_H_
+#define DYNAMICRESOLUTION_H_
+
+#include <chrono>
+
+#include "glext.h"
+#include "vertexarrays.h"
+
+namespace webgl {
+
+// Renders the frames of the default framebuffer into an internal one whose
+// resolution adapts to the frame time, and scales them up to the window when
+// nextFrame ends the frame.
+//
+// The internal framebuffer is allocated for the largest scale; lower scales
+// render into its lower left part. While the application has the default
+// framebuffer bound, the internal one is bound in its place and viewport and
+// scissor rectangles are scaled, so applications don't notice, except for
+// readPixels and gl_FragCoord, which see the rendered resolution.
+//
+// GLES2 has no timer queries, so the frame time is measured between the
+// presents: frames that take longer than the target lower the scale, and a
+// scale that meets the target for a while is raised again, step by step.
+class DynamicResolution {
+public:
+  struct Options {
+    float minScale;
+    float maxScale;
+    double targetFrameTime;
+    // A sharpening upscale instead of a plain bilinear one.
+    bool sharpen;
+  };
+
+  DynamicResolution(const GLExtensions& extensions, VertexArrays& vertexArrays);
+  ~DynamicResolution();
+
+  // width and height are those of the window. Returns false if the
+  // framebuffer or the upscale program can't be created.
+  bool init(GLsizei width, GLsizei height, const Options& options);
+  bool isEnabled() const { return framebuffer != 0; }
+  // Whether the internal framebuffer stands in for the default one for drawing.
+  bool isRedirecting() const { return framebuffer != 0 && defaultBound; }
+  float scale() const { return currentScale; }
+
+  // Stand-ins for the GL calls, which map the default framebuffer to the
+  // internal one.
+  void bindFramebuffer(GLenum target, GLuint buffer);
+  void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+  void scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+  // The values that the application set, and the framebuffer binding as the
+  // application sees it.
+  void getViewport(GLint* rect) const;
+  void getScissor(GLint* rect) const;
+  GLint framebufferBinding(GLint binding) const { return (GLuint) binding == framebuffer ? 0 : binding; }
+
+  // Draws the frame into the window; leaves the GL state as it was.
+  void present();
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  static void frameListener(void* data);
+
+  void applyRects();
+  void adapt(double frameTime);
+
+  const GLExtensions& extensions;
+  VertexArrays& vertexArrays;
+  Options options;
+  GLsizei width;
+  GLsizei height;
+  GLsizei bufferWidth;
+  GLsizei bufferHeight;
+  float currentScale;
+
+  GLuint framebuffer;
+  GLuint colorTexture;
+  GLuint depthBuffer;
+  GLuint program;
+  GLint extentLocation;
+  GLint texelLocation;
+  GLuint vertexBuffer;
+  GLuint vertexArray;
+
+  // Whether the application has the default framebuffer bound for drawing.
+  bool defaultBound;
+  GLint viewportRect[4];
+  GLint scissorRect[4];
+
+  Clock::time_point lastPresent;
+  double averageFrameTime;
+  // Frames since the scale last changed.
+  unsigned int settled;
+};
+
+}
+
+#endif /* DYNAMICRESOLUTION_H_ */
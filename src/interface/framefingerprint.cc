@@ -0,0 +1,225 @@
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "framefingerprint.h"
+#include "../gles2platform.h"
+
+namespace webgl {
+
+using namespace std;
+
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+
+// Values that can't be told apart by their bits alone.
+enum ValueTag {
+  TAG_UNDEFINED = 1,
+  TAG_NULL,
+  TAG_FALSE,
+  TAG_TRUE,
+  TAG_NUMBER,
+  TAG_STRING,
+  TAG_BYTES,
+  TAG_ARRAY,
+  TAG_UPLOADS,
+  TAG_STATE,
+  TAG_PREVIOUS
+};
+
+// Arrays nested deeper than this make the frame count as changed.
+static const int MAX_DEPTH = 2;
+
+// Assumed until nextFrame has measured the frame interval.
+static const double DEFAULT_INTERVAL = 1000.0 / 60;
+
+FrameFingerprint::FrameFingerprint(TextureUploader& textureUploader, const UploadScheduler& uploadScheduler,
+    const map<GLuint, MirroredBuffer*>& mirroredBuffers)
+    : textureUploader(textureUploader), uploadScheduler(uploadScheduler), mirroredBuffers(mirroredBuffers) {
+  enabled = false;
+  throttleAfter = 0;
+  maxInterval = 0;
+  hash = 0;
+  previous = 0;
+  started = false;
+  invalidated = false;
+  shown = 0;
+  hasShown = false;
+  repeated = 0;
+}
+
+FrameFingerprint::~FrameFingerprint() {
+  disable();
+}
+
+void FrameFingerprint::enable(unsigned int throttleAfter, double maxInterval) {
+  this->throttleAfter = max(throttleAfter, 1u);
+  this->maxInterval = max(maxInterval, 0.0);
+  if (enabled) {
+    return;
+  }
+
+  gles2platform::addFrameListener(frameListener, this);
+  enabled = true;
+  hash = 0;
+  started = false;
+  // The frame that is being built may have begun before.
+  invalidated = true;
+  hasShown = false;
+  repeated = 0;
+}
+
+void FrameFingerprint::disable() {
+  if (!enabled) {
+    return;
+  }
+  gles2platform::removeFrameListener(frameListener, this);
+  enabled = false;
+}
+
+void FrameFingerprint::record(const void* method, const Nan::FunctionCallbackInfo<Value>& info) {
+  if (!started) {
+    // Uploads between the frames change what this one draws, and so do the
+    // bindings it starts from.
+    mixUploads();
+    mixState();
+    started = true;
+  }
+
+  mix((uint64_t) reinterpret_cast<uintptr_t>(method));
+  mix(info.Length());
+  for (int i = 0; i < info.Length(); i++) {
+    mixValue(info[i], 0);
+  }
+}
+
+void FrameFingerprint::frameListener(void* data) {
+  static_cast<FrameFingerprint*>(data)->endFrame();
+}
+
+// The state a frame starts from is what the calls of the frame before left
+// behind: calls set state to what their arguments say, whatever it was. So
+// two frames with the same calls draw the same if the frames before them had
+// the same calls too, such as a uniform or binding that was set after the
+// last draw.
+void FrameFingerprint::endFrame() {
+  mixUploads();
+  uint64_t calls = hash;
+  mix(TAG_PREVIOUS);
+  mix(previous);
+  previous = calls;
+
+  if (!invalidated && hasShown && hash == shown) {
+    repeated++;
+
+    double interval = 0;
+    if (repeated >= throttleAfter) {
+      // Doubles every throttleAfter frames.
+      double base = gles2platform::frameInterval();
+      if (base <= 0) {
+        base = DEFAULT_INTERVAL;
+      }
+      unsigned int steps = min(repeated / throttleAfter, 16u);
+      interval = min(base * ldexp(1.0, steps), maxInterval);
+    }
+    gles2platform::skipSwap(interval);
+  } else {
+    shown = hash;
+    hasShown = true;
+    repeated = 0;
+  }
+
+  hash = 0;
+  started = false;
+  invalidated = false;
+}
+
+void FrameFingerprint::mix(uint64_t value) {
+  hash ^= value * PRIME2;
+  hash = (hash << 31) | (hash >> 33);
+  hash *= PRIME1;
+}
+
+void FrameFingerprint::mixBytes(const void* data, size_t length) {
+  mix(length);
+
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    uint64_t word;
+    memcpy(&word, bytes + i, 8);
+    mix(word);
+  }
+  if (i < length) {
+    uint64_t word = 0;
+    memcpy(&word, bytes + i, length - i);
+    mix(word);
+  }
+}
+
+void FrameFingerprint::mixValue(Local<Value> value, int depth) {
+  if (value->IsNumber()) {
+    double number = value->NumberValue();
+    uint64_t bits;
+    memcpy(&bits, &number, 8);
+    mix(TAG_NUMBER);
+    mix(bits);
+  } else if (value->IsBoolean()) {
+    mix(value->BooleanValue() ? TAG_TRUE : TAG_FALSE);
+  } else if (value->IsUndefined()) {
+    mix(TAG_UNDEFINED);
+  } else if (value->IsNull()) {
+    mix(TAG_NULL);
+  } else if (value->IsString()) {
+    Nan::Utf8String string(value);
+    mix(TAG_STRING);
+    mixBytes(*string, string.length());
+  } else if (value->IsArrayBufferView()) {
+    Local<ArrayBufferView> view = Local<ArrayBufferView>::Cast(value);
+    const unsigned char* data = static_cast<const unsigned char*>(view->Buffer()->GetContents().Data());
+    mix(TAG_BYTES);
+    mixBytes(data + view->ByteOffset(), view->ByteLength());
+  } else if (value->IsArrayBuffer()) {
+    ArrayBuffer::Contents contents = Local<ArrayBuffer>::Cast(value)->GetContents();
+    mix(TAG_BYTES);
+    mixBytes(contents.Data(), contents.ByteLength());
+  } else if (value->IsArray() && depth < MAX_DEPTH) {
+    Local<Array> array = Local<Array>::Cast(value);
+    mix(TAG_ARRAY);
+    mix(array->Length());
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      mixValue(Nan::Get(array, i).ToLocalChecked(), depth + 1);
+    }
+  } else {
+    // The contents of other objects may change without the object changing.
+    invalidated = true;
+  }
+}
+
+// The bindings the frame starts from, which the helpers and the platform may
+// change without recorded calls.
+void FrameFingerprint::mixState() {
+  static const GLenum BINDINGS[] = {
+    GL_CURRENT_PROGRAM, GL_FRAMEBUFFER_BINDING, GL_ARRAY_BUFFER_BINDING, GL_ELEMENT_ARRAY_BUFFER_BINDING,
+    GL_ACTIVE_TEXTURE, GL_TEXTURE_BINDING_2D, GL_TEXTURE_BINDING_CUBE_MAP
+  };
+  mix(TAG_STATE);
+  for (size_t i = 0; i < sizeof(BINDINGS) / sizeof(BINDINGS[0]); i++) {
+    GLint value = 0;
+    glGetIntegerv(BINDINGS[i], &value);
+    mix((uint64_t) value);
+  }
+}
+
+void FrameFingerprint::mixUploads() {
+  mix(TAG_UPLOADS);
+  mix((uint64_t) uploadScheduler.uploadedBytes());
+  mix((uint64_t) textureUploader.pending());
+  // Mirrored buffers flush themselves when nextFrame ends the frame, which
+  // may be after this frame's fingerprint was taken; the next one sees it.
+  for (map<GLuint, MirroredBuffer*>::const_iterator it = mirroredBuffers.begin(); it != mirroredBuffers.end(); ++it) {
+    mix((uint64_t) it->second->uploadedBytes());
+  }
+}
+
+} // end namespace webgl
@@ -0,0 +1,84 @@
+#ifndef FRAMEFINGERPRINT_H_
+#define FRAMEFINGERPRINT_H_
+
+#include <stdint.h>
+#include <map>
+
+#include "../common.h"
+#include "textureuploader.h"
+#include "uploadscheduler.h"
+#include "mirroredbuffer.h"
+
+using namespace v8;
+
+namespace webgl {
+
+// Hashes the calls that build a frame, with their arguments and the contents
+// of the arrays passed to them, so that a frame that repeats the last one
+// that was shown can be left out: nextFrame doesn't swap it. After a number
+// of such frames in a row, the frames are also spaced out further and further,
+// up to a maximum interval, until a frame differs again.
+//
+// The calls have already been executed when the frame turns out to repeat
+// the last one; only the swap and the compositing are saved, and the rate at
+// which the application renders while throttled.
+//
+// A frame only repeats the last one if the frame before it had the same calls
+// too, since those left the uniforms and bindings it starts from.
+//
+// Frames with calls whose effect doesn't follow from their arguments (objects
+// other than arrays, unmapped buffers, flushed mirrored buffers), and frames
+// during which uploads made progress (including those of mirrored buffers at
+// the end of a frame), always count as changed. Frames whose
+// output depends on what their render targets held before, as with blending
+// into a framebuffer that isn't cleared, have to be invalidated explicitly.
+class FrameFingerprint {
+public:
+  FrameFingerprint(TextureUploader& textureUploader, const UploadScheduler& uploadScheduler,
+      const std::map<GLuint, MirroredBuffer*>& mirroredBuffers);
+  ~FrameFingerprint();
+
+  // Starts comparing the frames of the current context. Throttling starts
+  // after throttleAfter repeated frames, up to maxInterval ms between frames.
+  void enable(unsigned int throttleAfter, double maxInterval);
+  void disable();
+  bool isEnabled() const { return enabled; }
+
+  // Adds a call to the fingerprint of the current frame.
+  void record(const void* method, const Nan::FunctionCallbackInfo<Value>& info);
+  // Makes the current frame count as changed.
+  void invalidate() { invalidated = true; }
+
+private:
+  static void frameListener(void* data);
+
+  void endFrame();
+  void mix(uint64_t value);
+  void mixBytes(const void* data, size_t length);
+  void mixValue(Local<Value> value, int depth);
+  // Changes when uploads that don't go through calls make progress.
+  void mixUploads();
+  void mixState();
+
+  TextureUploader& textureUploader;
+  const UploadScheduler& uploadScheduler;
+  const std::map<GLuint, MirroredBuffer*>& mirroredBuffers;
+  bool enabled;
+  unsigned int throttleAfter;
+  double maxInterval;
+
+  uint64_t hash;
+  // The hash of the previous frame's calls, which set the state this one
+  // starts from.
+  uint64_t previous;
+  bool started;
+  bool invalidated;
+  uint64_t shown;
+  bool hasShown;
+  // Frames in a row that repeated the one that was shown.
+  unsigned int repeated;
+};
+
+}
+
+#endif /* FRAMEFINGERPRINT_H_ */
@@ -0,0 +1,116 @@
+#include <cstring>
+
+#include "gl3.h"
+#include "../gles2impl.h"
+
+namespace webgl {
+
+using namespace std;
+
+GL3Functions::GL3Functions() {
+  memset(this, 0, sizeof(*this));
+}
+
+bool GL3Functions::load(const GLExtensions& extensions) {
+  complete = extensions.version >= (extensions.es ? 300 : 330);
+
+  bindBufferBase = (PFNBINDBUFFERBASE) lookup("glBindBufferBase");
+  bindBufferRange = (PFNBINDBUFFERRANGE) lookup("glBindBufferRange");
+  copyBufferSubData = (PFNCOPYBUFFERSUBDATA) lookup("glCopyBufferSubData");
+  mapBufferRange = (PFNMAPBUFFERRANGE) lookup("glMapBufferRange");
+  unmapBuffer = (PFNUNMAPBUFFER) lookup("glUnmapBuffer");
+
+  getUniformBlockIndex = (PFNGETUNIFORMBLOCKINDEX) lookup("glGetUniformBlockIndex");
+  uniformBlockBinding = (PFNUNIFORMBLOCKBINDING) lookup("glUniformBlockBinding");
+  getActiveUniformBlockiv = (PFNGETACTIVEUNIFORMBLOCKIV) lookup("glGetActiveUniformBlockiv");
+  getActiveUniformBlockName = (PFNGETACTIVEUNIFORMBLOCKNAME) lookup("glGetActiveUniformBlockName");
+
+  vertexAttribIPointer = (PFNVERTEXATTRIBIPOINTER) lookup("glVertexAttribIPointer");
+  vertexAttribI4i = (PFNVERTEXATTRIBI4I) lookup("glVertexAttribI4i");
+  vertexAttribI4ui = (PFNVERTEXATTRIBI4UI) lookup("glVertexAttribI4ui");
+  uniformuiv[0] = (PFNUNIFORMUIV) lookup("glUniform1uiv");
+  uniformuiv[1] = (PFNUNIFORMUIV) lookup("glUniform2uiv");
+  uniformuiv[2] = (PFNUNIFORMUIV) lookup("glUniform3uiv");
+  uniformuiv[3] = (PFNUNIFORMUIV) lookup("glUniform4uiv");
+
+  drawRangeElements = (PFNDRAWRANGEELEMENTS) lookup("glDrawRangeElements");
+  drawBuffers = (PFNDRAWBUFFERS) lookup("glDrawBuffers");
+  readBuffer = (PFNREADBUFFER) lookup("glReadBuffer");
+
+  fenceSync = (PFNFENCESYNC) lookup("glFenceSync");
+  deleteSync = (PFNDELETESYNC) lookup("glDeleteSync");
+  clientWaitSync = (PFNCLIENTWAITSYNC) lookup("glClientWaitSync");
+  waitSync = (PFNWAITSYNC) lookup("glWaitSync");
+  getSynciv = (PFNGETSYNCIV) lookup("glGetSynciv");
+
+  texStorage2D = (PFNTEXSTORAGE2D) lookup("glTexStorage2D", !extensions.es);
+  texStorage3D = (PFNTEXSTORAGE3D) lookup("glTexStorage3D", !extensions.es);
+  texImage3D = (PFNTEXIMAGE3D) lookup("glTexImage3D");
+  texSubImage3D = (PFNTEXSUBIMAGE3D) lookup("glTexSubImage3D");
+  framebufferTextureLayer = (PFNFRAMEBUFFERTEXTURELAYER) lookup("glFramebufferTextureLayer");
+
+  genSamplers = (PFNGENSAMPLERS) lookup("glGenSamplers");
+  deleteSamplers = (PFNDELETESAMPLERS) lookup("glDeleteSamplers");
+  isSampler = (PFNISSAMPLER) lookup("glIsSampler");
+  bindSampler = (PFNBINDSAMPLER) lookup("glBindSampler");
+  samplerParameteri = (PFNSAMPLERPARAMETERI) lookup("glSamplerParameteri");
+  samplerParameterf = (PFNSAMPLERPARAMETERF) lookup("glSamplerParameterf");
+
+  blitFramebuffer = (PFNBLITFRAMEBUFFER) lookup("glBlitFramebuffer");
+  renderbufferStorageMultisample = (PFNRENDERBUFFERSTORAGEMULTISAMPLE) lookup("glRenderbufferStorageMultisample");
+  invalidateFramebuffer = (PFNINVALIDATEFRAMEBUFFER) lookup("glInvalidateFramebuffer", !extensions.es);
+  clearBufferfv = (PFNCLEARBUFFERFV) lookup("glClearBufferfv");
+  clearBufferiv = (PFNCLEARBUFFERIV) lookup("glClearBufferiv");
+  clearBufferuiv = (PFNCLEARBUFFERUIV) lookup("glClearBufferuiv");
+  clearBufferfi = (PFNCLEARBUFFERFI) lookup("glClearBufferfi");
+
+  return complete;
+}
+
+void* GL3Functions::lookup(const char* name, bool optional) {
+  void* function = gles2impl::getProcAddress(name);
+  if (!function && !optional) {
+    complete = false;
+  }
+  return function;
+}
+
+bool GL3Functions::unsizedFormat(GLenum internalformat, GLenum& format, GLenum& type) {
+  static const struct {
+    GLenum internalformat;
+    GLenum format;
+    GLenum type;
+  } formats[] = {
+    { 0x8058 /* RGBA8 */, GL_RGBA, GL_UNSIGNED_BYTE },
+    { 0x8051 /* RGB8 */, GL_RGB, GL_UNSIGNED_BYTE },
+    { 0x8C43 /* SRGB8_ALPHA8 */, GL_RGBA, GL_UNSIGNED_BYTE },
+    { 0x8229 /* R8 */, 0x1903 /* RED */, GL_UNSIGNED_BYTE },
+    { 0x822B /* RG8 */, 0x8227 /* RG */, GL_UNSIGNED_BYTE },
+    { 0x881A /* RGBA16F */, GL_RGBA, 0x140B /* HALF_FLOAT */ },
+    { 0x881B /* RGB16F */, GL_RGB, 0x140B /* HALF_FLOAT */ },
+    { 0x822D /* R16F */, 0x1903 /* RED */, 0x140B /* HALF_FLOAT */ },
+    { 0x822F /* RG16F */, 0x8227 /* RG */, 0x140B /* HALF_FLOAT */ },
+    { 0x8814 /* RGBA32F */, GL_RGBA, GL_FLOAT },
+    { 0x8815 /* RGB32F */, GL_RGB, GL_FLOAT },
+    { 0x822E /* R32F */, 0x1903 /* RED */, GL_FLOAT },
+    { 0x8230 /* RG32F */, 0x8227 /* RG */, GL_FLOAT },
+    { 0x8D62 /* RGB565 */, GL_RGB, GL_UNSIGNED_SHORT_5_6_5 },
+    { 0x8056 /* RGBA4 */, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4 },
+    { 0x8057 /* RGB5_A1 */, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1 },
+    { 0x81A5 /* DEPTH_COMPONENT16 */, GL_DEPTH_COMPONENT, GL_UNSIGNED_SHORT },
+    { 0x81A6 /* DEPTH_COMPONENT24 */, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT },
+    { 0x8CAC /* DEPTH_COMPONENT32F */, GL_DEPTH_COMPONENT, GL_FLOAT },
+    { 0x88F0 /* DEPTH24_STENCIL8 */, 0x84F9 /* DEPTH_STENCIL */, 0x84FA /* UNSIGNED_INT_24_8 */ },
+  };
+
+  for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+    if (formats[i].internalformat == internalformat) {
+      format = formats[i].format;
+      type = formats[i].type;
+      return true;
+    }
+  }
+  return false;
+}
+
+} // end namespace webgl
@@ -0,0 +1,229 @@
+#ifndef GL3_H_
+#define GL3_H_
+
+#include "glext.h"
+
+// OpenGL ES 3.0 enums that the GLES2 headers lack.
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER_BINDING
+#define GL_PIXEL_PACK_BUFFER_BINDING 0x88ED
+#endif
+#ifndef GL_PIXEL_UNPACK_BUFFER_BINDING
+#define GL_PIXEL_UNPACK_BUFFER_BINDING 0x88EF
+#endif
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+#ifndef GL_UNPACK_SKIP_ROWS
+#define GL_UNPACK_SKIP_ROWS 0x0CF3
+#endif
+#ifndef GL_UNPACK_SKIP_PIXELS
+#define GL_UNPACK_SKIP_PIXELS 0x0CF4
+#endif
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER 0x8A11
+#endif
+#ifndef GL_UNIFORM_BUFFER_BINDING
+#define GL_UNIFORM_BUFFER_BINDING 0x8A28
+#endif
+#ifndef GL_COPY_READ_BUFFER
+#define GL_COPY_READ_BUFFER 0x8F36
+#endif
+#ifndef GL_COPY_WRITE_BUFFER
+#define GL_COPY_WRITE_BUFFER 0x8F37
+#endif
+#ifndef GL_INVALID_INDEX
+#define GL_INVALID_INDEX 0xFFFFFFFFu
+#endif
+#ifndef GL_UNIFORM_BLOCK_DATA_SIZE
+#define GL_UNIFORM_BLOCK_DATA_SIZE 0x8A40
+#endif
+#ifndef GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS
+#define GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS 0x8A42
+#endif
+#ifndef GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES
+#define GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES 0x8A43
+#endif
+#ifndef GL_UNIFORM_BLOCK_REFERENCED_BY_VERTEX_SHADER
+#define GL_UNIFORM_BLOCK_REFERENCED_BY_VERTEX_SHADER 0x8A44
+#endif
+#ifndef GL_UNIFORM_BLOCK_REFERENCED_BY_FRAGMENT_SHADER
+#define GL_UNIFORM_BLOCK_REFERENCED_BY_FRAGMENT_SHADER 0x8A46
+#endif
+#ifndef GL_READ_FRAMEBUFFER
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#endif
+#ifndef GL_DRAW_FRAMEBUFFER
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#endif
+#ifndef GL_READ_FRAMEBUFFER_BINDING
+#define GL_READ_FRAMEBUFFER_BINDING 0x8CAA
+#endif
+#ifndef GL_DRAW_FRAMEBUFFER_BINDING
+#define GL_DRAW_FRAMEBUFFER_BINDING 0x8CA6
+#endif
+#ifndef GL_TEXTURE_3D
+#define GL_TEXTURE_3D 0x806F
+#endif
+#ifndef GL_TEXTURE_2D_ARRAY
+#define GL_TEXTURE_2D_ARRAY 0x8C1A
+#endif
+#ifndef GL_TEXTURE_IMMUTABLE_FORMAT
+#define GL_TEXTURE_IMMUTABLE_FORMAT 0x912F
+#endif
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_RG
+#define GL_RG 0x8227
+#endif
+#ifndef GL_RED_INTEGER
+#define GL_RED_INTEGER 0x8D94
+#endif
+#ifndef GL_RG_INTEGER
+#define GL_RG_INTEGER 0x8228
+#endif
+#ifndef GL_RGB_INTEGER
+#define GL_RGB_INTEGER 0x8D98
+#endif
+#ifndef GL_RGBA_INTEGER
+#define GL_RGBA_INTEGER 0x8D99
+#endif
+#ifndef GL_DEPTH_STENCIL
+#define GL_DEPTH_STENCIL 0x84F9
+#endif
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+#ifndef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT_OES 0x8D61
+#endif
+#ifndef GL_UNSIGNED_INT_2_10_10_10_REV
+#define GL_UNSIGNED_INT_2_10_10_10_REV 0x8368
+#endif
+#ifndef GL_UNSIGNED_INT_10F_11F_11F_REV
+#define GL_UNSIGNED_INT_10F_11F_11F_REV 0x8C3B
+#endif
+#ifndef GL_UNSIGNED_INT_5_9_9_9_REV
+#define GL_UNSIGNED_INT_5_9_9_9_REV 0x8C3E
+#endif
+#ifndef GL_UNSIGNED_INT_24_8
+#define GL_UNSIGNED_INT_24_8 0x84FA
+#endif
+
+namespace webgl {
+
+typedef void (GLEXT_APIENTRY *PFNBINDBUFFERBASE)(GLenum target, GLuint index, GLuint buffer);
+typedef void (GLEXT_APIENTRY *PFNBINDBUFFERRANGE)(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+typedef void (GLEXT_APIENTRY *PFNCOPYBUFFERSUBDATA)(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+typedef GLuint (GLEXT_APIENTRY *PFNGETUNIFORMBLOCKINDEX)(GLuint program, const GLchar *name);
+typedef void (GLEXT_APIENTRY *PFNUNIFORMBLOCKBINDING)(GLuint program, GLuint blockIndex, GLuint binding);
+typedef void (GLEXT_APIENTRY *PFNGETACTIVEUNIFORMBLOCKIV)(GLuint program, GLuint blockIndex, GLenum pname, GLint *params);
+typedef void (GLEXT_APIENTRY *PFNGETACTIVEUNIFORMBLOCKNAME)(GLuint program, GLuint blockIndex, GLsizei bufSize, GLsizei *length, GLchar *name);
+typedef void (GLEXT_APIENTRY *PFNVERTEXATTRIBIPOINTER)(GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer);
+typedef void (GLEXT_APIENTRY *PFNVERTEXATTRIBI4I)(GLuint index, GLint x, GLint y, GLint z, GLint w);
+typedef void (GLEXT_APIENTRY *PFNVERTEXATTRIBI4UI)(GLuint index, GLuint x, GLuint y, GLuint z, GLuint w);
+typedef void (GLEXT_APIENTRY *PFNUNIFORMUIV)(GLint location, GLsizei count, const GLuint *value);
+typedef void (GLEXT_APIENTRY *PFNDRAWRANGEELEMENTS)(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices);
+typedef void (GLEXT_APIENTRY *PFNDRAWBUFFERS)(GLsizei n, const GLenum *bufs);
+typedef void (GLEXT_APIENTRY *PFNREADBUFFER)(GLenum src);
+typedef void (GLEXT_APIENTRY *PFNWAITSYNC)(GLsync sync, GLbitfield flags, uint64_t timeout);
+typedef void (GLEXT_APIENTRY *PFNGETSYNCIV)(GLsync sync, GLenum pname, GLsizei bufSize, GLsizei *length, GLint *values);
+typedef void (GLEXT_APIENTRY *PFNTEXSTORAGE2D)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+typedef void (GLEXT_APIENTRY *PFNTEXSTORAGE3D)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+typedef void (GLEXT_APIENTRY *PFNTEXIMAGE3D)(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void *pixels);
+typedef void (GLEXT_APIENTRY *PFNTEXSUBIMAGE3D)(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels);
+typedef void (GLEXT_APIENTRY *PFNFRAMEBUFFERTEXTURELAYER)(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer);
+typedef void (GLEXT_APIENTRY *PFNGENSAMPLERS)(GLsizei count, GLuint *samplers);
+typedef void (GLEXT_APIENTRY *PFNDELETESAMPLERS)(GLsizei count, const GLuint *samplers);
+typedef GLboolean (GLEXT_APIENTRY *PFNISSAMPLER)(GLuint sampler);
+typedef void (GLEXT_APIENTRY *PFNBINDSAMPLER)(GLuint unit, GLuint sampler);
+typedef void (GLEXT_APIENTRY *PFNSAMPLERPARAMETERI)(GLuint sampler, GLenum pname, GLint param);
+typedef void (GLEXT_APIENTRY *PFNSAMPLERPARAMETERF)(GLuint sampler, GLenum pname, GLfloat param);
+typedef void (GLEXT_APIENTRY *PFNBLITFRAMEBUFFER)(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+typedef void (GLEXT_APIENTRY *PFNRENDERBUFFERSTORAGEMULTISAMPLE)(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height);
+typedef void (GLEXT_APIENTRY *PFNINVALIDATEFRAMEBUFFER)(GLenum target, GLsizei numAttachments, const GLenum *attachments);
+typedef void (GLEXT_APIENTRY *PFNCLEARBUFFERFV)(GLenum buffer, GLint drawbuffer, const GLfloat *value);
+typedef void (GLEXT_APIENTRY *PFNCLEARBUFFERIV)(GLenum buffer, GLint drawbuffer, const GLint *value);
+typedef void (GLEXT_APIENTRY *PFNCLEARBUFFERUIV)(GLenum buffer, GLint drawbuffer, const GLuint *value);
+typedef void (GLEXT_APIENTRY *PFNCLEARBUFFERFI)(GLenum buffer, GLint drawbuffer, GLfloat depth, GLint stencil);
+
+// The OpenGL ES 3.0 entry points used by WebGL 2, resolved at runtime like the
+// extensions so that the GLES2 builds can use them when the driver has them.
+// Desktop GL provides them from 3.3 on, except for the ones marked optional.
+class GL3Functions {
+public:
+  GL3Functions();
+
+  // Must be called with the context current. Returns false if the context
+  // lacks any of the required entry points.
+  bool load(const GLExtensions& extensions);
+
+  PFNBINDBUFFERBASE bindBufferBase;
+  PFNBINDBUFFERRANGE bindBufferRange;
+  PFNCOPYBUFFERSUBDATA copyBufferSubData;
+  PFNMAPBUFFERRANGE mapBufferRange;
+  PFNUNMAPBUFFER unmapBuffer;
+
+  PFNGETUNIFORMBLOCKINDEX getUniformBlockIndex;
+  PFNUNIFORMBLOCKBINDING uniformBlockBinding;
+  PFNGETACTIVEUNIFORMBLOCKIV getActiveUniformBlockiv;
+  PFNGETACTIVEUNIFORMBLOCKNAME getActiveUniformBlockName;
+
+  PFNVERTEXATTRIBIPOINTER vertexAttribIPointer;
+  PFNVERTEXATTRIBI4I vertexAttribI4i;
+  PFNVERTEXATTRIBI4UI vertexAttribI4ui;
+  PFNUNIFORMUIV uniformuiv[4];
+
+  PFNDRAWRANGEELEMENTS drawRangeElements;
+  PFNDRAWBUFFERS drawBuffers;
+  PFNREADBUFFER readBuffer;
+
+  PFNFENCESYNC fenceSync;
+  PFNDELETESYNC deleteSync;
+  PFNCLIENTWAITSYNC clientWaitSync;
+  PFNWAITSYNC waitSync;
+  PFNGETSYNCIV getSynciv;
+
+  // Optional on GL: 4.2 or GL_ARB_texture_storage. Emulated with texImage
+  // calls for the common sized formats when missing.
+  PFNTEXSTORAGE2D texStorage2D;
+  PFNTEXSTORAGE3D texStorage3D;
+  PFNTEXIMAGE3D texImage3D;
+  PFNTEXSUBIMAGE3D texSubImage3D;
+  PFNFRAMEBUFFERTEXTURELAYER framebufferTextureLayer;
+
+  PFNGENSAMPLERS genSamplers;
+  PFNDELETESAMPLERS deleteSamplers;
+  PFNISSAMPLER isSampler;
+  PFNBINDSAMPLER bindSampler;
+  PFNSAMPLERPARAMETERI samplerParameteri;
+  PFNSAMPLERPARAMETERF samplerParameterf;
+
+  PFNBLITFRAMEBUFFER blitFramebuffer;
+  PFNRENDERBUFFERSTORAGEMULTISAMPLE renderbufferStorageMultisample;
+  // Optional on GL: 4.3 or GL_ARB_invalidate_subdata. It is only a hint.
+  PFNINVALIDATEFRAMEBUFFER invalidateFramebuffer;
+  PFNCLEARBUFFERFV clearBufferfv;
+  PFNCLEARBUFFERIV clearBufferiv;
+  PFNCLEARBUFFERUIV clearBufferuiv;
+  PFNCLEARBUFFERFI clearBufferfi;
+
+  // The unsized format and type that texImage needs for a sized internal
+  // format, for emulating immutable storage. Returns false if unknown.
+  static bool unsizedFormat(GLenum internalformat, GLenum& format, GLenum& type);
+
+private:
+  bool complete;
+
+  void* lookup(const char* name, bool optional = false);
+};
+
+}
+
+#endif /* GL3_H_ */
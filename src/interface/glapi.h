@@ -0,0 +1,16 @@
+#ifndef GLAPI_H_
+#define GLAPI_H_
+
+#ifdef __IPHONE_OS_VERSION_MIN_REQUIRED
+    #include <OpenGLES/ES2/gl.h>
+    #include <OpenGLES/ES2/glext.h>
+    typedef double GLclampd;
+#else
+    #ifdef IS_GLEW
+    #include <GL/glew.h>
+    #else
+    #include <GLES2/gl2.h>
+    #endif
+#endif
+
+#endif /* GLAPI_H_ */
@@ -0,0 +1,203 @@
+#include <cstring>
+#include <cstdio>
+
+#include "glext.h"
+#include "../gles2impl.h"
+
+// Desktop GL exposes the extension entry points without a suffix.
+#ifdef IS_GLEW
+  #define GLEXT_NAME(es, desktop) desktop
+#else
+  #define GLEXT_NAME(es, desktop) es
+#endif
+
+namespace webgl {
+
+using namespace std;
+
+GLExtensions::GLExtensions() {
+  es = false;
+  version = 0;
+  coreProfile = false;
+  programBinary = false;
+  getProgramBinary = NULL;
+  programBinaryLoad = NULL;
+  programParameteri = NULL;
+  parallelShaderCompile = false;
+  maxShaderCompilerThreads = NULL;
+  vertexArrayObject = false;
+  genVertexArrays = NULL;
+  bindVertexArray = NULL;
+  deleteVertexArrays = NULL;
+  isVertexArray = NULL;
+  instancedArrays = false;
+  drawArraysInstanced = NULL;
+  drawElementsInstanced = NULL;
+  vertexAttribDivisor = NULL;
+  fences = false;
+  fenceSync = NULL;
+  clientWaitSync = NULL;
+  deleteSync = NULL;
+  bufferMapping = false;
+  mapBufferRange = NULL;
+  unmapBuffer = NULL;
+  wholeBufferMapping = false;
+  mapBuffer = NULL;
+}
+
+void GLExtensions::load() {
+  loadVersion();
+
+  // Core profiles only list the extensions one by one.
+  const char* list = coreProfile ? NULL : (const char*) glGetString(GL_EXTENSIONS);
+  if (list) {
+    extensions = string(" ") + list + string(" ");
+  } else {
+    extensions = " ";
+    PFNGETSTRINGI getStringi = (PFNGETSTRINGI) lookup("glGetStringi");
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; getStringi && i < count; i++) {
+      const char* name = (const char*) getStringi(GL_EXTENSIONS, i);
+      if (name) {
+        extensions += string(name) + string(" ");
+      }
+    }
+  }
+
+  if (has("GL_OES_get_program_binary") || has("GL_ARB_get_program_binary")) {
+    getProgramBinary = (PFNGETPROGRAMBINARY) lookup(GLEXT_NAME("glGetProgramBinaryOES", "glGetProgramBinary"));
+    programBinaryLoad = (PFNPROGRAMBINARY) lookup(GLEXT_NAME("glProgramBinaryOES", "glProgramBinary"));
+    programParameteri = (PFNPROGRAMPARAMETERI) lookup(GLEXT_NAME(NULL, "glProgramParameteri"));
+
+    // Some drivers advertise the extension without supporting a single format.
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    programBinary = (getProgramBinary != NULL && programBinaryLoad != NULL && formats > 0);
+  }
+
+  // Both GL and GLES name the entry point after the extension.
+  if (has("GL_KHR_parallel_shader_compile")) {
+    maxShaderCompilerThreads = (PFNMAXSHADERCOMPILERTHREADS) lookup("glMaxShaderCompilerThreadsKHR");
+  } else if (has("GL_ARB_parallel_shader_compile")) {
+    maxShaderCompilerThreads = (PFNMAXSHADERCOMPILERTHREADS) lookup("glMaxShaderCompilerThreadsARB");
+  }
+  parallelShaderCompile = (maxShaderCompilerThreads != NULL);
+
+  if (version >= 300) {
+    genVertexArrays = (PFNGENVERTEXARRAYS) lookup("glGenVertexArrays");
+    bindVertexArray = (PFNBINDVERTEXARRAY) lookup("glBindVertexArray");
+    deleteVertexArrays = (PFNDELETEVERTEXARRAYS) lookup("glDeleteVertexArrays");
+    isVertexArray = (PFNISVERTEXARRAY) lookup("glIsVertexArray");
+    vertexArrayObject = (genVertexArrays != NULL && bindVertexArray != NULL && deleteVertexArrays != NULL && isVertexArray != NULL);
+  } else if (has(GLEXT_NAME("GL_OES_vertex_array_object", "GL_ARB_vertex_array_object"))) {
+    genVertexArrays = (PFNGENVERTEXARRAYS) lookup(GLEXT_NAME("glGenVertexArraysOES", "glGenVertexArrays"));
+    bindVertexArray = (PFNBINDVERTEXARRAY) lookup(GLEXT_NAME("glBindVertexArrayOES", "glBindVertexArray"));
+    deleteVertexArrays = (PFNDELETEVERTEXARRAYS) lookup(GLEXT_NAME("glDeleteVertexArraysOES", "glDeleteVertexArrays"));
+    isVertexArray = (PFNISVERTEXARRAY) lookup(GLEXT_NAME("glIsVertexArrayOES", "glIsVertexArray"));
+    vertexArrayObject = (genVertexArrays != NULL && bindVertexArray != NULL && deleteVertexArrays != NULL && isVertexArray != NULL);
+  }
+
+  // The divisor and the instanced draw calls may come from different extensions.
+  if (version >= (es ? 300 : 330)) {
+    loadInstancedArrays("", "");
+  }
+#ifdef IS_GLEW
+  else if (has("GL_ARB_instanced_arrays")) {
+    if (has("GL_ARB_draw_instanced")) {
+      loadInstancedArrays("ARB", "ARB");
+    } else if (has("GL_EXT_draw_instanced")) {
+      loadInstancedArrays("EXT", "ARB");
+    }
+  }
+#else
+  else if (has("GL_ANGLE_instanced_arrays")) {
+    loadInstancedArrays("ANGLE", "ANGLE");
+  } else if (has("GL_EXT_instanced_arrays")) {
+    loadInstancedArrays("EXT", "EXT");
+  } else if (has("GL_NV_instanced_arrays") && has("GL_NV_draw_instanced")) {
+    loadInstancedArrays("NV", "NV");
+  }
+#endif
+
+  if (version >= (es ? 300 : 320) || has("GL_ARB_sync")) {
+    fenceSync = (PFNFENCESYNC) lookup("glFenceSync");
+    clientWaitSync = (PFNCLIENTWAITSYNC) lookup("glClientWaitSync");
+    deleteSync = (PFNDELETESYNC) lookup("glDeleteSync");
+  } else if (has("GL_APPLE_sync")) {
+    fenceSync = (PFNFENCESYNC) lookup("glFenceSyncAPPLE");
+    clientWaitSync = (PFNCLIENTWAITSYNC) lookup("glClientWaitSyncAPPLE");
+    deleteSync = (PFNDELETESYNC) lookup("glDeleteSyncAPPLE");
+  }
+  fences = (fenceSync != NULL && clientWaitSync != NULL && deleteSync != NULL);
+
+  if (version >= 300 || has("GL_ARB_map_buffer_range")) {
+    mapBufferRange = (PFNMAPBUFFERRANGE) lookup("glMapBufferRange");
+    unmapBuffer = (PFNUNMAPBUFFER) lookup("glUnmapBuffer");
+  } else if (has("GL_EXT_map_buffer_range") && has("GL_OES_mapbuffer")) {
+    mapBufferRange = (PFNMAPBUFFERRANGE) lookup("glMapBufferRangeEXT");
+    unmapBuffer = (PFNUNMAPBUFFER) lookup("glUnmapBufferOES");
+  }
+  bufferMapping = (mapBufferRange != NULL && unmapBuffer != NULL);
+
+  // Whole buffers can be mapped write-only on any desktop GL.
+#ifdef IS_GLEW
+  mapBuffer = (PFNMAPBUFFER) lookup("glMapBuffer");
+  if (!unmapBuffer) {
+    unmapBuffer = (PFNUNMAPBUFFER) lookup("glUnmapBuffer");
+  }
+#else
+  if (has("GL_OES_mapbuffer")) {
+    mapBuffer = (PFNMAPBUFFER) lookup("glMapBufferOES");
+    if (!unmapBuffer) {
+      unmapBuffer = (PFNUNMAPBUFFER) lookup("glUnmapBufferOES");
+    }
+  }
+#endif
+  wholeBufferMapping = (mapBuffer != NULL && unmapBuffer != NULL);
+}
+
+void GLExtensions::loadVersion() {
+  // "OpenGL ES 3.0 <vendor specific>" or "3.3.0 <vendor specific>".
+  const char* text = (const char*) glGetString(GL_VERSION);
+  int major = 0, minor = 0;
+  if (text) {
+    es = (strncmp(text, "OpenGL ES", 9) == 0);
+    const char* number = strpbrk(text, "0123456789");
+    if (number) {
+      sscanf(number, "%d.%d", &major, &minor);
+    }
+  }
+  version = major * 100 + minor * 10;
+
+  if (!es && version >= 320) {
+    GLint mask = 0;
+    glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &mask);
+    coreProfile = (mask & GL_CONTEXT_CORE_PROFILE_BIT) != 0;
+  }
+}
+
+bool GLExtensions::has(const char* name) const {
+  string token = string(" ") + name + string(" ");
+  return extensions.find(token) != string::npos;
+}
+
+// Far longer than any frame's worth of GPU work.
+static const uint64_t MAX_SYNC_WAIT = 5000000000ull;
+
+GLenum GLExtensions::waitSync(GLsync fence, GLbitfield flags) const {
+  return clientWaitSync(fence, flags, MAX_SYNC_WAIT);
+}
+
+void GLExtensions::loadInstancedArrays(const char* drawSuffix, const char* divisorSuffix) {
+  drawArraysInstanced = (PFNDRAWARRAYSINSTANCED) lookup((string("glDrawArraysInstanced") + drawSuffix).c_str());
+  drawElementsInstanced = (PFNDRAWELEMENTSINSTANCED) lookup((string("glDrawElementsInstanced") + drawSuffix).c_str());
+  vertexAttribDivisor = (PFNVERTEXATTRIBDIVISOR) lookup((string("glVertexAttribDivisor") + divisorSuffix).c_str());
+  instancedArrays = (drawArraysInstanced != NULL && drawElementsInstanced != NULL && vertexAttribDivisor != NULL);
+}
+
+void* GLExtensions::lookup(const char* name) const {
+  return name ? gles2impl::getProcAddress(name) : NULL;
+}
+
+} // end namespace webgl
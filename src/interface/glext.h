@@ -0,0 +1,181 @@
+#ifndef GLEXT_H_
+#define GLEXT_H_
+
+#include <string>
+#include <stdint.h>
+
+#include "glapi.h"
+
+// Extension entry points are resolved at runtime, so that one binary works with
+// drivers that do and drivers that don't expose them. The function pointer
+// types are declared here because GLES2 and desktop GL headers disagree on them.
+#ifdef IS_GLEW
+  #define GLEXT_APIENTRY GLAPIENTRY
+#else
+  #define GLEXT_APIENTRY GL_APIENTRY
+#endif
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_VERTEX_ATTRIB_ARRAY_DIVISOR
+#define GL_VERTEX_ATTRIB_ARRAY_DIVISOR 0x88FE
+#endif
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT 0x0001
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_INVALIDATE_RANGE_BIT
+#define GL_MAP_INVALIDATE_RANGE_BIT 0x0004
+#endif
+#ifndef GL_MAP_INVALIDATE_BUFFER_BIT
+#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#endif
+#ifndef GL_MAP_UNSYNCHRONIZED_BIT
+#define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#endif
+#ifndef GL_WRITE_ONLY
+#define GL_WRITE_ONLY 0x88B9
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+#define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+#ifndef GL_WAIT_FAILED
+#define GL_WAIT_FAILED 0x911D
+#endif
+#ifndef GL_TIMEOUT_IGNORED
+#define GL_TIMEOUT_IGNORED 0xFFFFFFFFFFFFFFFFull
+#endif
+#ifndef GL_NUM_EXTENSIONS
+#define GL_NUM_EXTENSIONS 0x821D
+#endif
+#ifndef GL_CONTEXT_PROFILE_MASK
+#define GL_CONTEXT_PROFILE_MASK 0x9126
+#endif
+#ifndef GL_CONTEXT_CORE_PROFILE_BIT
+#define GL_CONTEXT_CORE_PROFILE_BIT 0x00000001
+#endif
+
+namespace webgl {
+
+#ifndef IS_GLEW
+typedef struct __GLsync *GLsync;
+#endif
+
+typedef void (GLEXT_APIENTRY *PFNGETPROGRAMBINARY)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (GLEXT_APIENTRY *PFNPROGRAMBINARY)(GLuint program, GLenum binaryFormat, const void *binary, GLint length);
+typedef void (GLEXT_APIENTRY *PFNPROGRAMPARAMETERI)(GLuint program, GLenum pname, GLint value);
+typedef void (GLEXT_APIENTRY *PFNMAXSHADERCOMPILERTHREADS)(GLuint count);
+typedef void (GLEXT_APIENTRY *PFNGENVERTEXARRAYS)(GLsizei n, GLuint *arrays);
+typedef void (GLEXT_APIENTRY *PFNBINDVERTEXARRAY)(GLuint array);
+typedef void (GLEXT_APIENTRY *PFNDELETEVERTEXARRAYS)(GLsizei n, const GLuint *arrays);
+typedef GLboolean (GLEXT_APIENTRY *PFNISVERTEXARRAY)(GLuint array);
+typedef void (GLEXT_APIENTRY *PFNDRAWARRAYSINSTANCED)(GLenum mode, GLint first, GLsizei count, GLsizei primcount);
+typedef void (GLEXT_APIENTRY *PFNDRAWELEMENTSINSTANCED)(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount);
+typedef void (GLEXT_APIENTRY *PFNVERTEXATTRIBDIVISOR)(GLuint index, GLuint divisor);
+typedef const GLubyte* (GLEXT_APIENTRY *PFNGETSTRINGI)(GLenum name, GLuint index);
+typedef GLsync (GLEXT_APIENTRY *PFNFENCESYNC)(GLenum condition, GLbitfield flags);
+typedef void (GLEXT_APIENTRY *PFNDELETESYNC)(GLsync sync);
+typedef GLenum (GLEXT_APIENTRY *PFNCLIENTWAITSYNC)(GLsync sync, GLbitfield flags, uint64_t timeout);
+typedef void* (GLEXT_APIENTRY *PFNMAPBUFFERRANGE)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef GLboolean (GLEXT_APIENTRY *PFNUNMAPBUFFER)(GLenum target);
+typedef void* (GLEXT_APIENTRY *PFNMAPBUFFER)(GLenum target, GLenum access);
+
+class GLExtensions {
+public:
+  GLExtensions();
+
+  // Resolves the entry points; must be called with the context current.
+  void load();
+
+  // Exact match against the tokens of GL_EXTENSIONS.
+  bool has(const char* name) const;
+
+  // Space separated, like GL_EXTENSIONS.
+  const std::string& list() const { return extensions; }
+
+  // The context's version, as in GLSL: 300 for OpenGL ES 3.0, 330 for OpenGL 3.3.
+  bool es;
+  int version;
+
+  // Core profile contexts have no default vertex array object and no
+  // GL_EXTENSIONS string.
+  bool coreProfile;
+
+  // GL_OES_get_program_binary / GL_ARB_get_program_binary.
+  bool programBinary;
+  PFNGETPROGRAMBINARY getProgramBinary;
+  PFNPROGRAMBINARY programBinaryLoad;
+  PFNPROGRAMPARAMETERI programParameteri;
+
+  // GL_KHR_parallel_shader_compile / GL_ARB_parallel_shader_compile.
+  bool parallelShaderCompile;
+  PFNMAXSHADERCOMPILERTHREADS maxShaderCompilerThreads;
+
+  // GL_OES_vertex_array_object / GL_ARB_vertex_array_object; core in
+  // OpenGL ES 3.0 and OpenGL 3.0.
+  bool vertexArrayObject;
+  PFNGENVERTEXARRAYS genVertexArrays;
+  PFNBINDVERTEXARRAY bindVertexArray;
+  PFNDELETEVERTEXARRAYS deleteVertexArrays;
+  PFNISVERTEXARRAY isVertexArray;
+
+  // GL_ARB_instanced_arrays with GL_ARB/EXT_draw_instanced on GL;
+  // GL_ANGLE/EXT_instanced_arrays or GL_NV_instanced_arrays with
+  // GL_NV_draw_instanced on GLES. Core in OpenGL ES 3.0 and OpenGL 3.3.
+  bool instancedArrays;
+  PFNDRAWARRAYSINSTANCED drawArraysInstanced;
+  PFNDRAWELEMENTSINSTANCED drawElementsInstanced;
+  PFNVERTEXATTRIBDIVISOR vertexAttribDivisor;
+
+  // GL_APPLE_sync on GLES2; core in OpenGL ES 3.0 and OpenGL 3.2
+  // (GL_ARB_sync).
+  bool fences;
+  PFNFENCESYNC fenceSync;
+  PFNCLIENTWAITSYNC clientWaitSync;
+  PFNDELETESYNC deleteSync;
+
+  // clientWaitSync for work that the caller can't go on without, bounded so
+  // that a lost context or a hung GPU, whose fences never signal, doesn't
+  // hang it forever. Returns GL_TIMEOUT_EXPIRED if it gave up.
+  GLenum waitSync(GLsync fence, GLbitfield flags) const;
+
+  // GL_EXT_map_buffer_range with GL_OES_mapbuffer on GLES2; core in OpenGL
+  // ES 3.0 and OpenGL 3.0 (GL_ARB_map_buffer_range).
+  bool bufferMapping;
+  PFNMAPBUFFERRANGE mapBufferRange;
+  PFNUNMAPBUFFER unmapBuffer;
+
+  // GL_OES_mapbuffer on GLES2, core in OpenGL. Write-only, and unmapped with
+  // unmapBuffer above.
+  bool wholeBufferMapping;
+  PFNMAPBUFFER mapBuffer;
+
+private:
+  void* lookup(const char* name) const;
+  void loadVersion();
+  void loadInstancedArrays(const char* drawSuffix, const char* divisorSuffix);
+
+  std::string extensions;
+};
+
+}
+
+#endif /* GLEXT_H_ */
@@ -0,0 +1,81 @@
+#include "glprogram.h"
+
+namespace webgl {
+
+using namespace std;
+
+static const char* LEGACY_VERTEX =
+  "#define ATTRIBUTE attribute\n"
+  "#define VARYING varying\n";
+static const char* LEGACY_FRAGMENT =
+  "#ifdef GL_ES\n"
+  "precision mediump float;\n"
+  "#endif\n"
+  "#define VARYING varying\n"
+  "#define TEXTURE texture2D\n"
+  "#define FRAG_COLOR gl_FragColor\n";
+static const char* CORE_VERTEX =
+  "#version 330 core\n"
+  "#define ATTRIBUTE in\n"
+  "#define VARYING out\n";
+static const char* CORE_FRAGMENT =
+  "#version 330 core\n"
+  "#define VARYING in\n"
+  "#define TEXTURE texture\n"
+  "out vec4 fragColor;\n"
+  "#define FRAG_COLOR fragColor\n";
+
+string shaderHeader(GLenum type, const GLExtensions& extensions) {
+  if (extensions.coreProfile) {
+    return type == GL_VERTEX_SHADER ? CORE_VERTEX : CORE_FRAGMENT;
+  }
+  return type == GL_VERTEX_SHADER ? LEGACY_VERTEX : LEGACY_FRAGMENT;
+}
+
+static GLuint compile(GLenum type, const string& source, const GLExtensions& extensions, const string& defines) {
+  string header = shaderHeader(type, extensions) + defines;
+  const char* sources[] = { header.c_str(), source.c_str() };
+  GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 2, sources, NULL);
+  glCompileShader(shader);
+
+  GLint status = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+  if (!status) {
+    glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
+
+GLuint createProgram(const GLExtensions& extensions, const string& vertexSource, const string& fragmentSource, const char** attributes, const string& defines) {
+  GLuint program = 0;
+  GLuint vertexShader = compile(GL_VERTEX_SHADER, vertexSource, extensions, defines);
+  GLuint fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentSource, extensions, defines);
+  if (vertexShader && fragmentShader) {
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    for (GLuint i = 0; attributes[i]; i++) {
+      glBindAttribLocation(program, i, attributes[i]);
+    }
+    glLinkProgram(program);
+  }
+  if (vertexShader) {
+    glDeleteShader(vertexShader);
+  }
+  if (fragmentShader) {
+    glDeleteShader(fragmentShader);
+  }
+  GLint linked = GL_FALSE;
+  if (program) {
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  }
+  if (!linked && program) {
+    glDeleteProgram(program);
+    program = 0;
+  }
+  return program;
+}
+
+}
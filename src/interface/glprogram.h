@@ -0,0 +1,25 @@
+#ifndef GLPROGRAM_H_
+#define GLPROGRAM_H_
+
+#include <string>
+
+#include "glapi.h"
+#include "glext.h"
+
+namespace webgl {
+
+// Programs of the helpers that draw for the application (sprite batches,
+// text, paths, dynamic resolution). Their shaders are written once with
+// ATTRIBUTE, VARYING, TEXTURE and FRAG_COLOR, which the header of a stage
+// defines: compatibility profiles and GLES take GLSL ES 1.00 (desktop GLSL
+// 1.10 without the precision statement); core profiles need GLSL 3.30.
+std::string shaderHeader(GLenum type, const GLExtensions& extensions);
+
+// Compiles both stages after their header and the defines, binds the NULL
+// terminated attributes to locations 0, 1, ... and links. Returns 0 if a
+// stage doesn't compile or the program doesn't link.
+GLuint createProgram(const GLExtensions& extensions, const std::string& vertexSource, const std::string& fragmentSource, const char** attributes, const std::string& defines = std::string());
+
+}
+
+#endif /* GLPROGRAM_H_ */
@@ -0,0 +1,179 @@
+#include <cstring>
+#include <algorithm>
+
+#include "glyphatlas.h"
+#include "unpackstate.h"
+
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_R8
+#define GL_R8 0x8229
+#endif
+
+namespace webgl {
+
+using namespace std;
+
+// Zeroes around each glyph, so that filtering doesn't pick up its neighbours.
+static const GLsizei PADDING = 1;
+
+// A glyph may go on a shelf that is up to this much higher than itself.
+static const GLsizei SHELF_SLACK = 4;
+
+GlyphAtlas::GlyphAtlas(const GLExtensions& extensions) : extensions(extensions) {
+  pageSize = 0;
+  maxPages = 0;
+  listener = NULL;
+  listenerData = NULL;
+  clock = 0;
+}
+
+GlyphAtlas::~GlyphAtlas() {
+  for (size_t i = 0; i < pages.size(); i++) {
+    glDeleteTextures(1, &pages[i].texture);
+  }
+}
+
+void GlyphAtlas::init(GLsizei pageSize, GLuint maxPages, EvictionListener listener, void* data) {
+  this->pageSize = max(pageSize, (GLsizei) 64);
+  this->maxPages = max(maxPages, 1u);
+  this->listener = listener;
+  listenerData = data;
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::find(uint64_t key) {
+  map<uint64_t, Glyph>::iterator it = glyphs.find(key);
+  if (it == glyphs.end()) {
+    return NULL;
+  }
+  pages[it->second.page].used = ++clock;
+  return &it->second;
+}
+
+// Takes the lowest shelf that is high enough without wasting much, or opens a
+// new one below the others.
+bool GlyphAtlas::place(Page& page, GLsizei width, GLsizei height, GLint& x, GLint& y) {
+  Shelf* best = NULL;
+  for (size_t i = 0; i < page.shelves.size(); i++) {
+    Shelf& shelf = page.shelves[i];
+    if (shelf.height >= height && shelf.height <= height + SHELF_SLACK && shelf.x + width <= pageSize &&
+        (!best || shelf.height < best->height)) {
+      best = &shelf;
+    }
+  }
+  if (!best) {
+    if (page.bottom + height > pageSize || width > pageSize) {
+      return false;
+    }
+    Shelf shelf = { page.bottom, height, 0 };
+    page.shelves.push_back(shelf);
+    page.bottom += height;
+    best = &page.shelves.back();
+  }
+
+  x = best->x;
+  y = best->y;
+  best->x += width;
+  return true;
+}
+
+void GlyphAtlas::createPage() {
+  Page page;
+  page.bottom = 0;
+  page.used = 0;
+
+  GLint previousTexture = 0;
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+  glGenTextures(1, &page.texture);
+  glBindTexture(GL_TEXTURE_2D, page.texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  // Core profiles have no alpha textures; the shaders read the red channel
+  // there instead.
+  if (extensions.coreProfile) {
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, pageSize, pageSize, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+  } else {
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, pageSize, pageSize, 0, GL_ALPHA, GL_UNSIGNED_BYTE, NULL);
+  }
+  glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+  pages.push_back(page);
+}
+
+void GlyphAtlas::evict(GLuint index) {
+  if (listener) {
+    listener(listenerData, index);
+  }
+  Page& page = pages[index];
+  for (size_t i = 0; i < page.keys.size(); i++) {
+    glyphs.erase(page.keys[i]);
+  }
+  page.keys.clear();
+  page.shelves.clear();
+  page.bottom = 0;
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::insert(uint64_t key, const GLubyte* pixels, GLsizei width, GLsizei height) {
+  GLsizei paddedWidth = width + 2 * PADDING;
+  GLsizei paddedHeight = height + 2 * PADDING;
+  if (!pageSize || paddedWidth > pageSize || paddedHeight > pageSize) {
+    return NULL;
+  }
+
+  GLint x = 0, y = 0;
+  GLuint index = 0;
+  bool placed = false;
+  for (; index < pages.size() && !placed; index++) {
+    placed = place(pages[index], paddedWidth, paddedHeight, x, y);
+  }
+  if (placed) {
+    index--;
+  } else if (pages.size() < maxPages) {
+    createPage();
+    index = pages.size() - 1;
+    placed = place(pages[index], paddedWidth, paddedHeight, x, y);
+  } else if (!pages.empty()) {
+    index = 0;
+    for (GLuint i = 1; i < pages.size(); i++) {
+      if (pages[i].used < pages[index].used) {
+        index = i;
+      }
+    }
+    evict(index);
+    placed = place(pages[index], paddedWidth, paddedHeight, x, y);
+  }
+  if (!placed) {
+    return NULL;
+  }
+
+  staging.assign(paddedWidth * paddedHeight, 0);
+  for (GLsizei row = 0; row < height; row++) {
+    memcpy(&staging[(row + PADDING) * paddedWidth + PADDING], pixels + row * width, width);
+  }
+
+  Page& page = pages[index];
+  GLint previousTexture = 0;
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+  {
+    ClientUnpackState unpack(extensions, 1);
+    glBindTexture(GL_TEXTURE_2D, page.texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, paddedWidth, paddedHeight,
+        extensions.coreProfile ? GL_RED : GL_ALPHA, GL_UNSIGNED_BYTE, &staging[0]);
+  }
+  glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+  Glyph glyph;
+  glyph.page = index;
+  glyph.u0 = (GLfloat) (x + PADDING) / pageSize;
+  glyph.v0 = (GLfloat) (y + PADDING) / pageSize;
+  glyph.u1 = (GLfloat) (x + PADDING + width) / pageSize;
+  glyph.v1 = (GLfloat) (y + PADDING + height) / pageSize;
+  page.keys.push_back(key);
+  page.used = ++clock;
+  return &(glyphs[key] = glyph);
+}
+
+} // end namespace webgl
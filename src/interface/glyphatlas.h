@@ -0,0 +1,80 @@
+#ifndef GLYPHATLAS_H_
+#define GLYPHATLAS_H_
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+#include "glapi.h"
+#include "glext.h"
+
+namespace webgl {
+
+// Single channel textures (pages) that rasterized glyphs are packed into,
+// on shelves: rows as high as the first glyph placed in them, which suits
+// glyphs of similar heights.
+//
+// When a glyph fits in none of the pages and no more pages may be created,
+// the least recently used page is emptied, and all glyphs on it have to be
+// inserted again when they are needed. The eviction listener is called before,
+// so that draws that still use the page can be issued first.
+class GlyphAtlas {
+public:
+  struct Glyph {
+    GLuint page;
+    // Texture coordinates of the bitmap, without the padding around it.
+    GLfloat u0, v0, u1, v1;
+  };
+
+  typedef void (*EvictionListener)(void* data, GLuint page);
+
+  GlyphAtlas(const GLExtensions& extensions);
+  ~GlyphAtlas();
+
+  void init(GLsizei pageSize, GLuint maxPages, EvictionListener listener, void* data);
+
+  // Returns NULL if the glyph isn't in the atlas. Marks its page as used.
+  const Glyph* find(uint64_t key);
+
+  // Copies the width x height coverage (or distance) values into a page,
+  // uploading them with a border of zeroes. Returns NULL if the glyph is
+  // larger than a page.
+  const Glyph* insert(uint64_t key, const GLubyte* pixels, GLsizei width, GLsizei height);
+
+  GLuint texture(GLuint page) const { return pages[page].texture; }
+  size_t pageCount() const { return pages.size(); }
+
+private:
+  struct Shelf {
+    GLint y;
+    GLsizei height;
+    GLint x;
+  };
+
+  struct Page {
+    GLuint texture;
+    std::vector<Shelf> shelves;
+    // The y of the first row below the shelves.
+    GLint bottom;
+    uint64_t used;
+    std::vector<uint64_t> keys;
+  };
+
+  bool place(Page& page, GLsizei width, GLsizei height, GLint& x, GLint& y);
+  void createPage();
+  void evict(GLuint page);
+
+  const GLExtensions& extensions;
+  GLsizei pageSize;
+  GLuint maxPages;
+  EvictionListener listener;
+  void* listenerData;
+  uint64_t clock;
+  std::vector<Page> pages;
+  std::map<uint64_t, Glyph> glyphs;
+  std::vector<GLubyte> staging;
+};
+
+}
+
+#endif /* GLYPHATLAS_H_ */
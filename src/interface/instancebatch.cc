@@ -0,0 +1,129 @@
+#include <cstring>
+#include <algorithm>
+
+#include "instancebatch.h"
+
+namespace webgl {
+
+using namespace std;
+
+InstanceBatch::InstanceBatch(VertexArrays& vertexArrays) : vertexArrays(vertexArrays) {
+  vertexBuffer = 0;
+  indexBuffer = 0;
+  stride = 0;
+  indexCount = 0;
+  instanceAttribute = 0;
+  vectorsPerInstance = 0;
+  perDraw = 0;
+}
+
+InstanceBatch::~InstanceBatch() {
+  if (vertexBuffer) {
+    glDeleteBuffers(1, &vertexBuffer);
+    vertexArrays.deleteBuffer(vertexBuffer);
+  }
+  if (indexBuffer) {
+    glDeleteBuffers(1, &indexBuffer);
+    vertexArrays.deleteBuffer(indexBuffer);
+  }
+}
+
+bool InstanceBatch::init(const unsigned char* vertices, GLsizei vertexBytes, GLsizei stride,
+    const GLushort* indices, GLsizei indexCount, const vector<Attribute>& attributes,
+    GLuint instanceAttribute, GLuint vectorsPerInstance, GLuint reservedVectors) {
+  if (stride <= 0 || vertexBytes < stride || indexCount <= 0 || vectorsPerInstance == 0) {
+    return false;
+  }
+
+  GLsizei vertexCount = vertexBytes / stride;
+
+  // The copies of an index past the mesh would read the vertices of the next
+  // copy, or past the buffer.
+  for (GLsizei i = 0; i < indexCount; i++) {
+    if (indices[i] >= vertexCount) {
+      return false;
+    }
+  }
+
+  GLint maxVectors = 0;
+  glGetIntegerv(GL_MAX_VERTEX_UNIFORM_VECTORS, &maxVectors);
+  GLint available = maxVectors - (GLint) reservedVectors;
+  if (available < (GLint) vectorsPerInstance) {
+    return false;
+  }
+  perDraw = available / vectorsPerInstance;
+  perDraw = min(perDraw, (GLuint) (65536 / vertexCount));
+  if (perDraw == 0) {
+    return false;
+  }
+
+  this->stride = stride + sizeof(GLfloat);
+  this->indexCount = indexCount;
+  this->attributes = attributes;
+  this->instanceAttribute = instanceAttribute;
+  this->vectorsPerInstance = vectorsPerInstance;
+
+  // Each copy of the mesh is followed by its index in the draw.
+  vector<unsigned char> replicated((size_t) this->stride * vertexCount * perDraw);
+  vector<GLushort> replicatedIndices((size_t) indexCount * perDraw);
+  unsigned char* out = &replicated[0];
+  for (GLuint copy = 0; copy < perDraw; copy++) {
+    GLfloat index = (GLfloat) copy;
+    for (GLsizei v = 0; v < vertexCount; v++) {
+      memcpy(out, vertices + v * stride, stride);
+      memcpy(out + stride, &index, sizeof(index));
+      out += this->stride;
+    }
+    GLushort base = (GLushort) (copy * vertexCount);
+    for (GLsizei i = 0; i < indexCount; i++) {
+      replicatedIndices[copy * indexCount + i] = base + indices[i];
+    }
+  }
+
+  glGenBuffers(1, &vertexBuffer);
+  glGenBuffers(1, &indexBuffer);
+  bind();
+  glBufferData(GL_ARRAY_BUFFER, replicated.size(), &replicated[0], GL_STATIC_DRAW);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, replicatedIndices.size() * sizeof(GLushort), &replicatedIndices[0], GL_STATIC_DRAW);
+
+  return true;
+}
+
+// Leaves the batch's buffers bound and its attributes enabled, like the
+// calls an application would make itself before a draw.
+void InstanceBatch::bind() {
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  vertexArrays.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+  vertexArrays.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+  for (size_t i = 0; i < attributes.size(); i++) {
+    const Attribute& a = attributes[i];
+    glVertexAttribPointer(a.index, a.size, a.type, a.normalized, stride, (const GLvoid *) (GLintptr) a.offset);
+    vertexArrays.attribPointer(a.index, a.size, a.type, a.normalized, stride, a.offset);
+    glEnableVertexAttribArray(a.index);
+    vertexArrays.enableAttrib(a.index, true);
+  }
+
+  GLsizei instanceOffset = stride - sizeof(GLfloat);
+  glVertexAttribPointer(instanceAttribute, 1, GL_FLOAT, GL_FALSE, stride, (const GLvoid *) (GLintptr) instanceOffset);
+  vertexArrays.attribPointer(instanceAttribute, 1, GL_FLOAT, GL_FALSE, stride, instanceOffset);
+  glEnableVertexAttribArray(instanceAttribute);
+  vertexArrays.enableAttrib(instanceAttribute, true);
+}
+
+void InstanceBatch::draw(GLenum mode, GLint location, const GLfloat* data, GLsizei count) {
+  if (!perDraw || count <= 0) {
+    return;
+  }
+
+  bind();
+
+  for (GLsizei first = 0; first < count; first += perDraw) {
+    GLsizei n = min((GLsizei) perDraw, count - first);
+    glUniform4fv(location, n * vectorsPerInstance, data + (size_t) first * vectorsPerInstance * 4);
+    glDrawElements(mode, indexCount * n, GL_UNSIGNED_SHORT, 0);
+  }
+}
+
+} // end namespace webgl
@@ -0,0 +1,66 @@
+#ifndef INSTANCEBATCH_H_
+#define INSTANCEBATCH_H_
+
+#include <vector>
+
+#include "glapi.h"
+#include "vertexarrays.h"
+
+namespace webgl {
+
+// Pseudo-instancing, for GLES2 drivers without instanced arrays.
+//
+// The mesh is replicated into one vertex buffer as many times as instances fit
+// in one draw, with an extra float attribute that holds the copy's index. The
+// per-instance parameters (a fixed number of vec4s per instance) are uploaded
+// as a uniform array for each draw, so the vertex shader reads
+//
+//   uniform vec4 instances[INSTANCES_PER_DRAW * VECTORS_PER_INSTANCE];
+//   attribute float instanceIndex;
+//
+// and N instances take N / instancesPerDraw() draws. The number of instances
+// per draw is limited by MAX_VERTEX_UNIFORM_VECTORS and by 16 bit indices.
+class InstanceBatch {
+public:
+  struct Attribute {
+    GLuint index;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    GLsizei offset;
+  };
+
+  explicit InstanceBatch(VertexArrays& vertexArrays);
+  ~InstanceBatch();
+
+  // reservedVectors are the uniform vectors the shader uses otherwise.
+  // Returns false if an index is out of the vertices' range, or if not even
+  // one instance fits.
+  bool init(const unsigned char* vertices, GLsizei vertexBytes, GLsizei stride,
+      const GLushort* indices, GLsizei indexCount, const std::vector<Attribute>& attributes,
+      GLuint instanceAttribute, GLuint vectorsPerInstance, GLuint reservedVectors);
+
+  GLuint instancesPerDraw() const { return perDraw; }
+  GLuint instanceVectors() const { return vectorsPerInstance; }
+
+  // Draws count instances with the current program; location is the uniform
+  // array, data holds vectorsPerInstance vec4s per instance.
+  void draw(GLenum mode, GLint location, const GLfloat* data, GLsizei count);
+
+private:
+  void bind();
+
+  VertexArrays& vertexArrays;
+  GLuint vertexBuffer;
+  GLuint indexBuffer;
+  GLsizei stride;
+  GLsizei indexCount;
+  std::vector<Attribute> attributes;
+  GLuint instanceAttribute;
+  GLuint vectorsPerInstance;
+  GLuint perDraw;
+};
+
+}
+
+#endif /* INSTANCEBATCH_H_ */
@@ -0,0 +1,147 @@
+#include <cstring>
+#include <algorithm>
+
+#include "mirroredbuffer.h"
+#include "../gles2platform.h"
+
+namespace webgl {
+
+using namespace std;
+
+// Ranges closer than this are uploaded together; sending a few unchanged
+// bytes is cheaper than another call.
+static const GLsizeiptr MERGE_GAP = 256;
+
+// Beyond this many ranges they are coalesced right away.
+static const size_t MAX_RANGES = 1024;
+
+MirroredBuffer::MirroredBuffer(VertexArrays& vertexArrays) : vertexArrays(vertexArrays) {
+  vertexBuffer = 0;
+  bufferSize = 0;
+  pageSize = 0;
+  totalUploaded = 0;
+}
+
+MirroredBuffer::~MirroredBuffer() {
+  if (vertexBuffer) {
+    gles2platform::removeFrameListener(frameListener, this);
+    glDeleteBuffers(1, &vertexBuffer);
+    vertexArrays.deleteBuffer(vertexBuffer);
+  }
+  mirror.Reset();
+}
+
+bool MirroredBuffer::init(Local<Object> mirror, GLenum usage, GLsizeiptr pageSize) {
+  this->mirror.Reset(mirror);
+  unsigned char* data = contents();
+  if (!data || !bufferSize) {
+    return false;
+  }
+
+  this->pageSize = pageSize;
+  if (pageSize > 0) {
+    uploaded.assign(data, data + bufferSize);
+  }
+
+  GLint previous = 0;
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previous);
+  glGenBuffers(1, &vertexBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER, bufferSize, data, usage);
+  glBindBuffer(GL_ARRAY_BUFFER, previous);
+
+  gles2platform::addFrameListener(frameListener, this);
+  return true;
+}
+
+void MirroredBuffer::frameListener(void* data) {
+  static_cast<MirroredBuffer*>(data)->flush();
+}
+
+// The array's bytes, or NULL if it no longer has the size it was created
+// with, as when its buffer was detached.
+unsigned char* MirroredBuffer::contents() {
+  Nan::HandleScope scope;
+
+  Local<ArrayBufferView> view = Local<ArrayBufferView>::Cast(Nan::New(mirror));
+  if (vertexBuffer && (GLsizeiptr) view->ByteLength() != bufferSize) {
+    return NULL;
+  }
+  bufferSize = view->ByteLength();
+  return static_cast<unsigned char*>(view->Buffer()->GetContents().Data()) + view->ByteOffset();
+}
+
+void MirroredBuffer::markDirty(GLintptr offset, GLsizeiptr length) {
+  GLintptr begin = max((GLintptr) 0, offset);
+  GLintptr end = min((GLintptr) bufferSize, offset + length);
+  if (begin >= end) {
+    return;
+  }
+  dirty.push_back(Range(begin, end));
+  if (dirty.size() > MAX_RANGES) {
+    coalesce();
+  }
+}
+
+void MirroredBuffer::compare(const unsigned char* data) {
+  for (GLintptr page = 0; page < bufferSize; page += pageSize) {
+    GLsizeiptr length = min(pageSize, bufferSize - page);
+    if (memcmp(&uploaded[page], data + page, length)) {
+      memcpy(&uploaded[page], data + page, length);
+      dirty.push_back(Range(page, page + length));
+    }
+  }
+}
+
+void MirroredBuffer::coalesce() {
+  if (dirty.size() < 2) {
+    return;
+  }
+  sort(dirty.begin(), dirty.end());
+  size_t last = 0;
+  for (size_t i = 1; i < dirty.size(); i++) {
+    if (dirty[i].first <= dirty[last].second + MERGE_GAP) {
+      dirty[last].second = max(dirty[last].second, dirty[i].second);
+    } else {
+      dirty[++last] = dirty[i];
+    }
+  }
+  dirty.resize(last + 1);
+}
+
+void MirroredBuffer::flush() {
+  if (!vertexBuffer) {
+    return;
+  }
+
+  unsigned char* data = contents();
+  if (!data) {
+    dirty.clear();
+    return;
+  }
+  if (pageSize > 0) {
+    compare(data);
+  }
+  if (dirty.empty()) {
+    return;
+  }
+  coalesce();
+
+  GLint previous = 0;
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previous);
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  for (size_t i = 0; i < dirty.size(); i++) {
+    GLsizeiptr length = dirty[i].second - dirty[i].first;
+    glBufferSubData(GL_ARRAY_BUFFER, dirty[i].first, length, data + dirty[i].first);
+    totalUploaded += length;
+    // Ranges that were marked dirty, or merged in between, are up to date
+    // too; otherwise the next comparison would upload them again.
+    if (pageSize > 0) {
+      memcpy(&uploaded[dirty[i].first], data + dirty[i].first, length);
+    }
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, previous);
+  dirty.clear();
+}
+
+} // end namespace webgl
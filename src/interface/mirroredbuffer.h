@@ -0,0 +1,63 @@
+#ifndef MIRROREDBUFFER_H_
+#define MIRROREDBUFFER_H_
+
+#include <vector>
+#include <utility>
+
+#include "../common.h"
+#include "glapi.h"
+#include "vertexarrays.h"
+
+using namespace v8;
+
+namespace webgl {
+
+// A GL buffer that follows a JS typed array. The parts of the array that
+// changed are uploaded when nextFrame ends the frame, or on flush(). They are
+// either marked with markDirty() or, with a page size, found by comparing the
+// array with a copy of what was uploaded last, page by page. Ranges that are
+// close together are uploaded with one glBufferSubData call.
+class MirroredBuffer {
+public:
+  explicit MirroredBuffer(VertexArrays& vertexArrays);
+  ~MirroredBuffer();
+
+  // mirror is an ArrayBufferView. A pageSize of 0 disables the comparison.
+  // Returns false if the array is empty.
+  bool init(Local<Object> mirror, GLenum usage, GLsizeiptr pageSize);
+
+  GLuint buffer() const { return vertexBuffer; }
+  GLsizeiptr size() const { return bufferSize; }
+
+  // In bytes; clipped to the array.
+  void markDirty(GLintptr offset, GLsizeiptr length);
+
+  // Uploads the dirty ranges. Keeps the GL_ARRAY_BUFFER binding.
+  void flush();
+
+  // Since creation, including the flushes when nextFrame ends the frame.
+  GLsizeiptr uploadedBytes() const { return totalUploaded; }
+
+private:
+  typedef std::pair<GLintptr, GLintptr> Range;
+
+  static void frameListener(void* data);
+
+  unsigned char* contents();
+  void compare(const unsigned char* data);
+  void coalesce();
+
+  VertexArrays& vertexArrays;
+  Nan::Persistent<Object> mirror;
+  GLuint vertexBuffer;
+  GLsizeiptr bufferSize;
+  GLsizeiptr pageSize;
+  std::vector<unsigned char> uploaded;
+  // [begin, end) in bytes.
+  std::vector<Range> dirty;
+  GLsizeiptr totalUploaded;
+};
+
+}
+
+#endif /* MIRROREDBUFFER_H_ */
@@ -0,0 +1,478 @@
+#include <cmath>
+#include <algorithm>
+
+#include "pathrenderer.h"
+#include "glprogram.h"
+
+#ifndef GL_STENCIL
+#define GL_STENCIL 0x1802
+#endif
+#ifndef GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE
+#define GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE 0x2217
+#endif
+
+namespace webgl {
+
+using namespace std;
+
+// Meshes are made again when the scale they are drawn at changes by more than
+// this fraction.
+static const GLfloat SCALE_TOLERANCE = 0.01f;
+
+// The stencil bits that count windings, and those that hold the clip depth.
+static const GLuint WINDING_MASK = 0x0F;
+static const GLuint CLIP_MASK = 0xF0;
+static const int CLIP_SHIFT = 4;
+
+// transformX and transformY are the rows of the paint's transform; view maps
+// pixels, with the origin at the top left, to clip space.
+static const char* VERTEX_SHADER =
+  "ATTRIBUTE vec2 position;\n"
+  "ATTRIBUTE vec2 aa;\n"
+  "uniform vec4 view;\n"
+  "uniform vec3 transformX;\n"
+  "uniform vec3 transformY;\n"
+  "VARYING vec2 edge;\n"
+  "void main() {\n"
+  "  edge = aa;\n"
+  "  vec3 point = vec3(position, 1.0);\n"
+  "  vec2 pixel = vec2(dot(transformX, point), dot(transformY, point));\n"
+  "  gl_Position = vec4(pixel * view.xy + view.zw, 0.0, 1.0);\n"
+  "}\n";
+
+// Fragments covered less than threshold are dropped, so that translucent
+// strokes can lay down their solid middle first.
+static const char* FRAGMENT_SHADER =
+  "VARYING vec2 edge;\n"
+  "uniform vec4 color;\n"
+  "uniform float threshold;\n"
+  "void main() {\n"
+  "  float coverage = clamp(edge.y - abs(edge.x), 0.0, 1.0);\n"
+  "  if (coverage < threshold) discard;\n"
+  "  FRAG_COLOR = vec4(color.rgb, color.a * coverage);\n"
+  "}\n";
+
+// Pixels per path unit, on average over both axes.
+static GLfloat transformScale(const GLfloat* transform) {
+  return sqrt(fabs(transform[0] * transform[3] - transform[1] * transform[2]));
+}
+
+PathRenderer::PathRenderer(const GLExtensions& extensions, VertexArrays& vertexArrays)
+    : extensions(extensions), vertexArrays(vertexArrays) {
+  program = 0;
+  viewLocation = -1;
+  transformXLocation = -1;
+  transformYLocation = -1;
+  colorLocation = -1;
+  thresholdLocation = -1;
+  vertexArray = 0;
+  quadBuffer = 0;
+  nextPath = 1;
+  clipDepth = 0;
+}
+
+PathRenderer::~PathRenderer() {
+  while (!paths.empty()) {
+    deletePath(paths.begin()->first);
+  }
+  if (program) {
+    glDeleteProgram(program);
+  }
+  if (quadBuffer) {
+    glDeleteBuffers(1, &quadBuffer);
+    vertexArrays.deleteBuffer(quadBuffer);
+  }
+  if (vertexArray) {
+    vertexArrays.destroy(vertexArray);
+  }
+}
+
+bool PathRenderer::init() {
+  if (program) {
+    return false;
+  }
+
+  static const char* ATTRIBUTES[] = { "position", "aa", NULL };
+  program = createProgram(extensions, VERTEX_SHADER, FRAGMENT_SHADER, ATTRIBUTES);
+  if (!program) {
+    return false;
+  }
+  viewLocation = glGetUniformLocation(program, "view");
+  transformXLocation = glGetUniformLocation(program, "transformX");
+  transformYLocation = glGetUniformLocation(program, "transformY");
+  colorLocation = glGetUniformLocation(program, "color");
+  thresholdLocation = glGetUniformLocation(program, "threshold");
+
+  GLint previousBuffer = 0;
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousBuffer);
+  static const PathTessellator::Vertex QUAD[] = {
+    { 0, 0, 0, 1 }, { 1, 0, 0, 1 }, { 0, 1, 0, 1 },
+    { 0, 1, 0, 1 }, { 1, 0, 0, 1 }, { 1, 1, 0, 1 }
+  };
+  glGenBuffers(1, &quadBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(QUAD), QUAD, GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+  vertexArrays.bindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+
+  // The attributes are enabled in a vertex array of their own, so that drawing
+  // doesn't disturb the application's.
+  GLuint previousArray = vertexArrays.bound();
+  vertexArray = vertexArrays.create();
+  vertexArrays.bind(vertexArray);
+  for (GLuint i = 0; i < 2; i++) {
+    glEnableVertexAttribArray(i);
+    vertexArrays.enableAttrib(i, true);
+  }
+  vertexArrays.bind(previousArray);
+  return true;
+}
+
+GLuint PathRenderer::createPath() {
+  Path* path = new Path();
+  path->fill.buffer = 0;
+  path->fill.valid = false;
+  path->stroke.buffer = 0;
+  path->stroke.valid = false;
+  GLuint id = nextPath++;
+  paths[id] = path;
+  return id;
+}
+
+PathRenderer::Path* PathRenderer::findPath(GLuint path) {
+  map<GLuint, Path*>::iterator it = paths.find(path);
+  return it != paths.end() ? it->second : NULL;
+}
+
+bool PathRenderer::setPath(GLuint id, const GLfloat* commands, size_t count) {
+  Path* path = findPath(id);
+  if (!path) {
+    return false;
+  }
+  path->fill.valid = false;
+  path->stroke.valid = false;
+  return path->tessellator.setCommands(commands, count);
+}
+
+void PathRenderer::deletePath(GLuint id) {
+  Path* path = findPath(id);
+  if (!path) {
+    return;
+  }
+  GLuint buffers[] = { path->fill.buffer, path->stroke.buffer };
+  for (int i = 0; i < 2; i++) {
+    if (buffers[i]) {
+      glDeleteBuffers(1, &buffers[i]);
+      vertexArrays.deleteBuffer(buffers[i]);
+    }
+  }
+  delete path;
+  paths.erase(id);
+}
+
+// Tessellates the path again unless the cached mesh was made for about the
+// same scale and the same parameters. Returns true if it did.
+bool PathRenderer::update(Path& path, CachedMesh& cached, GLfloat scale, const GLfloat* parameters, bool stroke,
+    const StrokeStyle* style) {
+  bool same = cached.valid && fabs(scale / cached.scale - 1) <= SCALE_TOLERANCE;
+  for (int i = 0; i < 4 && same; i++) {
+    same = parameters[i] == cached.parameters[i];
+  }
+  if (same) {
+    return false;
+  }
+
+  if (stroke) {
+    path.tessellator.stroke(scale, style->width, style->join, style->cap, style->miterLimit, cached.mesh);
+  } else {
+    path.tessellator.fill(scale, parameters[0], cached.mesh);
+  }
+  if (!cached.buffer) {
+    glGenBuffers(1, &cached.buffer);
+  }
+  const vector<PathTessellator::Vertex>& vertices = cached.mesh.vertices;
+  glBindBuffer(GL_ARRAY_BUFFER, cached.buffer);
+  vertexArrays.bindBuffer(GL_ARRAY_BUFFER, cached.buffer);
+  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(PathTessellator::Vertex),
+      vertices.empty() ? NULL : &vertices[0], GL_STATIC_DRAW);
+  // Only the ranges are needed from now on.
+  vector<PathTessellator::Vertex>().swap(cached.mesh.vertices);
+
+  cached.valid = true;
+  cached.scale = scale;
+  copy(parameters, parameters + 4, cached.parameters);
+  return true;
+}
+
+void PathRenderer::begin(SavedState& state, const Paint& paint, GLfloat width, GLfloat height) {
+  glGetIntegerv(GL_CURRENT_PROGRAM, &state.program);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &state.arrayBuffer);
+  state.vertexArray = vertexArrays.bound();
+  state.blend = glIsEnabled(GL_BLEND);
+  glGetIntegerv(GL_BLEND_SRC_RGB, &state.blendFunc[0]);
+  glGetIntegerv(GL_BLEND_DST_RGB, &state.blendFunc[1]);
+  glGetIntegerv(GL_BLEND_SRC_ALPHA, &state.blendFunc[2]);
+  glGetIntegerv(GL_BLEND_DST_ALPHA, &state.blendFunc[3]);
+  glGetIntegerv(GL_BLEND_EQUATION_RGB, &state.blendEquation[0]);
+  glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &state.blendEquation[1]);
+  state.depthTest = glIsEnabled(GL_DEPTH_TEST);
+  state.cullFace = glIsEnabled(GL_CULL_FACE);
+  state.stencilTest = glIsEnabled(GL_STENCIL_TEST);
+  glGetIntegerv(GL_STENCIL_FUNC, &state.stencilFunc[0][0]);
+  glGetIntegerv(GL_STENCIL_REF, &state.stencilFunc[0][1]);
+  glGetIntegerv(GL_STENCIL_VALUE_MASK, &state.stencilFunc[0][2]);
+  glGetIntegerv(GL_STENCIL_BACK_FUNC, &state.stencilFunc[1][0]);
+  glGetIntegerv(GL_STENCIL_BACK_REF, &state.stencilFunc[1][1]);
+  glGetIntegerv(GL_STENCIL_BACK_VALUE_MASK, &state.stencilFunc[1][2]);
+  glGetIntegerv(GL_STENCIL_FAIL, &state.stencilOp[0][0]);
+  glGetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, &state.stencilOp[0][1]);
+  glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, &state.stencilOp[0][2]);
+  glGetIntegerv(GL_STENCIL_BACK_FAIL, &state.stencilOp[1][0]);
+  glGetIntegerv(GL_STENCIL_BACK_PASS_DEPTH_FAIL, &state.stencilOp[1][1]);
+  glGetIntegerv(GL_STENCIL_BACK_PASS_DEPTH_PASS, &state.stencilOp[1][2]);
+  glGetIntegerv(GL_STENCIL_WRITEMASK, &state.stencilWriteMask[0]);
+  glGetIntegerv(GL_STENCIL_BACK_WRITEMASK, &state.stencilWriteMask[1]);
+  glGetBooleanv(GL_COLOR_WRITEMASK, state.colorMask);
+
+  glUseProgram(program);
+  glUniform4f(viewLocation, 2 / width, -2 / height, -1, 1);
+  const GLfloat* t = paint.transform;
+  glUniform3f(transformXLocation, t[0], t[2], t[4]);
+  glUniform3f(transformYLocation, t[1], t[3], t[5]);
+  glUniform4f(colorLocation, paint.color[0], paint.color[1], paint.color[2], paint.color[3]);
+  glUniform1f(thresholdLocation, 0);
+  vertexArrays.bind(vertexArray);
+
+  // Paths are ordered by when they are drawn, not by depth, and either winding
+  // follows from their transforms.
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_CULL_FACE);
+  glEnable(GL_BLEND);
+  glBlendEquation(GL_FUNC_ADD);
+  glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+  // Everything that is drawn stays inside the clip.
+  if (clipDepth) {
+    glEnable(GL_STENCIL_TEST);
+    glStencilMask(0);
+    glStencilFunc(GL_EQUAL, clipDepth << CLIP_SHIFT, CLIP_MASK);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+  } else {
+    glDisable(GL_STENCIL_TEST);
+  }
+}
+
+void PathRenderer::end(const SavedState& state) {
+  vertexArrays.bind(state.vertexArray);
+  glBindBuffer(GL_ARRAY_BUFFER, state.arrayBuffer);
+  vertexArrays.bindBuffer(GL_ARRAY_BUFFER, state.arrayBuffer);
+  glUseProgram(state.program);
+  glBlendEquationSeparate(state.blendEquation[0], state.blendEquation[1]);
+  glBlendFuncSeparate(state.blendFunc[0], state.blendFunc[1], state.blendFunc[2], state.blendFunc[3]);
+  static const GLenum FACES[] = { GL_FRONT, GL_BACK };
+  for (int i = 0; i < 2; i++) {
+    glStencilFuncSeparate(FACES[i], state.stencilFunc[i][0], state.stencilFunc[i][1], state.stencilFunc[i][2]);
+    glStencilOpSeparate(FACES[i], state.stencilOp[i][0], state.stencilOp[i][1], state.stencilOp[i][2]);
+    glStencilMaskSeparate(FACES[i], state.stencilWriteMask[i]);
+  }
+  glColorMask(state.colorMask[0], state.colorMask[1], state.colorMask[2], state.colorMask[3]);
+
+  const GLenum capabilities[] = { GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_STENCIL_TEST };
+  const GLboolean enabled[] = { state.blend, state.depthTest, state.cullFace, state.stencilTest };
+  for (int i = 0; i < 4; i++) {
+    if (enabled[i]) {
+      glEnable(capabilities[i]);
+    } else {
+      glDisable(capabilities[i]);
+    }
+  }
+}
+
+void PathRenderer::use(GLuint buffer) {
+  const GLsizei stride = sizeof(PathTessellator::Vertex);
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  vertexArrays.bindBuffer(GL_ARRAY_BUFFER, buffer);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid *) 0);
+  vertexArrays.attribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, 0);
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid *) 8);
+  vertexArrays.attribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, 8);
+}
+
+// The winding counts and clip depths need eight bits.
+bool PathRenderer::hasStencil() {
+  GLint bits = 0;
+  if (extensions.coreProfile) {
+    // Core profiles don't have GL_STENCIL_BITS.
+    GLint framebuffer = 0, type = GL_NONE;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    GLenum attachment = framebuffer ? GL_STENCIL_ATTACHMENT : GL_STENCIL;
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+    if (type != GL_NONE) {
+      glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &bits);
+    }
+  } else {
+    glGetIntegerv(GL_STENCIL_BITS, &bits);
+  }
+  return bits >= 8;
+}
+
+void PathRenderer::drawRange(GLint first, GLsizei count) {
+  if (count) {
+    glDrawArrays(GL_TRIANGLES, first, count);
+  }
+}
+
+// Paths that need the stencil buffer count the windings of their fans into its
+// low bits, draw the fringe outside, and cover the inside, clearing the counts
+// again.
+bool PathRenderer::fill(GLuint id, const Paint& paint, GLfloat feather, GLfloat width, GLfloat height) {
+  Path* path = findPath(id);
+  if (!program || !path) {
+    return false;
+  }
+  GLfloat scale = transformScale(paint.transform);
+  if (scale <= 0 || width <= 0 || height <= 0) {
+    return true;
+  }
+
+  SavedState state;
+  begin(state, paint, width, height);
+  const GLfloat parameters[] = { max(feather, 0.0f), 0, 0, 0 };
+  update(*path, path->fill, scale, parameters, false, NULL);
+  use(path->fill.buffer);
+
+  const PathTessellator::Mesh& mesh = path->fill.mesh;
+  GLint ref = clipDepth << CLIP_SHIFT;
+  if (mesh.stencil && hasStencil()) {
+    glEnable(GL_STENCIL_TEST);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glStencilMask(WINDING_MASK);
+    glStencilFunc(GL_EQUAL, ref, CLIP_MASK);
+    glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP);
+    glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP);
+    drawRange(mesh.fillFirst, mesh.fillCount);
+
+    glColorMask(state.colorMask[0], state.colorMask[1], state.colorMask[2], state.colorMask[3]);
+    glStencilFunc(GL_EQUAL, ref, CLIP_MASK | WINDING_MASK);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    drawRange(mesh.fringeFirst, mesh.fringeCount);
+
+    // Writes the clip depth back, which only clears the counts.
+    glStencilFunc(GL_NOTEQUAL, ref, WINDING_MASK);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    drawRange(mesh.coverFirst, mesh.coverCount);
+  } else {
+    drawRange(mesh.fillFirst, mesh.fillCount);
+    drawRange(mesh.fringeFirst, mesh.fringeCount);
+  }
+
+  end(state);
+  return true;
+}
+
+// Where parts of a translucent stroke overlap, the solid middle is drawn once,
+// marked in the stencil buffer, then the fading edges around it, and the marks
+// are cleared again.
+bool PathRenderer::stroke(GLuint id, const Paint& paint, const StrokeStyle& style, GLfloat width, GLfloat height) {
+  Path* path = findPath(id);
+  if (!program || !path) {
+    return false;
+  }
+  GLfloat scale = transformScale(paint.transform);
+  if (scale <= 0 || style.width <= 0 || width <= 0 || height <= 0) {
+    return true;
+  }
+
+  SavedState state;
+  begin(state, paint, width, height);
+  const GLfloat parameters[] = { style.width, (GLfloat) style.join, (GLfloat) style.cap, style.miterLimit };
+  update(*path, path->stroke, scale, parameters, true, &style);
+  use(path->stroke.buffer);
+
+  const PathTessellator::Mesh& mesh = path->stroke.mesh;
+  GLint ref = clipDepth << CLIP_SHIFT;
+  if (paint.color[3] < 1 && hasStencil()) {
+    glEnable(GL_STENCIL_TEST);
+    glStencilMask(WINDING_MASK);
+    glStencilFunc(GL_EQUAL, ref, CLIP_MASK | WINDING_MASK);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+    glUniform1f(thresholdLocation, 1 - 0.5f / 255);
+    drawRange(mesh.fillFirst, mesh.fillCount);
+
+    glUniform1f(thresholdLocation, 0);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    drawRange(mesh.fillFirst, mesh.fillCount);
+
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glStencilFunc(GL_NOTEQUAL, ref, WINDING_MASK);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    drawRange(mesh.fillFirst, mesh.fillCount);
+  } else {
+    drawRange(mesh.fillFirst, mesh.fillCount);
+  }
+
+  end(state);
+  return true;
+}
+
+// The fans count windings where the clip is as deep as it is now, and the
+// pixels inside get the next depth, which clears their counts.
+bool PathRenderer::pushClip(GLuint id, const Paint& paint, GLfloat width, GLfloat height) {
+  Path* path = findPath(id);
+  if (!program || !path || clipDepth >= MAX_CLIP_DEPTH || width <= 0 || height <= 0 || !hasStencil()) {
+    return false;
+  }
+  GLfloat scale = transformScale(paint.transform);
+
+  SavedState state;
+  begin(state, paint, width, height);
+  // A degenerate transform clips everything away.
+  if (scale > 0) {
+    const GLfloat parameters[] = { 0, 0, 0, 0 };
+    update(*path, path->fill, scale, parameters, false, NULL);
+    use(path->fill.buffer);
+
+    const PathTessellator::Mesh& mesh = path->fill.mesh;
+    glEnable(GL_STENCIL_TEST);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glStencilMask(WINDING_MASK);
+    glStencilFunc(GL_EQUAL, clipDepth << CLIP_SHIFT, CLIP_MASK);
+    glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP);
+    glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP);
+    drawRange(mesh.fillFirst, mesh.fillCount);
+
+    glStencilMask(CLIP_MASK | WINDING_MASK);
+    glStencilFunc(GL_NOTEQUAL, (clipDepth + 1) << CLIP_SHIFT, WINDING_MASK);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    drawRange(mesh.fillFirst, mesh.fillCount);
+  }
+  end(state);
+
+  clipDepth++;
+  return true;
+}
+
+// Pixels deeper than the clip that is left are set back to its depth.
+void PathRenderer::popClip(GLfloat width, GLfloat height) {
+  if (!program || !clipDepth) {
+    return;
+  }
+  clipDepth--;
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  Paint paint = { { 0, 0, 0, 0 }, { width, 0, 0, height, 0, 0 } };
+  SavedState state;
+  begin(state, paint, width, height);
+  use(quadBuffer);
+  glEnable(GL_STENCIL_TEST);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  glStencilMask(CLIP_MASK | WINDING_MASK);
+  glStencilFunc(GL_LESS, clipDepth << CLIP_SHIFT, CLIP_MASK);
+  glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+  drawRange(0, 6);
+  end(state);
+}
+
+} // end namespace webgl
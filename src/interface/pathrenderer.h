@@ -0,0 +1,139 @@
+#ifndef PATHRENDERER_H_
+#define PATHRENDERER_H_
+
+#include <map>
+#include <vector>
+
+#include "glapi.h"
+#include "glext.h"
+#include "vertexarrays.h"
+#include "pathtessellator.h"
+
+namespace webgl {
+
+// Fills and strokes 2D paths, and clips to them, in pixel coordinates with the
+// origin at the top left.
+//
+// Paths are tessellated by a PathTessellator into vertex buffers of their own,
+// which are kept until the path changes or is drawn at another scale (a fill
+// and a stroke each); moving or rotating a path reuses them. Edges are
+// anti-aliased in the fragment shader, without multisampling.
+//
+// The stencil buffer is needed to fill paths that aren't a single convex
+// contour, to draw translucent strokes without darker overlaps, and for clips.
+// Its low four bits count windings and its high four bits hold the depth of
+// the clip that covers each pixel, so clips nest up to 15 deep. It must be
+// cleared to 0 before the first clip; clearing it drops all clips, which
+// resetClip() has to be told about. Without a stencil buffer, such fills
+// come out as triangle fans and clips fail.
+class PathRenderer {
+public:
+  struct Paint {
+    GLfloat color[4];
+    // The matrix a, b, c, d and translation e, f from path to pixel
+    // coordinates, in the order of the canvas transform().
+    GLfloat transform[6];
+  };
+
+  struct StrokeStyle {
+    GLfloat width;
+    PathTessellator::Join join;
+    PathTessellator::Cap cap;
+    GLfloat miterLimit;
+  };
+
+  static const GLuint MAX_CLIP_DEPTH = 15;
+
+  PathRenderer(const GLExtensions& extensions, VertexArrays& vertexArrays);
+  ~PathRenderer();
+
+  // Returns false if the program can't be created.
+  bool init();
+
+  GLuint createPath();
+  // Takes the commands described in PathTessellator. Returns false if they are
+  // malformed, leaving the path empty.
+  bool setPath(GLuint path, const GLfloat* commands, size_t count);
+  void deletePath(GLuint path);
+
+  // Draw into the current framebuffer in a viewport that covers width x height
+  // pixels, inside the current clip. Fills fade out over feather pixels at
+  // their edges, for soft shadows, or over one pixel. Return false if the path
+  // doesn't exist. Leave the GL state as it was.
+  bool fill(GLuint path, const Paint& paint, GLfloat feather, GLfloat width, GLfloat height);
+  bool stroke(GLuint path, const Paint& paint, const StrokeStyle& style, GLfloat width, GLfloat height);
+
+  // Intersects the clip with the path, placed by the paint's transform; its
+  // colour doesn't matter. Clip edges are not anti-aliased. Returns false if
+  // there is no stencil buffer, the path doesn't exist or the clips are
+  // nested too deep.
+  bool pushClip(GLuint path, const Paint& paint, GLfloat width, GLfloat height);
+  // Goes back to the clip before the last pushClip.
+  void popClip(GLfloat width, GLfloat height);
+  // Forgets all clips, after the stencil buffer was cleared.
+  void resetClip() { clipDepth = 0; }
+  GLuint clips() const { return clipDepth; }
+
+private:
+  // A tessellation uploaded to a buffer, with the parameters it was made for.
+  struct CachedMesh {
+    GLuint buffer;
+    bool valid;
+    GLfloat scale;
+    GLfloat parameters[4];
+    PathTessellator::Mesh mesh;
+  };
+
+  struct Path {
+    PathTessellator tessellator;
+    CachedMesh fill;
+    CachedMesh stroke;
+  };
+
+  // GL state that drawing changes.
+  struct SavedState {
+    GLint program;
+    GLint arrayBuffer;
+    GLuint vertexArray;
+    GLboolean blend;
+    GLint blendFunc[4];
+    GLint blendEquation[2];
+    GLboolean depthTest;
+    GLboolean cullFace;
+    GLboolean stencilTest;
+    GLint stencilFunc[2][3];
+    GLint stencilOp[2][3];
+    GLint stencilWriteMask[2];
+    GLboolean colorMask[4];
+  };
+
+  Path* findPath(GLuint path);
+  bool update(Path& path, CachedMesh& cached, GLfloat scale, const GLfloat* parameters, bool stroke,
+      const StrokeStyle* style);
+  void begin(SavedState& state, const Paint& paint, GLfloat width, GLfloat height);
+  void end(const SavedState& state);
+  void use(GLuint buffer);
+  bool hasStencil();
+  void drawRange(GLint first, GLsizei count);
+
+  const GLExtensions& extensions;
+  VertexArrays& vertexArrays;
+
+  GLuint program;
+  GLint viewLocation;
+  GLint transformXLocation;
+  GLint transformYLocation;
+  GLint colorLocation;
+  GLint thresholdLocation;
+  GLuint vertexArray;
+  // A unit square, scaled to the viewport to reset clips.
+  GLuint quadBuffer;
+
+  std::map<GLuint, Path*> paths;
+  GLuint nextPath;
+  GLuint clipDepth;
+};
+
+}
+
+#endif /* PATHRENDERER_H_ */
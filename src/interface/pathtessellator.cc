@@ -0,0 +1,484 @@
+#include <cmath>
+#include <algorithm>
+
+#include "pathtessellator.h"
+
+namespace webgl {
+
+using namespace std;
+
+static const GLfloat PI = 3.14159265358979f;
+
+// Flattened curves stay within this many pixels of the exact ones.
+static const GLfloat TOLERANCE = 0.25f;
+
+// Offsets of fill fringes are limited to this many times their width at
+// sharp corners.
+static const GLfloat FRINGE_MITER_LIMIT = 4;
+
+static const GLuint MAX_CURVE_SEGMENTS = 256;
+
+// The number of arguments of each command.
+static const size_t ARGUMENTS[] = { 2, 2, 4, 6, 0, 6, 4, 5 };
+
+// The number of segments that keeps an arc through angle radians within
+// tolerance of its circle.
+static GLuint arcSegments(GLfloat angle, GLfloat radius, GLfloat tolerance) {
+  if (radius <= tolerance) {
+    return 1;
+  }
+  GLfloat step = 2 * acos(1 - tolerance / radius);
+  return min(max((GLuint) ceil(fabs(angle) / step), 1u), MAX_CURVE_SEGMENTS);
+}
+
+PathTessellator::PathTessellator() {
+  flattenedScale = 0;
+}
+
+bool PathTessellator::setCommands(const GLfloat* commands, size_t count) {
+  this->commands.clear();
+  flattenedScale = 0;
+  for (size_t i = 0; i < count; i += 1 + ARGUMENTS[(size_t) commands[i]]) {
+    if (!(commands[i] >= MOVE_TO && commands[i] <= ROUND_RECT) || i + 1 + ARGUMENTS[(size_t) commands[i]] > count) {
+      return false;
+    }
+  }
+  this->commands.assign(commands, commands + count);
+  return true;
+}
+
+void PathTessellator::addPoint(GLfloat x, GLfloat y) {
+  Contour& contour = contours.back();
+  if (contour.count) {
+    const Point& last = points.back();
+    if (fabs(last.x - x) < 1e-6f && fabs(last.y - y) < 1e-6f) {
+      return;
+    }
+  }
+  Point point = { x, y };
+  points.push_back(point);
+  contour.count++;
+}
+
+// The number of points of a contour as a closed one, which leaves out a last
+// point that comes back to the first, as after full circles.
+size_t PathTessellator::closedCount(const Contour& contour) const {
+  const Point& first = points[contour.first];
+  const Point& last = points[contour.first + contour.count - 1];
+  if (contour.count > 1 && fabs(last.x - first.x) < 1e-3f / flattenedScale &&
+      fabs(last.y - first.y) < 1e-3f / flattenedScale) {
+    return contour.count - 1;
+  }
+  return contour.count;
+}
+
+void PathTessellator::startContour(GLfloat x, GLfloat y) {
+  Contour contour = { points.size(), 0, false };
+  contours.push_back(contour);
+  addPoint(x, y);
+}
+
+// Follows canvas: the sweep is limited to a full turn, and goes the other way
+// round when the angles are the wrong way round for the direction.
+void PathTessellator::arc(GLfloat cx, GLfloat cy, GLfloat radius, GLfloat start, GLfloat end, bool counterclockwise,
+    GLfloat tolerance) {
+  radius = max(radius, 0.0f);
+  GLfloat sweep = end - start;
+  if (!counterclockwise) {
+    sweep = sweep >= 2 * PI ? 2 * PI : sweep < 0 ? fmod(sweep, 2 * PI) + 2 * PI : sweep;
+  } else {
+    sweep = sweep <= -2 * PI ? -2 * PI : sweep > 0 ? fmod(sweep, 2 * PI) - 2 * PI : sweep;
+  }
+
+  GLuint segments = arcSegments(sweep, radius, tolerance);
+  for (GLuint i = 0; i <= segments; i++) {
+    GLfloat angle = start + sweep * i / segments;
+    GLfloat x = cx + cos(angle) * radius;
+    GLfloat y = cy + sin(angle) * radius;
+    if (!i && contours.empty()) {
+      startContour(x, y);
+    } else {
+      addPoint(x, y);
+    }
+  }
+}
+
+void PathTessellator::flatten(GLfloat scale) {
+  if (scale == flattenedScale) {
+    return;
+  }
+  flattenedScale = scale;
+  points.clear();
+  contours.clear();
+
+  GLfloat tolerance = TOLERANCE / scale;
+  // The current point, where a new contour starts if there is none.
+  GLfloat x = 0, y = 0;
+  bool open = false;
+  for (size_t i = 0; i < commands.size(); i += 1 + ARGUMENTS[(size_t) commands[i]]) {
+    const GLfloat* a = &commands[i + 1];
+    Command command = (Command) (GLuint) commands[i];
+    if (command == MOVE_TO) {
+      startContour(a[0], a[1]);
+      open = true;
+    } else if (command == CLOSE) {
+      if (open) {
+        Contour& contour = contours.back();
+        contour.count = closedCount(contour);
+        points.resize(contour.first + contour.count);
+        contour.closed = true;
+        x = points[contour.first].x;
+        y = points[contour.first].y;
+        open = false;
+      }
+      continue;
+    } else if (command == RECT || command == ROUND_RECT) {
+      GLfloat left = min(a[0], a[0] + a[2]), top = min(a[1], a[1] + a[3]);
+      GLfloat right = max(a[0], a[0] + a[2]), bottom = max(a[1], a[1] + a[3]);
+      GLfloat r = command == ROUND_RECT ? min(max(a[4], 0.0f), min(right - left, bottom - top) / 2) : 0;
+      startContour(left + r, top);
+      arc(right - r, top + r, r, -PI / 2, 0, false, tolerance);
+      arc(right - r, bottom - r, r, 0, PI / 2, false, tolerance);
+      arc(left + r, bottom - r, r, PI / 2, PI, false, tolerance);
+      arc(left + r, top + r, r, PI, 3 * PI / 2, false, tolerance);
+      Contour& contour = contours.back();
+      contour.count = closedCount(contour);
+      points.resize(contour.first + contour.count);
+      contour.closed = true;
+      x = left;
+      y = top;
+      open = false;
+      continue;
+    } else {
+      // Without an open contour, one starts at the current point, or where
+      // the command does if there is none.
+      if (!open && !contours.empty()) {
+        startContour(x, y);
+      } else if (!open && command != ARC) {
+        startContour(a[0], a[1]);
+      }
+      open = true;
+      GLfloat x0 = x, y0 = y;
+      if (!contours.empty()) {
+        x0 = points.back().x;
+        y0 = points.back().y;
+      }
+      if (command == LINE_TO) {
+        addPoint(a[0], a[1]);
+      } else if (command == QUADRATIC_TO) {
+        GLfloat dx = x0 - 2 * a[0] + a[2], dy = y0 - 2 * a[1] + a[3];
+        GLuint segments = min(max((GLuint) ceil(sqrt(sqrt(dx * dx + dy * dy) / (4 * tolerance))), 1u),
+            MAX_CURVE_SEGMENTS);
+        for (GLuint s = 1; s <= segments; s++) {
+          GLfloat t = (GLfloat) s / segments, u = 1 - t;
+          addPoint(u * u * x0 + 2 * u * t * a[0] + t * t * a[2], u * u * y0 + 2 * u * t * a[1] + t * t * a[3]);
+        }
+      } else if (command == CUBIC_TO) {
+        GLfloat dx0 = x0 - 2 * a[0] + a[2], dy0 = y0 - 2 * a[1] + a[3];
+        GLfloat dx1 = a[0] - 2 * a[2] + a[4], dy1 = a[1] - 2 * a[3] + a[5];
+        GLfloat d = max(sqrt(dx0 * dx0 + dy0 * dy0), sqrt(dx1 * dx1 + dy1 * dy1));
+        GLuint segments = min(max((GLuint) ceil(sqrt(0.75f * d / tolerance)), 1u), MAX_CURVE_SEGMENTS);
+        for (GLuint s = 1; s <= segments; s++) {
+          GLfloat t = (GLfloat) s / segments, u = 1 - t;
+          GLfloat b0 = u * u * u, b1 = 3 * u * u * t, b2 = 3 * u * t * t, b3 = t * t * t;
+          addPoint(b0 * x0 + b1 * a[0] + b2 * a[2] + b3 * a[4], b0 * y0 + b1 * a[1] + b2 * a[3] + b3 * a[5]);
+        }
+      } else {
+        arc(a[0], a[1], a[2], a[3], a[4], a[5] != 0, tolerance);
+      }
+    }
+    x = points.back().x;
+    y = points.back().y;
+  }
+}
+
+// A single contour that turns the same way at every point, and only once
+// round.
+bool PathTessellator::isConvex() const {
+  if (contours.size() != 1) {
+    return false;
+  }
+  const Point* p = &points[contours[0].first];
+  size_t n = closedCount(contours[0]);
+  GLfloat sign = 0, turn = 0;
+  for (size_t i = 0; i < n; i++) {
+    const Point& a = p[(i + n - 1) % n];
+    const Point& b = p[i];
+    const Point& c = p[(i + 1) % n];
+    GLfloat cross = (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+    GLfloat dot = (b.x - a.x) * (c.x - b.x) + (b.y - a.y) * (c.y - b.y);
+    if (fabs(cross) > 1e-9f) {
+      if (sign * cross < 0) {
+        return false;
+      }
+      sign = cross;
+    }
+    turn += atan2(cross, dot);
+  }
+  return fabs(turn) < 2 * PI + 0.1f;
+}
+
+static void addVertex(PathTessellator::Mesh& mesh, GLfloat x, GLfloat y, GLfloat aaX, GLfloat aaY) {
+  PathTessellator::Vertex vertex = { x, y, aaX, aaY };
+  mesh.vertices.push_back(vertex);
+}
+
+void PathTessellator::fill(GLfloat scale, GLfloat feather, Mesh& mesh) {
+  flatten(scale);
+  mesh.vertices.clear();
+  mesh.stencil = !isConvex();
+
+  // Fringes are offset along the outward normals, which point to the right
+  // of contours that wind the way the path mostly does.
+  GLfloat area = 0;
+  for (size_t c = 0; c < contours.size(); c++) {
+    const Point* p = &points[contours[c].first];
+    size_t n = closedCount(contours[c]);
+    for (size_t i = 0; i < n; i++) {
+      const Point& a = p[i];
+      const Point& b = p[(i + 1) % n];
+      area += a.x * b.y - b.x * a.y;
+    }
+  }
+  GLfloat orientation = area < 0 ? -1 : 1;
+  GLfloat fringe = max(feather, 1.0f) / scale;
+
+  // Convex paths are filled to the middle of their fringes; stencilled ones
+  // to the contour, with the fringe outside, where the stencil test lets it
+  // through.
+  GLfloat inset = mesh.stencil ? 0 : fringe / 2;
+  inner.resize(points.size());
+  outer.resize(points.size());
+  mesh.fillFirst = 0;
+  for (size_t c = 0; c < contours.size(); c++) {
+    const Contour& contour = contours[c];
+    const Point* p = &points[contour.first];
+    size_t n = closedCount(contour);
+    if (n < 3) {
+      continue;
+    }
+    for (size_t i = 0; i < n; i++) {
+      const Point& previous = p[(i + n - 1) % n];
+      const Point& b = p[i];
+      const Point& next = p[(i + 1) % n];
+      GLfloat l0 = sqrt((b.x - previous.x) * (b.x - previous.x) + (b.y - previous.y) * (b.y - previous.y));
+      GLfloat l1 = sqrt((next.x - b.x) * (next.x - b.x) + (next.y - b.y) * (next.y - b.y));
+      GLfloat nx = 0, ny = 0;
+      if (l0 > 0) {
+        nx += orientation * (b.y - previous.y) / l0 / 2;
+        ny -= orientation * (b.x - previous.x) / l0 / 2;
+      }
+      if (l1 > 0) {
+        nx += orientation * (next.y - b.y) / l1 / 2;
+        ny -= orientation * (next.x - b.x) / l1 / 2;
+      }
+      // The miter offset for a unit distance from both edges.
+      GLfloat length = sqrt(nx * nx + ny * ny);
+      GLfloat miter = length > 1e-6f ? min(1 / length, FRINGE_MITER_LIMIT) / length : 0;
+      Point in = { b.x - nx * miter * inset, b.y - ny * miter * inset };
+      Point out = { b.x + nx * miter * (fringe - inset), b.y + ny * miter * (fringe - inset) };
+      inner[contour.first + i] = in;
+      outer[contour.first + i] = out;
+    }
+
+    const Point* fan = mesh.stencil ? p : &inner[contour.first];
+    for (size_t i = 1; i + 1 < n; i++) {
+      addVertex(mesh, fan[0].x, fan[0].y, 0, 1);
+      addVertex(mesh, fan[i].x, fan[i].y, 0, 1);
+      addVertex(mesh, fan[i + 1].x, fan[i + 1].y, 0, 1);
+    }
+  }
+  mesh.fillCount = mesh.vertices.size();
+
+  mesh.fringeFirst = mesh.vertices.size();
+  for (size_t c = 0; c < contours.size(); c++) {
+    size_t n = closedCount(contours[c]);
+    if (n < 3) {
+      continue;
+    }
+    const Point* in = &inner[contours[c].first];
+    const Point* out = &outer[contours[c].first];
+    for (size_t i = 0; i < n; i++) {
+      size_t j = (i + 1) % n;
+      addVertex(mesh, in[i].x, in[i].y, 0, 1);
+      addVertex(mesh, out[i].x, out[i].y, 0, 0);
+      addVertex(mesh, in[j].x, in[j].y, 0, 1);
+      addVertex(mesh, in[j].x, in[j].y, 0, 1);
+      addVertex(mesh, out[i].x, out[i].y, 0, 0);
+      addVertex(mesh, out[j].x, out[j].y, 0, 0);
+    }
+  }
+  mesh.fringeCount = mesh.vertices.size() - mesh.fringeFirst;
+
+  // Stencilled fills are covered by their bounds, fringes included.
+  mesh.coverFirst = mesh.vertices.size();
+  if (mesh.stencil && mesh.fillCount) {
+    GLfloat left = points[0].x, top = points[0].y, right = left, bottom = top;
+    for (size_t i = 1; i < points.size(); i++) {
+      left = min(left, points[i].x);
+      top = min(top, points[i].y);
+      right = max(right, points[i].x);
+      bottom = max(bottom, points[i].y);
+    }
+    left -= fringe;
+    top -= fringe;
+    right += fringe;
+    bottom += fringe;
+    addVertex(mesh, left, top, 0, 1);
+    addVertex(mesh, right, top, 0, 1);
+    addVertex(mesh, left, bottom, 0, 1);
+    addVertex(mesh, left, bottom, 0, 1);
+    addVertex(mesh, right, top, 0, 1);
+    addVertex(mesh, right, bottom, 0, 1);
+  }
+  mesh.coverCount = mesh.vertices.size() - mesh.coverFirst;
+}
+
+void PathTessellator::addPair(GLfloat leftX, GLfloat leftY, GLfloat rightX, GLfloat rightY, GLfloat leftSide,
+    GLfloat rightSide) {
+  Pair pair = { { leftX, leftY }, { rightX, rightY }, leftSide, rightSide };
+  pairs.push_back(pair);
+}
+
+// Joins the segments into and out of point, with a bevel where a miter would
+// be longer than miterLimit half widths. Where the inner corner would reach
+// past the end of a segment, both segments end square at the point instead,
+// and the join is drawn around it.
+void PathTessellator::join(const Point& previous, const Point& point, const Point& next, GLfloat halfWidth,
+    Join join, GLfloat miterLimit, GLfloat tolerance) {
+  GLfloat dx0 = point.x - previous.x, dy0 = point.y - previous.y;
+  GLfloat dx1 = next.x - point.x, dy1 = next.y - point.y;
+  GLfloat l0 = sqrt(dx0 * dx0 + dy0 * dy0), l1 = sqrt(dx1 * dx1 + dy1 * dy1);
+  dx0 /= l0;
+  dy0 /= l0;
+  dx1 /= l1;
+  dy1 /= l1;
+  // The normals to the left of both segments.
+  GLfloat nx0 = -dy0, ny0 = dx0, nx1 = -dy1, ny1 = dx1;
+  GLfloat cross = dx0 * dy1 - dy0 * dx1;
+  GLfloat mx = (nx0 + nx1) / 2, my = (ny0 + ny1) / 2;
+  GLfloat m2 = mx * mx + my * my;
+  bool hairpin = m2 < 1e-6f;
+  // The distance to the miter corners, in half widths.
+  GLfloat miter = hairpin ? 0 : 1 / sqrt(m2);
+  bool clamped = hairpin || miter * halfWidth > max(halfWidth, min(l0, l1));
+  // 1 if the outer corner is on the left, -1 if it is on the right.
+  GLfloat side = hairpin || cross < 0 ? 1 : -1;
+
+  GLfloat ix = point.x, iy = point.y, innerSide = 0;
+  if (!clamped) {
+    ix -= side * mx / m2 * halfWidth;
+    iy -= side * my / m2 * halfWidth;
+    innerSide = -side;
+  }
+  corners.clear();
+  if (join == JOIN_MITER && !hairpin && miter <= miterLimit) {
+    Point corner = { point.x + side * mx / m2 * halfWidth, point.y + side * my / m2 * halfWidth };
+    corners.push_back(corner);
+  } else if (join == JOIN_ROUND) {
+    GLfloat angle = hairpin ? PI : acos(max(min(nx0 * nx1 + ny0 * ny1, 1.0f), -1.0f));
+    GLfloat direction = !hairpin && cross >= 0 ? 1 : -1;
+    GLuint segments = arcSegments(angle, halfWidth, tolerance);
+    for (GLuint k = 0; k <= segments; k++) {
+      GLfloat a = direction * angle * k / segments;
+      Point corner = { point.x + side * (nx0 * cos(a) - ny0 * sin(a)) * halfWidth,
+          point.y + side * (nx0 * sin(a) + ny0 * cos(a)) * halfWidth };
+      corners.push_back(corner);
+    }
+  } else {
+    Point first = { point.x + side * nx0 * halfWidth, point.y + side * ny0 * halfWidth };
+    Point second = { point.x + side * nx1 * halfWidth, point.y + side * ny1 * halfWidth };
+    corners.push_back(first);
+    corners.push_back(second);
+  }
+
+  if (clamped) {
+    addPair(point.x + nx0 * halfWidth, point.y + ny0 * halfWidth, point.x - nx0 * halfWidth, point.y - ny0 * halfWidth);
+  }
+  for (size_t k = 0; k < corners.size(); k++) {
+    if (side > 0) {
+      addPair(corners[k].x, corners[k].y, ix, iy, 1, innerSide);
+    } else {
+      addPair(ix, iy, corners[k].x, corners[k].y, innerSide, -1);
+    }
+  }
+  if (clamped) {
+    addPair(point.x + nx1 * halfWidth, point.y + ny1 * halfWidth, point.x - nx1 * halfWidth, point.y - ny1 * halfWidth);
+  }
+}
+
+// Starts or ends a stroke at point, where it goes in direction dx, dy. Square
+// caps reach extension past the point.
+void PathTessellator::cap(const Point& point, GLfloat dx, GLfloat dy, bool start, GLfloat halfWidth,
+    GLfloat extension, Cap cap, GLfloat tolerance) {
+  GLfloat nx = -dy, ny = dx;
+  GLfloat forward = start ? -1 : 1;
+  if (cap == CAP_ROUND) {
+    GLuint segments = arcSegments(PI / 2, halfWidth, tolerance);
+    for (GLuint k = 0; k <= segments; k++) {
+      GLfloat a = PI / 2 * (start ? k : segments - k) / segments;
+      GLfloat along = forward * cos(a) * halfWidth, across = sin(a) * halfWidth;
+      GLfloat x = point.x + dx * along, y = point.y + dy * along;
+      addPair(x + nx * across, y + ny * across, x - nx * across, y - ny * across);
+    }
+  } else {
+    GLfloat along = cap == CAP_SQUARE ? forward * extension : 0;
+    GLfloat x = point.x + dx * along, y = point.y + dy * along;
+    addPair(x + nx * halfWidth, y + ny * halfWidth, x - nx * halfWidth, y - ny * halfWidth);
+  }
+}
+
+void PathTessellator::stroke(GLfloat scale, GLfloat width, Join join, Cap cap, GLfloat miterLimit, Mesh& mesh) {
+  flatten(scale);
+  mesh.vertices.clear();
+  mesh.stencil = false;
+  mesh.fillFirst = 0;
+
+  GLfloat halfWidth = width / 2;
+  // Strokes are half a pixel wider on each side, where they fade out.
+  GLfloat outline = halfWidth + 0.5f / scale;
+  GLfloat aa = halfWidth * scale + 0.5f;
+  GLfloat tolerance = TOLERANCE / scale;
+  for (size_t c = 0; c < contours.size() && halfWidth > 0; c++) {
+    const Contour& contour = contours[c];
+    if (contour.count < 2) {
+      continue;
+    }
+    const Point* p = &points[contour.first];
+    size_t n = contour.count;
+    pairs.clear();
+    if (contour.closed && n >= 3) {
+      for (size_t i = 0; i < n; i++) {
+        this->join(p[(i + n - 1) % n], p[i], p[(i + 1) % n], outline, join, miterLimit, tolerance);
+      }
+      Pair first = pairs[0];
+      pairs.push_back(first);
+    } else {
+      GLfloat dx = p[1].x - p[0].x, dy = p[1].y - p[0].y, length = sqrt(dx * dx + dy * dy);
+      this->cap(p[0], dx / length, dy / length, true, outline, halfWidth, cap, tolerance);
+      for (size_t i = 1; i + 1 < n; i++) {
+        this->join(p[i - 1], p[i], p[i + 1], outline, join, miterLimit, tolerance);
+      }
+      dx = p[n - 1].x - p[n - 2].x;
+      dy = p[n - 1].y - p[n - 2].y;
+      length = sqrt(dx * dx + dy * dy);
+      this->cap(p[n - 1], dx / length, dy / length, false, outline, halfWidth, cap, tolerance);
+    }
+
+    for (size_t k = 0; k + 1 < pairs.size(); k++) {
+      const Pair& a = pairs[k];
+      const Pair& b = pairs[k + 1];
+      addVertex(mesh, a.left.x, a.left.y, a.leftSide * aa, aa);
+      addVertex(mesh, a.right.x, a.right.y, a.rightSide * aa, aa);
+      addVertex(mesh, b.left.x, b.left.y, b.leftSide * aa, aa);
+      addVertex(mesh, b.left.x, b.left.y, b.leftSide * aa, aa);
+      addVertex(mesh, a.right.x, a.right.y, a.rightSide * aa, aa);
+      addVertex(mesh, b.right.x, b.right.y, b.rightSide * aa, aa);
+    }
+  }
+  mesh.fillCount = mesh.vertices.size();
+  mesh.fringeFirst = mesh.coverFirst = mesh.vertices.size();
+  mesh.fringeCount = mesh.coverCount = 0;
+}
+
+} // end namespace webgl
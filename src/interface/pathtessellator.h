@@ -0,0 +1,133 @@
+#ifndef PATHTESSELLATOR_H_
+#define PATHTESSELLATOR_H_
+
+#include <vector>
+#include <stddef.h>
+
+#include "glapi.h"
+
+namespace webgl {
+
+// Turns 2D path commands into triangles for PathRenderer.
+//
+// Curves and arcs are flattened to within a quarter of a pixel at the scale
+// the path is drawn at. Edges are anti-aliased analytically: every vertex
+// carries aa, in pixels, and the shader takes clamp(aa.y - abs(aa.x), 0, 1) as
+// the coverage. Fills get a fringe one pixel wide (or feather pixels, for soft
+// shadows) around their contours, ramping aa.y from 1 to 0; strokes ramp aa.x
+// across their width.
+//
+// A path that is a single convex contour is filled as a triangle fan. Other
+// paths are filled with the stencil buffer: the fans of all contours are
+// counted into it (nonzero winding), and a cover quad is drawn where the count
+// isn't 0.
+class PathTessellator {
+public:
+  // Commands, each followed by its arguments in the command array:
+  // MOVE_TO x y, LINE_TO x y, QUADRATIC_TO cx cy x y,
+  // CUBIC_TO c1x c1y c2x c2y x y, CLOSE,
+  // ARC cx cy radius startAngle endAngle counterclockwise,
+  // RECT x y width height, ROUND_RECT x y width height radius.
+  enum Command {
+    MOVE_TO,
+    LINE_TO,
+    QUADRATIC_TO,
+    CUBIC_TO,
+    CLOSE,
+    ARC,
+    RECT,
+    ROUND_RECT
+  };
+
+  enum Join {
+    JOIN_MITER,
+    JOIN_ROUND,
+    JOIN_BEVEL
+  };
+
+  enum Cap {
+    CAP_BUTT,
+    CAP_ROUND,
+    CAP_SQUARE
+  };
+
+  struct Vertex {
+    GLfloat x;
+    GLfloat y;
+    GLfloat aaX;
+    GLfloat aaY;
+  };
+
+  // Vertices drawn as triangles: fill (the fans, or the stroke), fringe and
+  // cover, which only stencilled fills have.
+  struct Mesh {
+    std::vector<Vertex> vertices;
+    GLint fillFirst;
+    GLsizei fillCount;
+    GLint fringeFirst;
+    GLsizei fringeCount;
+    GLint coverFirst;
+    GLsizei coverCount;
+    bool stencil;
+  };
+
+  PathTessellator();
+
+  // Returns false, and leaves the path empty, if a command lacks arguments or
+  // is unknown.
+  bool setCommands(const GLfloat* commands, size_t count);
+
+  // scale is the number of pixels per path unit.
+  void fill(GLfloat scale, GLfloat feather, Mesh& mesh);
+  void stroke(GLfloat scale, GLfloat width, Join join, Cap cap, GLfloat miterLimit, Mesh& mesh);
+
+private:
+  struct Point {
+    GLfloat x;
+    GLfloat y;
+  };
+
+  struct Contour {
+    size_t first;
+    size_t count;
+    bool closed;
+  };
+
+  // Points across a stroke, which is drawn as a strip of them, with their
+  // distances from its middle, from -1 on the right to 1 on the left.
+  struct Pair {
+    Point left;
+    Point right;
+    GLfloat leftSide;
+    GLfloat rightSide;
+  };
+
+  void flatten(GLfloat scale);
+  void addPoint(GLfloat x, GLfloat y);
+  void startContour(GLfloat x, GLfloat y);
+
+  void arc(GLfloat cx, GLfloat cy, GLfloat radius, GLfloat start, GLfloat end, bool counterclockwise,
+      GLfloat tolerance);
+  size_t closedCount(const Contour& contour) const;
+  bool isConvex() const;
+  void addPair(GLfloat leftX, GLfloat leftY, GLfloat rightX, GLfloat rightY, GLfloat leftSide = 1,
+      GLfloat rightSide = -1);
+  void join(const Point& previous, const Point& point, const Point& next, GLfloat halfWidth, Join join,
+      GLfloat miterLimit, GLfloat tolerance);
+  void cap(const Point& point, GLfloat dx, GLfloat dy, bool start, GLfloat halfWidth, GLfloat extension, Cap cap,
+      GLfloat tolerance);
+
+  std::vector<GLfloat> commands;
+  GLfloat flattenedScale;
+  std::vector<Point> points;
+  std::vector<Contour> contours;
+  // Scratch space.
+  std::vector<Point> inner;
+  std::vector<Point> outer;
+  std::vector<Point> corners;
+  std::vector<Pair> pairs;
+};
+
+}
+
+#endif /* PATHTESSELLATOR_H_ */
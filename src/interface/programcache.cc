@@ -0,0 +1,324 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "programcache.h"
+
+namespace webgl {
+
+using namespace std;
+
+static const char ENTRY_MAGIC[4] = {'W', 'G', 'P', 'B'};
+static const uint32_t ENTRY_VERSION = 1;
+static const char* INDEX_FILE = "shaders.idx";
+
+// 64 bit FNV-1a; stable across runs and platforms, unlike std::hash.
+static uint64_t fnv1a(const void* data, size_t length, uint64_t hash = 14695981039346656037ULL) {
+  const unsigned char* p = (const unsigned char*) data;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= p[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static string toHex(uint64_t value) {
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx", (unsigned long long) value);
+  return string(buf);
+}
+
+static string glString(GLenum name) {
+  const char* value = (const char*) glGetString(name);
+  return value ? string(value) : string("");
+}
+
+ProgramCache::ProgramCache() {
+  extensions = NULL;
+  enabled = false;
+}
+
+bool ProgramCache::open(const string& directory, const GLExtensions* extensions) {
+  this->extensions = extensions;
+  this->directory = directory;
+  enabled = extensions->programBinary;
+
+  if (!enabled) {
+    return false;
+  }
+
+  driver = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION) + "|" + glString(GL_SHADING_LANGUAGE_VERSION);
+
+  // The index lists the hashes of the shaders that compiled on this driver.
+  compiled.clear();
+  string indexPath = directory + "/" + INDEX_FILE;
+  FILE* index = fopen(indexPath.c_str(), "r");
+  bool valid = false;
+  if (index) {
+    char line[1024];
+    if (fgets(line, sizeof(line), index) && string(line) == driver + "\n") {
+      valid = true;
+      unsigned long long hash;
+      while (fscanf(index, "%16llx\n", &hash) == 1) {
+        compiled.insert((uint64_t) hash);
+      }
+    }
+    fclose(index);
+  }
+
+  if (!valid) {
+    // New cache, or a different driver: start over.
+    index = fopen(indexPath.c_str(), "w");
+    if (!index) {
+      enabled = false;
+      return false;
+    }
+    fprintf(index, "%s\n", driver.c_str());
+    fclose(index);
+  }
+
+  return true;
+}
+
+void ProgramCache::shaderSource(GLuint shader, const char* source, int length) {
+  if (!enabled) {
+    return;
+  }
+
+  shaderHashes[shader] = fnv1a(source, length);
+  deferred.erase(shader);
+}
+
+bool ProgramCache::compileShader(GLuint shader) {
+  if (enabled) {
+    map<GLuint, uint64_t>::iterator it = shaderHashes.find(shader);
+    if (it != shaderHashes.end() && compiled.count(it->second)) {
+      deferred.insert(shader);
+      return false;
+    }
+  }
+
+  deferred.erase(shader);
+  return true;
+}
+
+bool ProgramCache::isDeferred(GLuint shader) const {
+  return deferred.count(shader) != 0;
+}
+
+bool ProgramCache::undefer(GLuint shader) {
+  return deferred.erase(shader) != 0;
+}
+
+void ProgramCache::bindAttribLocation(GLuint program, GLuint index, const char* name) {
+  if (enabled) {
+    attribBindings[program][name] = index;
+  }
+}
+
+bool ProgramCache::loadProgram(GLuint program) {
+  linking.erase(program);
+  if (!enabled) {
+    return false;
+  }
+
+  uint64_t key = programKey(program);
+  if (key && loadBinary(program, key)) {
+    return true;
+  }
+
+  if (extensions->programParameteri) {
+    extensions->programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+
+  if (key) {
+    // Remember what is being linked; the sources may change before the link
+    // has finished.
+    PendingLink& pending = linking[program];
+    pending.key = key;
+    GLuint shaders[16];
+    GLsizei count = 0;
+    glGetAttachedShaders(program, 16, &count, shaders);
+    for (GLsizei i = 0; i < count; i++) {
+      pending.shaders.push_back(shaderHashes[shaders[i]]);
+    }
+  }
+
+  return false;
+}
+
+void ProgramCache::programLinked(GLuint program) {
+  map<GLuint, PendingLink>::iterator it = linking.find(program);
+  if (it == linking.end()) {
+    return;
+  }
+
+  GLint status = 0;
+  glGetProgramiv(program, GL_LINK_STATUS, &status);
+  if (status) {
+    for (size_t i = 0; i < it->second.shaders.size(); i++) {
+      markCompiled(it->second.shaders[i]);
+    }
+    storeBinary(program, it->second.key);
+  }
+  linking.erase(it);
+}
+
+void ProgramCache::deleteShader(GLuint shader) {
+  // A deleted shader stays alive while attached, so it remains deferred: a
+  // relink of such a program compiles it. The name is only reused after a
+  // new ShaderSource, which clears the deferred state.
+  shaderHashes.erase(shader);
+}
+
+void ProgramCache::deleteProgram(GLuint program) {
+  attribBindings.erase(program);
+  linking.erase(program);
+}
+
+// Returns 0 if the program can't be cached (a shader without known source).
+uint64_t ProgramCache::programKey(GLuint program) {
+  GLuint shaders[16];
+  GLsizei count = 0;
+  glGetAttachedShaders(program, 16, &count, shaders);
+  if (count == 0) {
+    return 0;
+  }
+
+  // Attach order doesn't influence the result of a link.
+  vector<uint64_t> hashes;
+  for (GLsizei i = 0; i < count; i++) {
+    map<GLuint, uint64_t>::iterator it = shaderHashes.find(shaders[i]);
+    if (it == shaderHashes.end()) {
+      return 0;
+    }
+    hashes.push_back(it->second);
+  }
+  sort(hashes.begin(), hashes.end());
+
+  uint64_t key = fnv1a(driver.data(), driver.size());
+  key = fnv1a(&hashes[0], hashes.size() * sizeof(uint64_t), key);
+
+  map<string, GLuint>& bindings = attribBindings[program];
+  for (map<string, GLuint>::iterator it = bindings.begin(); it != bindings.end(); ++it) {
+    key = fnv1a(it->first.c_str(), it->first.size() + 1, key);
+    key = fnv1a(&it->second, sizeof(GLuint), key);
+  }
+
+  return key ? key : 1;
+}
+
+bool ProgramCache::loadBinary(GLuint program, uint64_t key) {
+  string path = entryPath(key, ".bin");
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) {
+    return false;
+  }
+
+  // The lengths in the entry are only trusted up to the size of the file.
+  long size = -1;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    size = ftell(file);
+  }
+  rewind(file);
+
+  char magic[4];
+  uint32_t version = 0, driverLength = 0, format = 0, length = 0;
+  bool valid = size > 0 && fread(magic, 1, 4, file) == 4 && memcmp(magic, ENTRY_MAGIC, 4) == 0
+    && fread(&version, sizeof(version), 1, file) == 1 && version == ENTRY_VERSION
+    && fread(&driverLength, sizeof(driverLength), 1, file) == 1 && driverLength == driver.size();
+
+  vector<char> data;
+  if (valid) {
+    data.resize(driverLength);
+    valid = (driverLength == 0 || fread(&data[0], 1, driverLength, file) == driverLength)
+      && string(data.begin(), data.end()) == driver
+      && fread(&format, sizeof(format), 1, file) == 1
+      && fread(&length, sizeof(length), 1, file) == 1 && length > 0
+      && length <= (uint32_t) (size - ftell(file));
+  }
+  if (valid) {
+    data.resize(length);
+    valid = fread(&data[0], 1, length, file) == length;
+  }
+  fclose(file);
+
+  if (valid) {
+    extensions->programBinaryLoad(program, format, &data[0], length);
+
+    // The driver may still reject the binary, e.g. after an update that kept
+    // the version string.
+    GLint status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status) {
+      return true;
+    }
+  }
+
+  remove(path.c_str());
+  return false;
+}
+
+void ProgramCache::storeBinary(GLuint program, uint64_t key) {
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) {
+    return;
+  }
+
+  vector<char> data(length);
+  GLenum format = 0;
+  GLsizei written = 0;
+  extensions->getProgramBinary(program, length, &written, &format, &data[0]);
+  if (written <= 0) {
+    return;
+  }
+
+  // Write to a temporary file first, so a crash never leaves a truncated entry.
+  string path = entryPath(key, ".bin");
+  string tmp = entryPath(key, ".tmp");
+  FILE* file = fopen(tmp.c_str(), "wb");
+  if (!file) {
+    return;
+  }
+
+  uint32_t driverLength = driver.size();
+  uint32_t binaryFormat = format;
+  uint32_t binaryLength = written;
+  bool ok = fwrite(ENTRY_MAGIC, 1, 4, file) == 4
+    && fwrite(&ENTRY_VERSION, sizeof(ENTRY_VERSION), 1, file) == 1
+    && fwrite(&driverLength, sizeof(driverLength), 1, file) == 1
+    && fwrite(driver.data(), 1, driverLength, file) == driverLength
+    && fwrite(&binaryFormat, sizeof(binaryFormat), 1, file) == 1
+    && fwrite(&binaryLength, sizeof(binaryLength), 1, file) == 1
+    && fwrite(&data[0], 1, written, file) == (size_t) written;
+  ok = (fclose(file) == 0) && ok;
+
+  if (ok) {
+    remove(path.c_str());
+    ok = rename(tmp.c_str(), path.c_str()) == 0;
+  }
+  if (!ok) {
+    remove(tmp.c_str());
+  }
+}
+
+void ProgramCache::markCompiled(uint64_t hash) {
+  if (!compiled.insert(hash).second) {
+    return;
+  }
+
+  string indexPath = directory + "/" + INDEX_FILE;
+  FILE* index = fopen(indexPath.c_str(), "a");
+  if (index) {
+    fprintf(index, "%s\n", toHex(hash).c_str());
+    fclose(index);
+  }
+}
+
+string ProgramCache::entryPath(uint64_t key, const char* suffix) const {
+  return directory + "/" + toHex(key) + suffix;
+}
+
+} // end namespace webgl
@@ -0,0 +1,75 @@
+#ifndef PROGRAMCACHE_H_
+#define PROGRAMCACHE_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "glext.h"
+
+namespace webgl {
+
+// On-disk cache of linked program binaries (GL_OES/ARB_get_program_binary).
+//
+// Shader sources are hashed when they are set. A program is identified by the
+// hashes of its attached shaders and its attribute bindings; on link, a stored
+// binary for that key is loaded instead of linking. Shaders that are known to
+// compile on this driver are not compiled until something needs them, so a
+// cache hit skips both compilation and linking. Entries are tagged with the
+// driver vendor/renderer/version and ignored when that changes.
+class ProgramCache {
+public:
+  ProgramCache();
+
+  // Enables the cache; returns false if the driver can't load program binaries.
+  bool open(const std::string& directory, const GLExtensions* extensions);
+  bool isOpen() const { return enabled; }
+
+  void shaderSource(GLuint shader, const char* source, int length);
+  // Returns false if compiling the shader can be deferred.
+  bool compileShader(GLuint shader);
+  void bindAttribLocation(GLuint program, GLuint index, const char* name);
+  void deleteShader(GLuint shader);
+  void deleteProgram(GLuint program);
+
+  // A deferred shader has not been compiled, but is known to compile.
+  bool isDeferred(GLuint shader) const;
+  // Takes the shader out of the deferred state; returns true if it still
+  // has to be compiled.
+  bool undefer(GLuint shader);
+
+  // Loads a stored binary into the program; returns false if it has to be
+  // linked, after compiling its deferred shaders.
+  bool loadProgram(GLuint program);
+  // Stores the binary of a program that has been linked after loadProgram.
+  void programLinked(GLuint program);
+
+private:
+  uint64_t programKey(GLuint program);
+  bool loadBinary(GLuint program, uint64_t key);
+  void storeBinary(GLuint program, uint64_t key);
+  void markCompiled(uint64_t hash);
+  std::string entryPath(uint64_t key, const char* suffix) const;
+
+  const GLExtensions* extensions;
+  bool enabled;
+  std::string directory;
+  std::string driver;
+
+  std::map<GLuint, uint64_t> shaderHashes;
+  std::set<GLuint> deferred;
+  std::set<uint64_t> compiled;
+  std::map<GLuint, std::map<std::string, GLuint> > attribBindings;
+
+  struct PendingLink {
+    uint64_t key;
+    std::vector<uint64_t> shaders;
+  };
+  std::map<GLuint, PendingLink> linking;
+};
+
+}
+
+#endif /* PROGRAMCACHE_H_ */
@@ -0,0 +1,343 @@
+#include <cstdlib>
+
+#include "shadercompiler.h"
+
+namespace webgl {
+
+using namespace std;
+
+set<ShaderCompiler*> ShaderCompiler::running;
+mutex ShaderCompiler::runningMutex;
+
+ShaderCompiler::ShaderCompiler(ProgramCache& cache) : cache(cache) {
+  extensions = NULL;
+  mode = SYNC;
+  paused = false;
+  context = NULL;
+  started = false;
+  stopping = false;
+}
+
+ShaderCompiler::~ShaderCompiler() {
+  stop();
+}
+
+bool ShaderCompiler::enable(const GLExtensions* extensions) {
+  if (mode != SYNC) {
+    return true;
+  }
+
+  this->extensions = extensions;
+
+  if (extensions->parallelShaderCompile) {
+    // Let the driver pick the number of threads.
+    extensions->maxShaderCompilerThreads(0xFFFFFFFF);
+    mode = PARALLEL;
+    return true;
+  }
+
+  context = gles2impl::createSharedContext(gles2impl::currentContext());
+  if (!context) {
+    return false;
+  }
+
+  stopping = false;
+  worker = thread(&ShaderCompiler::run, this);
+
+  // Wait until the worker made its context current, or failed to.
+  {
+    unique_lock<mutex> lock(queueMutex);
+    finished.wait(lock, [this] { return started || stopping; });
+  }
+  if (!started) {
+    worker.join();
+    gles2impl::destroySharedContext(context);
+    context = NULL;
+    return false;
+  }
+
+  // The worker has to be stopped before the backend tears down its display.
+  {
+    lock_guard<mutex> lock(runningMutex);
+    static bool registered = false;
+    if (!registered) {
+      atexit(AtExit);
+      registered = true;
+    }
+    running.insert(this);
+  }
+
+  mode = THREAD;
+  return true;
+}
+
+void ShaderCompiler::setMaxThreads(unsigned int count) {
+  if (mode == PARALLEL) {
+    extensions->maxShaderCompilerThreads(count);
+  } else if (mode == THREAD) {
+    paused = (count == 0);
+  }
+}
+
+void ShaderCompiler::compileShader(GLuint shader) {
+  finishShader(shader);
+
+  if (!cache.compileShader(shader)) {
+    return;
+  }
+
+  if (mode == THREAD && !paused) {
+    JobPtr job(new Job());
+    job->program = 0;
+    job->shaders.push_back(shader);
+    job->done = false;
+    shaderJobs[shader] = job;
+    submit(job);
+    return;
+  }
+
+  glCompileShader(shader);
+}
+
+void ShaderCompiler::linkProgram(GLuint program) {
+  finishProgram(program);
+
+  if (cache.loadProgram(program)) {
+    return;
+  }
+
+  GLuint attached[16];
+  GLsizei count = 0;
+  glGetAttachedShaders(program, 16, &count, attached);
+
+  vector<GLuint> shaders;
+  for (GLsizei i = 0; i < count; i++) {
+    if (cache.undefer(attached[i])) {
+      shaders.push_back(attached[i]);
+    }
+  }
+
+  // The render thread may draw with, or set uniforms of, the current program
+  // at any time; relinking it on the worker would race with that, so it is
+  // linked here, like a synchronous link.
+  GLint current = 0;
+  if (mode == THREAD && !paused) {
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+  }
+
+  if (mode == THREAD && !paused && (GLuint) current != program) {
+    JobPtr job(new Job());
+    job->program = program;
+    job->shaders = shaders;
+    job->done = false;
+    programJobs[program] = job;
+    for (size_t i = 0; i < shaders.size(); i++) {
+      shaderJobs[shaders[i]] = job;
+    }
+    linking.insert(program);
+    submit(job);
+    return;
+  }
+
+  // Shaders compiling on the worker have to be done before the link.
+  for (GLsizei i = 0; i < count; i++) {
+    finishShader(attached[i]);
+  }
+  for (size_t i = 0; i < shaders.size(); i++) {
+    glCompileShader(shaders[i]);
+  }
+  glLinkProgram(program);
+
+  if (mode == PARALLEL) {
+    linking.insert(program);
+  } else {
+    cache.programLinked(program);
+  }
+}
+
+bool ShaderCompiler::isShaderComplete(GLuint shader) {
+  if (mode == THREAD) {
+    map<GLuint, JobPtr>::iterator it = shaderJobs.find(shader);
+    if (it != shaderJobs.end()) {
+      if (!isDone(it->second)) {
+        return false;
+      }
+      shaderJobs.erase(it);
+    }
+  } else if (mode == PARALLEL && !cache.isDeferred(shader)) {
+    GLint status = GL_TRUE;
+    glGetShaderiv(shader, GL_COMPLETION_STATUS_KHR, &status);
+    return status != 0;
+  }
+
+  return true;
+}
+
+bool ShaderCompiler::isProgramComplete(GLuint program) {
+  if (mode == THREAD) {
+    map<GLuint, JobPtr>::iterator it = programJobs.find(program);
+    if (it != programJobs.end() && !isDone(it->second)) {
+      return false;
+    }
+  } else if (mode == PARALLEL && linking.count(program)) {
+    GLint status = GL_TRUE;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &status);
+    if (!status) {
+      return false;
+    }
+  }
+
+  finishProgram(program);
+  return true;
+}
+
+void ShaderCompiler::finishShader(GLuint shader) {
+  map<GLuint, JobPtr>::iterator it = shaderJobs.find(shader);
+  if (it != shaderJobs.end()) {
+    wait(it->second);
+    shaderJobs.erase(it);
+  }
+}
+
+void ShaderCompiler::finishProgram(GLuint program) {
+  map<GLuint, JobPtr>::iterator it = programJobs.find(program);
+  if (it != programJobs.end()) {
+    wait(it->second);
+    programJobs.erase(it);
+  }
+
+  // With the driver extension, this blocks until the link is done.
+  if (linking.erase(program)) {
+    cache.programLinked(program);
+  }
+}
+
+void ShaderCompiler::ensureCompiled(GLuint shader) {
+  finishShader(shader);
+
+  if (cache.undefer(shader)) {
+    glCompileShader(shader);
+  }
+}
+
+void ShaderCompiler::submit(const JobPtr& job) {
+  reap();
+
+  // The worker's context only sees the source, attachments and attribute
+  // locations that were set here once the commands that set them have been
+  // flushed.
+  glFlush();
+
+  {
+    lock_guard<mutex> lock(queueMutex);
+    queue.push_back(job);
+  }
+  wake.notify_one();
+}
+
+void ShaderCompiler::wait(const JobPtr& job) {
+  unique_lock<mutex> lock(queueMutex);
+  finished.wait(lock, [&job] { return job->done; });
+}
+
+bool ShaderCompiler::isDone(const JobPtr& job) {
+  lock_guard<mutex> lock(queueMutex);
+  return job->done;
+}
+
+// Forgets finished jobs that nothing asked about.
+void ShaderCompiler::reap() {
+  lock_guard<mutex> lock(queueMutex);
+  for (map<GLuint, JobPtr>::iterator it = shaderJobs.begin(); it != shaderJobs.end();) {
+    if (it->second->done) {
+      shaderJobs.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  for (map<GLuint, JobPtr>::iterator it = programJobs.begin(); it != programJobs.end();) {
+    if (it->second->done) {
+      programJobs.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ShaderCompiler::run() {
+  bool current = gles2impl::makeCurrent(context);
+  {
+    lock_guard<mutex> lock(queueMutex);
+    started = current;
+    stopping = !current;
+  }
+  finished.notify_all();
+  if (!current) {
+    return;
+  }
+
+  for (;;) {
+    JobPtr job;
+    {
+      unique_lock<mutex> lock(queueMutex);
+      wake.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) {
+        break;
+      }
+      job = queue.front();
+      queue.pop_front();
+    }
+
+    for (size_t i = 0; i < job->shaders.size(); i++) {
+      glCompileShader(job->shaders[i]);
+    }
+    if (job->program) {
+      glLinkProgram(job->program);
+    }
+
+    // Other contexts only see the results of completed commands.
+    glFinish();
+
+    {
+      lock_guard<mutex> lock(queueMutex);
+      job->done = true;
+    }
+    finished.notify_all();
+  }
+
+  gles2impl::makeCurrent(NULL);
+}
+
+void ShaderCompiler::stop() {
+  if (!started) {
+    return;
+  }
+
+  {
+    lock_guard<mutex> lock(queueMutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  worker.join();
+
+  gles2impl::destroySharedContext(context);
+  context = NULL;
+  started = false;
+  mode = SYNC;
+
+  lock_guard<mutex> lock(runningMutex);
+  running.erase(this);
+}
+
+void ShaderCompiler::AtExit() {
+  set<ShaderCompiler*> compilers;
+  {
+    lock_guard<mutex> lock(runningMutex);
+    compilers = running;
+  }
+  for (set<ShaderCompiler*>::iterator it = compilers.begin(); it != compilers.end(); ++it) {
+    (*it)->stop();
+  }
+}
+
+} // end namespace webgl
@@ -0,0 +1,101 @@
+#ifndef SHADERCOMPILER_H_
+#define SHADERCOMPILER_H_
+
+#include <map>
+#include <set>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+#include "glext.h"
+#include "programcache.h"
+#include "../gles2impl.h"
+
+namespace webgl {
+
+// Schedules shader compilation and program linking, so that applications can
+// keep rendering while programs build (KHR_parallel_shader_compile semantics).
+//
+// By default everything happens synchronously. Once enabled, the driver's
+// parallel compile extension is used when available; otherwise compiles and
+// links run on a worker thread with a context that shares objects with the
+// main one. Anything that needs the result of a pending job (queries, use,
+// deletion) waits for it, so the asynchrony is never observable except
+// through COMPLETION_STATUS_KHR. The program in use is never linked on the
+// worker, since draws and uniform calls use it without asking.
+class ShaderCompiler {
+public:
+  explicit ShaderCompiler(ProgramCache& cache);
+  ~ShaderCompiler();
+
+  // Returns false if neither the extension nor a shared context is available.
+  bool enable(const GLExtensions* extensions);
+  bool isEnabled() const { return mode != SYNC; }
+
+  // 0 makes compilation synchronous again.
+  void setMaxThreads(unsigned int count);
+
+  void compileShader(GLuint shader);
+  void linkProgram(GLuint program);
+
+  // Non-blocking COMPLETION_STATUS_KHR queries.
+  bool isShaderComplete(GLuint shader);
+  bool isProgramComplete(GLuint program);
+
+  // Block until pending work on the object is done.
+  void finishShader(GLuint shader);
+  void finishProgram(GLuint program);
+
+  // Compiles a shader that the program cache deferred, e.g. for its info log.
+  void ensureCompiled(GLuint shader);
+
+  static void AtExit();
+
+private:
+  enum Mode { SYNC, PARALLEL, THREAD };
+
+  struct Job {
+    GLuint program;
+    std::vector<GLuint> shaders;
+    bool done;
+  };
+  typedef std::shared_ptr<Job> JobPtr;
+
+  void submit(const JobPtr& job);
+  void wait(const JobPtr& job);
+  bool isDone(const JobPtr& job);
+  void reap();
+  void run();
+  void stop();
+
+  ProgramCache& cache;
+  const GLExtensions* extensions;
+  Mode mode;
+  bool paused;
+
+  // Programs linked asynchronously that the cache hasn't seen the result of.
+  std::set<GLuint> linking;
+
+  // Worker state; the job maps are only used on the main thread.
+  gles2impl::SharedContext* context;
+  std::thread worker;
+  std::mutex queueMutex;
+  std::condition_variable wake;
+  std::condition_variable finished;
+  std::deque<JobPtr> queue;
+  bool started;
+  bool stopping;
+  std::map<GLuint, JobPtr> shaderJobs;
+  std::map<GLuint, JobPtr> programJobs;
+
+  // Compilers of all threads that load the module.
+  static std::set<ShaderCompiler*> running;
+  static std::mutex runningMutex;
+};
+
+}
+
+#endif /* SHADERCOMPILER_H_ */
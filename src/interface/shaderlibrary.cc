@@ -0,0 +1,293 @@
+#include <cstdlib>
+#include <algorithm>
+
+#include "shaderlibrary.h"
+#include "desktopshaders.h"
+
+namespace webgl {
+
+using namespace std;
+
+// Default float precision; highp isn't guaranteed in GLES fragment shaders.
+static const char* PRECISION_PROLOGUE =
+  "#ifdef GL_ES\n"
+  "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+  "precision highp float;\n"
+  "#else\n"
+  "precision mediump float;\n"
+  "#endif\n"
+  "#endif\n";
+
+// Comments and whitespace don't change what a shader compiles to. Newlines
+// are kept, as they end preprocessor directives.
+static string normalize(const string& source) {
+  string out;
+  bool space = false;
+  size_t i = 0, n = source.size();
+  while (i < n) {
+    char c = source[i];
+    if (c == '/' && i + 1 < n && source[i + 1] == '/') {
+      while (i < n && source[i] != '\n') {
+        i++;
+      }
+      continue;
+    }
+    if (c == '/' && i + 1 < n && source[i + 1] == '*') {
+      size_t close = source.find("*/", i + 2);
+      i = (close == string::npos) ? n : close + 2;
+      space = true;
+      continue;
+    }
+    if (c == '\n') {
+      if (!out.empty() && out[out.size() - 1] != '\n') {
+        out += '\n';
+      }
+      space = false;
+      i++;
+      continue;
+    }
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+      space = true;
+      i++;
+      continue;
+    }
+    if (space && !out.empty() && out[out.size() - 1] != '\n') {
+      out += ' ';
+    }
+    space = false;
+    out += c;
+    i++;
+  }
+  return out;
+}
+
+// Finds the leading #version and #extension lines, with the comments and
+// whitespace between them; a precision statement has to follow any #extension.
+// Other directives end the header, so that the prologue doesn't land inside a
+// conditional block. #version, if present, is the first directive.
+static void scanHeader(const string& source, size_t& versionEnd, int& version, size_t& headerEnd) {
+  versionEnd = 0;
+  version = 100;
+  headerEnd = 0;
+
+  bool comment = false;
+  bool first = true;
+  size_t pos = 0;
+  while (pos < source.size()) {
+    size_t eol = source.find('\n', pos);
+    size_t next = (eol == string::npos) ? source.size() : eol + 1;
+    if (eol == string::npos) {
+      eol = source.size();
+    }
+
+    bool code = false;
+    size_t i = pos;
+    while (i < eol) {
+      if (comment) {
+        size_t close = source.find("*/", i);
+        if (close == string::npos || close >= eol) {
+          i = eol;
+        } else {
+          comment = false;
+          i = close + 2;
+        }
+        continue;
+      }
+
+      char c = source[i];
+      if (c == ' ' || c == '\t' || c == '\r') {
+        i++;
+      } else if (source.compare(i, 2, "//") == 0) {
+        break;
+      } else if (source.compare(i, 2, "/*") == 0) {
+        comment = true;
+        i += 2;
+      } else if (c == '#') {
+        size_t d = source.find_first_not_of(" \t", i + 1);
+        if (first && d != string::npos && source.compare(d, 7, "version") == 0) {
+          version = atoi(source.c_str() + d + 7);
+          versionEnd = next;
+        } else if (d == string::npos || source.compare(d, 9, "extension") != 0) {
+          code = true;
+        }
+        first = false;
+        break;
+      } else {
+        code = true;
+        break;
+      }
+    }
+
+    if (code) {
+      break;
+    }
+    pos = next;
+    if (!comment) {
+      headerEnd = pos;
+    }
+  }
+}
+
+static int countLines(const string& source, size_t end) {
+  return (int) count(source.begin(), source.begin() + end, '\n');
+}
+
+// Makes the following line report as nextLine in compile errors. GLSL ES 3.00
+// and GLSL 3.30 changed #line to number the next line instead of the current.
+static string lineDirective(int version, int nextLine) {
+  int line = (version >= 300) ? nextLine : nextLine - 1;
+  return string("#line ") + to_string(line) + string("\n");
+}
+
+string ShaderLibrary::prepareSource(const string& source, const vector<string>& defines) {
+  size_t versionEnd, headerEnd;
+  int version;
+  scanHeader(source, versionEnd, version, headerEnd);
+
+  string out = source.substr(0, versionEnd);
+  if (!out.empty() && out[out.size() - 1] != '\n') {
+    out += '\n';
+  }
+  for (size_t i = 0; i < defines.size(); i++) {
+    out += string("#define ") + defines[i] + string("\n");
+  }
+  out += lineDirective(version, countLines(source, versionEnd) + 1);
+
+  out += source.substr(versionEnd, headerEnd - versionEnd);
+  if (headerEnd > versionEnd && source[headerEnd - 1] != '\n') {
+    out += '\n';
+  }
+  out += PRECISION_PROLOGUE;
+  out += lineDirective(version, countLines(source, headerEnd) + 1);
+
+  out += source.substr(headerEnd);
+  return out;
+}
+
+ShaderLibrary::ShaderLibrary(ShaderCompiler& compiler, ProgramCache& cache, const GLExtensions& extensions)
+    : compiler(compiler), cache(cache), extensions(extensions) {
+}
+
+GLuint ShaderLibrary::getProgram(const string& vertexSource, const string& fragmentSource,
+    vector<string> defines, const vector<string>& attributes) {
+  sort(defines.begin(), defines.end());
+  defines.erase(unique(defines.begin(), defines.end()), defines.end());
+
+  string defineKey;
+  for (size_t i = 0; i < defines.size(); i++) {
+    defineKey += defines[i] + '\n';
+  }
+  string vertexKey = string("vertex\x01") + defineKey + '\x01' + normalize(vertexSource);
+  string fragmentKey = string("fragment\x01") + defineKey + '\x01' + normalize(fragmentSource);
+
+  string key = vertexKey + '\x02' + fragmentKey + '\x02';
+  for (size_t i = 0; i < attributes.size(); i++) {
+    key += attributes[i] + '\n';
+  }
+
+  map<string, GLuint>::iterator it = programKeys.find(key);
+  if (it != programKeys.end()) {
+    programs[it->second].refs++;
+    return it->second;
+  }
+
+  GLuint program = glCreateProgram();
+  Program& entry = programs[program];
+  entry.refs = 1;
+  entry.key = key;
+  entry.vertexKey = vertexKey;
+  entry.fragmentKey = fragmentKey;
+  entry.attributes = attributes;
+  entry.vertexSource = vertexSource;
+  entry.fragmentSource = fragmentSource;
+  entry.defines = defines;
+  entry.realized = false;
+  programKeys[key] = program;
+
+  return program;
+}
+
+void ShaderLibrary::realize(GLuint program) {
+  map<GLuint, Program>::iterator it = programs.find(program);
+  if (it == programs.end() || it->second.realized) {
+    return;
+  }
+
+  Program& entry = it->second;
+  GLuint vertex = acquireShader(GL_VERTEX_SHADER, entry.vertexKey, entry.vertexSource, entry.defines);
+  GLuint fragment = acquireShader(GL_FRAGMENT_SHADER, entry.fragmentKey, entry.fragmentSource, entry.defines);
+
+  glAttachShader(program, vertex);
+  glAttachShader(program, fragment);
+  for (size_t i = 0; i < entry.attributes.size(); i++) {
+    glBindAttribLocation(program, i, entry.attributes[i].c_str());
+    cache.bindAttribLocation(program, i, entry.attributes[i].c_str());
+  }
+
+  compiler.linkProgram(program);
+
+  entry.realized = true;
+  string().swap(entry.vertexSource);
+  string().swap(entry.fragmentSource);
+  vector<string>().swap(entry.defines);
+}
+
+bool ShaderLibrary::release(GLuint program) {
+  map<GLuint, Program>::iterator it = programs.find(program);
+  if (it == programs.end()) {
+    return false;
+  }
+
+  if (--it->second.refs > 0) {
+    return true;
+  }
+
+  compiler.finishProgram(program);
+  glDeleteProgram(program);
+  cache.deleteProgram(program);
+
+  if (it->second.realized) {
+    releaseShader(it->second.vertexKey);
+    releaseShader(it->second.fragmentKey);
+  }
+
+  programKeys.erase(it->second.key);
+  programs.erase(it);
+  return true;
+}
+
+GLuint ShaderLibrary::acquireShader(GLenum type, const string& key, const string& source, const vector<string>& defines) {
+  map<string, Shader>::iterator it = shaders.find(key);
+  if (it != shaders.end()) {
+    it->second.refs++;
+    return it->second.shader;
+  }
+
+  string prepared = desktopShaderSource(prepareSource(source, defines), type, extensions);
+  const char* sources[1] = { prepared.c_str() };
+  GLint length = prepared.size();
+
+  GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, sources, &length);
+  cache.shaderSource(shader, prepared.c_str(), length);
+  compiler.compileShader(shader);
+
+  Shader& entry = shaders[key];
+  entry.shader = shader;
+  entry.refs = 1;
+  return shader;
+}
+
+void ShaderLibrary::releaseShader(const string& key) {
+  map<string, Shader>::iterator it = shaders.find(key);
+  if (it == shaders.end() || --it->second.refs > 0) {
+    return;
+  }
+
+  compiler.finishShader(it->second.shader);
+  glDeleteShader(it->second.shader);
+  cache.deleteShader(it->second.shader);
+  shaders.erase(it);
+}
+
+} // end namespace webgl
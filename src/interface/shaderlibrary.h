@@ -0,0 +1,77 @@
+#ifndef SHADERLIBRARY_H_
+#define SHADERLIBRARY_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "glext.h"
+#include "programcache.h"
+#include "shadercompiler.h"
+
+namespace webgl {
+
+// Programs generated from shared sources with different #define sets.
+//
+// Variants are keyed by the normalized source (comments and whitespace don't
+// matter) plus the sorted defines, so identical requests from different parts
+// of an application share one program, and variants with an identical vertex
+// or fragment stage share that shader. Nothing is compiled until a program is
+// first used. Programs are reference counted per request and shaders per
+// program; deleting the last reference deletes the GL objects.
+//
+// Every shader gets a prologue with the defines and a default float precision
+// for GLES, so sources work unchanged on GL and GLES; desktop contexts then
+// get it translated like sources from shaderSource.
+class ShaderLibrary {
+public:
+  ShaderLibrary(ShaderCompiler& compiler, ProgramCache& cache, const GLExtensions& extensions);
+
+  // Returns the (not yet linked) program for a variant. Attributes are bound
+  // to locations in the given order.
+  GLuint getProgram(const std::string& vertexSource, const std::string& fragmentSource,
+      std::vector<std::string> defines, const std::vector<std::string>& attributes);
+
+  // Compiles and links a variant on its first use; ignores other programs.
+  void realize(GLuint program);
+
+  // Drops one reference to a variant; returns false for other programs.
+  bool release(GLuint program);
+
+  // The source that is compiled for a shader stage.
+  static std::string prepareSource(const std::string& source, const std::vector<std::string>& defines);
+
+private:
+  struct Shader {
+    GLuint shader;
+    int refs;
+  };
+
+  struct Program {
+    int refs;
+    std::string key;
+    std::string vertexKey;
+    std::string fragmentKey;
+    std::vector<std::string> attributes;
+    // Kept until the variant is realized.
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::vector<std::string> defines;
+    bool realized;
+  };
+
+  GLuint acquireShader(GLenum type, const std::string& key, const std::string& source, const std::vector<std::string>& defines);
+  void releaseShader(const std::string& key);
+
+  ShaderCompiler& compiler;
+  ProgramCache& cache;
+  const GLExtensions& extensions;
+
+  std::map<std::string, Shader> shaders;
+  std::map<std::string, GLuint> programKeys;
+  std::map<GLuint, Program> programs;
+};
+
+}
+
+#endif /* SHADERLIBRARY_H_ */
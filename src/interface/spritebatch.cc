@@ -0,0 +1,327 @@
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "spritebatch.h"
+#include "glprogram.h"
+#include "drawstate.h"
+
+namespace webgl {
+
+using namespace std;
+
+// 16 bit indices address 65536 vertices, four per sprite.
+static const GLuint MAX_CAPACITY = 16384;
+
+// Texture units sampled by one draw. The fragment shader picks the unit of a
+// sprite with a chain of branches, which gets slower with every unit.
+static const GLint MAX_UNITS = 8;
+
+// Frames of vertices that may be in flight.
+static const GLuint FRAMES = 3;
+
+// Sort keys: the layer, blend mode and texture above the record index.
+static const int INDEX_BITS = 20;
+static const int TEXTURE_BITS = 24;
+static const int BLEND_BITS = 4;
+static const uint64_t INDEX_MASK = (1ull << INDEX_BITS) - 1;
+static const uint64_t TEXTURE_MASK = (1ull << TEXTURE_BITS) - 1;
+static const uint64_t BLEND_MASK = (1ull << BLEND_BITS) - 1;
+
+// view maps pixels, with the origin at the top left, to clip space.
+static const char* VERTEX_SHADER =
+  "ATTRIBUTE vec2 position;\n"
+  "ATTRIBUTE vec2 texcoord;\n"
+  "ATTRIBUTE vec4 color;\n"
+  "ATTRIBUTE float unit;\n"
+  "uniform vec4 view;\n"
+  "VARYING vec2 uv;\n"
+  "VARYING vec4 tint;\n"
+  "VARYING float slot;\n"
+  "void main() {\n"
+  "  uv = texcoord;\n"
+  "  tint = color;\n"
+  "  slot = unit;\n"
+  "  gl_Position = vec4(position * view.xy + view.zw, 0.0, 1.0);\n"
+  "}\n";
+
+static inline GLuint indexOf(uint64_t key) {
+  return (GLuint) (key & INDEX_MASK);
+}
+
+static inline GLuint textureOf(uint64_t key) {
+  return (GLuint) ((key >> INDEX_BITS) & TEXTURE_MASK);
+}
+
+static inline GLuint blendOf(uint64_t key) {
+  return (GLuint) ((key >> (INDEX_BITS + TEXTURE_BITS)) & BLEND_MASK);
+}
+
+// The fragment shader for units textures, which are all sampled with the
+// same coordinates so that only the branch that is taken costs anything; all
+// fragments of a sprite take the same one.
+static string fragmentShader(GLuint units) {
+  string source =
+    "VARYING vec2 uv;\n"
+    "VARYING vec4 tint;\n"
+    "VARYING float slot;\n";
+  char line[96];
+  for (GLuint i = 0; i < units; i++) {
+    snprintf(line, sizeof(line), "uniform sampler2D texture%u;\n", i);
+    source += line;
+  }
+  source +=
+    "void main() {\n"
+    "  vec4 texel;\n";
+  for (GLuint i = 0; i + 1 < units; i++) {
+    snprintf(line, sizeof(line), "  %sif (slot < %u.5) texel = TEXTURE(texture%u, uv);\n", i ? "else " : "", i, i);
+    source += line;
+  }
+  snprintf(line, sizeof(line), "  %stexel = TEXTURE(texture%u, uv);\n", units > 1 ? "else " : "", units - 1);
+  source += line;
+  source +=
+    "  FRAG_COLOR = texel * tint;\n"
+    "}\n";
+  return source;
+}
+
+SpriteBatch::SpriteBatch(const GLExtensions& extensions, VertexArrays& vertexArrays)
+    : extensions(extensions), vertexArrays(vertexArrays), vertexBuffer(extensions, vertexArrays) {
+  capacity = 0;
+  units = 0;
+  program = 0;
+  viewLocation = -1;
+  indexBuffer = 0;
+  vertexArray = 0;
+}
+
+SpriteBatch::~SpriteBatch() {
+  if (program) {
+    glDeleteProgram(program);
+  }
+  if (indexBuffer) {
+    glDeleteBuffers(1, &indexBuffer);
+    vertexArrays.deleteBuffer(indexBuffer);
+  }
+  if (vertexArray) {
+    vertexArrays.destroy(vertexArray);
+  }
+}
+
+bool SpriteBatch::init(GLuint capacity, GLuint frameSprites) {
+  if (program || capacity == 0) {
+    return false;
+  }
+
+  this->capacity = min(capacity, MAX_CAPACITY);
+  frameSprites = max(frameSprites, this->capacity);
+  GLint maxUnits = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxUnits);
+  units = (GLuint) max(min(maxUnits, MAX_UNITS), 1);
+
+  static const char* ATTRIBUTES[] = { "position", "texcoord", "color", "unit", NULL };
+  program = createProgram(extensions, VERTEX_SHADER, fragmentShader(units), ATTRIBUTES);
+  if (!program) {
+    return false;
+  }
+  viewLocation = glGetUniformLocation(program, "view");
+
+  GLint previousProgram = 0, previousBuffer = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousBuffer);
+
+  glUseProgram(program);
+  char name[16];
+  for (GLuint i = 0; i < units; i++) {
+    snprintf(name, sizeof(name), "texture%u", i);
+    glUniform1i(glGetUniformLocation(program, name), i);
+  }
+  glUseProgram(previousProgram);
+
+  bool created = vertexBuffer.init((GLsizeiptr) frameSprites * 4 * sizeof(Vertex) * FRAMES, FRAMES);
+  if (created) {
+    vertexArray = createQuadArray(vertexArrays, this->capacity, 4, indexBuffer);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+  vertexArrays.bindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+  if (!created) {
+    glDeleteProgram(program);
+    program = 0;
+    return false;
+  }
+
+  vertices.resize(this->capacity * 4);
+  boundTextures.reserve(units);
+  return true;
+}
+
+// The keys are unique, as they end with the index, so an unstable sort keeps
+// the order of the records within each layer, blend mode and texture. Frames
+// tend to repeat the order of the last one, so sorted records are common.
+void SpriteBatch::sort(const GLfloat* records, GLuint count) {
+  keys.resize(count);
+  bool sorted = true;
+  for (GLuint i = 0; i < count; i++) {
+    const GLfloat* record = records + (size_t) i * FIELDS;
+    GLint layer = (GLint) min(max(record[LAYER], -32768.0f), 32767.0f) + 32768;
+    uint64_t blend = (uint64_t) min(max(record[BLEND], 0.0f), (GLfloat) BLEND_PREMULTIPLIED);
+    uint64_t texture = (uint64_t) max(record[TEXTURE], 0.0f) & TEXTURE_MASK;
+    keys[i] = ((uint64_t) layer << (INDEX_BITS + TEXTURE_BITS + BLEND_BITS))
+      | (blend << (INDEX_BITS + TEXTURE_BITS))
+      | (texture << INDEX_BITS)
+      | i;
+    if (i && keys[i] < keys[i - 1]) {
+      sorted = false;
+    }
+  }
+  if (!sorted) {
+    std::sort(keys.begin(), keys.end());
+  }
+}
+
+// The corners go in the order top left, top right, bottom left, bottom right;
+// the four of a sprite are transformed at once where there is SIMD.
+void SpriteBatch::expand(const GLfloat* record, GLubyte unit, Vertex* out) {
+  GLfloat x0 = record[X], y0 = record[Y];
+  GLfloat x1 = x0 + record[WIDTH], y1 = y0 + record[HEIGHT];
+  GLfloat xs[4], ys[4];
+#if defined(__SSE__)
+  __m128 cornerX = _mm_setr_ps(x0, x1, x0, x1);
+  __m128 cornerY = _mm_setr_ps(y0, y0, y1, y1);
+  _mm_storeu_ps(xs, _mm_add_ps(_mm_add_ps(_mm_mul_ps(cornerX, _mm_set1_ps(record[A])),
+      _mm_mul_ps(cornerY, _mm_set1_ps(record[C]))), _mm_set1_ps(record[TX])));
+  _mm_storeu_ps(ys, _mm_add_ps(_mm_add_ps(_mm_mul_ps(cornerX, _mm_set1_ps(record[B])),
+      _mm_mul_ps(cornerY, _mm_set1_ps(record[D]))), _mm_set1_ps(record[TY])));
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const GLfloat cornersX[4] = { x0, x1, x0, x1 };
+  const GLfloat cornersY[4] = { y0, y0, y1, y1 };
+  float32x4_t cornerX = vld1q_f32(cornersX);
+  float32x4_t cornerY = vld1q_f32(cornersY);
+  vst1q_f32(xs, vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(record[TX]), cornerX, record[A]), cornerY, record[C]));
+  vst1q_f32(ys, vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(record[TY]), cornerX, record[B]), cornerY, record[D]));
+#else
+  const GLfloat cornersX[4] = { x0, x1, x0, x1 };
+  const GLfloat cornersY[4] = { y0, y0, y1, y1 };
+  for (int i = 0; i < 4; i++) {
+    xs[i] = cornersX[i] * record[A] + cornersY[i] * record[C] + record[TX];
+    ys[i] = cornersX[i] * record[B] + cornersY[i] * record[D] + record[TY];
+  }
+#endif
+
+  uint32_t color;
+  memcpy(&color, record + COLOR, sizeof(color));
+  const GLfloat us[4] = { record[U0], record[U1], record[U0], record[U1] };
+  const GLfloat vs[4] = { record[V0], record[V0], record[V1], record[V1] };
+  for (int i = 0; i < 4; i++) {
+    Vertex& vertex = out[i];
+    vertex.x = xs[i];
+    vertex.y = ys[i];
+    vertex.u = us[i];
+    vertex.v = vs[i];
+    vertex.color = color;
+    vertex.unit = unit;
+  }
+}
+
+void SpriteBatch::flush(GLsizei sprites, GLuint blend) {
+  GLsizeiptr bytes = (GLsizeiptr) sprites * 4 * sizeof(Vertex);
+  GLintptr offset = vertexBuffer.allocate(bytes, 4);
+  if (offset < 0) {
+    return;
+  }
+  vertexBuffer.write(offset, &vertices[0], bytes);
+
+  const GLsizei stride = sizeof(Vertex);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid *) offset);
+  vertexArrays.attribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, offset);
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid *) (offset + 8));
+  vertexArrays.attribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, offset + 8);
+  glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (const GLvoid *) (offset + 16));
+  vertexArrays.attribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, offset + 16);
+  glVertexAttribPointer(3, 1, GL_UNSIGNED_BYTE, GL_FALSE, stride, (const GLvoid *) (offset + 20));
+  vertexArrays.attribPointer(3, 1, GL_UNSIGNED_BYTE, GL_FALSE, stride, offset + 20);
+
+  switch (blend) {
+  case BLEND_OPAQUE:
+    glDisable(GL_BLEND);
+    break;
+  case BLEND_ADD:
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ZERO, GL_ONE);
+    break;
+  case BLEND_PREMULTIPLIED:
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    break;
+  default:
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    break;
+  }
+
+  glDrawElements(GL_TRIANGLES, sprites * 6, GL_UNSIGNED_SHORT, 0);
+}
+
+GLuint SpriteBatch::draw(const GLfloat* records, GLuint count, GLfloat width, GLfloat height) {
+  count = min(count, MAX_RECORDS);
+  if (!program || count == 0 || width <= 0 || height <= 0) {
+    return 0;
+  }
+
+  sort(records, count);
+
+  DrawState state(vertexArrays, units);
+
+  glUseProgram(program);
+  glUniform4f(viewLocation, 2 / width, -2 / height, -1, 1);
+  vertexArrays.bind(vertexArray);
+
+  // A draw takes the sorted sprites as long as they share the blend mode and
+  // their textures fit the units; layers are kept by the order of the quads.
+  GLuint draws = 0;
+  GLuint i = 0;
+  while (i < count) {
+    GLuint blend = blendOf(keys[i]);
+    GLuint texture = 0;
+    GLubyte unit = 0;
+    bool hasTexture = false;
+    boundTextures.clear();
+
+    GLsizei sprites = 0;
+    for (; i < count && (GLuint) sprites < capacity; i++) {
+      uint64_t key = keys[i];
+      if (blendOf(key) != blend) {
+        break;
+      }
+      if (!hasTexture || textureOf(key) != texture) {
+        texture = textureOf(key);
+        vector<GLuint>::iterator found = find(boundTextures.begin(), boundTextures.end(), texture);
+        if (found == boundTextures.end()) {
+          if (boundTextures.size() == units) {
+            break;
+          }
+          glActiveTexture(GL_TEXTURE0 + boundTextures.size());
+          glBindTexture(GL_TEXTURE_2D, texture);
+          found = boundTextures.insert(boundTextures.end(), texture);
+        }
+        unit = (GLubyte) (found - boundTextures.begin());
+        hasTexture = true;
+      }
+      expand(records + (size_t) indexOf(key) * FIELDS, unit, &vertices[sprites * 4]);
+      sprites++;
+    }
+
+    flush(sprites, blend);
+    draws++;
+  }
+
+  return draws;
+}
+
+} // end namespace webgl
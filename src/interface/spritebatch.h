@@ -0,0 +1,97 @@
+#ifndef SPRITEBATCH_H_
+#define SPRITEBATCH_H_
+
+#include <vector>
+#include <stdint.h>
+
+#include "glapi.h"
+#include "glext.h"
+#include "vertexarrays.h"
+#include "streamingbuffer.h"
+
+namespace webgl {
+
+// Draws textured quads from records that JS writes into a Float32Array, so
+// that a frame of sprites costs one call instead of several per sprite.
+//
+// The records are sorted by layer, then by blend mode and texture, so sprites
+// only keep their order across layers; within a layer, those with the same
+// blend mode and texture are drawn together. Each record is expanded to four
+// vertices in pixel coordinates (origin at the top left) into a streaming
+// vertex buffer, and one draw covers as many sprites as share a blend mode and
+// fit the texture units, up to capacity sprites.
+class SpriteBatch {
+public:
+  // The floats of a record. COLOR holds the bits of a 32 bit RGBA colour, red
+  // in the lowest byte, as written through a Uint32Array on the same buffer.
+  // The corners are x, y and x + width, y + height, transformed by the matrix
+  // a, b, c, d and the translation tx, ty; u0, v0 and u1, v1 are the texture
+  // coordinates at the corners.
+  enum Field {
+    TEXTURE, BLEND, LAYER, COLOR,
+    X, Y, WIDTH, HEIGHT,
+    U0, V0, U1, V1,
+    A, B, C, D, TX, TY,
+    FIELDS
+  };
+
+  enum Blend {
+    BLEND_ALPHA,
+    BLEND_ADD,
+    BLEND_OPAQUE,
+    BLEND_PREMULTIPLIED
+  };
+
+  // Sorting keeps this many bits of the record index, so no more records can
+  // be drawn at once.
+  static const GLuint MAX_RECORDS = 1 << 20;
+
+  SpriteBatch(const GLExtensions& extensions, VertexArrays& vertexArrays);
+  ~SpriteBatch();
+
+  // capacity is the number of sprites per draw, at most 16384 (16 bit
+  // indices); frameSprites the number expected per frame, which sizes the
+  // vertex buffer. Returns false if the program or buffers can't be created.
+  bool init(GLuint capacity, GLuint frameSprites);
+
+  GLuint textureUnits() const { return units; }
+
+  // Draws count records into the current framebuffer with the current viewport,
+  // which covers width x height pixels. Returns the number of draw calls.
+  // Leaves the GL state as it was.
+  GLuint draw(const GLfloat* records, GLuint count, GLfloat width, GLfloat height);
+
+private:
+  struct Vertex {
+    GLfloat x;
+    GLfloat y;
+    GLfloat u;
+    GLfloat v;
+    uint32_t color;
+    GLubyte unit;
+    GLubyte padding[3];
+  };
+
+  void sort(const GLfloat* records, GLuint count);
+  static void expand(const GLfloat* record, GLubyte unit, Vertex* out);
+  void flush(GLsizei sprites, GLuint blend);
+
+  const GLExtensions& extensions;
+  VertexArrays& vertexArrays;
+  StreamingBuffer vertexBuffer;
+  GLuint capacity;
+  GLuint units;
+
+  GLuint program;
+  GLint viewLocation;
+  GLuint indexBuffer;
+  GLuint vertexArray;
+
+  std::vector<uint64_t> keys;
+  std::vector<Vertex> vertices;
+  std::vector<GLuint> boundTextures;
+};
+
+}
+
+#endif /* SPRITEBATCH_H_ */
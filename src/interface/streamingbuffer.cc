@@ -0,0 +1,158 @@
+#include <cstring>
+
+#include "streamingbuffer.h"
+#include "../gles2platform.h"
+
+namespace webgl {
+
+using namespace std;
+
+StreamingBuffer::StreamingBuffer(const GLExtensions& extensions, VertexArrays& vertexArrays) :
+    extensions(extensions), vertexArrays(vertexArrays) {
+  vertexBuffer = 0;
+  bufferSize = 0;
+  regionSize = 0;
+  region = 0;
+  head = 0;
+  limit = 0;
+  used = false;
+  waitPending = false;
+}
+
+StreamingBuffer::~StreamingBuffer() {
+  if (vertexBuffer) {
+    gles2platform::removeFrameListener(frameListener, this);
+    glDeleteBuffers(1, &vertexBuffer);
+    vertexArrays.deleteBuffer(vertexBuffer);
+  }
+  for (size_t i = 0; i < fences.size(); i++) {
+    if (fences[i]) {
+      extensions.deleteSync(fences[i]);
+    }
+  }
+}
+
+bool StreamingBuffer::init(GLsizeiptr size, GLuint frames) {
+  if (size <= 0 || frames == 0) {
+    return false;
+  }
+
+  bufferSize = size;
+  if (extensions.fences) {
+    regionSize = size / frames;
+    fences.assign(frames, (GLsync) NULL);
+  } else {
+    regionSize = size;
+  }
+  if (regionSize <= 0) {
+    return false;
+  }
+
+  glGenBuffers(1, &vertexBuffer);
+  bind();
+  glBufferData(GL_ARRAY_BUFFER, bufferSize, NULL, GL_STREAM_DRAW);
+
+  head = 0;
+  limit = regionSize;
+  gles2platform::addFrameListener(frameListener, this);
+  return true;
+}
+
+void StreamingBuffer::frameListener(void* data) {
+  static_cast<StreamingBuffer*>(data)->endFrame();
+}
+
+void StreamingBuffer::bind() {
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  vertexArrays.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+}
+
+// Gives the buffer fresh storage; the draws that are still queued keep the
+// old one. All regions are free afterwards.
+void StreamingBuffer::orphan() {
+  bind();
+  glBufferData(GL_ARRAY_BUFFER, bufferSize, NULL, GL_STREAM_DRAW);
+  for (size_t i = 0; i < fences.size(); i++) {
+    if (fences[i]) {
+      extensions.deleteSync(fences[i]);
+      fences[i] = NULL;
+    }
+  }
+  region = 0;
+  head = 0;
+  limit = regionSize;
+  waitPending = false;
+}
+
+void StreamingBuffer::wait(GLuint region) {
+  GLsync fence = fences[region];
+  if (!fence) {
+    return;
+  }
+  extensions.waitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT);
+  extensions.deleteSync(fence);
+  fences[region] = NULL;
+}
+
+GLintptr StreamingBuffer::allocate(GLsizeiptr bytes, GLsizeiptr alignment) {
+  if (!vertexBuffer || bytes <= 0 || bytes > regionSize) {
+    return -1;
+  }
+
+  GLintptr offset = head;
+  if (alignment > 1) {
+    offset = (offset + alignment - 1) / alignment * alignment;
+  }
+  if (offset + bytes > limit) {
+    orphan();
+    offset = 0;
+  } else if (waitPending) {
+    wait(region);
+    waitPending = false;
+  }
+
+  head = offset + bytes;
+  used = true;
+  return offset;
+}
+
+void StreamingBuffer::write(GLintptr offset, const void* data, GLsizeiptr bytes) {
+  if (!vertexBuffer || bytes <= 0) {
+    return;
+  }
+
+  bind();
+
+  // allocate() made sure that nothing in flight reads this range.
+  if (extensions.bufferMapping) {
+    void* mapped = extensions.mapBufferRange(GL_ARRAY_BUFFER, offset, bytes,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (mapped) {
+      memcpy(mapped, data, bytes);
+      extensions.unmapBuffer(GL_ARRAY_BUFFER);
+      return;
+    }
+  }
+  glBufferSubData(GL_ARRAY_BUFFER, offset, bytes, data);
+}
+
+void StreamingBuffer::endFrame() {
+  if (!extensions.fences) {
+    // The buffer just fills up across frames.
+    return;
+  }
+
+  if (used) {
+    fences[region] = extensions.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    used = false;
+  }
+
+  // The next frame's region is waited for on its first allocation, to give
+  // the GPU as much time as possible.
+  region = (region + 1) % fences.size();
+  head = region * regionSize;
+  limit = head + regionSize;
+  waitPending = (fences[region] != NULL);
+}
+
+} // end namespace webgl
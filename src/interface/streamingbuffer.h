@@ -0,0 +1,67 @@
+#ifndef STREAMINGBUFFER_H_
+#define STREAMINGBUFFER_H_
+
+#include <vector>
+
+#include "glapi.h"
+#include "glext.h"
+#include "vertexarrays.h"
+
+namespace webgl {
+
+// A vertex buffer for geometry that is rebuilt every frame, used as a ring so
+// that uploads never have to wait for the draws that still read older data.
+//
+// With fences the buffer is split into one region per frame in flight. Each
+// frame allocates from its own region, which is fenced when nextFrame ends the
+// frame and waited for when the ring comes back to it, normally long after the
+// GPU is done with it. Without fences the whole buffer is filled in order and
+// orphaned when it is full, so that the driver hands out fresh storage instead
+// of synchronizing. A frame that overflows its region orphans the buffer too.
+//
+// Writes go through an unsynchronized buffer mapping when the context has one,
+// and through glBufferSubData otherwise.
+class StreamingBuffer {
+public:
+  StreamingBuffer(const GLExtensions& extensions, VertexArrays& vertexArrays);
+  ~StreamingBuffer();
+
+  // Returns false if the buffer can't be created.
+  bool init(GLsizeiptr size, GLuint frames);
+
+  GLuint buffer() const { return vertexBuffer; }
+  GLsizeiptr size() const { return bufferSize; }
+
+  // The offset of bytes that are free for this frame, or -1 if more than one
+  // frame's share of the buffer was asked for.
+  GLintptr allocate(GLsizeiptr bytes, GLsizeiptr alignment);
+
+  // Leaves the buffer bound to GL_ARRAY_BUFFER.
+  void write(GLintptr offset, const void* data, GLsizeiptr bytes);
+
+  // Called by nextFrame.
+  void endFrame();
+
+private:
+  static void frameListener(void* data);
+
+  void bind();
+  void orphan();
+  void wait(GLuint region);
+
+  const GLExtensions& extensions;
+  VertexArrays& vertexArrays;
+  GLuint vertexBuffer;
+  GLsizeiptr bufferSize;
+  GLsizeiptr regionSize;
+  GLuint region;
+  GLintptr head;
+  GLintptr limit;
+  bool used;
+  bool waitPending;
+  std::vector<GLsync> fences;
+};
+
+}
+
+#endif /* STREAMINGBUFFER_H_ */
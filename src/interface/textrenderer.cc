@@ -0,0 +1,572 @@
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+#include "textrenderer.h"
+#include "glprogram.h"
+#include "drawstate.h"
+
+namespace webgl {
+
+using namespace std;
+
+// Glyphs per draw; 16 bit indices address 65536 vertices, four per glyph.
+static const GLuint QUADS_PER_DRAW = 4096;
+
+// Frames of vertices that may be in flight.
+static const GLuint FRAMES = 3;
+
+// Distance field glyphs are rasterized at this size, with distances of up to
+// SPREAD pixels on either side of the edge.
+static const GLuint FIELD_SIZE = 32;
+static const GLint SPREAD = 4;
+
+// Bitmap glyphs are rasterized at whole pixel sizes up to this.
+static const GLuint MAX_PIXEL_SIZE = 1024;
+
+// Glyphs are in the alpha channel, or in the red one where there are no alpha
+// textures.
+static const char* LEGACY_COVERAGE = "#define COVERAGE(texel) texel.a\n";
+static const char* CORE_COVERAGE = "#define COVERAGE(texel) texel.r\n";
+
+// view maps pixels, with the origin at the top left, to clip space.
+static const char* VERTEX_SHADER =
+  "ATTRIBUTE vec2 position;\n"
+  "ATTRIBUTE vec2 texcoord;\n"
+  "uniform vec4 view;\n"
+  "VARYING vec2 uv;\n"
+  "void main() {\n"
+  "  uv = texcoord;\n"
+  "  gl_Position = vec4(position * view.xy + view.zw, 0.0, 1.0);\n"
+  "}\n";
+
+// Distances are stored around 0.5 at the edge; smoothing is half a screen
+// pixel in those units.
+static const char* FRAGMENT_SHADER =
+  "uniform sampler2D glyphs;\n"
+  "uniform vec4 color;\n"
+  "uniform float smoothing;\n"
+  "VARYING vec2 uv;\n"
+  "void main() {\n"
+  "  float coverage = COVERAGE(TEXTURE(glyphs, uv));\n"
+  "#ifdef DISTANCE_FIELD\n"
+  "  coverage = smoothstep(0.5 - smoothing, 0.5 + smoothing, coverage);\n"
+  "#endif\n"
+  "  FRAG_COLOR = vec4(color.rgb, color.a * coverage);\n"
+  "}\n";
+
+static inline uint64_t glyphKey(GLuint font, GLuint pixelSize, uint32_t glyph) {
+  return ((uint64_t) (font & 0xFFFF) << 48) | ((uint64_t) (pixelSize & 0xFFFF) << 32) | glyph;
+}
+
+#ifdef HAVE_FREETYPE
+// Malformed sequences become U+FFFD.
+static void decodeUtf8(const string& text, vector<uint32_t>& codepoints) {
+  codepoints.clear();
+  size_t i = 0;
+  while (i < text.size()) {
+    unsigned char lead = text[i++];
+    uint32_t codepoint;
+    int following;
+    if (lead < 0x80) {
+      codepoint = lead;
+      following = 0;
+    } else if ((lead & 0xE0) == 0xC0) {
+      codepoint = lead & 0x1F;
+      following = 1;
+    } else if ((lead & 0xF0) == 0xE0) {
+      codepoint = lead & 0x0F;
+      following = 2;
+    } else if ((lead & 0xF8) == 0xF0) {
+      codepoint = lead & 0x07;
+      following = 3;
+    } else {
+      codepoints.push_back(0xFFFD);
+      continue;
+    }
+    for (; following > 0 && i < text.size() && (text[i] & 0xC0) == 0x80; following--) {
+      codepoint = (codepoint << 6) | (text[i++] & 0x3F);
+    }
+    codepoints.push_back(following ? 0xFFFD : codepoint);
+  }
+}
+
+// The squared distance transform of one row or column (Felzenszwalb and
+// Huttenlocher): f holds 0 at the pixels that are measured to and a large
+// value elsewhere.
+static void distanceTransform(const float* f, float* d, int n, int* v, float* z) {
+  static const float FAR = 1e20f;
+  int k = 0;
+  v[0] = 0;
+  z[0] = -FAR;
+  z[1] = FAR;
+  for (int q = 1; q < n; q++) {
+    float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+    while (s <= z[k]) {
+      k--;
+      s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+    }
+    k++;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = FAR;
+  }
+  k = 0;
+  for (int q = 0; q < n; q++) {
+    while (z[k + 1] < q) {
+      k++;
+    }
+    d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+  }
+}
+
+static void distanceTransform(vector<float>& grid, int width, int height) {
+  int n = max(width, height);
+  vector<float> f(n), d(n), z(n + 1);
+  vector<int> v(n);
+  for (int x = 0; x < width; x++) {
+    for (int y = 0; y < height; y++) {
+      f[y] = grid[y * width + x];
+    }
+    distanceTransform(&f[0], &d[0], height, &v[0], &z[0]);
+    for (int y = 0; y < height; y++) {
+      grid[y * width + x] = d[y];
+    }
+  }
+  for (int y = 0; y < height; y++) {
+    distanceTransform(&grid[y * width], &d[0], width, &v[0], &z[0]);
+    copy(d.begin(), d.begin() + width, grid.begin() + y * width);
+  }
+}
+
+// Turns the coverage of a glyph into distances to its edge, SPREAD pixels
+// larger on each side: 128 on the edge, more inside.
+static void buildDistanceField(const vector<GLubyte>& coverage, GLsizei width, GLsizei height, vector<GLubyte>& field) {
+  static const float FAR = 1e20f;
+  int fieldWidth = width + 2 * SPREAD;
+  int fieldHeight = height + 2 * SPREAD;
+  vector<float> toInside(fieldWidth * fieldHeight, FAR);
+  vector<float> toOutside(fieldWidth * fieldHeight, 0);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      if (coverage[y * width + x] >= 128) {
+        int i = (y + SPREAD) * fieldWidth + x + SPREAD;
+        toInside[i] = 0;
+        toOutside[i] = FAR;
+      }
+    }
+  }
+  distanceTransform(toInside, fieldWidth, fieldHeight);
+  distanceTransform(toOutside, fieldWidth, fieldHeight);
+
+  field.resize(fieldWidth * fieldHeight);
+  for (size_t i = 0; i < field.size(); i++) {
+    // Pixel centres are half a pixel away from the edge between them.
+    float distance = toOutside[i] > 0 ? sqrt(toOutside[i]) - 0.5f : 0.5f - sqrt(toInside[i]);
+    float value = 128 + distance * 127 / SPREAD;
+    field[i] = (GLubyte) min(max(value, 0.0f), 255.0f);
+  }
+}
+#endif
+
+TextRenderer::TextRenderer(const GLExtensions& extensions, VertexArrays& vertexArrays)
+    : extensions(extensions), vertexArrays(vertexArrays), atlas(extensions), vertexBuffer(extensions, vertexArrays) {
+  distanceField = false;
+  program = 0;
+  viewLocation = -1;
+  colorLocation = -1;
+  smoothingLocation = -1;
+  indexBuffer = 0;
+  vertexArray = 0;
+#ifdef HAVE_FREETYPE
+  library = NULL;
+#endif
+  nextFont = 1;
+}
+
+TextRenderer::~TextRenderer() {
+#ifdef HAVE_FREETYPE
+  for (map<GLuint, Font*>::iterator it = fonts.begin(); it != fonts.end(); ++it) {
+    FT_Done_Face(it->second->face);
+    delete it->second;
+  }
+  if (library) {
+    FT_Done_FreeType(library);
+  }
+#endif
+  if (program) {
+    glDeleteProgram(program);
+  }
+  if (indexBuffer) {
+    glDeleteBuffers(1, &indexBuffer);
+    vertexArrays.deleteBuffer(indexBuffer);
+  }
+  if (vertexArray) {
+    vertexArrays.destroy(vertexArray);
+  }
+}
+
+bool TextRenderer::init(GLsizei pageSize, GLuint maxPages, bool distanceField, GLuint frameGlyphs) {
+  if (program) {
+    return false;
+  }
+
+  this->distanceField = distanceField;
+  atlas.init(pageSize, maxPages, evictionListener, this);
+
+  static const char* ATTRIBUTES[] = { "position", "texcoord", NULL };
+  string defines = extensions.coreProfile ? CORE_COVERAGE : LEGACY_COVERAGE;
+  if (distanceField) {
+    defines += "#define DISTANCE_FIELD\n";
+  }
+  program = createProgram(extensions, VERTEX_SHADER, FRAGMENT_SHADER, ATTRIBUTES, defines);
+  if (!program) {
+    return false;
+  }
+  viewLocation = glGetUniformLocation(program, "view");
+  colorLocation = glGetUniformLocation(program, "color");
+  smoothingLocation = glGetUniformLocation(program, "smoothing");
+
+  GLint previousProgram = 0, previousBuffer = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousBuffer);
+
+  glUseProgram(program);
+  glUniform1i(glGetUniformLocation(program, "glyphs"), 0);
+  glUseProgram(previousProgram);
+
+  frameGlyphs = max(frameGlyphs, QUADS_PER_DRAW);
+  bool created = vertexBuffer.init((GLsizeiptr) frameGlyphs * 4 * sizeof(Vertex) * FRAMES, FRAMES);
+  if (created) {
+    vertexArray = createQuadArray(vertexArrays, QUADS_PER_DRAW, 2, indexBuffer);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+  vertexArrays.bindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+  if (!created) {
+    glDeleteProgram(program);
+    program = 0;
+    return false;
+  }
+
+#ifdef HAVE_FREETYPE
+  if (FT_Init_FreeType(&library)) {
+    library = NULL;
+  }
+#endif
+  return true;
+}
+
+GLuint TextRenderer::loadFont(const unsigned char* data, size_t length) {
+#ifdef HAVE_FREETYPE
+  if (!library || !data || !length) {
+    return 0;
+  }
+
+  // FreeType reads the file from memory for as long as the face lives.
+  Font* font = new Font();
+  font->data.assign(data, data + length);
+  font->pixelSize = 0;
+  if (FT_New_Memory_Face(library, &font->data[0], (FT_Long) length, 0, &font->face)) {
+    delete font;
+    return 0;
+  }
+
+  GLuint id = nextFont++;
+  fonts[id] = font;
+  return id;
+#else
+  return 0;
+#endif
+}
+
+void TextRenderer::deleteFont(GLuint font) {
+#ifdef HAVE_FREETYPE
+  map<GLuint, Font*>::iterator it = fonts.find(font);
+  if (it == fonts.end()) {
+    return;
+  }
+  FT_Done_Face(it->second->face);
+  delete it->second;
+  fonts.erase(it);
+
+  // Its glyphs stay in the atlas until their pages are evicted.
+  uint64_t first = glyphKey(font, 0, 0);
+  metricsCache.erase(metricsCache.lower_bound(first), metricsCache.lower_bound(first + (1ull << 48)));
+#endif
+}
+
+#ifdef HAVE_FREETYPE
+TextRenderer::Font* TextRenderer::findFont(GLuint font) {
+  map<GLuint, Font*>::iterator it = fonts.find(font);
+  return it != fonts.end() ? it->second : NULL;
+}
+
+bool TextRenderer::setSize(Font& font, GLuint pixelSize) {
+  if (font.pixelSize == pixelSize) {
+    return true;
+  }
+  if (FT_Set_Pixel_Sizes(font.face, 0, pixelSize)) {
+    return false;
+  }
+  font.pixelSize = pixelSize;
+  return true;
+}
+
+const TextRenderer::Metrics* TextRenderer::metrics(GLuint fontId, Font& font, uint32_t glyph, GLuint pixelSize) {
+  uint64_t key = glyphKey(fontId, pixelSize, glyph);
+  map<uint64_t, Metrics>::iterator it = metricsCache.find(key);
+  if (it != metricsCache.end()) {
+    return &it->second;
+  }
+  if (!rasterize(font, glyph, pixelSize, key)) {
+    return NULL;
+  }
+  return &metricsCache[key];
+}
+
+// Records the glyph's metrics and puts its bitmap, if it has one, into the
+// atlas.
+bool TextRenderer::rasterize(Font& font, uint32_t glyph, GLuint pixelSize, uint64_t key) {
+  if (!setSize(font, pixelSize)) {
+    return false;
+  }
+  // Distance fields are scaled, so hinting for the raster size would distort
+  // them.
+  if (FT_Load_Glyph(font.face, glyph, FT_LOAD_RENDER | (distanceField ? FT_LOAD_NO_HINTING : 0))) {
+    return false;
+  }
+
+  FT_GlyphSlot slot = font.face->glyph;
+  const FT_Bitmap& bitmap = slot->bitmap;
+  Metrics metrics;
+  metrics.advance = slot->advance.x / 64.0f;
+  metrics.left = slot->bitmap_left;
+  metrics.top = slot->bitmap_top;
+  metrics.width = bitmap.width;
+  metrics.height = bitmap.rows;
+
+  vector<GLubyte> coverage(metrics.width * metrics.height);
+  for (GLsizei y = 0; y < metrics.height; y++) {
+    const unsigned char* row = bitmap.buffer + y * bitmap.pitch;
+    for (GLsizei x = 0; x < metrics.width; x++) {
+      if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
+        coverage[y * metrics.width + x] = (row[x >> 3] & (0x80 >> (x & 7))) ? 255 : 0;
+      } else {
+        coverage[y * metrics.width + x] = row[x];
+      }
+    }
+  }
+
+  if (distanceField && metrics.width && metrics.height) {
+    vector<GLubyte> field;
+    buildDistanceField(coverage, metrics.width, metrics.height, field);
+    coverage.swap(field);
+    metrics.left -= SPREAD;
+    metrics.top += SPREAD;
+    metrics.width += 2 * SPREAD;
+    metrics.height += 2 * SPREAD;
+  }
+
+  metricsCache[key] = metrics;
+  if (metrics.width && metrics.height) {
+    atlas.insert(key, &coverage[0], metrics.width, metrics.height);
+  }
+  return true;
+}
+#endif
+
+GLuint TextRenderer::rasterSize(const Style& style) const {
+  if (distanceField) {
+    return FIELD_SIZE;
+  }
+  return min(max((GLuint) lround(style.size), 1u), MAX_PIXEL_SIZE);
+}
+
+bool TextRenderer::layout(const string& text, const Style& style, GLfloat& width, GLfloat& height) {
+  placements.clear();
+  width = 0;
+  height = 0;
+#ifdef HAVE_FREETYPE
+  Font* font = findFont(style.font);
+  GLuint pixelSize = rasterSize(style);
+  if (!font || style.size <= 0 || !setSize(*font, pixelSize)) {
+    return false;
+  }
+  GLfloat scale = style.size / pixelSize;
+  FT_Face face = font->face;
+  GLfloat lineAdvance = face->size->metrics.height / 64.0f * scale * (style.lineHeight > 0 ? style.lineHeight : 1);
+  bool kerning = FT_HAS_KERNING(face);
+
+  vector<uint32_t> codepoints;
+  decodeUtf8(text, codepoints);
+
+  // A line that gets too wide is broken after its last space, and the glyphs
+  // after it move to the next line.
+  vector<GLfloat> lineWidths;
+  GLfloat pen = 0;
+  FT_UInt previous = 0;
+  size_t breakAt = 0;
+  GLfloat breakPen = 0, widthAtBreak = 0;
+  for (size_t i = 0; i < codepoints.size(); i++) {
+    uint32_t codepoint = codepoints[i];
+    if (codepoint == '\n') {
+      lineWidths.push_back(pen);
+      pen = 0;
+      previous = 0;
+      breakAt = 0;
+      continue;
+    }
+
+    FT_UInt glyph = FT_Get_Char_Index(face, codepoint);
+    if (kerning && previous && glyph) {
+      FT_Vector delta;
+      if (!FT_Get_Kerning(face, previous, glyph, FT_KERNING_DEFAULT, &delta)) {
+        pen += delta.x / 64.0f * scale;
+      }
+    }
+    const Metrics* glyphMetrics = metrics(style.font, *font, glyph, pixelSize);
+    if (!glyphMetrics) {
+      continue;
+    }
+    GLfloat advance = glyphMetrics->advance * scale;
+
+    if (style.maxWidth > 0 && codepoint != ' ' && pen + advance > style.maxWidth && breakAt) {
+      lineWidths.push_back(widthAtBreak);
+      for (size_t j = breakAt; j < placements.size(); j++) {
+        placements[j].x -= breakPen;
+        placements[j].line = lineWidths.size();
+      }
+      pen -= breakPen;
+      breakAt = 0;
+    }
+
+    Placement placement = { glyph, pen, 0, (GLuint) lineWidths.size() };
+    placements.push_back(placement);
+    if (codepoint == ' ') {
+      breakAt = placements.size();
+      breakPen = pen + advance;
+      widthAtBreak = pen;
+    }
+    pen += advance;
+    previous = glyph;
+  }
+  lineWidths.push_back(pen);
+
+  for (size_t i = 0; i < lineWidths.size(); i++) {
+    width = max(width, lineWidths[i]);
+  }
+  height = lineWidths.size() * lineAdvance;
+
+  // Lines are aligned within the widest one.
+  GLfloat ascender = face->size->metrics.ascender / 64.0f * scale;
+  for (size_t i = 0; i < placements.size(); i++) {
+    Placement& placement = placements[i];
+    if (style.align == ALIGN_CENTER) {
+      placement.x += (width - lineWidths[placement.line]) / 2;
+    } else if (style.align == ALIGN_RIGHT) {
+      placement.x += width - lineWidths[placement.line];
+    }
+    placement.y = ascender + placement.line * lineAdvance;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+void TextRenderer::measure(const string& text, const Style& style, GLfloat& width, GLfloat& height) {
+  layout(text, style, width, height);
+}
+
+void TextRenderer::evictionListener(void* data, GLuint page) {
+  // Quads that still use the page have to be drawn before it is reused.
+  static_cast<TextRenderer*>(data)->flush(page);
+}
+
+void TextRenderer::flush(GLuint page) {
+  if (page >= quads.size() || quads[page].empty()) {
+    return;
+  }
+
+  vector<Vertex>& pending = quads[page];
+  GLsizeiptr bytes = (GLsizeiptr) pending.size() * sizeof(Vertex);
+  GLintptr offset = vertexBuffer.allocate(bytes, 4);
+  if (offset >= 0) {
+    vertexBuffer.write(offset, &pending[0], bytes);
+
+    const GLsizei stride = sizeof(Vertex);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid *) offset);
+    vertexArrays.attribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, offset);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid *) (offset + 8));
+    vertexArrays.attribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, offset + 8);
+
+    glBindTexture(GL_TEXTURE_2D, atlas.texture(page));
+    glDrawElements(GL_TRIANGLES, (GLsizei) (pending.size() / 4 * 6), GL_UNSIGNED_SHORT, 0);
+  }
+  pending.clear();
+}
+
+void TextRenderer::drawText(const string& text, GLfloat x, GLfloat y, const Style& style, GLfloat width, GLfloat height) {
+  GLfloat boxWidth, boxHeight;
+  if (!program || width <= 0 || height <= 0 || !layout(text, style, boxWidth, boxHeight)) {
+    return;
+  }
+
+  DrawState state(vertexArrays, 1);
+  glEnable(GL_BLEND);
+  glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+  GLuint pixelSize = rasterSize(style);
+  GLfloat scale = style.size / pixelSize;
+  glUseProgram(program);
+  glUniform4f(viewLocation, 2 / width, -2 / height, -1, 1);
+  glUniform4f(colorLocation, style.color[0], style.color[1], style.color[2], style.color[3]);
+  glUniform1f(smoothingLocation, 0.7f / (2 * SPREAD * scale));
+  vertexArrays.bind(vertexArray);
+
+#ifdef HAVE_FREETYPE
+  Font* font = findFont(style.font);
+  for (size_t i = 0; i < placements.size(); i++) {
+    const Placement& placement = placements[i];
+    uint64_t key = glyphKey(style.font, pixelSize, placement.glyph);
+    const Metrics& glyphMetrics = metricsCache[key];
+    if (!glyphMetrics.width || !glyphMetrics.height) {
+      continue;
+    }
+    const GlyphAtlas::Glyph* found = atlas.find(key);
+    if (!found) {
+      // Evicted since layout.
+      rasterize(*font, placement.glyph, pixelSize, key);
+      found = atlas.find(key);
+      if (!found) {
+        continue;
+      }
+    }
+    GlyphAtlas::Glyph glyph = *found;
+
+    GLfloat x0 = x + placement.x + glyphMetrics.left * scale;
+    GLfloat y0 = y + placement.y - glyphMetrics.top * scale;
+    GLfloat x1 = x0 + glyphMetrics.width * scale;
+    GLfloat y1 = y0 + glyphMetrics.height * scale;
+    if (quads.size() <= glyph.page) {
+      quads.resize(glyph.page + 1);
+    }
+    vector<Vertex>& pending = quads[glyph.page];
+    Vertex corners[4] = {
+      { x0, y0, glyph.u0, glyph.v0 },
+      { x1, y0, glyph.u1, glyph.v0 },
+      { x0, y1, glyph.u0, glyph.v1 },
+      { x1, y1, glyph.u1, glyph.v1 }
+    };
+    pending.insert(pending.end(), corners, corners + 4);
+    if (pending.size() >= QUADS_PER_DRAW * 4) {
+      flush(glyph.page);
+    }
+  }
+#endif
+  for (GLuint page = 0; page < quads.size(); page++) {
+    flush(page);
+  }
+}
+
+} // end namespace webgl
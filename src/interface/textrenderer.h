@@ -0,0 +1,147 @@
+#ifndef TEXTRENDERER_H_
+#define TEXTRENDERER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#ifdef HAVE_FREETYPE
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#endif
+
+#include "glapi.h"
+#include "glext.h"
+#include "vertexarrays.h"
+#include "streamingbuffer.h"
+#include "glyphatlas.h"
+
+namespace webgl {
+
+// Lays out UTF-8 text with FreeType fonts and draws it as quads, one draw per
+// atlas page, from glyphs that are rasterized once into a GlyphAtlas.
+//
+// Bitmap glyphs are rasterized at each pixel size they are drawn at. Signed
+// distance field glyphs are rasterized once at a fixed size and drawn at any
+// size, scaled, with the edge found in the shader; they cost less atlas space
+// when text comes in many sizes, but lose hinting and fine detail.
+//
+// Layout applies kerning and breaks lines at newlines and, with a maximum
+// width, at spaces. There is no shaping beyond that: scripts that need
+// ligatures or reordering come out as their separate glyphs.
+//
+// Without FreeType (HAVE_FREETYPE), no font can be loaded.
+class TextRenderer {
+public:
+  enum Align {
+    ALIGN_LEFT,
+    ALIGN_CENTER,
+    ALIGN_RIGHT
+  };
+
+  struct Style {
+    GLuint font;
+    // The em size in pixels.
+    GLfloat size;
+    GLfloat color[4];
+    // Lines are broken at spaces to fit, if more than 0.
+    GLfloat maxWidth;
+    // The distance between baselines, as a multiple of the font's.
+    GLfloat lineHeight;
+    Align align;
+  };
+
+  TextRenderer(const GLExtensions& extensions, VertexArrays& vertexArrays);
+  ~TextRenderer();
+
+  // frameGlyphs is the number of glyphs expected per frame, which sizes the
+  // vertex buffer. Returns false if the program or buffers can't be created.
+  bool init(GLsizei pageSize, GLuint maxPages, bool distanceField, GLuint frameGlyphs);
+
+  // Copies the font file. Returns 0 if it can't be read.
+  GLuint loadFont(const unsigned char* data, size_t length);
+  void deleteFont(GLuint font);
+
+  // The size of the box that drawText fills.
+  void measure(const std::string& text, const Style& style, GLfloat& width, GLfloat& height);
+
+  // Draws text into the current framebuffer with the top left of its box at
+  // x, y, in a viewport that covers width x height pixels. Leaves the GL state
+  // as it was.
+  void drawText(const std::string& text, GLfloat x, GLfloat y, const Style& style, GLfloat width, GLfloat height);
+
+private:
+  struct Vertex {
+    GLfloat x;
+    GLfloat y;
+    GLfloat u;
+    GLfloat v;
+  };
+
+  // A glyph's bitmap relative to the pen, and its advance, in pixels at the
+  // size it was rasterized at.
+  struct Metrics {
+    GLfloat advance;
+    GLint left;
+    GLint top;
+    GLsizei width;
+    GLsizei height;
+  };
+
+  // A glyph's pen position, with y on the baseline.
+  struct Placement {
+    uint32_t glyph;
+    GLfloat x;
+    GLfloat y;
+    GLuint line;
+  };
+
+#ifdef HAVE_FREETYPE
+  struct Font {
+    FT_Face face;
+    std::vector<unsigned char> data;
+    GLuint pixelSize;
+  };
+
+  Font* findFont(GLuint font);
+  bool setSize(Font& font, GLuint pixelSize);
+  const Metrics* metrics(GLuint fontId, Font& font, uint32_t glyph, GLuint pixelSize);
+  bool rasterize(Font& font, uint32_t glyph, GLuint pixelSize, uint64_t key);
+#endif
+
+  static void evictionListener(void* data, GLuint page);
+
+  // Fills placements in pixels at the style's size, relative to the top left
+  // of the box; returns false if the font isn't loaded.
+  bool layout(const std::string& text, const Style& style, GLfloat& width, GLfloat& height);
+  GLuint rasterSize(const Style& style) const;
+  void flush(GLuint page);
+
+  const GLExtensions& extensions;
+  VertexArrays& vertexArrays;
+  GlyphAtlas atlas;
+  StreamingBuffer vertexBuffer;
+  bool distanceField;
+
+  GLuint program;
+  GLint viewLocation;
+  GLint colorLocation;
+  GLint smoothingLocation;
+  GLuint indexBuffer;
+  GLuint vertexArray;
+
+#ifdef HAVE_FREETYPE
+  FT_Library library;
+  std::map<GLuint, Font*> fonts;
+#endif
+  GLuint nextFont;
+  std::map<uint64_t, Metrics> metricsCache;
+  std::vector<Placement> placements;
+  // Quads waiting to be drawn, by page.
+  std::vector<std::vector<Vertex> > quads;
+};
+
+}
+
+#endif /* TEXTRENDERER_H_ */
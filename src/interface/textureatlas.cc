@@ -0,0 +1,332 @@
+#include <cstring>
+#include <algorithm>
+
+#include "textureatlas.h"
+#include "gl3.h"
+#include "unpackstate.h"
+
+namespace webgl {
+
+using namespace std;
+
+TextureAtlas::TextureAtlas(const GLExtensions& extensions) : extensions(extensions) {
+  pageSize = 0;
+  maxPages = 0;
+  padding = 0;
+  nextHandle = 1;
+  currentGeneration = 0;
+  fragmented = false;
+}
+
+TextureAtlas::~TextureAtlas() {
+  for (size_t i = 0; i < pages.size(); i++) {
+    glDeleteTextures(1, &pages[i].texture);
+  }
+}
+
+void TextureAtlas::init(GLsizei pageSize, GLuint maxPages, GLsizei padding) {
+  GLint maxTextureSize = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+  this->pageSize = max(pageSize, (GLsizei) 64);
+  if (maxTextureSize > 0) {
+    this->pageSize = min(this->pageSize, (GLsizei) maxTextureSize);
+  }
+  this->maxPages = max(maxPages, 1u);
+  this->padding = max(padding, (GLsizei) 0);
+}
+
+void TextureAtlas::resetSkyline(vector<Segment>& skyline, GLsizei size) {
+  Segment segment;
+  segment.x = 0;
+  segment.y = 0;
+  segment.width = size;
+  skyline.assign(1, segment);
+}
+
+// The y at which a width x height rectangle rests on the skyline, with its
+// left edge on the segment at index.
+bool TextureAtlas::fit(const vector<Segment>& skyline, size_t index, GLsizei width, GLsizei height,
+    GLint& y) const {
+  if (skyline[index].x + width > pageSize) {
+    return false;
+  }
+  y = 0;
+  GLsizei left = width;
+  for (size_t i = index; left > 0; i++) {
+    y = max(y, skyline[i].y);
+    left -= skyline[i].width;
+  }
+  return y + height <= pageSize;
+}
+
+// Places the rectangle as low as possible, then as far left, and raises the
+// skyline over it.
+bool TextureAtlas::place(vector<Segment>& skyline, GLsizei width, GLsizei height, GLint& x, GLint& y) const {
+  size_t best = skyline.size();
+  GLint bestY = 0;
+  for (size_t i = 0; i < skyline.size(); i++) {
+    GLint segmentY;
+    if (fit(skyline, i, width, height, segmentY) && (best == skyline.size() || segmentY < bestY)) {
+      best = i;
+      bestY = segmentY;
+    }
+  }
+  if (best == skyline.size()) {
+    return false;
+  }
+  x = skyline[best].x;
+  y = bestY;
+
+  Segment segment;
+  segment.x = x;
+  segment.y = y + height;
+  segment.width = width;
+  skyline.insert(skyline.begin() + best, segment);
+
+  // Cut the segments that are now under the rectangle.
+  for (size_t i = best + 1; i < skyline.size();) {
+    GLint end = skyline[i - 1].x + skyline[i - 1].width;
+    if (skyline[i].x >= end) {
+      break;
+    }
+    GLsizei covered = end - skyline[i].x;
+    if (skyline[i].width <= covered) {
+      skyline.erase(skyline.begin() + i);
+      continue;
+    }
+    skyline[i].x += covered;
+    skyline[i].width -= covered;
+    break;
+  }
+
+  for (size_t i = 1; i < skyline.size();) {
+    if (skyline[i].y == skyline[i - 1].y) {
+      skyline[i - 1].width += skyline[i].width;
+      skyline.erase(skyline.begin() + i);
+    } else {
+      i++;
+    }
+  }
+  return true;
+}
+
+GLuint TextureAtlas::createTexture() {
+  GLuint texture = 0;
+  GLint previousTexture = 0;
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pageSize, pageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  glBindTexture(GL_TEXTURE_2D, previousTexture);
+  return texture;
+}
+
+GLuint TextureAtlas::add(const GLubyte* pixels, GLsizei width, GLsizei height) {
+  if (!pixels || width <= 0 || height <= 0) {
+    return 0;
+  }
+  GLsizei paddedWidth = width + 2 * padding;
+  GLsizei paddedHeight = height + 2 * padding;
+  if (paddedWidth > pageSize || paddedHeight > pageSize) {
+    return 0;
+  }
+
+  Entry entry;
+  entry.width = paddedWidth;
+  entry.height = paddedHeight;
+  bool placed = false;
+  for (GLuint i = 0; i < pages.size() && !placed; i++) {
+    if (place(pages[i].skyline, paddedWidth, paddedHeight, entry.x, entry.y)) {
+      entry.page = i;
+      placed = true;
+    }
+  }
+  if (!placed && pages.size() < maxPages) {
+    Page page;
+    page.texture = createTexture();
+    page.images = 0;
+    resetSkyline(page.skyline, pageSize);
+    pages.push_back(page);
+    entry.page = pages.size() - 1;
+    placed = place(pages.back().skyline, paddedWidth, paddedHeight, entry.x, entry.y);
+  }
+  if (!placed && fragmented) {
+    placed = defragment(paddedWidth, paddedHeight, entry);
+  }
+  if (!placed) {
+    return 0;
+  }
+
+  // Repeat the edge pixels into the padding.
+  staging.resize(paddedWidth * paddedHeight * 4);
+  for (GLsizei row = 0; row < paddedHeight; row++) {
+    GLsizei source = min(max(row - padding, (GLsizei) 0), height - 1);
+    const GLubyte* from = pixels + source * width * 4;
+    GLubyte* to = &staging[row * paddedWidth * 4];
+    for (GLsizei column = 0; column < padding; column++) {
+      memcpy(to + column * 4, from, 4);
+      memcpy(to + (padding + width + column) * 4, from + (width - 1) * 4, 4);
+    }
+    memcpy(to + padding * 4, from, width * 4);
+  }
+
+  GLint previousTexture = 0;
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+  {
+    ClientUnpackState unpack(extensions, 1);
+    glBindTexture(GL_TEXTURE_2D, pages[entry.page].texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, entry.x, entry.y, paddedWidth, paddedHeight, GL_RGBA, GL_UNSIGNED_BYTE,
+        &staging[0]);
+  }
+  glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+  pages[entry.page].images++;
+  GLuint handle = nextHandle++;
+  entries[handle] = entry;
+  return handle;
+}
+
+bool TextureAtlas::remove(GLuint handle) {
+  map<GLuint, Entry>::iterator it = entries.find(handle);
+  if (it == entries.end()) {
+    return false;
+  }
+  Page& page = pages[it->second.page];
+  entries.erase(it);
+  // An empty page can be packed from scratch, without moving anything.
+  if (--page.images == 0) {
+    resetSkyline(page.skyline, pageSize);
+  } else {
+    fragmented = true;
+  }
+  return true;
+}
+
+bool TextureAtlas::lookup(GLuint handle, Region& region) const {
+  map<GLuint, Entry>::const_iterator it = entries.find(handle);
+  if (it == entries.end()) {
+    return false;
+  }
+  const Entry& entry = it->second;
+  region.texture = pages[entry.page].texture;
+  region.u0 = (GLfloat) (entry.x + padding) / pageSize;
+  region.v0 = (GLfloat) (entry.y + padding) / pageSize;
+  region.u1 = (GLfloat) (entry.x + entry.width - padding) / pageSize;
+  region.v1 = (GLfloat) (entry.y + entry.height - padding) / pageSize;
+  region.width = entry.width - 2 * padding;
+  region.height = entry.height - 2 * padding;
+  return true;
+}
+
+// Repacks the images, and a width x height rectangle that is placed for the
+// caller, into new pages, tallest first, which packs a skyline best. Leaves
+// everything as it was if they don't fit into maxPages.
+bool TextureAtlas::defragment(GLsizei width, GLsizei height, Entry& placed) {
+  // (height, width, handle); the handle 0 is the new rectangle.
+  vector<pair<pair<GLsizei, GLsizei>, GLuint> > order;
+  order.push_back(make_pair(make_pair(height, width), 0u));
+  for (map<GLuint, Entry>::const_iterator it = entries.begin(); it != entries.end(); it++) {
+    order.push_back(make_pair(make_pair(it->second.height, it->second.width), it->first));
+  }
+  sort(order.rbegin(), order.rend());
+
+  vector<vector<Segment> > skylines;
+  map<GLuint, Entry> moved;
+  for (size_t i = 0; i < order.size(); i++) {
+    Entry entry;
+    entry.height = order[i].first.first;
+    entry.width = order[i].first.second;
+    bool fits = false;
+    for (GLuint page = 0; page < skylines.size() && !fits; page++) {
+      if (place(skylines[page], entry.width, entry.height, entry.x, entry.y)) {
+        entry.page = page;
+        fits = true;
+      }
+    }
+    if (!fits && skylines.size() < maxPages) {
+      skylines.push_back(vector<Segment>());
+      resetSkyline(skylines.back(), pageSize);
+      entry.page = skylines.size() - 1;
+      fits = place(skylines.back(), entry.width, entry.height, entry.x, entry.y);
+    }
+    if (!fits) {
+      return false;
+    }
+    moved[order[i].second] = entry;
+  }
+
+  vector<Page> repacked(skylines.size());
+  for (size_t i = 0; i < repacked.size(); i++) {
+    repacked[i].texture = createTexture();
+    repacked[i].skyline.swap(skylines[i]);
+    repacked[i].images = 0;
+  }
+
+  // Copy the images with their padding, reading each old page through a
+  // framebuffer.
+  // OpenGL ES 3.0 and OpenGL 3.0 have separate read and draw framebuffers,
+  // which binding GL_FRAMEBUFFER sets both of.
+  bool separateFramebuffers = extensions.version >= 300;
+  GLint previousReadFramebuffer = 0, previousDrawFramebuffer = 0, previousTexture = 0;
+  if (separateFramebuffers) {
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDrawFramebuffer);
+  } else {
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousDrawFramebuffer);
+  }
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+  GLuint framebuffer = 0;
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  bool complete = true;
+  for (GLuint page = 0; page < pages.size() && complete; page++) {
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pages[page].texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+      complete = false;
+      break;
+    }
+    for (map<GLuint, Entry>::const_iterator it = entries.begin(); it != entries.end(); it++) {
+      if (it->second.page != page) {
+        continue;
+      }
+      const Entry& from = it->second;
+      const Entry& to = moved[it->first];
+      glBindTexture(GL_TEXTURE_2D, repacked[to.page].texture);
+      glCopyTexSubImage2D(GL_TEXTURE_2D, 0, to.x, to.y, from.x, from.y, from.width, from.height);
+    }
+  }
+  if (separateFramebuffers) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousDrawFramebuffer);
+  } else {
+    glBindFramebuffer(GL_FRAMEBUFFER, previousDrawFramebuffer);
+  }
+  glDeleteFramebuffers(1, &framebuffer);
+  glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+  if (!complete) {
+    for (size_t i = 0; i < repacked.size(); i++) {
+      glDeleteTextures(1, &repacked[i].texture);
+    }
+    return false;
+  }
+
+  for (size_t i = 0; i < pages.size(); i++) {
+    glDeleteTextures(1, &pages[i].texture);
+  }
+  pages.swap(repacked);
+  for (map<GLuint, Entry>::iterator it = entries.begin(); it != entries.end(); it++) {
+    it->second = moved[it->first];
+    pages[it->second.page].images++;
+  }
+  placed = moved[0];
+  fragmented = false;
+  currentGeneration++;
+  return true;
+}
+
+} // end namespace webgl
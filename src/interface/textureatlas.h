@@ -0,0 +1,100 @@
+#ifndef TEXTUREATLAS_H_
+#define TEXTUREATLAS_H_
+
+#include <map>
+#include <vector>
+
+#include "glapi.h"
+#include "glext.h"
+
+namespace webgl {
+
+// RGBA textures (pages) that small images are packed into at runtime, so that
+// they can be drawn from a handful of textures, in one sprite batch.
+//
+// Pages are packed bottom-left along a skyline: the top edge of the images
+// placed so far, kept as segments of equal height. Each image is padded with
+// copies of its edge pixels, so that linear filtering at its edges doesn't
+// pick up its neighbours.
+//
+// Removed images leave holes that the skyline can't reuse, unless they empty
+// their page, which is then packed from scratch. When an image fits in none
+// of the pages and no more pages may be created, the images that are left are
+// repacked into new pages, copied on the GPU, and the old pages are deleted;
+// this changes the textures and coordinates of every image, and the
+// generation, so that they can be looked up again.
+class TextureAtlas {
+public:
+  struct Region {
+    GLuint texture;
+    // Texture coordinates of the image, without the padding around it.
+    GLfloat u0, v0, u1, v1;
+    GLsizei width;
+    GLsizei height;
+  };
+
+  TextureAtlas(const GLExtensions& extensions);
+  ~TextureAtlas();
+
+  // pageSize is clamped to GL_MAX_TEXTURE_SIZE. Pages are created as they
+  // are needed.
+  void init(GLsizei pageSize, GLuint maxPages, GLsizei padding);
+
+  // Uploads the width x height RGBA pixels, rows tightly packed. Returns a
+  // handle to the image, or 0 if it doesn't fit even after defragmenting.
+  GLuint add(const GLubyte* pixels, GLsizei width, GLsizei height);
+  // Returns false if there is no such image.
+  bool remove(GLuint handle);
+  bool lookup(GLuint handle, Region& region) const;
+
+  GLuint texture(GLuint page) const { return pages[page].texture; }
+  size_t pageCount() const { return pages.size(); }
+  size_t imageCount() const { return entries.size(); }
+  // Changes whenever images move.
+  GLuint generation() const { return currentGeneration; }
+
+private:
+  struct Segment {
+    GLint x;
+    GLint y;
+    GLsizei width;
+  };
+
+  struct Page {
+    GLuint texture;
+    std::vector<Segment> skyline;
+    size_t images;
+  };
+
+  // Where an image is, with its padding.
+  struct Entry {
+    GLuint page;
+    GLint x;
+    GLint y;
+    GLsizei width;
+    GLsizei height;
+  };
+
+  static void resetSkyline(std::vector<Segment>& skyline, GLsizei size);
+  bool fit(const std::vector<Segment>& skyline, size_t index, GLsizei width, GLsizei height, GLint& y) const;
+  bool place(std::vector<Segment>& skyline, GLsizei width, GLsizei height, GLint& x, GLint& y) const;
+  GLuint createTexture();
+  bool defragment(GLsizei width, GLsizei height, Entry& placed);
+
+  const GLExtensions& extensions;
+  GLsizei pageSize;
+  GLuint maxPages;
+  GLsizei padding;
+  std::vector<Page> pages;
+  std::map<GLuint, Entry> entries;
+  GLuint nextHandle;
+  GLuint currentGeneration;
+  // Whether images were removed since the last defragmentation, which only
+  // then can make room.
+  bool fragmented;
+  std::vector<GLubyte> staging;
+};
+
+}
+
+#endif /* TEXTUREATLAS_H_ */
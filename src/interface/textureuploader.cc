@@ -0,0 +1,341 @@
+#include <cstdlib>
+
+#include "textureuploader.h"
+#include "gl3.h"
+#include "unpackstate.h"
+
+namespace webgl {
+
+using namespace std;
+
+set<TextureUploader*> TextureUploader::running;
+mutex TextureUploader::runningMutex;
+
+static size_t componentsOf(GLenum format) {
+  switch (format) {
+  case GL_ALPHA: case GL_LUMINANCE: case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: return 1;
+  case GL_LUMINANCE_ALPHA: case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL: return 2;
+  case GL_RGB: case GL_RGB_INTEGER: return 3;
+  case GL_RGBA: case GL_RGBA_INTEGER: return 4;
+  default: return 0;
+  }
+}
+
+// Packed types hold a whole pixel, the others one component.
+static size_t bytesOf(GLenum type, bool& packed) {
+  packed = false;
+  switch (type) {
+  case GL_UNSIGNED_BYTE: case GL_BYTE: return 1;
+  case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: case GL_HALF_FLOAT_OES: return 2;
+  case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: return 4;
+  case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1:
+    packed = true;
+    return 2;
+  case GL_UNSIGNED_INT_2_10_10_10_REV: case GL_UNSIGNED_INT_10F_11F_11F_REV: case GL_UNSIGNED_INT_5_9_9_9_REV:
+  case GL_UNSIGNED_INT_24_8:
+    packed = true;
+    return 4;
+  default: return 0;
+  }
+}
+
+size_t TextureUploader::imageSize(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint alignment) {
+  if (width <= 0 || height <= 0) {
+    return 0;
+  }
+  bool packed;
+  size_t bytes = bytesOf(type, packed);
+  size_t pixel = packed ? bytes : bytes * componentsOf(format);
+  size_t align = alignment > 0 ? alignment : 1;
+  size_t row = pixel * width;
+  size_t stride = (row + align - 1) / align * align;
+  return stride * (height - 1) + row;
+}
+
+TextureUploader::TextureUploader(const GLExtensions& extensions) : extensions(extensions) {
+  failed = false;
+  context = NULL;
+  started = false;
+  stopping = false;
+  nextJob = 1;
+}
+
+TextureUploader::~TextureUploader() {
+  stop();
+  while (!jobs.empty()) {
+    release(jobs.begin()->first);
+  }
+}
+
+bool TextureUploader::start() {
+  if (started) {
+    return true;
+  }
+  if (failed) {
+    return false;
+  }
+
+  context = gles2impl::createSharedContext(gles2impl::currentContext());
+  if (!context) {
+    failed = true;
+    return false;
+  }
+
+  stopping = false;
+  worker = thread(&TextureUploader::run, this);
+
+  // Wait until the worker made its context current, or failed to.
+  {
+    unique_lock<mutex> lock(queueMutex);
+    finished.wait(lock, [this] { return started || stopping; });
+  }
+  if (!started) {
+    worker.join();
+    gles2impl::destroySharedContext(context);
+    context = NULL;
+    failed = true;
+    return false;
+  }
+
+  // The worker has to be stopped before the backend tears down its display.
+  lock_guard<mutex> lock(runningMutex);
+  static bool registered = false;
+  if (!registered) {
+    atexit(AtExit);
+    registered = true;
+  }
+  running.insert(this);
+  return true;
+}
+
+GLuint TextureUploader::upload(const Upload& upload, Local<Value> source) {
+  reap();
+
+  GLuint id = nextJob++;
+
+  if (!start()) {
+    // On the main context, the application's binding and unpack state are
+    // restored.
+    GLenum bindTarget = bindTargetOf(upload.target);
+    GLint bound = 0;
+    glGetIntegerv(bindTarget == GL_TEXTURE_2D ? GL_TEXTURE_BINDING_2D : GL_TEXTURE_BINDING_CUBE_MAP, &bound);
+    {
+      ClientUnpackState unpack(extensions, upload.alignment);
+      perform(upload);
+    }
+    glBindTexture(bindTarget, bound);
+    return id;
+  }
+
+  JobPtr job(new Job());
+  job->upload = upload;
+  job->done = false;
+  job->fence = NULL;
+  job->source.Reset(source);
+  jobs[id] = job;
+
+  {
+    lock_guard<mutex> lock(queueMutex);
+    queue.push_back(job);
+  }
+  wake.notify_one();
+
+  return id;
+}
+
+// Cube map faces are uploaded with the texture bound to the cube map.
+GLenum TextureUploader::bindTargetOf(GLenum target) {
+  if (target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z) {
+    return GL_TEXTURE_CUBE_MAP;
+  }
+  return target;
+}
+
+void TextureUploader::perform(const Upload& upload) {
+  const Upload& u = upload;
+  glBindTexture(bindTargetOf(u.target), u.texture);
+  if (u.sub) {
+    glTexSubImage2D(u.target, u.level, u.xoffset, u.yoffset, u.width, u.height, u.format, u.type, u.pixels);
+  } else {
+    glTexImage2D(u.target, u.level, u.internalformat, u.width, u.height, 0, u.format, u.type, u.pixels);
+  }
+}
+
+bool TextureUploader::isComplete(GLuint id) {
+  map<GLuint, JobPtr>::iterator it = jobs.find(id);
+  if (it == jobs.end()) {
+    return true;
+  }
+
+  {
+    lock_guard<mutex> lock(queueMutex);
+    if (!it->second->done) {
+      return false;
+    }
+  }
+  if (!isSignalled(it->second)) {
+    return false;
+  }
+
+  release(id);
+  return true;
+}
+
+void TextureUploader::finish(GLuint id) {
+  map<GLuint, JobPtr>::iterator it = jobs.find(id);
+  if (it == jobs.end()) {
+    return;
+  }
+
+  wait(it->second);
+  release(id);
+}
+
+void TextureUploader::finishTexture(GLuint texture) {
+  map<GLuint, JobPtr>::iterator it = jobs.begin();
+  while (it != jobs.end()) {
+    GLuint id = it->first;
+    bool matches = it->second->upload.texture == texture;
+    ++it;
+    if (matches) {
+      finish(id);
+    }
+  }
+}
+
+size_t TextureUploader::pending() {
+  reap();
+  return jobs.size();
+}
+
+void TextureUploader::wait(const JobPtr& job) {
+  {
+    unique_lock<mutex> lock(queueMutex);
+    finished.wait(lock, [&job] { return job->done; });
+  }
+
+  if (job->fence) {
+    extensions.waitSync(job->fence, 0);
+  }
+}
+
+// Only called for jobs that the worker is done with.
+bool TextureUploader::isSignalled(const JobPtr& job) {
+  if (!job->fence) {
+    return true;
+  }
+  return extensions.clientWaitSync(job->fence, 0, 0) != GL_TIMEOUT_EXPIRED;
+}
+
+void TextureUploader::release(GLuint id) {
+  map<GLuint, JobPtr>::iterator it = jobs.find(id);
+  JobPtr job = it->second;
+  if (job->fence) {
+    extensions.deleteSync(job->fence);
+    job->fence = NULL;
+  }
+  // The worker may hold the last reference, so the handle is released here.
+  job->source.Reset();
+  jobs.erase(it);
+}
+
+// Forgets complete uploads that nothing asked about.
+void TextureUploader::reap() {
+  map<GLuint, JobPtr>::iterator it = jobs.begin();
+  while (it != jobs.end()) {
+    GLuint id = it->first;
+    JobPtr job = it->second;
+    ++it;
+
+    bool done;
+    {
+      lock_guard<mutex> lock(queueMutex);
+      done = job->done;
+    }
+    if (done && isSignalled(job)) {
+      release(id);
+    }
+  }
+}
+
+void TextureUploader::run() {
+  bool current = gles2impl::makeCurrent(context);
+  {
+    lock_guard<mutex> lock(queueMutex);
+    started = current;
+    stopping = !current;
+  }
+  finished.notify_all();
+  if (!current) {
+    return;
+  }
+
+  for (;;) {
+    JobPtr job;
+    {
+      unique_lock<mutex> lock(queueMutex);
+      wake.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) {
+        break;
+      }
+      job = queue.front();
+      queue.pop_front();
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, job->upload.alignment);
+    perform(job->upload);
+
+    // Other contexts only see the results of completed commands. The fence
+    // lets the main thread check for that without stalling the worker.
+    GLsync fence = NULL;
+    if (extensions.fences) {
+      fence = extensions.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      glFlush();
+    } else {
+      glFinish();
+    }
+
+    {
+      lock_guard<mutex> lock(queueMutex);
+      job->fence = fence;
+      job->done = true;
+    }
+    finished.notify_all();
+  }
+
+  gles2impl::makeCurrent(NULL);
+}
+
+void TextureUploader::stop() {
+  if (!started) {
+    return;
+  }
+
+  // Pending uploads are still performed, since their textures may be in use.
+  {
+    lock_guard<mutex> lock(queueMutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  worker.join();
+
+  gles2impl::destroySharedContext(context);
+  context = NULL;
+  started = false;
+
+  lock_guard<mutex> lock(runningMutex);
+  running.erase(this);
+}
+
+void TextureUploader::AtExit() {
+  set<TextureUploader*> uploaders;
+  {
+    lock_guard<mutex> lock(runningMutex);
+    uploaders = running;
+  }
+  for (set<TextureUploader*>::iterator it = uploaders.begin(); it != uploaders.end(); ++it) {
+    (*it)->stop();
+  }
+}
+
+} // end namespace webgl
@@ -0,0 +1,113 @@
+#ifndef TEXTUREUPLOADER_H_
+#define TEXTUREUPLOADER_H_
+
+#include <map>
+#include <set>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+#include "../common.h"
+#include "glext.h"
+#include "../gles2impl.h"
+
+using namespace v8;
+
+namespace webgl {
+
+// Performs glTexImage2D and glTexSubImage2D calls on a thread with a context
+// that shares objects with the main one, so that large uploads don't stall
+// rendering.
+//
+// The worker fences every upload after issuing it; an upload is complete once
+// the fence is signalled (or, without fences, once the worker has finished
+// it). The main context only sees the new contents when the texture is bound
+// again after completion. The pixels stay referenced until then and must not
+// be modified.
+//
+// Without a shared context the uploads happen right away on the main thread.
+class TextureUploader {
+public:
+  struct Upload {
+    GLenum target;
+    GLuint texture;
+    GLint level;
+    GLint internalformat;
+    // texSubImage2D if set, otherwise texImage2D.
+    bool sub;
+    GLint xoffset;
+    GLint yoffset;
+    GLsizei width;
+    GLsizei height;
+    GLenum format;
+    GLenum type;
+    GLint alignment;
+    const void* pixels;
+  };
+
+  explicit TextureUploader(const GLExtensions& extensions);
+  ~TextureUploader();
+
+  // Returns the id of the upload. source is kept alive until it completes.
+  GLuint upload(const Upload& upload, Local<Value> source);
+
+  // The bytes that GL reads from width x height pixels, rows padded to the
+  // alignment; 0 for formats and types that GL rejects anyway.
+  static size_t imageSize(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint alignment);
+
+  // Non-blocking. Unknown ids are complete.
+  bool isComplete(GLuint id);
+  // Blocks until the upload is complete.
+  void finish(GLuint id);
+  // Blocks until all uploads to the texture are complete, before deleting it.
+  void finishTexture(GLuint texture);
+  // The number of uploads that aren't complete yet.
+  size_t pending();
+
+  static void AtExit();
+
+private:
+  struct Job {
+    Upload upload;
+    bool done;
+    GLsync fence;
+    Nan::Persistent<Value> source;
+  };
+  typedef std::shared_ptr<Job> JobPtr;
+
+  bool start();
+  static GLenum bindTargetOf(GLenum target);
+  void perform(const Upload& upload);
+  void wait(const JobPtr& job);
+  bool isSignalled(const JobPtr& job);
+  void release(GLuint id);
+  void reap();
+  void run();
+  void stop();
+
+  const GLExtensions& extensions;
+  // Set once starting the worker failed, to not try again for every upload.
+  bool failed;
+
+  // Worker state; the job map is only used on the main thread.
+  gles2impl::SharedContext* context;
+  std::thread worker;
+  std::mutex queueMutex;
+  std::condition_variable wake;
+  std::condition_variable finished;
+  std::deque<JobPtr> queue;
+  bool started;
+  bool stopping;
+  std::map<GLuint, JobPtr> jobs;
+  GLuint nextJob;
+
+  // Uploaders of all threads that load the module.
+  static std::set<TextureUploader*> running;
+  static std::mutex runningMutex;
+};
+
+}
+
+#endif /* TEXTUREUPLOADER_H_ */
@@ -0,0 +1,45 @@
+#include "unpackstate.h"
+#include "gl3.h"
+
+namespace webgl {
+
+ClientUnpackState::ClientUnpackState(const GLExtensions& extensions, GLint alignment) {
+  unpackBuffers = extensions.es ? extensions.version >= 300 : extensions.version >= 210;
+  rowLength = !extensions.es || extensions.version >= 300;
+  previousBuffer = 0;
+  previousAlignment = 4;
+  previousRowLength = 0;
+  previousSkipRows = 0;
+  previousSkipPixels = 0;
+
+  if (unpackBuffers) {
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &previousBuffer);
+    if (previousBuffer) {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+  }
+  glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousAlignment);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+  if (rowLength) {
+    glGetIntegerv(GL_UNPACK_ROW_LENGTH, &previousRowLength);
+    glGetIntegerv(GL_UNPACK_SKIP_ROWS, &previousSkipRows);
+    glGetIntegerv(GL_UNPACK_SKIP_PIXELS, &previousSkipPixels);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+  }
+}
+
+ClientUnpackState::~ClientUnpackState() {
+  if (rowLength) {
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, previousRowLength);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, previousSkipRows);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, previousSkipPixels);
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, previousAlignment);
+  if (previousBuffer) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, previousBuffer);
+  }
+}
+
+}
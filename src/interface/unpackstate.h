@@ -0,0 +1,34 @@
+#ifndef UNPACKSTATE_H_
+#define UNPACKSTATE_H_
+
+#include "glapi.h"
+#include "glext.h"
+
+namespace webgl {
+
+// The pixel unpack state of uploads that the helpers make from their own
+// memory, whatever the application left set: no pixel unpack buffer (which
+// would make the pointer an offset into it), rows tightly packed with the
+// given alignment, nothing skipped. The application's state is put back when
+// it goes out of scope.
+//
+// Pixel unpack buffers exist from OpenGL ES 3.0 and OpenGL 2.1 on, row length
+// and skips from OpenGL ES 3.0 and in every desktop version.
+class ClientUnpackState {
+public:
+  ClientUnpackState(const GLExtensions& extensions, GLint alignment);
+  ~ClientUnpackState();
+
+private:
+  bool unpackBuffers;
+  bool rowLength;
+  GLint previousBuffer;
+  GLint previousAlignment;
+  GLint previousRowLength;
+  GLint previousSkipRows;
+  GLint previousSkipPixels;
+};
+
+}
+
+#endif /* UNPACKSTATE_H_ */
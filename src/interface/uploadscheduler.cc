@@ -0,0 +1,307 @@
+#include <chrono>
+#include <algorithm>
+
+#include "uploadscheduler.h"
+#include "unpackstate.h"
+#include "../gles2platform.h"
+
+#ifndef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT_OES 0x8D61
+#endif
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_RG
+#define GL_RG 0x8227
+#endif
+
+namespace webgl {
+
+using namespace std;
+
+// The size of a band. Small enough to keep a frame's uploads close to its
+// budget, large enough that the calls don't dominate.
+static const GLsizeiptr SLICE_BYTES = 256 * 1024;
+
+// 0 for the formats and types that aren't supported.
+static GLsizei bytesPerPixel(GLenum format, GLenum type) {
+  switch (type) {
+    case GL_UNSIGNED_SHORT_5_6_5:
+    case GL_UNSIGNED_SHORT_4_4_4_4:
+    case GL_UNSIGNED_SHORT_5_5_5_1:
+      return 2;
+  }
+
+  GLsizei components;
+  switch (format) {
+    case GL_ALPHA:
+    case GL_LUMINANCE:
+    case GL_RED:
+      components = 1;
+      break;
+    case GL_LUMINANCE_ALPHA:
+    case GL_RG:
+      components = 2;
+      break;
+    case GL_RGB:
+      components = 3;
+      break;
+    case GL_RGBA:
+      components = 4;
+      break;
+    default:
+      return 0;
+  }
+
+  switch (type) {
+    case GL_UNSIGNED_BYTE:
+      return components;
+    case GL_HALF_FLOAT_OES:
+    case GL_HALF_FLOAT:
+      return components * 2;
+    case GL_FLOAT:
+      return components * 4;
+    default:
+      return 0;
+  }
+}
+
+// Rows are padded to the unpack alignment, except for the last one.
+static GLsizeiptr rowStride(const UploadScheduler::TextureUpload& upload) {
+  GLsizeiptr row = (GLsizeiptr) upload.width * bytesPerPixel(upload.format, upload.type);
+  GLint alignment = max(upload.alignment, 1);
+  return (row + alignment - 1) / alignment * alignment;
+}
+
+static GLenum bindTargetOf(GLenum target) {
+  if (target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z) {
+    return GL_TEXTURE_CUBE_MAP;
+  }
+  return target;
+}
+
+UploadScheduler::UploadScheduler(const GLExtensions& extensions) : extensions(extensions) {
+  budgetMilliseconds = 4;
+  budgetBytes = 0;
+  totalUploaded = 0;
+  listening = false;
+  nextJob = 1;
+}
+
+UploadScheduler::~UploadScheduler() {
+  if (listening) {
+    gles2platform::removeFrameListener(frameListener, this);
+  }
+  for (size_t i = 0; i < queue.size(); i++) {
+    queue[i]->source.Reset();
+    delete queue[i];
+  }
+}
+
+void UploadScheduler::setBudget(double milliseconds, GLsizeiptr bytes) {
+  budgetMilliseconds = max(milliseconds, 0.0);
+  budgetBytes = max(bytes, (GLsizeiptr) 0);
+}
+
+GLuint UploadScheduler::queueTexture(const TextureUpload& upload, Local<Object> source, int priority) {
+  GLsizei pixelBytes = bytesPerPixel(upload.format, upload.type);
+  if (!pixelBytes || upload.width <= 0 || upload.height <= 0) {
+    return 0;
+  }
+
+  Local<ArrayBufferView> view = Local<ArrayBufferView>::Cast(source);
+  GLsizeiptr needed = rowStride(upload) * (upload.height - 1) + (GLsizeiptr) upload.width * pixelBytes;
+  if ((GLsizeiptr) view->ByteLength() < needed) {
+    return 0;
+  }
+
+  Job* job = new Job();
+  job->isTexture = true;
+  job->texture = upload;
+  job->buffer = 0;
+  job->usage = 0;
+  job->size = 0;
+  job->offset = 0;
+  job->priority = priority;
+  return enqueue(job, source);
+}
+
+GLuint UploadScheduler::queueBuffer(GLuint buffer, GLenum usage, GLsizeiptr size, GLintptr offset, Local<Object> source, int priority) {
+  Local<ArrayBufferView> view = Local<ArrayBufferView>::Cast(source);
+  if (offset < 0 || (usage && offset + (GLsizeiptr) view->ByteLength() > size)) {
+    return 0;
+  }
+
+  Job* job = new Job();
+  job->isTexture = false;
+  job->buffer = buffer;
+  job->usage = usage;
+  job->size = size;
+  job->offset = offset;
+  job->priority = priority;
+  return enqueue(job, source);
+}
+
+GLuint UploadScheduler::enqueue(Job* job, Local<Object> source) {
+  job->id = nextJob++;
+  job->source.Reset(source);
+  job->sourceLength = Local<ArrayBufferView>::Cast(source)->ByteLength();
+  job->done = 0;
+  job->started = false;
+
+  // After the jobs of the same or a higher priority.
+  deque<Job*>::iterator it = queue.begin();
+  while (it != queue.end() && (*it)->priority >= job->priority) {
+    ++it;
+  }
+  queue.insert(it, job);
+
+  if (!listening) {
+    gles2platform::addFrameListener(frameListener, this);
+    listening = true;
+  }
+
+  return job->id;
+}
+
+void UploadScheduler::cancelTexture(GLuint texture) {
+  deque<Job*>::iterator it = queue.begin();
+  while (it != queue.end()) {
+    Job* job = *it;
+    if (job->isTexture && job->texture.texture == texture) {
+      it = queue.erase(it);
+      complete(job, false);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void UploadScheduler::cancelBuffer(GLuint buffer) {
+  deque<Job*>::iterator it = queue.begin();
+  while (it != queue.end()) {
+    Job* job = *it;
+    if (!job->isTexture && job->buffer == buffer) {
+      it = queue.erase(it);
+      complete(job, false);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void UploadScheduler::flush() {
+  run(true);
+}
+
+vector<pair<GLuint, bool> > UploadScheduler::takeCompleted() {
+  vector<pair<GLuint, bool> > result;
+  result.swap(completed);
+  return result;
+}
+
+void UploadScheduler::frameListener(void* data) {
+  static_cast<UploadScheduler*>(data)->run(false);
+}
+
+void UploadScheduler::run(bool all) {
+  if (queue.empty()) {
+    return;
+  }
+
+  Nan::HandleScope scope;
+
+  GLint texture2D = 0, textureCubeMap = 0, arrayBuffer = 0;
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture2D);
+  glGetIntegerv(GL_TEXTURE_BINDING_CUBE_MAP, &textureCubeMap);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &arrayBuffer);
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  GLsizeiptr bytes = 0;
+
+  while (!queue.empty()) {
+    Job* job = queue.front();
+    GLsizeiptr uploaded = slice(job);
+    if (uploaded < 0) {
+      queue.pop_front();
+      complete(job, false);
+      continue;
+    }
+    bytes += uploaded;
+    totalUploaded += uploaded;
+
+    GLsizeiptr total = job->isTexture ? job->texture.height : (GLsizeiptr) job->sourceLength;
+    if (job->done >= total) {
+      queue.pop_front();
+      complete(job, true);
+    }
+
+    if (all) {
+      continue;
+    }
+    if (budgetBytes > 0 && bytes >= budgetBytes) {
+      break;
+    }
+    if (budgetMilliseconds > 0) {
+      chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+      if (elapsed.count() >= budgetMilliseconds) {
+        break;
+      }
+    }
+  }
+
+  glBindTexture(GL_TEXTURE_2D, texture2D);
+  glBindTexture(GL_TEXTURE_CUBE_MAP, textureCubeMap);
+  glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+}
+
+GLsizeiptr UploadScheduler::slice(Job* job) {
+  Local<ArrayBufferView> view = Local<ArrayBufferView>::Cast(Nan::New(job->source));
+  if (view->ByteLength() != job->sourceLength) {
+    return -1;
+  }
+  const unsigned char* data = static_cast<const unsigned char*>(view->Buffer()->GetContents().Data()) + view->ByteOffset();
+
+  if (!job->isTexture) {
+    glBindBuffer(GL_ARRAY_BUFFER, job->buffer);
+    if (!job->started && job->usage) {
+      glBufferData(GL_ARRAY_BUFFER, job->size, NULL, job->usage);
+    }
+    job->started = true;
+
+    GLsizeiptr length = min(SLICE_BYTES, (GLsizeiptr) job->sourceLength - job->done);
+    if (length > 0) {
+      glBufferSubData(GL_ARRAY_BUFFER, job->offset + job->done, length, data + job->done);
+    }
+    job->done += length;
+    return length;
+  }
+
+  // The bands are read from the source, whatever pixel unpack buffer, row
+  // length or skips the application has set.
+  const TextureUpload& u = job->texture;
+  ClientUnpackState unpack(extensions, u.alignment);
+  glBindTexture(bindTargetOf(u.target), u.texture);
+  if (!job->started && u.allocate) {
+    glTexImage2D(u.target, u.level, u.internalformat, u.width, u.height, 0, u.format, u.type, NULL);
+  }
+  job->started = true;
+
+  GLsizeiptr stride = rowStride(u);
+  GLsizei rows = (GLsizei) min(max(SLICE_BYTES / stride, (GLsizeiptr) 1), (GLsizeiptr) u.height - job->done);
+  glTexSubImage2D(u.target, u.level, u.xoffset, u.yoffset + (GLint) job->done, u.width, rows, u.format, u.type,
+      data + stride * job->done);
+  job->done += rows;
+  return stride * rows;
+}
+
+void UploadScheduler::complete(Job* job, bool ok) {
+  completed.push_back(make_pair(job->id, ok));
+  job->source.Reset();
+  delete job;
+}
+
+} // end namespace webgl
@@ -0,0 +1,111 @@
+#ifndef UPLOADSCHEDULER_H_
+#define UPLOADSCHEDULER_H_
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <utility>
+
+#include "../common.h"
+#include "glapi.h"
+#include "glext.h"
+
+using namespace v8;
+
+namespace webgl {
+
+// Spreads texture and buffer uploads over frames. Queued uploads are split
+// into bands of rows (texSubImage2D) or chunks (bufferSubData) that are
+// performed when nextFrame ends the frame, until the frame's time or byte
+// budget is spent. Uploads with a higher priority go first, others in the
+// order they were queued. At least one band is uploaded every frame.
+//
+// Textures and buffers are bound to TEXTURE_2D (or TEXTURE_CUBE_MAP) of the
+// active unit and ARRAY_BUFFER while uploading; the bindings are restored, and
+// so is the pixel unpack state (see ClientUnpackState).
+class UploadScheduler {
+public:
+  struct TextureUpload {
+    GLenum target;
+    GLuint texture;
+    GLint level;
+    // Allocates the level with texImage2D first if set; otherwise it is a
+    // texSubImage2D at xoffset, yoffset.
+    bool allocate;
+    GLint internalformat;
+    GLint xoffset;
+    GLint yoffset;
+    GLsizei width;
+    GLsizei height;
+    GLenum format;
+    GLenum type;
+    GLint alignment;
+  };
+
+  UploadScheduler(const GLExtensions& extensions);
+  ~UploadScheduler();
+
+  // A budget of 0 doesn't limit. The default is 4 ms and no byte limit.
+  void setBudget(double milliseconds, GLsizeiptr bytes);
+
+  // source is an ArrayBufferView, referenced until the upload is done. Return
+  // the id of the upload, or 0 if the format is unknown or source is too small.
+  GLuint queueTexture(const TextureUpload& upload, Local<Object> source, int priority);
+  // Allocates the buffer with size bytes first if usage isn't 0.
+  GLuint queueBuffer(GLuint buffer, GLenum usage, GLsizeiptr size, GLintptr offset, Local<Object> source, int priority);
+
+  // Drops the pending uploads to an object that is being deleted.
+  void cancelTexture(GLuint texture);
+  void cancelBuffer(GLuint buffer);
+
+  // Performs everything that is queued right away.
+  void flush();
+
+  // The ids of the uploads that finished since the last call, paired with
+  // whether they succeeded. Cancelled uploads and those whose source was
+  // detached fail.
+  std::vector<std::pair<GLuint, bool> > takeCompleted();
+
+  // The bytes uploaded so far, which changes whenever an upload made progress.
+  GLsizeiptr uploadedBytes() const { return totalUploaded; }
+
+private:
+  struct Job {
+    GLuint id;
+    int priority;
+    bool isTexture;
+    TextureUpload texture;
+    GLuint buffer;
+    GLenum usage;
+    GLsizeiptr size;
+    GLintptr offset;
+    Nan::Persistent<Object> source;
+    size_t sourceLength;
+    // Rows or bytes done; the allocation counts as started.
+    GLsizeiptr done;
+    bool started;
+  };
+
+  static void frameListener(void* data);
+
+  GLuint enqueue(Job* job, Local<Object> source);
+  void run(bool all);
+  // Uploads the next band of the job; returns the bytes uploaded, or -1 if
+  // the source went away.
+  GLsizeiptr slice(Job* job);
+  void complete(Job* job, bool ok);
+
+  const GLExtensions& extensions;
+  double budgetMilliseconds;
+  GLsizeiptr budgetBytes;
+  GLsizeiptr totalUploaded;
+  bool listening;
+  // Sorted by priority, then by id.
+  std::deque<Job*> queue;
+  GLuint nextJob;
+  std::vector<std::pair<GLuint, bool> > completed;
+};
+
+}
+
+#endif /* UPLOADSCHEDULER_H_ */
@@ -0,0 +1,244 @@
+#include "vertexarrays.h"
+
+namespace webgl {
+
+using namespace std;
+
+VertexArrays::Attrib::Attrib() {
+  enabled = false;
+  buffer = 0;
+  size = 4;
+  type = GL_FLOAT;
+  normalized = GL_FALSE;
+  stride = 0;
+  offset = 0;
+  divisor = 0;
+}
+
+bool VertexArrays::Attrib::samePointer(const Attrib& other) const {
+  return buffer == other.buffer && size == other.size && type == other.type
+    && normalized == other.normalized && stride == other.stride && offset == other.offset;
+}
+
+// Takes the fields that glVertexAttribPointer sets, and not the enabled flag or
+// the divisor, which are applied on their own.
+void VertexArrays::Attrib::copyPointer(const Attrib& other) {
+  buffer = other.buffer;
+  size = other.size;
+  type = other.type;
+  normalized = other.normalized;
+  stride = other.stride;
+  offset = other.offset;
+}
+
+VertexArrays::VertexArrays() {
+  extensions = NULL;
+  emulated = false;
+  maxAttribs = 0;
+  next = 1;
+  current = 0;
+  arrayBuffer = 0;
+  defaultArray = 0;
+}
+
+void VertexArrays::init(const GLExtensions* extensions) {
+  this->extensions = extensions;
+  emulated = !extensions->vertexArrayObject;
+
+  if (extensions->coreProfile && !emulated) {
+    extensions->genVertexArrays(1, &defaultArray);
+    extensions->bindVertexArray(defaultArray);
+  }
+
+  if (emulated) {
+    GLint max = 0;
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &max);
+    maxAttribs = max > 0 ? max : 0;
+
+    State& state = arrays[0];
+    state.elementBuffer = 0;
+    state.attribs.resize(maxAttribs);
+    applied = state;
+  }
+}
+
+GLuint VertexArrays::create() {
+  if (!emulated) {
+    GLuint array = 0;
+    extensions->genVertexArrays(1, &array);
+    return array;
+  }
+
+  GLuint array = next++;
+  State& state = arrays[array];
+  state.elementBuffer = 0;
+  state.attribs.resize(maxAttribs);
+  return array;
+}
+
+void VertexArrays::destroy(GLuint array) {
+  if (array == 0) {
+    return;
+  }
+
+  // Deleting the bound array binds the default one.
+  if (array == current) {
+    bind(0);
+  }
+
+  if (!emulated) {
+    extensions->deleteVertexArrays(1, &array);
+  } else {
+    arrays.erase(array);
+  }
+}
+
+bool VertexArrays::isVertexArray(GLuint array) const {
+  if (!emulated) {
+    return array != defaultArray && extensions->isVertexArray(array) != GL_FALSE;
+  }
+  return array != 0 && arrays.count(array) != 0;
+}
+
+void VertexArrays::bind(GLuint array) {
+  if (!emulated) {
+    extensions->bindVertexArray(array ? array : defaultArray);
+    current = array;
+    return;
+  }
+
+  if (array == current || !arrays.count(array)) {
+    return;
+  }
+
+  apply(arrays[array]);
+  current = array;
+}
+
+void VertexArrays::bindBuffer(GLenum target, GLuint buffer) {
+  if (!emulated) {
+    return;
+  }
+
+  if (target == GL_ARRAY_BUFFER) {
+    arrayBuffer = buffer;
+  } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+    arrays[current].elementBuffer = buffer;
+    applied.elementBuffer = buffer;
+  }
+}
+
+void VertexArrays::deleteBuffer(GLuint buffer) {
+  if (!emulated) {
+    return;
+  }
+
+  // GL detaches a deleted buffer from the bound array only; the others keep
+  // it alive. Emulated arrays can't keep it, so they all drop it.
+  if (arrayBuffer == buffer) {
+    arrayBuffer = 0;
+  }
+  forgetBuffer(applied, buffer);
+  for (map<GLuint, State>::iterator it = arrays.begin(); it != arrays.end(); ++it) {
+    forgetBuffer(it->second, buffer);
+  }
+}
+
+void VertexArrays::forgetBuffer(State& state, GLuint buffer) {
+  if (state.elementBuffer == buffer) {
+    state.elementBuffer = 0;
+  }
+  for (size_t i = 0; i < state.attribs.size(); i++) {
+    if (state.attribs[i].buffer == buffer) {
+      state.attribs[i].buffer = 0;
+    }
+  }
+}
+
+void VertexArrays::enableAttrib(GLuint index, bool enabled) {
+  if (!emulated) {
+    return;
+  }
+
+  State& state = arrays[current];
+  if (index < state.attribs.size()) {
+    state.attribs[index].enabled = enabled;
+    applied.attribs[index].enabled = enabled;
+  }
+}
+
+void VertexArrays::attribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLintptr offset) {
+  if (!emulated) {
+    return;
+  }
+
+  State& state = arrays[current];
+  if (index < state.attribs.size()) {
+    Attrib& attrib = state.attribs[index];
+    attrib.buffer = arrayBuffer;
+    attrib.size = size;
+    attrib.type = type;
+    attrib.normalized = normalized;
+    attrib.stride = stride;
+    attrib.offset = offset;
+    applied.attribs[index].copyPointer(attrib);
+  }
+}
+
+void VertexArrays::attribDivisor(GLuint index, GLuint divisor) {
+  if (!emulated) {
+    return;
+  }
+
+  State& state = arrays[current];
+  if (index < state.attribs.size()) {
+    state.attribs[index].divisor = divisor;
+    applied.attribs[index].divisor = divisor;
+  }
+}
+
+// Pointers of disabled attributes don't affect drawing, so they are only set
+// once the attribute is enabled.
+void VertexArrays::apply(const State& to) {
+  GLuint boundBuffer = arrayBuffer;
+
+  for (size_t i = 0; i < to.attribs.size(); i++) {
+    Attrib& a = applied.attribs[i];
+    const Attrib& b = to.attribs[i];
+
+    if (b.enabled && !a.samePointer(b)) {
+      if (boundBuffer != b.buffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, b.buffer);
+        boundBuffer = b.buffer;
+      }
+      glVertexAttribPointer(i, b.size, b.type, b.normalized, b.stride, (const GLvoid *) b.offset);
+      a.copyPointer(b);
+    }
+
+    if (a.divisor != b.divisor) {
+      extensions->vertexAttribDivisor(i, b.divisor);
+      a.divisor = b.divisor;
+    }
+
+    if (a.enabled != b.enabled) {
+      if (b.enabled) {
+        glEnableVertexAttribArray(i);
+      } else {
+        glDisableVertexAttribArray(i);
+      }
+      a.enabled = b.enabled;
+    }
+  }
+
+  if (applied.elementBuffer != to.elementBuffer) {
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, to.elementBuffer);
+    applied.elementBuffer = to.elementBuffer;
+  }
+
+  // The array buffer binding isn't part of the vertex array state.
+  if (boundBuffer != arrayBuffer) {
+    glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+  }
+}
+
+} // end namespace webgl
@@ -0,0 +1,81 @@
+#ifndef VERTEXARRAYS_H_
+#define VERTEXARRAYS_H_
+
+#include <map>
+#include <vector>
+
+#include "glext.h"
+
+namespace webgl {
+
+// Vertex array objects (OES_vertex_array_object).
+//
+// Uses the driver's vertex array objects when it has them. Otherwise they are
+// emulated: the context reports every change of vertex array state, which is
+// recorded for the bound array, and binding another array issues only the
+// calls needed to turn the recorded state of one into the other.
+class VertexArrays {
+public:
+  VertexArrays();
+
+  // Must be called with the context current, after the extensions are loaded.
+  void init(const GLExtensions* extensions);
+
+  bool isEmulated() const { return emulated; }
+
+  GLuint create();
+  void destroy(GLuint array);
+  bool isVertexArray(GLuint array) const;
+  void bind(GLuint array);
+  GLuint bound() const { return current; }
+
+  // Vertex array state changes; only needed when emulating.
+  void bindBuffer(GLenum target, GLuint buffer);
+  void deleteBuffer(GLuint buffer);
+  void enableAttrib(GLuint index, bool enabled);
+  void attribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLintptr offset);
+  void attribDivisor(GLuint index, GLuint divisor);
+
+private:
+  struct Attrib {
+    Attrib();
+    bool samePointer(const Attrib& other) const;
+    void copyPointer(const Attrib& other);
+
+    bool enabled;
+    GLuint buffer;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    GLsizei stride;
+    GLintptr offset;
+    GLuint divisor;
+  };
+
+  struct State {
+    GLuint elementBuffer;
+    std::vector<Attrib> attribs;
+  };
+
+  void apply(const State& to);
+  static void forgetBuffer(State& state, GLuint buffer);
+
+  const GLExtensions* extensions;
+  bool emulated;
+  GLuint maxAttribs;
+  GLuint next;
+  GLuint current;
+  GLuint arrayBuffer;
+
+  // Stands in for the default array (0) on core profile contexts.
+  GLuint defaultArray;
+
+  // Emulated arrays, including the default one (0), and the state that was
+  // last set in GL.
+  std::map<GLuint, State> arrays;
+  State applied;
+};
+
+}
+
+#endif /* VERTEXARRAYS_H_ */
@@ -1,8 +1,10 @@
 #include <cstring>
 #include <vector>
 #include <iostream>
+#include <mutex>
 
 #include "webgl.h"
+#include "desktopshaders.h"
 #include <node.h>
 #include <node_buffer.h>
 
@@ -10,7 +12,7 @@
   #define  strcasestr(s, t) strstr(strupr(s), strupr(t))
 #endif
 
-#define CHECK_ARRAY_BUFFER(val) if(!val->IsArrayBufferView()) \
+#define CHECK_ARRAY_BUFFER(val) if(!val->IsArrayBufferView() && !val->IsArrayBuffer()) \
         {Nan::ThrowTypeError("Only support array buffer"); return;}
 
 namespace webgl {
@@ -37,47 +39,8 @@ static GLuint ToGLuint(const void* ptr) {
   return static_cast<GLuint>(reinterpret_cast<size_t>(ptr));
 }
 
-template<typename Type>
-inline Type* getArrayData(Local<Value> arg, int* num = NULL) {
-  Type *data=NULL;
-  if(num) *num=0;
-
-  if(!arg->IsNull()) {
-    if(arg->IsArray()) {
-      Nan::ThrowError("Not support array type");
-    }
-    else if(arg->IsObject()) {
-      Nan::TypedArrayContents<Type> p(arg);
-      data = *p;
-      if (num) *num = p.length();
-    }
-    else
-      Nan::ThrowError("Bad array argument");
-  }
-
-  return data;
-}
-
-inline void *getImageData(Local<Value> arg) {
-  void *pixels = NULL;
-  if (!arg->IsNull()) {
-    Local<Object> obj = Local<Object>::Cast(arg);
-    if (!obj->IsObject()){
-      Nan::ThrowError("Bad texture argument");
-    }else if(obj->IsArrayBufferView()){
-        int num;
-        pixels = getArrayData<BYTE>(obj, &num);
-    }else{
-        pixels = node::Buffer::Data(Nan::Get(obj, JS_STR("data")).ToLocalChecked());
-    }
-  }
-  return pixels;
-}
-
-Persistent<Function> WebGLRenderingContext::constructor_template;
-
-void WebGLRenderingContext::Initialize (Handle<Object> target) {
-  Nan::HandleScope scope;
+Local<FunctionTemplate> WebGLRenderingContext::Initialize (Handle<Object> target) {
+  Nan::EscapableHandleScope scope;
 
   // constructor
   Local<FunctionTemplate> ctor = Nan::New<FunctionTemplate>(New);
@@ -85,157 +48,308 @@ void WebGLRenderingContext::Initialize (Handle<Object> target) {
   ctor->SetClassName(JS_STR("WebGLRenderingContext"));
 
   // prototype
-  Nan::SetPrototypeMethod(ctor, "uniform1f", Uniform1f);
-  Nan::SetPrototypeMethod(ctor, "uniform2f", Uniform2f);
-  Nan::SetPrototypeMethod(ctor, "uniform3f", Uniform3f);
-  Nan::SetPrototypeMethod(ctor, "uniform4f", Uniform4f);
-  Nan::SetPrototypeMethod(ctor, "uniform1i", Uniform1i);
-  Nan::SetPrototypeMethod(ctor, "uniform2i", Uniform2i);
-  Nan::SetPrototypeMethod(ctor, "uniform3i", Uniform3i);
-  Nan::SetPrototypeMethod(ctor, "uniform4i", Uniform4i);
-  Nan::SetPrototypeMethod(ctor, "uniform1fv", Uniform1fv);
-  Nan::SetPrototypeMethod(ctor, "uniform2fv", Uniform2fv);
-  Nan::SetPrototypeMethod(ctor, "uniform3fv", Uniform3fv);
-  Nan::SetPrototypeMethod(ctor, "uniform4fv", Uniform4fv);
-  Nan::SetPrototypeMethod(ctor, "uniform1iv", Uniform1iv);
-  Nan::SetPrototypeMethod(ctor, "uniform2iv", Uniform2iv);
-  Nan::SetPrototypeMethod(ctor, "uniform3iv", Uniform3iv);
-  Nan::SetPrototypeMethod(ctor, "uniform4iv", Uniform4iv);
-  Nan::SetPrototypeMethod(ctor, "pixelStorei", PixelStorei);
-  Nan::SetPrototypeMethod(ctor, "bindAttribLocation", BindAttribLocation);
-  Nan::SetPrototypeMethod(ctor, "getError", GetError);
-  Nan::SetPrototypeMethod(ctor, "drawArrays", DrawArrays);
-  Nan::SetPrototypeMethod(ctor, "uniformMatrix2fv", UniformMatrix2fv);
-  Nan::SetPrototypeMethod(ctor, "uniformMatrix3fv", UniformMatrix3fv);
-  Nan::SetPrototypeMethod(ctor, "uniformMatrix4fv", UniformMatrix4fv);
-
-  Nan::SetPrototypeMethod(ctor, "generateMipmap", GenerateMipmap);
-
-  Nan::SetPrototypeMethod(ctor, "getAttribLocation", GetAttribLocation);
-  Nan::SetPrototypeMethod(ctor, "depthFunc", DepthFunc);
-  Nan::SetPrototypeMethod(ctor, "viewport", Viewport);
-  Nan::SetPrototypeMethod(ctor, "createShader", CreateShader);
-  Nan::SetPrototypeMethod(ctor, "shaderSource", ShaderSource);
-  Nan::SetPrototypeMethod(ctor, "compileShader", CompileShader);
-  Nan::SetPrototypeMethod(ctor, "getShaderParameter", GetShaderParameter);
-  Nan::SetPrototypeMethod(ctor, "getShaderInfoLog", GetShaderInfoLog);
-  Nan::SetPrototypeMethod(ctor, "createProgram", CreateProgram);
-  Nan::SetPrototypeMethod(ctor, "attachShader", AttachShader);
-  Nan::SetPrototypeMethod(ctor, "linkProgram", LinkProgram);
-  Nan::SetPrototypeMethod(ctor, "getProgramParameter", GetProgramParameter);
-  Nan::SetPrototypeMethod(ctor, "getUniformLocation", GetUniformLocation);
-  Nan::SetPrototypeMethod(ctor, "clearColor", ClearColor);
-  Nan::SetPrototypeMethod(ctor, "clearDepth", ClearDepth);
-
-  Nan::SetPrototypeMethod(ctor, "disable", Disable);
-  Nan::SetPrototypeMethod(ctor, "createTexture", CreateTexture);
-  Nan::SetPrototypeMethod(ctor, "bindTexture", BindTexture);
-  Nan::SetPrototypeMethod(ctor, "texImage2D", TexImage2D);
-  Nan::SetPrototypeMethod(ctor, "texParameteri", TexParameteri);
-  Nan::SetPrototypeMethod(ctor, "texParameterf", TexParameterf);
-  Nan::SetPrototypeMethod(ctor, "clear", Clear);
-  Nan::SetPrototypeMethod(ctor, "useProgram", UseProgram);
-  Nan::SetPrototypeMethod(ctor, "createFramebuffer", CreateFramebuffer);
-  Nan::SetPrototypeMethod(ctor, "bindFramebuffer", BindFramebuffer);
-  Nan::SetPrototypeMethod(ctor, "framebufferTexture2D", FramebufferTexture2D);
-  Nan::SetPrototypeMethod(ctor, "createBuffer", CreateBuffer);
-  Nan::SetPrototypeMethod(ctor, "bindBuffer", BindBuffer);
-  Nan::SetPrototypeMethod(ctor, "bufferData", BufferData);
-  Nan::SetPrototypeMethod(ctor, "bufferSubData", BufferSubData);
-  Nan::SetPrototypeMethod(ctor, "enable", Enable);
-  Nan::SetPrototypeMethod(ctor, "blendEquation", BlendEquation);
-  Nan::SetPrototypeMethod(ctor, "blendFunc", BlendFunc);
-  Nan::SetPrototypeMethod(ctor, "enableVertexAttribArray", EnableVertexAttribArray);
-  Nan::SetPrototypeMethod(ctor, "vertexAttribPointer", VertexAttribPointer);
-  Nan::SetPrototypeMethod(ctor, "activeTexture", ActiveTexture);
-  Nan::SetPrototypeMethod(ctor, "drawElements", DrawElements);
-  Nan::SetPrototypeMethod(ctor, "flush", Flush);
-  Nan::SetPrototypeMethod(ctor, "finish", Finish);
-
-  Nan::SetPrototypeMethod(ctor, "vertexAttrib1f", VertexAttrib1f);
-  Nan::SetPrototypeMethod(ctor, "vertexAttrib2f", VertexAttrib2f);
-  Nan::SetPrototypeMethod(ctor, "vertexAttrib3f", VertexAttrib3f);
-  Nan::SetPrototypeMethod(ctor, "vertexAttrib4f", VertexAttrib4f);
-  Nan::SetPrototypeMethod(ctor, "vertexAttrib1fv", VertexAttrib1fv);
-  Nan::SetPrototypeMethod(ctor, "vertexAttrib2fv", VertexAttrib2fv);
-  Nan::SetPrototypeMethod(ctor, "vertexAttrib3fv", VertexAttrib3fv);
-  Nan::SetPrototypeMethod(ctor, "vertexAttrib4fv", VertexAttrib4fv);
-
-  Nan::SetPrototypeMethod(ctor, "blendColor", BlendColor);
-  Nan::SetPrototypeMethod(ctor, "blendEquationSeparate", BlendEquationSeparate);
-  Nan::SetPrototypeMethod(ctor, "blendFuncSeparate", BlendFuncSeparate);
-  Nan::SetPrototypeMethod(ctor, "clearStencil", ClearStencil);
-  Nan::SetPrototypeMethod(ctor, "colorMask", ColorMask);
-  Nan::SetPrototypeMethod(ctor, "copyTexImage2D", CopyTexImage2D);
-  Nan::SetPrototypeMethod(ctor, "copyTexSubImage2D", CopyTexSubImage2D);
-  Nan::SetPrototypeMethod(ctor, "cullFace", CullFace);
-  Nan::SetPrototypeMethod(ctor, "depthMask", DepthMask);
-  Nan::SetPrototypeMethod(ctor, "depthRange", DepthRange);
-  Nan::SetPrototypeMethod(ctor, "disableVertexAttribArray", DisableVertexAttribArray);
-  Nan::SetPrototypeMethod(ctor, "hint", Hint);
-  Nan::SetPrototypeMethod(ctor, "isEnabled", IsEnabled);
-  Nan::SetPrototypeMethod(ctor, "lineWidth", LineWidth);
-  Nan::SetPrototypeMethod(ctor, "polygonOffset", PolygonOffset);
-
-  Nan::SetPrototypeMethod(ctor, "sampleCoverage", SampleCoverage);
-  Nan::SetPrototypeMethod(ctor, "scissor", Scissor);
-  Nan::SetPrototypeMethod(ctor, "stencilFunc", StencilFunc);
-  Nan::SetPrototypeMethod(ctor, "stencilFuncSeparate", StencilFuncSeparate);
-  Nan::SetPrototypeMethod(ctor, "stencilMask", StencilMask);
-  Nan::SetPrototypeMethod(ctor, "stencilMaskSeparate", StencilMaskSeparate);
-  Nan::SetPrototypeMethod(ctor, "stencilOp", StencilOp);
-  Nan::SetPrototypeMethod(ctor, "stencilOpSeparate", StencilOpSeparate);
-  Nan::SetPrototypeMethod(ctor, "bindRenderbuffer", BindRenderbuffer);
-  Nan::SetPrototypeMethod(ctor, "createRenderbuffer", CreateRenderbuffer);
-
-  Nan::SetPrototypeMethod(ctor, "deleteBuffer", DeleteBuffer);
-  Nan::SetPrototypeMethod(ctor, "deleteFramebuffer", DeleteFramebuffer);
-  Nan::SetPrototypeMethod(ctor, "deleteProgram", DeleteProgram);
-  Nan::SetPrototypeMethod(ctor, "deleteRenderbuffer", DeleteRenderbuffer);
-  Nan::SetPrototypeMethod(ctor, "deleteShader", DeleteShader);
-  Nan::SetPrototypeMethod(ctor, "deleteTexture", DeleteTexture);
-  Nan::SetPrototypeMethod(ctor, "detachShader", DetachShader);
-  Nan::SetPrototypeMethod(ctor, "framebufferRenderbuffer", FramebufferRenderbuffer);
-  Nan::SetPrototypeMethod(ctor, "getVertexAttribOffset", GetVertexAttribOffset);
-
-  Nan::SetPrototypeMethod(ctor, "isBuffer", IsBuffer);
-  Nan::SetPrototypeMethod(ctor, "isFramebuffer", IsFramebuffer);
-  Nan::SetPrototypeMethod(ctor, "isProgram", IsProgram);
-  Nan::SetPrototypeMethod(ctor, "isRenderbuffer", IsRenderbuffer);
-  Nan::SetPrototypeMethod(ctor, "isShader", IsShader);
-  Nan::SetPrototypeMethod(ctor, "isTexture", IsTexture);
-
-  Nan::SetPrototypeMethod(ctor, "renderbufferStorage", RenderbufferStorage);
-  Nan::SetPrototypeMethod(ctor, "getShaderSource", GetShaderSource);
-  Nan::SetPrototypeMethod(ctor, "validateProgram", ValidateProgram);
-
-  Nan::SetPrototypeMethod(ctor, "texSubImage2D", TexSubImage2D);
-  Nan::SetPrototypeMethod(ctor, "readPixels", ReadPixels);
-  Nan::SetPrototypeMethod(ctor, "getTexParameter", GetTexParameter);
-  Nan::SetPrototypeMethod(ctor, "getActiveAttrib", GetActiveAttrib);
-  Nan::SetPrototypeMethod(ctor, "getActiveUniform", GetActiveUniform);
-  Nan::SetPrototypeMethod(ctor, "getAttachedShaders", GetAttachedShaders);
-  Nan::SetPrototypeMethod(ctor, "getParameter", GetParameter);
-  Nan::SetPrototypeMethod(ctor, "getBufferParameter", GetBufferParameter);
-  Nan::SetPrototypeMethod(ctor, "getFramebufferAttachmentParameter", GetFramebufferAttachmentParameter);
-  Nan::SetPrototypeMethod(ctor, "getProgramInfoLog", GetProgramInfoLog);
-  Nan::SetPrototypeMethod(ctor, "getRenderbufferParameter", GetRenderbufferParameter);
-  Nan::SetPrototypeMethod(ctor, "getVertexAttrib", GetVertexAttrib);
-  Nan::SetPrototypeMethod(ctor, "getSupportedExtensions", GetSupportedExtensions);
-  Nan::SetPrototypeMethod(ctor, "getExtension", GetExtension);
-  Nan::SetPrototypeMethod(ctor, "checkFramebufferStatus", CheckFramebufferStatus);
-
-  Nan::SetPrototypeMethod(ctor, "frontFace", FrontFace);
+  SetMethod(ctor, "uniform1f", Uniform1f);
+  SetMethod(ctor, "uniform2f", Uniform2f);
+  SetMethod(ctor, "uniform3f", Uniform3f);
+  SetMethod(ctor, "uniform4f", Uniform4f);
+  SetMethod(ctor, "uniform1i", Uniform1i);
+  SetMethod(ctor, "uniform2i", Uniform2i);
+  SetMethod(ctor, "uniform3i", Uniform3i);
+  SetMethod(ctor, "uniform4i", Uniform4i);
+  SetMethod(ctor, "uniform1fv", Uniform1fv);
+  SetMethod(ctor, "uniform2fv", Uniform2fv);
+  SetMethod(ctor, "uniform3fv", Uniform3fv);
+  SetMethod(ctor, "uniform4fv", Uniform4fv);
+  SetMethod(ctor, "uniform1iv", Uniform1iv);
+  SetMethod(ctor, "uniform2iv", Uniform2iv);
+  SetMethod(ctor, "uniform3iv", Uniform3iv);
+  SetMethod(ctor, "uniform4iv", Uniform4iv);
+  SetMethod(ctor, "pixelStorei", PixelStorei);
+  SetMethod(ctor, "bindAttribLocation", BindAttribLocation);
+  SetMethod(ctor, "getError", GetError);
+  SetMethod(ctor, "drawArrays", DrawArrays);
+  SetMethod(ctor, "uniformMatrix2fv", UniformMatrix2fv);
+  SetMethod(ctor, "uniformMatrix3fv", UniformMatrix3fv);
+  SetMethod(ctor, "uniformMatrix4fv", UniformMatrix4fv);
+
+  SetMethod(ctor, "generateMipmap", GenerateMipmap);
+
+  SetMethod(ctor, "getAttribLocation", GetAttribLocation);
+  SetMethod(ctor, "depthFunc", DepthFunc);
+  SetMethod(ctor, "viewport", Viewport);
+  SetMethod(ctor, "createShader", CreateShader);
+  SetMethod(ctor, "shaderSource", ShaderSource);
+  SetMethod(ctor, "compileShader", CompileShader);
+  SetMethod(ctor, "getShaderParameter", GetShaderParameter);
+  SetMethod(ctor, "getShaderInfoLog", GetShaderInfoLog);
+  SetMethod(ctor, "createProgram", CreateProgram);
+  SetMethod(ctor, "attachShader", AttachShader);
+  SetMethod(ctor, "linkProgram", LinkProgram);
+  SetMethod(ctor, "getProgramParameter", GetProgramParameter);
+  SetMethod(ctor, "getUniformLocation", GetUniformLocation);
+  SetMethod(ctor, "clearColor", ClearColor);
+  SetMethod(ctor, "clearDepth", ClearDepth);
+
+  SetMethod(ctor, "disable", Disable);
+  SetMethod(ctor, "createTexture", CreateTexture);
+  SetMethod(ctor, "bindTexture", BindTexture);
+  SetMethod(ctor, "texImage2D", TexImage2D);
+  SetMethod(ctor, "texParameteri", TexParameteri);
+  SetMethod(ctor, "texParameterf", TexParameterf);
+  SetMethod(ctor, "clear", Clear);
+  SetMethod(ctor, "useProgram", UseProgram);
+  SetMethod(ctor, "createFramebuffer", CreateFramebuffer);
+  SetMethod(ctor, "bindFramebuffer", BindFramebuffer);
+  SetMethod(ctor, "framebufferTexture2D", FramebufferTexture2D);
+  SetMethod(ctor, "createBuffer", CreateBuffer);
+  SetMethod(ctor, "bindBuffer", BindBuffer);
+  SetMethod(ctor, "bufferData", BufferData);
+  SetMethod(ctor, "bufferSubData", BufferSubData);
+  SetMethod(ctor, "enable", Enable);
+  SetMethod(ctor, "blendEquation", BlendEquation);
+  SetMethod(ctor, "blendFunc", BlendFunc);
+  SetMethod(ctor, "enableVertexAttribArray", EnableVertexAttribArray);
+  SetMethod(ctor, "vertexAttribPointer", VertexAttribPointer);
+  SetMethod(ctor, "activeTexture", ActiveTexture);
+  SetMethod(ctor, "drawElements", DrawElements);
+  SetMethod(ctor, "flush", Flush);
+  SetMethod(ctor, "finish", Finish);
+
+  SetMethod(ctor, "vertexAttrib1f", VertexAttrib1f);
+  SetMethod(ctor, "vertexAttrib2f", VertexAttrib2f);
+  SetMethod(ctor, "vertexAttrib3f", VertexAttrib3f);
+  SetMethod(ctor, "vertexAttrib4f", VertexAttrib4f);
+  SetMethod(ctor, "vertexAttrib1fv", VertexAttrib1fv);
+  SetMethod(ctor, "vertexAttrib2fv", VertexAttrib2fv);
+  SetMethod(ctor, "vertexAttrib3fv", VertexAttrib3fv);
+  SetMethod(ctor, "vertexAttrib4fv", VertexAttrib4fv);
+
+  SetMethod(ctor, "blendColor", BlendColor);
+  SetMethod(ctor, "blendEquationSeparate", BlendEquationSeparate);
+  SetMethod(ctor, "blendFuncSeparate", BlendFuncSeparate);
+  SetMethod(ctor, "clearStencil", ClearStencil);
+  SetMethod(ctor, "colorMask", ColorMask);
+  SetMethod(ctor, "copyTexImage2D", CopyTexImage2D);
+  SetMethod(ctor, "copyTexSubImage2D", CopyTexSubImage2D);
+  SetMethod(ctor, "cullFace", CullFace);
+  SetMethod(ctor, "depthMask", DepthMask);
+  SetMethod(ctor, "depthRange", DepthRange);
+  SetMethod(ctor, "disableVertexAttribArray", DisableVertexAttribArray);
+  SetMethod(ctor, "hint", Hint);
+  SetMethod(ctor, "isEnabled", IsEnabled);
+  SetMethod(ctor, "lineWidth", LineWidth);
+  SetMethod(ctor, "polygonOffset", PolygonOffset);
+
+  SetMethod(ctor, "sampleCoverage", SampleCoverage);
+  SetMethod(ctor, "scissor", Scissor);
+  SetMethod(ctor, "stencilFunc", StencilFunc);
+  SetMethod(ctor, "stencilFuncSeparate", StencilFuncSeparate);
+  SetMethod(ctor, "stencilMask", StencilMask);
+  SetMethod(ctor, "stencilMaskSeparate", StencilMaskSeparate);
+  SetMethod(ctor, "stencilOp", StencilOp);
+  SetMethod(ctor, "stencilOpSeparate", StencilOpSeparate);
+  SetMethod(ctor, "bindRenderbuffer", BindRenderbuffer);
+  SetMethod(ctor, "createRenderbuffer", CreateRenderbuffer);
+
+  SetMethod(ctor, "deleteBuffer", DeleteBuffer);
+  SetMethod(ctor, "deleteFramebuffer", DeleteFramebuffer);
+  SetMethod(ctor, "deleteProgram", DeleteProgram);
+  SetMethod(ctor, "deleteRenderbuffer", DeleteRenderbuffer);
+  SetMethod(ctor, "deleteShader", DeleteShader);
+  SetMethod(ctor, "deleteTexture", DeleteTexture);
+  SetMethod(ctor, "detachShader", DetachShader);
+  SetMethod(ctor, "framebufferRenderbuffer", FramebufferRenderbuffer);
+  SetMethod(ctor, "getVertexAttribOffset", GetVertexAttribOffset);
+
+  SetMethod(ctor, "isBuffer", IsBuffer);
+  SetMethod(ctor, "isFramebuffer", IsFramebuffer);
+  SetMethod(ctor, "isProgram", IsProgram);
+  SetMethod(ctor, "isRenderbuffer", IsRenderbuffer);
+  SetMethod(ctor, "isShader", IsShader);
+  SetMethod(ctor, "isTexture", IsTexture);
+
+  SetMethod(ctor, "renderbufferStorage", RenderbufferStorage);
+  SetMethod(ctor, "getShaderSource", GetShaderSource);
+  SetMethod(ctor, "validateProgram", ValidateProgram);
+
+  SetMethod(ctor, "texSubImage2D", TexSubImage2D);
+  SetMethod(ctor, "readPixels", ReadPixels);
+  SetMethod(ctor, "getTexParameter", GetTexParameter);
+  SetMethod(ctor, "getActiveAttrib", GetActiveAttrib);
+  SetMethod(ctor, "getActiveUniform", GetActiveUniform);
+  SetMethod(ctor, "getAttachedShaders", GetAttachedShaders);
+  SetMethod(ctor, "getParameter", GetParameter);
+  SetMethod(ctor, "getBufferParameter", GetBufferParameter);
+  SetMethod(ctor, "getFramebufferAttachmentParameter", GetFramebufferAttachmentParameter);
+  SetMethod(ctor, "getProgramInfoLog", GetProgramInfoLog);
+  SetMethod(ctor, "getRenderbufferParameter", GetRenderbufferParameter);
+  SetMethod(ctor, "getVertexAttrib", GetVertexAttrib);
+  SetMethod(ctor, "getSupportedExtensions", GetSupportedExtensions);
+  SetMethod(ctor, "getExtension", GetExtension);
+  SetMethod(ctor, "checkFramebufferStatus", CheckFramebufferStatus);
+
+  SetMethod(ctor, "frontFace", FrontFace);
+
+  SetMethod(ctor, "enableProgramCache", EnableProgramCache);
+  SetMethod(ctor, "enableParallelShaderCompile", EnableParallelShaderCompile);
+  SetMethod(ctor, "maxShaderCompilerThreads", MaxShaderCompilerThreads);
+  SetMethod(ctor, "getLibraryProgram", GetLibraryProgram);
+
+  SetMethod(ctor, "createVertexArray", CreateVertexArray);
+  SetMethod(ctor, "deleteVertexArray", DeleteVertexArray);
+  SetMethod(ctor, "isVertexArray", IsVertexArray);
+  SetMethod(ctor, "bindVertexArray", BindVertexArray);
+
+  SetMethod(ctor, "hasInstancedArrays", HasInstancedArrays);
+  SetMethod(ctor, "drawArraysInstanced", DrawArraysInstanced);
+  SetMethod(ctor, "drawElementsInstanced", DrawElementsInstanced);
+  SetMethod(ctor, "vertexAttribDivisor", VertexAttribDivisor);
+
+  SetMethod(ctor, "createInstanceBatch", CreateInstanceBatch);
+  SetMethod(ctor, "getInstanceBatchSize", GetInstanceBatchSize);
+  SetMethod(ctor, "drawInstanceBatch", DrawInstanceBatch);
+  SetMethod(ctor, "deleteInstanceBatch", DeleteInstanceBatch);
+  SetMethod(ctor, "createSpriteBatch", CreateSpriteBatch);
+  SetMethod(ctor, "getSpriteBatchUnits", GetSpriteBatchUnits);
+  SetMethod(ctor, "drawSpriteBatch", DrawSpriteBatch);
+  SetMethod(ctor, "deleteSpriteBatch", DeleteSpriteBatch);
+  SetMethod(ctor, "createTextRenderer", CreateTextRenderer);
+  SetMethod(ctor, "loadFont", LoadFont);
+  SetMethod(ctor, "deleteFont", DeleteFont);
+  SetMethod(ctor, "measureText", MeasureText);
+  SetMethod(ctor, "drawText", DrawText);
+  SetMethod(ctor, "deleteTextRenderer", DeleteTextRenderer);
+  SetMethod(ctor, "createPathRenderer", CreatePathRenderer);
+  SetMethod(ctor, "createPath", CreatePath);
+  SetMethod(ctor, "setPath", SetPath);
+  SetMethod(ctor, "deletePath", DeletePath);
+  SetMethod(ctor, "fillPath", FillPath);
+  SetMethod(ctor, "strokePath", StrokePath);
+  SetMethod(ctor, "pushClip", PushClip);
+  SetMethod(ctor, "popClip", PopClip);
+  SetMethod(ctor, "resetClip", ResetClip);
+  SetMethod(ctor, "deletePathRenderer", DeletePathRenderer);
+  SetMethod(ctor, "createTextureAtlas", CreateTextureAtlas);
+  SetMethod(ctor, "addAtlasImage", AddAtlasImage);
+  SetMethod(ctor, "removeAtlasImage", RemoveAtlasImage);
+  SetMethod(ctor, "lookupAtlasImage", LookupAtlasImage);
+  SetMethod(ctor, "getAtlasGeneration", GetAtlasGeneration);
+  SetMethod(ctor, "deleteTextureAtlas", DeleteTextureAtlas);
+  SetMethod(ctor, "mapBuffer", MapBuffer);
+  SetMethod(ctor, "unmapBuffer", UnmapBuffer);
+  SetMethod(ctor, "createStreamingBuffer", CreateStreamingBuffer);
+  SetMethod(ctor, "getStreamingBufferObject", GetStreamingBufferObject);
+  SetMethod(ctor, "streamingBufferAllocate", StreamingBufferAllocate);
+  SetMethod(ctor, "streamingBufferWrite", StreamingBufferWrite);
+  SetMethod(ctor, "deleteStreamingBuffer", DeleteStreamingBuffer);
+  SetMethod(ctor, "createMirroredBuffer", CreateMirroredBuffer);
+  SetMethod(ctor, "getMirroredBufferObject", GetMirroredBufferObject);
+  SetMethod(ctor, "mirroredBufferMarkDirty", MirroredBufferMarkDirty);
+  SetMethod(ctor, "flushMirroredBuffer", FlushMirroredBuffer);
+  SetMethod(ctor, "deleteMirroredBuffer", DeleteMirroredBuffer);
+  SetMethod(ctor, "uploadTexture", UploadTexture);
+  SetMethod(ctor, "isTextureUploadComplete", IsTextureUploadComplete);
+  SetMethod(ctor, "finishTextureUpload", FinishTextureUpload);
+  SetMethod(ctor, "queueTextureUpload", QueueTextureUpload);
+  SetMethod(ctor, "queueBufferUpload", QueueBufferUpload);
+  SetMethod(ctor, "setUploadBudget", SetUploadBudget);
+  SetMethod(ctor, "flushUploads", FlushUploads);
+  SetMethod(ctor, "takeCompletedUploads", TakeCompletedUploads);
+  SetMethod(ctor, "enableDynamicResolution", EnableDynamicResolution);
+  SetMethod(ctor, "getResolutionScale", GetResolutionScale);
+  SetMethod(ctor, "enableFrameSkipping", EnableFrameSkipping);
+  SetMethod(ctor, "invalidateFrame", InvalidateFrame);
 
   Nan::Set(target, JS_STR("WebGLRenderingContext"), ctor->GetFunction());
 
-  constructor_template.Reset(Isolate::GetCurrent(), ctor->GetFunction());
+  return scope.Escape(ctor);
+}
+
+void WebGLRenderingContext::SetMethod(Local<FunctionTemplate> ctor, const char* name, Nan::FunctionCallback callback) {
+  Nan::SetPrototypeMethod(ctor, name, Recorded, Nan::New<External>(reinterpret_cast<void*>(callback)));
 }
 
-WebGLRenderingContext::WebGLRenderingContext() {
+// Every prototype method is called through here, so that the frame
+// fingerprint sees all calls when it is enabled.
+NAN_METHOD(WebGLRenderingContext::Recorded) {
+  Nan::FunctionCallback callback = reinterpret_cast<Nan::FunctionCallback>(Local<External>::Cast(info.Data())->Value());
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  if (obj->frameFingerprint.isEnabled()) {
+    obj->frameFingerprint.record(reinterpret_cast<const void*>(callback), info);
+  }
+
+  callback(info);
+}
+
+WebGLRenderingContext::WebGLRenderingContext() : shaderCompiler(programCache), shaderLibrary(shaderCompiler, programCache, extensions), bufferMappings(extensions),
+    textureUploader(extensions), uploadScheduler(extensions), dynamicResolution(extensions, vertexArrays), frameFingerprint(textureUploader, uploadScheduler, mirroredBuffers) {
+  nextInstanceBatch = 1;
+  nextStreamingBuffer = 1;
+  nextMirroredBuffer = 1;
+  nextSpriteBatch = 1;
+  nextTextRenderer = 1;
+  nextPathRenderer = 1;
+  nextTextureAtlas = 1;
   pixelStorei_UNPACK_FLIP_Y_WEBGL = 0;
   pixelStorei_UNPACK_PREMULTIPLY_ALPHA_WEBGL = 0;
   pixelStorei_UNPACK_FLIP_BLUE_RED = 0;
+  unpackAlignment = 4;
+  extensions.load();
+  vertexArrays.init(&extensions);
+}
+
+// The helpers that JS didn't delete. Streaming and mirrored buffers
+// unregister their frame listeners as they go.
+WebGLRenderingContext::~WebGLRenderingContext() {
+  for (map<GLuint, InstanceBatch*>::iterator it = instanceBatches.begin(); it != instanceBatches.end(); ++it) {
+    delete it->second;
+  }
+  for (map<GLuint, StreamingBuffer*>::iterator it = streamingBuffers.begin(); it != streamingBuffers.end(); ++it) {
+    delete it->second;
+  }
+  for (map<GLuint, MirroredBuffer*>::iterator it = mirroredBuffers.begin(); it != mirroredBuffers.end(); ++it) {
+    delete it->second;
+  }
+  for (map<GLuint, SpriteBatch*>::iterator it = spriteBatches.begin(); it != spriteBatches.end(); ++it) {
+    delete it->second;
+  }
+  for (map<GLuint, TextRenderer*>::iterator it = textRenderers.begin(); it != textRenderers.end(); ++it) {
+    delete it->second;
+  }
+  for (map<GLuint, PathRenderer*>::iterator it = pathRenderers.begin(); it != pathRenderers.end(); ++it) {
+    delete it->second;
+  }
+  for (map<GLuint, TextureAtlas*>::iterator it = textureAtlases.begin(); it != textureAtlases.end(); ++it) {
+    delete it->second;
+  }
+  for (map<GLenum, Nan::Persistent<ArrayBuffer>*>::iterator it = mappedArrays.begin(); it != mappedArrays.end(); ++it) {
+    it->second->Reset();
+    delete it->second;
+  }
+}
+
+void WebGLRenderingContext::prepareProgram(GLuint program) {
+  shaderLibrary.realize(program);
+  shaderCompiler.finishProgram(program);
+}
+
+// JS must not touch the memory of a range once it is unmapped.
+void WebGLRenderingContext::detachMapping(GLenum target) {
+  map<GLenum, Nan::Persistent<ArrayBuffer>*>::iterator it = mappedArrays.find(target);
+  if (it == mappedArrays.end()) {
+    return;
+  }
+
+  Local<ArrayBuffer> arrayBuffer = Nan::New(*it->second);
+#if V8_MAJOR_VERSION > 7 || (V8_MAJOR_VERSION == 7 && V8_MINOR_VERSION >= 3)
+  arrayBuffer->Detach();
+#else
+  arrayBuffer->Neuter();
+#endif
+  it->second->Reset();
+  delete it->second;
+  mappedArrays.erase(it);
 }
 
 NAN_METHOD(WebGLRenderingContext::New) {
@@ -445,6 +559,9 @@ NAN_METHOD(WebGLRenderingContext::PixelStorei) {
   } else if (pname == 0x9245 /* UNPACK_FLIP_BLUE_RED */) {
     WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
     obj->pixelStorei_UNPACK_FLIP_BLUE_RED = param;
+  } else if (pname == GL_UNPACK_ALIGNMENT) {
+    WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+    obj->unpackAlignment = param;
   }
 
   glPixelStorei(pname,param);
@@ -455,12 +572,17 @@ NAN_METHOD(WebGLRenderingContext::PixelStorei) {
 NAN_METHOD(WebGLRenderingContext::BindAttribLocation) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->prepareProgram(info[0]->Uint32Value());
+
   int program = info[0]->Int32Value();
   int index = info[1]->Int32Value();
   String::Utf8Value name(info[2]);
 
   glBindAttribLocation(program, index, *name);
 
+  obj->programCache.bindAttribLocation(program, index, *name);
+
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
@@ -546,6 +668,9 @@ NAN_METHOD(WebGLRenderingContext::GenerateMipmap) {
 NAN_METHOD(WebGLRenderingContext::GetAttribLocation) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->prepareProgram(info[0]->Uint32Value());
+
   int program = info[0]->Int32Value();
   String::Utf8Value name(info[1]);
 
@@ -570,7 +695,8 @@ NAN_METHOD(WebGLRenderingContext::Viewport) {
   int width = info[2]->Int32Value();
   int height = info[3]->Int32Value();
 
-  glViewport(x, y, width, height);
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->dynamicResolution.viewport(x, y, width, height);
 
   info.GetReturnValue().Set(Nan::Undefined());
 }
@@ -593,12 +719,24 @@ NAN_METHOD(WebGLRenderingContext::ShaderSource) {
   int id = info[0]->Int32Value();
   String::Utf8Value code(info[1]);
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->shaderCompiler.finishShader(id);
+
+  string source(*code, code.length());
+  if (!obj->extensions.es) {
+    GLint type;
+    glGetShaderiv(id, GL_SHADER_TYPE, &type);
+    source = desktopShaderSource(source, type, obj->extensions);
+  }
+
   const char* codes[1];
-  codes[0] = *code;
-  GLint length=code.length();
+  codes[0] = source.c_str();
+  GLint length=source.size();
 
   glShaderSource  (id, 1, codes, &length);
 
+  obj->programCache.shaderSource(id, codes[0], length);
+
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
@@ -606,7 +744,8 @@ NAN_METHOD(WebGLRenderingContext::ShaderSource) {
 NAN_METHOD(WebGLRenderingContext::CompileShader) {
   Nan::HandleScope scope;
 
-  glCompileShader(info[0]->Int32Value());
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->shaderCompiler.compileShader(info[0]->Int32Value());
 
   info.GetReturnValue().Set(Nan::Undefined());
 }
@@ -626,6 +765,23 @@ NAN_METHOD(WebGLRenderingContext::GetShaderParameter) {
   int shader = info[0]->Int32Value();
   int pname = info[1]->Int32Value();
   int value = 0;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  if (pname == GL_COMPLETION_STATUS_KHR) {
+    info.GetReturnValue().Set(JS_BOOL(obj->shaderCompiler.isShaderComplete(shader)));
+    return;
+  }
+  obj->shaderCompiler.finishShader(shader);
+
+  // Shaders deferred by the program cache are known to compile.
+  if (pname == GL_COMPILE_STATUS && obj->programCache.isDeferred(shader)) {
+    info.GetReturnValue().Set(JS_BOOL(true));
+    return;
+  }
+  if (pname == GL_INFO_LOG_LENGTH) {
+    obj->shaderCompiler.ensureCompiled(shader);
+  }
+
   switch (pname) {
   case GL_DELETE_STATUS:
   case GL_COMPILE_STATUS:
@@ -653,6 +809,10 @@ NAN_METHOD(WebGLRenderingContext::GetShaderInfoLog) {
   int id = info[0]->Int32Value();
   int Len = 1024;
   char Error[1024];
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->shaderCompiler.ensureCompiled(id);
+
   glGetShaderInfoLog(id, 1024, &Len, Error);
 
   info.GetReturnValue().Set(JS_STR(Error));
@@ -674,6 +834,9 @@ NAN_METHOD(WebGLRenderingContext::CreateProgram) {
 NAN_METHOD(WebGLRenderingContext::AttachShader) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->prepareProgram(info[0]->Uint32Value());
+
   int program = info[0]->Int32Value();
   int shader = info[1]->Int32Value();
 
@@ -686,7 +849,8 @@ NAN_METHOD(WebGLRenderingContext::AttachShader) {
 NAN_METHOD(WebGLRenderingContext::LinkProgram) {
   Nan::HandleScope scope;
 
-  glLinkProgram(info[0]->Int32Value());
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->shaderCompiler.linkProgram(info[0]->Int32Value());
 
   info.GetReturnValue().Set(Nan::Undefined());
 }
@@ -698,6 +862,14 @@ NAN_METHOD(WebGLRenderingContext::GetProgramParameter) {
   int program = info[0]->Int32Value();
   int pname = info[1]->Int32Value();
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  if (pname == GL_COMPLETION_STATUS_KHR) {
+    obj->shaderLibrary.realize(program);
+    info.GetReturnValue().Set(JS_BOOL(obj->shaderCompiler.isProgramComplete(program)));
+    return;
+  }
+  obj->prepareProgram(program);
+
   int value = 0;
   switch (pname) {
   case GL_DELETE_STATUS:
@@ -722,6 +894,9 @@ NAN_METHOD(WebGLRenderingContext::GetProgramParameter) {
 NAN_METHOD(WebGLRenderingContext::GetUniformLocation) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->prepareProgram(info[0]->Uint32Value());
+
   int program = info[0]->Int32Value();
   v8::String::Utf8Value name(info[1]);
 
@@ -791,6 +966,39 @@ NAN_METHOD(WebGLRenderingContext::BindTexture) {
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
+#ifdef IS_GLEW
+// Core profiles dropped the LUMINANCE and ALPHA formats. Such textures are
+// stored as RED or RG instead, with a swizzle that makes sampling return what
+// the legacy format would.
+static GLenum coreTextureFormat(GLenum format) {
+  switch (format) {
+    case GL_LUMINANCE:
+    case GL_ALPHA:
+      return GL_RED;
+    case GL_LUMINANCE_ALPHA:
+      return GL_RG;
+  }
+  return format;
+}
+
+// Set (or reset) whenever level 0 is specified, since a texture can be
+// respecified with another format.
+static void setCoreTextureSwizzle(GLenum target, GLenum format) {
+  GLint swizzle[4] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
+  if (format == GL_LUMINANCE || format == GL_LUMINANCE_ALPHA) {
+    swizzle[0] = swizzle[1] = swizzle[2] = GL_RED;
+    swizzle[3] = (format == GL_LUMINANCE) ? GL_ONE : GL_GREEN;
+  } else if (format == GL_ALPHA) {
+    swizzle[0] = swizzle[1] = swizzle[2] = GL_ZERO;
+    swizzle[3] = GL_RED;
+  }
+  if (target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z) {
+    target = GL_TEXTURE_CUBE_MAP;
+  }
+  glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+}
+#endif
+
 NAN_METHOD(WebGLRenderingContext::TexImage2D) {
   Nan::HandleScope scope;
 
@@ -804,11 +1012,21 @@ NAN_METHOD(WebGLRenderingContext::TexImage2D) {
   int type = info[7]->Int32Value();
   void *pixels=getImageData(info[8]);
 
-  if (pixels) {
-    WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  if (pixels && !info[8]->IsNumber()) {
     obj->preprocessTexImageData(pixels, width, height, format, type);
   }
 
+#ifdef IS_GLEW
+  if (obj->extensions.coreProfile) {
+    if (level == 0) {
+      setCoreTextureSwizzle(target, format);
+    }
+    internalformat = coreTextureFormat(internalformat);
+    format = coreTextureFormat(format);
+  }
+#endif
+
   glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
 
   info.GetReturnValue().Set(Nan::Undefined());
@@ -852,6 +1070,9 @@ NAN_METHOD(WebGLRenderingContext::Clear) {
 NAN_METHOD(WebGLRenderingContext::UseProgram) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->prepareProgram(info[0]->Uint32Value());
+
   glUseProgram(info[0]->Int32Value());
 
   info.GetReturnValue().Set(Nan::Undefined());
@@ -876,6 +1097,9 @@ NAN_METHOD(WebGLRenderingContext::BindBuffer) {
   int buffer = info[1]->Uint32Value();
   glBindBuffer(target,buffer);
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->vertexArrays.bindBuffer(target, buffer);
+
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
@@ -899,7 +1123,8 @@ NAN_METHOD(WebGLRenderingContext::BindFramebuffer) {
   int target = info[0]->Int32Value();
   int buffer = info[1]->IsNull() ? 0 : info[1]->Int32Value();
 
-  glBindFramebuffer(target, buffer);
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->dynamicResolution.bindFramebuffer(target, buffer);
 
   info.GetReturnValue().Set(Nan::Undefined());
 }
@@ -919,20 +1144,63 @@ NAN_METHOD(WebGLRenderingContext::FramebufferTexture2D) {
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
+// The bytes of an ArrayBuffer or of the range of its buffer that a view covers,
+// without copying. srcOffset and length are in bytes and select a part of
+// them; an undefined length means up to the end. Throws if they don't fit.
+static bool getBufferSource(Local<Object> obj, Local<Value> srcOffset, Local<Value> length, void*& data, GLsizeiptr& size) {
+  char* base;
+  size_t byteLength;
+  if (obj->IsArrayBufferView()) {
+    Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(obj);
+    base = static_cast<char*>(arr->Buffer()->GetContents().Data()) + arr->ByteOffset();
+    byteLength = arr->ByteLength();
+  } else {
+    Local<ArrayBuffer> buffer = Local<ArrayBuffer>::Cast(obj);
+    base = static_cast<char*>(buffer->GetContents().Data());
+    byteLength = buffer->ByteLength();
+  }
+
+  int64_t offset = srcOffset->IsUndefined() ? 0 : srcOffset->IntegerValue();
+  if (offset < 0 || (uint64_t) offset > byteLength) {
+    Nan::ThrowRangeError("srcOffset is beyond the end of the data");
+    return false;
+  }
+  int64_t count = length->IsUndefined() ? (int64_t) (byteLength - offset) : length->IntegerValue();
+  if (count < 0 || (uint64_t) (offset + count) > byteLength) {
+    Nan::ThrowRangeError("length is beyond the end of the data");
+    return false;
+  }
+
+  data = base + offset;
+  size = count;
+  return true;
+}
+
 NAN_METHOD(WebGLRenderingContext::BufferData) {
   Nan::HandleScope scope;
 
   int target = info[0]->Int32Value();
+
+  // New storage unmaps the buffer, at whichever target it was mapped; other
+  // buffers keep their mappings.
+  WebGLRenderingContext* context = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  vector<GLenum> mapped = context->bufferMappings.targets(BufferMappings::bound(target));
+  for (size_t i = 0; i < mapped.size(); i++) {
+    context->detachMapping(mapped[i]);
+    context->bufferMappings.unmap(mapped[i]);
+  }
+
   if(info[1]->IsObject()) {
     Local<Object> obj = Local<Object>::Cast(info[1]);
     GLenum usage = info[2]->Int32Value();
 
     CHECK_ARRAY_BUFFER(obj);
 
-    int element_size = 1;
-    Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(obj);
-    int size = arr->ByteLength()* element_size;
-    void* data = arr->Buffer()->GetContents().Data();
+    void* data;
+    GLsizeiptr size;
+    if (!getBufferSource(obj, info[3], info[4], data, size)) {
+      return;
+    }
 
     glBufferData(target, size, data, usage);
   }
@@ -949,13 +1217,16 @@ NAN_METHOD(WebGLRenderingContext::BufferSubData) {
   Nan::HandleScope scope;
 
   int target = info[0]->Int32Value();
-  int offset = info[1]->Int32Value();
+  GLintptr offset = info[1]->IntegerValue();
   Local<Object> obj = Local<Object>::Cast(info[2]);
 
-   int element_size = 1;
-   Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(obj);
-   int size = arr->ByteLength()* element_size;
-   void* data = arr->Buffer()->GetContents().Data();
+  CHECK_ARRAY_BUFFER(obj);
+
+  void* data;
+  GLsizeiptr size;
+  if (!getBufferSource(obj, info[3], info[4], data, size)) {
+    return;
+  }
 
   glBufferSubData(target, offset, size, data);
 
@@ -991,6 +1262,9 @@ NAN_METHOD(WebGLRenderingContext::EnableVertexAttribArray) {
 
   glEnableVertexAttribArray(info[0]->Int32Value());
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->vertexArrays.enableAttrib(info[0]->Int32Value(), true);
+
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
@@ -1008,6 +1282,9 @@ NAN_METHOD(WebGLRenderingContext::VertexAttribPointer) {
   //    printf("VertexAttribPointer %d %d %d %d %d %d\n", indx, size, type, normalized, stride, offset);
   glVertexAttribPointer(indx, size, type, normalized, stride, (const GLvoid *)offset);
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->vertexArrays.attribPointer(indx, size, type, normalized, stride, offset);
+
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
@@ -1251,6 +1528,9 @@ NAN_METHOD(WebGLRenderingContext::DisableVertexAttribArray) {
   GLuint index = info[0]->Int32Value();
 
   glDisableVertexAttribArray(index);
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->vertexArrays.enableAttrib(index, false);
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
@@ -1310,7 +1590,8 @@ NAN_METHOD(WebGLRenderingContext::Scissor) {
   GLsizei width = info[2]->Int32Value();
   GLsizei height = info[3]->Int32Value();
 
-  glScissor(x, y, width, height);
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->dynamicResolution.scissor(x, y, width, height);
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
@@ -1408,6 +1689,14 @@ NAN_METHOD(WebGLRenderingContext::DeleteBuffer) {
   GLuint buffer = info[0]->Uint32Value();
 
   glDeleteBuffers(1,&buffer);
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->vertexArrays.deleteBuffer(buffer);
+  obj->uploadScheduler.cancelBuffer(buffer);
+  vector<GLenum> targets = obj->bufferMappings.forget(buffer);
+  for (size_t i = 0; i < targets.size(); i++) {
+    obj->detachMapping(targets[i]);
+  }
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
@@ -1423,9 +1712,19 @@ NAN_METHOD(WebGLRenderingContext::DeleteFramebuffer) {
 NAN_METHOD(WebGLRenderingContext::DeleteProgram) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
   GLuint program = info[0]->Uint32Value();
 
+  // Library variants are shared and reference counted.
+  if (obj->shaderLibrary.release(program)) {
+    info.GetReturnValue().Set(Nan::Undefined());
+    return;
+  }
+
+  obj->shaderCompiler.finishProgram(program);
   glDeleteProgram(program);
+
+  obj->programCache.deleteProgram(program);
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
@@ -1441,9 +1740,14 @@ NAN_METHOD(WebGLRenderingContext::DeleteRenderbuffer) {
 NAN_METHOD(WebGLRenderingContext::DeleteShader) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->shaderCompiler.finishShader(info[0]->Uint32Value());
+
   GLuint shader = info[0]->Uint32Value();
 
   glDeleteShader(shader);
+
+  obj->programCache.deleteShader(shader);
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
@@ -1452,6 +1756,10 @@ NAN_METHOD(WebGLRenderingContext::DeleteTexture) {
 
   GLuint texture = info[0]->Uint32Value();
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->textureUploader.finishTexture(texture);
+  obj->uploadScheduler.cancelTexture(texture);
+
   glDeleteTextures(1,&texture);
   info.GetReturnValue().Set(Nan::Undefined());
 }
@@ -1459,6 +1767,9 @@ NAN_METHOD(WebGLRenderingContext::DeleteTexture) {
 NAN_METHOD(WebGLRenderingContext::DetachShader) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->prepareProgram(info[0]->Uint32Value());
+
   GLuint program = info[0]->Uint32Value();
   GLuint shader = info[1]->Uint32Value();
 
@@ -1556,6 +1867,9 @@ NAN_METHOD(WebGLRenderingContext::GetShaderSource) {
 NAN_METHOD(WebGLRenderingContext::ValidateProgram) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->prepareProgram(info[0]->Uint32Value());
+
   glValidateProgram(info[0]->Int32Value());
 
   info.GetReturnValue().Set(Nan::Undefined());
@@ -1574,11 +1888,17 @@ NAN_METHOD(WebGLRenderingContext::TexSubImage2D) {
   GLenum type = info[7]->Int32Value();
   void *pixels=getImageData(info[8]);
 
-  if (pixels) {
-    WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  if (pixels && !info[8]->IsNumber()) {
     obj->preprocessTexImageData(pixels, width, height, format, type);
   }
 
+#ifdef IS_GLEW
+  if (obj->extensions.coreProfile) {
+    format = coreTextureFormat(format);
+  }
+#endif
+
   glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
 
   info.GetReturnValue().Set(Nan::Undefined());
@@ -1615,6 +1935,9 @@ NAN_METHOD(WebGLRenderingContext::GetTexParameter) {
 NAN_METHOD(WebGLRenderingContext::GetActiveAttrib) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->prepareProgram(info[0]->Uint32Value());
+
   GLuint program = info[0]->Int32Value();
   GLuint index = info[1]->Int32Value();
 
@@ -1635,6 +1958,9 @@ NAN_METHOD(WebGLRenderingContext::GetActiveAttrib) {
 NAN_METHOD(WebGLRenderingContext::GetActiveUniform) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->prepareProgram(info[0]->Uint32Value());
+
   GLuint program = info[0]->Int32Value();
   GLuint index = info[1]->Int32Value();
 
@@ -1747,7 +2073,14 @@ NAN_METHOD(WebGLRenderingContext::GetParameter) {
   {
     // return a int32[4]
     GLint params[4];
-    ::glGetIntegerv(name, params);
+    WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+    if (!obj->dynamicResolution.isEnabled()) {
+      ::glGetIntegerv(name, params);
+    } else if (name == GL_VIEWPORT) {
+      obj->dynamicResolution.getViewport(params);
+    } else {
+      obj->dynamicResolution.getScissor(params);
+    }
 
     Local<Array> arr=Nan::New<Array>(4);
     arr->Set(0,JS_INT(params[0]));
@@ -1797,10 +2130,18 @@ NAN_METHOD(WebGLRenderingContext::GetParameter) {
     info.GetReturnValue().Set(arr);
     break;
   }
+  case GL_FRAMEBUFFER_BINDING:
+  case 0x8CAA /* READ_FRAMEBUFFER_BINDING */:
+  {
+    GLint params;
+    ::glGetIntegerv(name, &params);
+    WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+    info.GetReturnValue().Set(JS_INT(obj->dynamicResolution.framebufferBinding(params)));
+    break;
+  }
   case GL_ARRAY_BUFFER_BINDING:
   case GL_CURRENT_PROGRAM:
   case GL_ELEMENT_ARRAY_BUFFER_BINDING:
-  case GL_FRAMEBUFFER_BINDING:
   case GL_RENDERBUFFER_BINDING:
   case GL_TEXTURE_BINDING_2D:
   case GL_TEXTURE_BINDING_CUBE_MAP:
@@ -1847,6 +2188,9 @@ NAN_METHOD(WebGLRenderingContext::GetFramebufferAttachmentParameter) {
 NAN_METHOD(WebGLRenderingContext::GetProgramInfoLog) {
   Nan::HandleScope scope;
 
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->prepareProgram(info[0]->Uint32Value());
+
   GLuint program = info[0]->Int32Value();
   int Len = 1024;
   char Error[1024];
@@ -1887,6 +2231,7 @@ NAN_METHOD(WebGLRenderingContext::GetVertexAttrib) {
     info.GetReturnValue().Set(JS_INT(value));
     break;
   case GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING:
+  case GL_VERTEX_ATTRIB_ARRAY_DIVISOR:
     glGetVertexAttribiv(index,pname,&value);
     info.GetReturnValue().Set(JS_INT(value));
     break;
@@ -1911,9 +2256,14 @@ NAN_METHOD(WebGLRenderingContext::GetVertexAttrib) {
 NAN_METHOD(WebGLRenderingContext::GetSupportedExtensions) {
   Nan::HandleScope scope;
 
-  char *extensions=(char*) glGetString(GL_EXTENSIONS);
+  // Core profiles have no GL_EXTENSIONS string; use the list that was loaded.
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  string extensions = obj->extensions.list();
+  size_t first = extensions.find_first_not_of(' ');
+  size_t last = extensions.find_last_not_of(' ');
+  extensions = (first == string::npos) ? string() : extensions.substr(first, last - first + 1);
 
-  info.GetReturnValue().Set(JS_STR(extensions));
+  info.GetReturnValue().Set(JS_STR(extensions.c_str()));
 }
 
 // TODO GetExtension(name) return the extension name if found, should be an object...
@@ -1922,8 +2272,11 @@ NAN_METHOD(WebGLRenderingContext::GetExtension) {
 
   String::Utf8Value name(info[0]);
   char *sname=*name;
-  char *extensions=(char*) glGetString(GL_EXTENSIONS);
-  char *ext=strcasestr(extensions, sname);
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  // strcasestr upper-cases its arguments in place on Windows; search a copy
+  // of the cached list.
+  string extensions = obj->extensions.list();
+  char *ext=strcasestr(&extensions[0], sname);
 
   if(ext==NULL){
       info.GetReturnValue().Set(Nan::Undefined());
@@ -1932,6 +2285,1049 @@ NAN_METHOD(WebGLRenderingContext::GetExtension) {
   }
 }
 
+NAN_METHOD(WebGLRenderingContext::EnableProgramCache) {
+  Nan::HandleScope scope;
+
+  Nan::Utf8String directory(info[0]);
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  bool enabled = obj->programCache.open(*directory, &obj->extensions);
+
+  info.GetReturnValue().Set(JS_BOOL(enabled));
+}
+
+NAN_METHOD(WebGLRenderingContext::EnableParallelShaderCompile) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  bool enabled = obj->shaderCompiler.enable(&obj->extensions);
+
+  info.GetReturnValue().Set(JS_BOOL(enabled));
+}
+
+// Converts a JS array to strings; anything else gives an empty list.
+static vector<string> toStringVector(Local<Value> value) {
+  vector<string> strings;
+  if (value->IsArray()) {
+    Local<Array> array = Local<Array>::Cast(value);
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      Nan::Utf8String item(array->Get(i));
+      strings.push_back(string(*item, item.length()));
+    }
+  }
+  return strings;
+}
+
+NAN_METHOD(WebGLRenderingContext::GetLibraryProgram) {
+  Nan::HandleScope scope;
+
+  Nan::Utf8String vertexSource(info[0]);
+  Nan::Utf8String fragmentSource(info[1]);
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  GLuint program = obj->shaderLibrary.getProgram(string(*vertexSource, vertexSource.length()),
+      string(*fragmentSource, fragmentSource.length()), toStringVector(info[2]), toStringVector(info[3]));
+
+  info.GetReturnValue().Set(Nan::New<Number>(program));
+}
+
+NAN_METHOD(WebGLRenderingContext::MaxShaderCompilerThreads) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->shaderCompiler.setMaxThreads(info[0]->Uint32Value());
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::CreateVertexArray) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  GLuint array = obj->vertexArrays.create();
+
+  info.GetReturnValue().Set(Nan::New<Number>(array));
+}
+
+NAN_METHOD(WebGLRenderingContext::DeleteVertexArray) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->vertexArrays.destroy(info[0]->Uint32Value());
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::IsVertexArray) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+
+  info.GetReturnValue().Set(JS_BOOL(obj->vertexArrays.isVertexArray(info[0]->Uint32Value())));
+}
+
+NAN_METHOD(WebGLRenderingContext::BindVertexArray) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->vertexArrays.bind(info[0]->Uint32Value());
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::HasInstancedArrays) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+
+  info.GetReturnValue().Set(JS_BOOL(obj->extensions.instancedArrays));
+}
+
+NAN_METHOD(WebGLRenderingContext::DrawArraysInstanced) {
+  Nan::HandleScope scope;
+
+  int mode = info[0]->Int32Value();
+  int first = info[1]->Int32Value();
+  int count = info[2]->Int32Value();
+  int primcount = info[3]->Int32Value();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->extensions.drawArraysInstanced(mode, first, count, primcount);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::DrawElementsInstanced) {
+  Nan::HandleScope scope;
+
+  int mode = info[0]->Int32Value();
+  int count = info[1]->Int32Value();
+  int type = info[2]->Int32Value();
+  GLvoid *offset = reinterpret_cast<GLvoid*>(info[3]->Uint32Value());
+  int primcount = info[4]->Int32Value();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->extensions.drawElementsInstanced(mode, count, type, offset, primcount);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::VertexAttribDivisor) {
+  Nan::HandleScope scope;
+
+  GLuint index = info[0]->Uint32Value();
+  GLuint divisor = info[1]->Uint32Value();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->extensions.vertexAttribDivisor(index, divisor);
+  obj->vertexArrays.attribDivisor(index, divisor);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::CreateInstanceBatch) {
+  Nan::HandleScope scope;
+
+  int vertexBytes = 0;
+  unsigned char* vertices = getArrayData<unsigned char>(info[0], &vertexBytes);
+  GLsizei stride = info[1]->Int32Value();
+  int indexCount = 0;
+  GLushort* indices = getArrayData<GLushort>(info[2], &indexCount);
+  GLuint instanceAttribute = info[4]->Uint32Value();
+  GLuint vectorsPerInstance = info[5]->Uint32Value();
+  GLuint reservedVectors = info[6]->Uint32Value();
+
+  // Attributes come as [index, size, type, normalized, offset, ...].
+  vector<InstanceBatch::Attribute> attributes;
+  if (info[3]->IsArray()) {
+    Local<Array> array = Local<Array>::Cast(info[3]);
+    for (uint32_t i = 0; i + 5 <= array->Length(); i += 5) {
+      InstanceBatch::Attribute attribute;
+      attribute.index = array->Get(i)->Uint32Value();
+      attribute.size = array->Get(i + 1)->Int32Value();
+      attribute.type = array->Get(i + 2)->Uint32Value();
+      attribute.normalized = array->Get(i + 3)->BooleanValue();
+      attribute.offset = array->Get(i + 4)->Int32Value();
+      attributes.push_back(attribute);
+    }
+  }
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  InstanceBatch* batch = new InstanceBatch(obj->vertexArrays);
+  if (!vertices || !indices || !batch->init(vertices, vertexBytes, stride, indices, indexCount, attributes,
+      instanceAttribute, vectorsPerInstance, reservedVectors)) {
+    delete batch;
+    info.GetReturnValue().Set(Nan::New<Number>(0));
+    return;
+  }
+
+  GLuint id = obj->nextInstanceBatch++;
+  obj->instanceBatches[id] = batch;
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+NAN_METHOD(WebGLRenderingContext::GetInstanceBatchSize) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, InstanceBatch*>::iterator it = obj->instanceBatches.find(info[0]->Uint32Value());
+  GLuint size = (it != obj->instanceBatches.end()) ? it->second->instancesPerDraw() : 0;
+
+  info.GetReturnValue().Set(Nan::New<Number>(size));
+}
+
+NAN_METHOD(WebGLRenderingContext::DrawInstanceBatch) {
+  Nan::HandleScope scope;
+
+  GLuint id = info[0]->Uint32Value();
+  GLenum mode = info[1]->Int32Value();
+  GLint location = info[2]->Int32Value();
+  int num = 0;
+  GLfloat* data = getArrayData<GLfloat>(info[3], &num);
+  GLsizei count = info[4]->Int32Value();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, InstanceBatch*>::iterator it = obj->instanceBatches.find(id);
+  if (it == obj->instanceBatches.end() || !data) {
+    info.GetReturnValue().Set(Nan::Undefined());
+    return;
+  }
+
+  // Never read beyond the data that was passed.
+  GLuint vectors = it->second->instanceVectors();
+  count = min(count, (GLsizei) (num / (4 * vectors)));
+  it->second->draw(mode, location, data, count);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::DeleteInstanceBatch) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, InstanceBatch*>::iterator it = obj->instanceBatches.find(info[0]->Uint32Value());
+  if (it != obj->instanceBatches.end()) {
+    delete it->second;
+    obj->instanceBatches.erase(it);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::CreateSpriteBatch) {
+  Nan::HandleScope scope;
+
+  GLuint capacity = info[0]->Uint32Value();
+  GLuint frameSprites = info[1]->Uint32Value();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  SpriteBatch* batch = new SpriteBatch(obj->extensions, obj->vertexArrays);
+  if (!batch->init(capacity, frameSprites)) {
+    delete batch;
+    info.GetReturnValue().Set(Nan::New<Number>(0));
+    return;
+  }
+
+  GLuint id = obj->nextSpriteBatch++;
+  obj->spriteBatches[id] = batch;
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+NAN_METHOD(WebGLRenderingContext::GetSpriteBatchUnits) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, SpriteBatch*>::iterator it = obj->spriteBatches.find(info[0]->Uint32Value());
+  GLuint units = (it != obj->spriteBatches.end()) ? it->second->textureUnits() : 0;
+
+  info.GetReturnValue().Set(Nan::New<Number>(units));
+}
+
+NAN_METHOD(WebGLRenderingContext::DrawSpriteBatch) {
+  Nan::HandleScope scope;
+
+  GLuint id = info[0]->Uint32Value();
+  int num = 0;
+  GLfloat* records = getArrayData<GLfloat>(info[1], &num);
+  GLuint count = info[2]->Uint32Value();
+  GLfloat width = (GLfloat) info[3]->NumberValue();
+  GLfloat height = (GLfloat) info[4]->NumberValue();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, SpriteBatch*>::iterator it = obj->spriteBatches.find(id);
+  if (it == obj->spriteBatches.end() || !records) {
+    info.GetReturnValue().Set(Nan::New<Number>(0));
+    return;
+  }
+
+  // Never read beyond the records that were passed.
+  count = min(count, (GLuint) (num / SpriteBatch::FIELDS));
+  GLuint draws = it->second->draw(records, count, width, height);
+
+  info.GetReturnValue().Set(Nan::New<Number>(draws));
+}
+
+NAN_METHOD(WebGLRenderingContext::DeleteSpriteBatch) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, SpriteBatch*>::iterator it = obj->spriteBatches.find(info[0]->Uint32Value());
+  if (it != obj->spriteBatches.end()) {
+    delete it->second;
+    obj->spriteBatches.erase(it);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::CreateTextRenderer) {
+  Nan::HandleScope scope;
+
+  GLsizei pageSize = info[0]->Int32Value();
+  GLuint maxPages = info[1]->Uint32Value();
+  bool distanceField = info[2]->BooleanValue();
+  GLuint frameGlyphs = info[3]->Uint32Value();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  TextRenderer* renderer = new TextRenderer(obj->extensions, obj->vertexArrays);
+  if (!renderer->init(pageSize, maxPages, distanceField, frameGlyphs)) {
+    delete renderer;
+    info.GetReturnValue().Set(Nan::New<Number>(0));
+    return;
+  }
+
+  GLuint id = obj->nextTextRenderer++;
+  obj->textRenderers[id] = renderer;
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+NAN_METHOD(WebGLRenderingContext::LoadFont) {
+  Nan::HandleScope scope;
+
+  int length = 0;
+  unsigned char* data = getArrayData<unsigned char>(info[1], &length);
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, TextRenderer*>::iterator it = obj->textRenderers.find(info[0]->Uint32Value());
+  GLuint font = (it != obj->textRenderers.end()) ? it->second->loadFont(data, length) : 0;
+
+  info.GetReturnValue().Set(Nan::New<Number>(font));
+}
+
+NAN_METHOD(WebGLRenderingContext::DeleteFont) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, TextRenderer*>::iterator it = obj->textRenderers.find(info[0]->Uint32Value());
+  if (it != obj->textRenderers.end()) {
+    it->second->deleteFont(info[1]->Uint32Value());
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+// The style arguments font, size, maxWidth, lineHeight, align and the colour,
+// from first on.
+static TextRenderer::Style toTextStyle(const Nan::FunctionCallbackInfo<Value>& info, int first) {
+  TextRenderer::Style style;
+  style.font = info[first]->Uint32Value();
+  style.size = (GLfloat) info[first + 1]->NumberValue();
+  style.maxWidth = (GLfloat) info[first + 2]->NumberValue();
+  style.lineHeight = (GLfloat) info[first + 3]->NumberValue();
+  style.align = (TextRenderer::Align) min(max(info[first + 4]->Int32Value(), 0), (int) TextRenderer::ALIGN_RIGHT);
+  for (int i = 0; i < 4; i++) {
+    style.color[i] = (GLfloat) info[first + 5 + i]->NumberValue();
+  }
+  return style;
+}
+
+NAN_METHOD(WebGLRenderingContext::MeasureText) {
+  Nan::HandleScope scope;
+
+  Nan::Utf8String text(info[1]);
+  TextRenderer::Style style = toTextStyle(info, 2);
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, TextRenderer*>::iterator it = obj->textRenderers.find(info[0]->Uint32Value());
+  GLfloat width = 0, height = 0;
+  if (it != obj->textRenderers.end()) {
+    it->second->measure(string(*text, text.length()), style, width, height);
+  }
+
+  Local<Object> size = Nan::New<Object>();
+  Nan::Set(size, JS_STR("width"), Nan::New<Number>(width));
+  Nan::Set(size, JS_STR("height"), Nan::New<Number>(height));
+  info.GetReturnValue().Set(size);
+}
+
+NAN_METHOD(WebGLRenderingContext::DrawText) {
+  Nan::HandleScope scope;
+
+  Nan::Utf8String text(info[1]);
+  GLfloat x = (GLfloat) info[2]->NumberValue();
+  GLfloat y = (GLfloat) info[3]->NumberValue();
+  TextRenderer::Style style = toTextStyle(info, 4);
+  GLfloat width = (GLfloat) info[13]->NumberValue();
+  GLfloat height = (GLfloat) info[14]->NumberValue();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, TextRenderer*>::iterator it = obj->textRenderers.find(info[0]->Uint32Value());
+  if (it != obj->textRenderers.end()) {
+    it->second->drawText(string(*text, text.length()), x, y, style, width, height);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::DeleteTextRenderer) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, TextRenderer*>::iterator it = obj->textRenderers.find(info[0]->Uint32Value());
+  if (it != obj->textRenderers.end()) {
+    delete it->second;
+    obj->textRenderers.erase(it);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::CreatePathRenderer) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  PathRenderer* renderer = new PathRenderer(obj->extensions, obj->vertexArrays);
+  if (!renderer->init()) {
+    delete renderer;
+    info.GetReturnValue().Set(Nan::New<Number>(0));
+    return;
+  }
+
+  GLuint id = obj->nextPathRenderer++;
+  obj->pathRenderers[id] = renderer;
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+NAN_METHOD(WebGLRenderingContext::CreatePath) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, PathRenderer*>::iterator it = obj->pathRenderers.find(info[0]->Uint32Value());
+  GLuint path = (it != obj->pathRenderers.end()) ? it->second->createPath() : 0;
+
+  info.GetReturnValue().Set(Nan::New<Number>(path));
+}
+
+NAN_METHOD(WebGLRenderingContext::SetPath) {
+  Nan::HandleScope scope;
+
+  int num = 0;
+  GLfloat* commands = getArrayData<GLfloat>(info[2], &num);
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, PathRenderer*>::iterator it = obj->pathRenderers.find(info[0]->Uint32Value());
+  bool set = it != obj->pathRenderers.end() && it->second->setPath(info[1]->Uint32Value(), commands, commands ? num : 0);
+
+  info.GetReturnValue().Set(Nan::New<Boolean>(set));
+}
+
+NAN_METHOD(WebGLRenderingContext::DeletePath) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, PathRenderer*>::iterator it = obj->pathRenderers.find(info[0]->Uint32Value());
+  if (it != obj->pathRenderers.end()) {
+    it->second->deletePath(info[1]->Uint32Value());
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+// The paint array holds the colour and the transform a, b, c, d, e, f. Returns
+// false if it is too short.
+static bool toPaint(Local<Value> value, PathRenderer::Paint& paint) {
+  int num = 0;
+  GLfloat* data = getArrayData<GLfloat>(value, &num);
+  if (!data || num < 10) {
+    return false;
+  }
+  copy(data, data + 4, paint.color);
+  copy(data + 4, data + 10, paint.transform);
+  return true;
+}
+
+NAN_METHOD(WebGLRenderingContext::FillPath) {
+  Nan::HandleScope scope;
+
+  PathRenderer::Paint paint;
+  bool valid = toPaint(info[2], paint);
+  GLfloat feather = (GLfloat) info[3]->NumberValue();
+  GLfloat width = (GLfloat) info[4]->NumberValue();
+  GLfloat height = (GLfloat) info[5]->NumberValue();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, PathRenderer*>::iterator it = obj->pathRenderers.find(info[0]->Uint32Value());
+  bool drawn = valid && it != obj->pathRenderers.end() &&
+      it->second->fill(info[1]->Uint32Value(), paint, feather, width, height);
+
+  info.GetReturnValue().Set(Nan::New<Boolean>(drawn));
+}
+
+NAN_METHOD(WebGLRenderingContext::StrokePath) {
+  Nan::HandleScope scope;
+
+  PathRenderer::Paint paint;
+  bool valid = toPaint(info[2], paint);
+  PathRenderer::StrokeStyle style;
+  style.width = (GLfloat) info[3]->NumberValue();
+  style.join = (PathTessellator::Join) min(max(info[4]->Int32Value(), 0), (int) PathTessellator::JOIN_BEVEL);
+  style.cap = (PathTessellator::Cap) min(max(info[5]->Int32Value(), 0), (int) PathTessellator::CAP_SQUARE);
+  style.miterLimit = (GLfloat) info[6]->NumberValue();
+  GLfloat width = (GLfloat) info[7]->NumberValue();
+  GLfloat height = (GLfloat) info[8]->NumberValue();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, PathRenderer*>::iterator it = obj->pathRenderers.find(info[0]->Uint32Value());
+  bool drawn = valid && it != obj->pathRenderers.end() &&
+      it->second->stroke(info[1]->Uint32Value(), paint, style, width, height);
+
+  info.GetReturnValue().Set(Nan::New<Boolean>(drawn));
+}
+
+NAN_METHOD(WebGLRenderingContext::PushClip) {
+  Nan::HandleScope scope;
+
+  PathRenderer::Paint paint;
+  bool valid = toPaint(info[2], paint);
+  GLfloat width = (GLfloat) info[3]->NumberValue();
+  GLfloat height = (GLfloat) info[4]->NumberValue();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, PathRenderer*>::iterator it = obj->pathRenderers.find(info[0]->Uint32Value());
+  bool pushed = valid && it != obj->pathRenderers.end() &&
+      it->second->pushClip(info[1]->Uint32Value(), paint, width, height);
+
+  info.GetReturnValue().Set(Nan::New<Boolean>(pushed));
+}
+
+NAN_METHOD(WebGLRenderingContext::PopClip) {
+  Nan::HandleScope scope;
+
+  GLfloat width = (GLfloat) info[1]->NumberValue();
+  GLfloat height = (GLfloat) info[2]->NumberValue();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, PathRenderer*>::iterator it = obj->pathRenderers.find(info[0]->Uint32Value());
+  if (it != obj->pathRenderers.end()) {
+    it->second->popClip(width, height);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::ResetClip) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, PathRenderer*>::iterator it = obj->pathRenderers.find(info[0]->Uint32Value());
+  if (it != obj->pathRenderers.end()) {
+    it->second->resetClip();
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::DeletePathRenderer) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, PathRenderer*>::iterator it = obj->pathRenderers.find(info[0]->Uint32Value());
+  if (it != obj->pathRenderers.end()) {
+    delete it->second;
+    obj->pathRenderers.erase(it);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::CreateTextureAtlas) {
+  Nan::HandleScope scope;
+
+  GLsizei pageSize = info[0]->Int32Value();
+  GLuint maxPages = info[1]->Uint32Value();
+  GLsizei padding = info[2]->Int32Value();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  TextureAtlas* atlas = new TextureAtlas(obj->extensions);
+  atlas->init(pageSize, maxPages, padding);
+
+  GLuint id = obj->nextTextureAtlas++;
+  obj->textureAtlases[id] = atlas;
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+NAN_METHOD(WebGLRenderingContext::AddAtlasImage) {
+  Nan::HandleScope scope;
+
+  int num = 0;
+  GLubyte* pixels = getArrayData<GLubyte>(info[1], &num);
+  GLsizei width = info[2]->Int32Value();
+  GLsizei height = info[3]->Int32Value();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, TextureAtlas*>::iterator it = obj->textureAtlases.find(info[0]->Uint32Value());
+  GLuint handle = 0;
+  if (it != obj->textureAtlases.end() && pixels && width > 0 && height > 0 && num / 4 / width >= height) {
+    handle = it->second->add(pixels, width, height);
+  }
+
+  info.GetReturnValue().Set(Nan::New<Number>(handle));
+}
+
+NAN_METHOD(WebGLRenderingContext::RemoveAtlasImage) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, TextureAtlas*>::iterator it = obj->textureAtlases.find(info[0]->Uint32Value());
+  bool removed = it != obj->textureAtlases.end() && it->second->remove(info[1]->Uint32Value());
+
+  info.GetReturnValue().Set(Nan::New<Boolean>(removed));
+}
+
+// Returns the texture, coordinates and size of the image, or null.
+NAN_METHOD(WebGLRenderingContext::LookupAtlasImage) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, TextureAtlas*>::iterator it = obj->textureAtlases.find(info[0]->Uint32Value());
+  TextureAtlas::Region region;
+  if (it == obj->textureAtlases.end() || !it->second->lookup(info[1]->Uint32Value(), region)) {
+    info.GetReturnValue().Set(Nan::Null());
+    return;
+  }
+
+  Local<Object> result = Nan::New<Object>();
+  Nan::Set(result, JS_STR("texture"), Nan::New<Number>(region.texture));
+  Nan::Set(result, JS_STR("u0"), Nan::New<Number>(region.u0));
+  Nan::Set(result, JS_STR("v0"), Nan::New<Number>(region.v0));
+  Nan::Set(result, JS_STR("u1"), Nan::New<Number>(region.u1));
+  Nan::Set(result, JS_STR("v1"), Nan::New<Number>(region.v1));
+  Nan::Set(result, JS_STR("width"), Nan::New<Number>(region.width));
+  Nan::Set(result, JS_STR("height"), Nan::New<Number>(region.height));
+  info.GetReturnValue().Set(result);
+}
+
+NAN_METHOD(WebGLRenderingContext::GetAtlasGeneration) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, TextureAtlas*>::iterator it = obj->textureAtlases.find(info[0]->Uint32Value());
+  GLuint generation = (it != obj->textureAtlases.end()) ? it->second->generation() : 0;
+
+  info.GetReturnValue().Set(Nan::New<Number>(generation));
+}
+
+NAN_METHOD(WebGLRenderingContext::DeleteTextureAtlas) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, TextureAtlas*>::iterator it = obj->textureAtlases.find(info[0]->Uint32Value());
+  if (it != obj->textureAtlases.end()) {
+    delete it->second;
+    obj->textureAtlases.erase(it);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::MapBuffer) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+  GLintptr offset = info[1]->IntegerValue();
+  GLsizeiptr length = info[2]->IntegerValue();
+  GLbitfield access = info[3]->Uint32Value();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  void* data = obj->bufferMappings.map(target, offset, length, access);
+  if (!data) {
+    info.GetReturnValue().Set(Nan::Null());
+    return;
+  }
+
+  Local<ArrayBuffer> arrayBuffer = ArrayBuffer::New(Isolate::GetCurrent(), data, length);
+  obj->mappedArrays[target] = new Nan::Persistent<ArrayBuffer>(arrayBuffer);
+
+  info.GetReturnValue().Set(arrayBuffer);
+}
+
+NAN_METHOD(WebGLRenderingContext::UnmapBuffer) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  // The contents were written through the mapping.
+  obj->frameFingerprint.invalidate();
+  obj->detachMapping(target);
+  bool intact = obj->bufferMappings.unmap(target);
+
+  info.GetReturnValue().Set(JS_BOOL(intact));
+}
+
+NAN_METHOD(WebGLRenderingContext::CreateStreamingBuffer) {
+  Nan::HandleScope scope;
+
+  GLsizeiptr size = info[0]->IntegerValue();
+  GLuint frames = info[1]->Uint32Value();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  StreamingBuffer* buffer = new StreamingBuffer(obj->extensions, obj->vertexArrays);
+  if (!buffer->init(size, frames)) {
+    delete buffer;
+    info.GetReturnValue().Set(Nan::New<Number>(0));
+    return;
+  }
+
+  GLuint id = obj->nextStreamingBuffer++;
+  obj->streamingBuffers[id] = buffer;
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+NAN_METHOD(WebGLRenderingContext::GetStreamingBufferObject) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, StreamingBuffer*>::iterator it = obj->streamingBuffers.find(info[0]->Uint32Value());
+  GLuint buffer = (it != obj->streamingBuffers.end()) ? it->second->buffer() : 0;
+
+  info.GetReturnValue().Set(Nan::New<Number>(buffer));
+}
+
+NAN_METHOD(WebGLRenderingContext::StreamingBufferAllocate) {
+  Nan::HandleScope scope;
+
+  GLuint id = info[0]->Uint32Value();
+  GLsizeiptr bytes = info[1]->IntegerValue();
+  GLsizeiptr alignment = info[2]->IntegerValue();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, StreamingBuffer*>::iterator it = obj->streamingBuffers.find(id);
+  GLintptr offset = (it != obj->streamingBuffers.end()) ? it->second->allocate(bytes, alignment) : -1;
+
+  info.GetReturnValue().Set(Nan::New<Number>((double) offset));
+}
+
+NAN_METHOD(WebGLRenderingContext::StreamingBufferWrite) {
+  Nan::HandleScope scope;
+
+  GLuint id = info[0]->Uint32Value();
+  GLintptr offset = info[1]->IntegerValue();
+  int num = 0;
+  unsigned char* data = getArrayData<unsigned char>(info[2], &num);
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, StreamingBuffer*>::iterator it = obj->streamingBuffers.find(id);
+  if (it == obj->streamingBuffers.end() || !data) {
+    info.GetReturnValue().Set(Nan::Undefined());
+    return;
+  }
+
+  if (offset < 0 || offset + num > it->second->size()) {
+    Nan::ThrowRangeError("Write beyond the end of the streaming buffer");
+    return;
+  }
+  it->second->write(offset, data, num);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::DeleteStreamingBuffer) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, StreamingBuffer*>::iterator it = obj->streamingBuffers.find(info[0]->Uint32Value());
+  if (it != obj->streamingBuffers.end()) {
+    delete it->second;
+    obj->streamingBuffers.erase(it);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::CreateMirroredBuffer) {
+  Nan::HandleScope scope;
+
+  if (!info[0]->IsArrayBufferView()) {
+    Nan::ThrowTypeError("Only support array buffer views");
+    return;
+  }
+  GLenum usage = info[1]->Int32Value();
+  GLsizeiptr pageSize = info[2]->IntegerValue();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  MirroredBuffer* buffer = new MirroredBuffer(obj->vertexArrays);
+  if (!buffer->init(Local<Object>::Cast(info[0]), usage, pageSize)) {
+    delete buffer;
+    info.GetReturnValue().Set(Nan::New<Number>(0));
+    return;
+  }
+
+  GLuint id = obj->nextMirroredBuffer++;
+  obj->mirroredBuffers[id] = buffer;
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+NAN_METHOD(WebGLRenderingContext::GetMirroredBufferObject) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, MirroredBuffer*>::iterator it = obj->mirroredBuffers.find(info[0]->Uint32Value());
+  GLuint buffer = (it != obj->mirroredBuffers.end()) ? it->second->buffer() : 0;
+
+  info.GetReturnValue().Set(Nan::New<Number>(buffer));
+}
+
+NAN_METHOD(WebGLRenderingContext::MirroredBufferMarkDirty) {
+  Nan::HandleScope scope;
+
+  GLuint id = info[0]->Uint32Value();
+  GLintptr offset = info[1]->IntegerValue();
+  GLsizeiptr length = info[2]->IntegerValue();
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, MirroredBuffer*>::iterator it = obj->mirroredBuffers.find(id);
+  if (it != obj->mirroredBuffers.end()) {
+    it->second->markDirty(offset, length);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::FlushMirroredBuffer) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, MirroredBuffer*>::iterator it = obj->mirroredBuffers.find(info[0]->Uint32Value());
+  if (it != obj->mirroredBuffers.end()) {
+    // The copy is written from JS without calls.
+    obj->frameFingerprint.invalidate();
+    it->second->flush();
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::DeleteMirroredBuffer) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  map<GLuint, MirroredBuffer*>::iterator it = obj->mirroredBuffers.find(info[0]->Uint32Value());
+  if (it != obj->mirroredBuffers.end()) {
+    delete it->second;
+    obj->mirroredBuffers.erase(it);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+// texture, target, level, internalformat, sub, xoffset, yoffset, width, height,
+// format, type, pixels
+NAN_METHOD(WebGLRenderingContext::UploadTexture) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+
+  TextureUploader::Upload upload;
+  upload.texture = info[0]->Uint32Value();
+  upload.target = info[1]->Int32Value();
+  upload.level = info[2]->Int32Value();
+  upload.internalformat = info[3]->Int32Value();
+  upload.sub = info[4]->BooleanValue();
+  upload.xoffset = info[5]->Int32Value();
+  upload.yoffset = info[6]->Int32Value();
+  upload.width = info[7]->Int32Value();
+  upload.height = info[8]->Int32Value();
+  upload.format = info[9]->Int32Value();
+  upload.type = info[10]->Int32Value();
+  upload.alignment = obj->unpackAlignment;
+
+  int length;
+  void* pixels = getArrayData<BYTE>(info[11], &length);
+  if (!pixels) {
+    return;
+  }
+  // The pixels are read later, where GL can't check their length.
+  if ((size_t) length < TextureUploader::imageSize(upload.width, upload.height, upload.format, upload.type, upload.alignment)) {
+    Nan::ThrowRangeError("pixels is too small for width, height, format and type");
+    return;
+  }
+  obj->preprocessTexImageData(pixels, upload.width, upload.height, upload.format, upload.type);
+  upload.pixels = pixels;
+
+  GLuint id = obj->textureUploader.upload(upload, info[11]);
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+NAN_METHOD(WebGLRenderingContext::IsTextureUploadComplete) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+
+  info.GetReturnValue().Set(JS_BOOL(obj->textureUploader.isComplete(info[0]->Uint32Value())));
+}
+
+NAN_METHOD(WebGLRenderingContext::FinishTextureUpload) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->textureUploader.finish(info[0]->Uint32Value());
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+// width, height, minScale, maxScale, targetFrameTime, sharpen
+NAN_METHOD(WebGLRenderingContext::EnableDynamicResolution) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+
+  DynamicResolution::Options options;
+  options.minScale = (float) info[2]->NumberValue();
+  options.maxScale = (float) info[3]->NumberValue();
+  options.targetFrameTime = info[4]->NumberValue();
+  options.sharpen = info[5]->BooleanValue();
+  bool enabled = obj->dynamicResolution.init(info[0]->Int32Value(), info[1]->Int32Value(), options);
+
+  info.GetReturnValue().Set(JS_BOOL(enabled));
+}
+
+NAN_METHOD(WebGLRenderingContext::GetResolutionScale) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+
+  info.GetReturnValue().Set(JS_FLOAT(obj->dynamicResolution.scale()));
+}
+
+// enable, throttleAfter, maxInterval
+NAN_METHOD(WebGLRenderingContext::EnableFrameSkipping) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  if (info[0]->BooleanValue()) {
+    obj->frameFingerprint.enable(info[1]->Uint32Value(), info[2]->NumberValue());
+  } else {
+    obj->frameFingerprint.disable();
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::InvalidateFrame) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->frameFingerprint.invalidate();
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+// texture, target, level, allocate, internalformat, xoffset, yoffset, width,
+// height, format, type, pixels, priority
+NAN_METHOD(WebGLRenderingContext::QueueTextureUpload) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+
+  UploadScheduler::TextureUpload upload;
+  upload.texture = info[0]->Uint32Value();
+  upload.target = info[1]->Int32Value();
+  upload.level = info[2]->Int32Value();
+  upload.allocate = info[3]->BooleanValue();
+  upload.internalformat = info[4]->Int32Value();
+  upload.xoffset = info[5]->Int32Value();
+  upload.yoffset = info[6]->Int32Value();
+  upload.width = info[7]->Int32Value();
+  upload.height = info[8]->Int32Value();
+  upload.format = info[9]->Int32Value();
+  upload.type = info[10]->Int32Value();
+  upload.alignment = obj->unpackAlignment;
+
+  int length;
+  void* pixels = getArrayData<BYTE>(info[11], &length);
+  if (!pixels) {
+    return;
+  }
+  // The pixels are read later, where GL can't check their length.
+  if ((size_t) length < TextureUploader::imageSize(upload.width, upload.height, upload.format, upload.type, upload.alignment)) {
+    Nan::ThrowRangeError("pixels is too small for width, height, format and type");
+    return;
+  }
+  obj->preprocessTexImageData(pixels, upload.width, upload.height, upload.format, upload.type);
+
+  GLuint id = obj->uploadScheduler.queueTexture(upload, Local<Object>::Cast(info[11]), info[12]->Int32Value());
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+// buffer, usage, size, offset, data, priority; usage 0 for bufferSubData.
+NAN_METHOD(WebGLRenderingContext::QueueBufferUpload) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+
+  GLuint buffer = info[0]->Uint32Value();
+  GLenum usage = info[1]->Int32Value();
+  GLsizeiptr size = (GLsizeiptr) info[2]->IntegerValue();
+  GLintptr offset = (GLintptr) info[3]->IntegerValue();
+  GLuint id = obj->uploadScheduler.queueBuffer(buffer, usage, size, offset, Local<Object>::Cast(info[4]), info[5]->Int32Value());
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+NAN_METHOD(WebGLRenderingContext::SetUploadBudget) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->uploadScheduler.setBudget(info[0]->NumberValue(), (GLsizeiptr) info[1]->IntegerValue());
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGLRenderingContext::FlushUploads) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  obj->uploadScheduler.flush();
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+// Returns [id, ok, id, ok, ...].
+NAN_METHOD(WebGLRenderingContext::TakeCompletedUploads) {
+  Nan::HandleScope scope;
+
+  WebGLRenderingContext* obj = ObjectWrap::Unwrap<WebGLRenderingContext>(info.Holder());
+  vector<pair<GLuint, bool> > completed = obj->uploadScheduler.takeCompleted();
+
+  Local<Array> result = Nan::New<Array>(completed.size() * 2);
+  for (size_t i = 0; i < completed.size(); i++) {
+    Nan::Set(result, i * 2, Nan::New<Number>(completed[i].first));
+    Nan::Set(result, i * 2 + 1, JS_BOOL(completed[i].second));
+  }
+
+  info.GetReturnValue().Set(result);
+}
+
 NAN_METHOD(WebGLRenderingContext::CheckFramebufferStatus) {
   Nan::HandleScope scope;
 
@@ -1984,13 +3380,17 @@ struct GLObj {
 
 vector<GLObj*> globjs;
 static bool atExit=false;
+// Worker threads register their objects too.
+static mutex globjsMutex;
 
 void registerGLObj(GLObjectType type, GLuint obj) {
+  lock_guard<mutex> lock(globjsMutex);
   globjs.push_back(new GLObj(type,obj));
 }
 
 
 void unregisterGLObj(GLuint obj) {
+  lock_guard<mutex> lock(globjsMutex);
   if(atExit) return;
 
   vector<GLObj*>::iterator it = globjs.begin();
@@ -2006,6 +3406,7 @@ void unregisterGLObj(GLuint obj) {
 }
 
 void WebGLRenderingContext::AtExit() {
+  lock_guard<mutex> lock(globjsMutex);
   atExit=true;
   //glFinish();
 
@@ -1,20 +1,28 @@
 #ifndef WEBGL_H_
 #define WEBGL_H_
 
-#ifdef __IPHONE_OS_VERSION_MIN_REQUIRED
-    #include <OpenGLES/ES2/gl.h>
-    #include <OpenGLES/ES2/glext.h>
-    typedef double GLclampd;
-#else
-    #ifdef IS_GLEW
-    #include <GL/glew.h>
-    #else
-    #include <GLES2/gl2.h>
-    #endif
-#endif
+#include "glapi.h"
 
+#include <node_buffer.h>
 
 #include "../common.h"
+#include "glext.h"
+#include "programcache.h"
+#include "shadercompiler.h"
+#include "shaderlibrary.h"
+#include "vertexarrays.h"
+#include "instancebatch.h"
+#include "streamingbuffer.h"
+#include "buffermappings.h"
+#include "mirroredbuffer.h"
+#include "textureuploader.h"
+#include "uploadscheduler.h"
+#include "dynamicresolution.h"
+#include "framefingerprint.h"
+#include "spritebatch.h"
+#include "textrenderer.h"
+#include "pathrenderer.h"
+#include "textureatlas.h"
 
 using namespace node;
 using namespace v8;
@@ -23,17 +31,96 @@ namespace webgl {
 
 typedef uint8_t BYTE;
 
+template<typename Type>
+inline Type* getArrayData(Local<Value> arg, int* num = NULL) {
+  Type *data=NULL;
+  if(num) *num=0;
+
+  if(!arg->IsNull()) {
+    if(arg->IsArray()) {
+      Nan::ThrowError("Not support array type");
+    }
+    else if(arg->IsObject()) {
+      Nan::TypedArrayContents<Type> p(arg);
+      data = *p;
+      if (num) *num = p.length();
+    }
+    else
+      Nan::ThrowError("Bad array argument");
+  }
+
+  return data;
+}
+
+// A number is an offset into the bound pixel pack or unpack buffer.
+inline void *getImageData(Local<Value> arg) {
+  void *pixels = NULL;
+  if (arg->IsNumber()) {
+    pixels = reinterpret_cast<void*>(static_cast<size_t>(arg->IntegerValue()));
+  } else if (!arg->IsNull()) {
+    Local<Object> obj = Local<Object>::Cast(arg);
+    if (!obj->IsObject()){
+      Nan::ThrowError("Bad texture argument");
+    }else if(obj->IsArrayBufferView()){
+        int num;
+        pixels = getArrayData<BYTE>(obj, &num);
+    }else{
+        pixels = node::Buffer::Data(Nan::Get(obj, JS_STR("data")).ToLocalChecked());
+    }
+  }
+  return pixels;
+}
+
 class WebGLRenderingContext : public ObjectWrap {
 public:
   explicit WebGLRenderingContext();
-  static void Initialize (Handle<Object> target);
+  virtual ~WebGLRenderingContext();
+  // Returns the template, which the WebGL 2 context inherits from. Templates
+  // belong to an isolate, so every worker thread that loads the module gets
+  // its own.
+  static Local<FunctionTemplate> Initialize (Handle<Object> target);
   static void AtExit();
 
 protected:
   int pixelStorei_UNPACK_FLIP_Y_WEBGL;
   int pixelStorei_UNPACK_PREMULTIPLY_ALPHA_WEBGL;
   int pixelStorei_UNPACK_FLIP_BLUE_RED;
+  // For the texture uploader, whose context has its own pixel store state.
+  GLint unpackAlignment;
+  GLExtensions extensions;
+  ProgramCache programCache;
+  ShaderCompiler shaderCompiler;
+  ShaderLibrary shaderLibrary;
+  VertexArrays vertexArrays;
+  BufferMappings bufferMappings;
+  // The ArrayBuffers over the mapped ranges, detached when they are unmapped.
+  std::map<GLenum, Nan::Persistent<ArrayBuffer>*> mappedArrays;
+  std::map<GLuint, InstanceBatch*> instanceBatches;
+  GLuint nextInstanceBatch;
+  std::map<GLuint, StreamingBuffer*> streamingBuffers;
+  GLuint nextStreamingBuffer;
+  std::map<GLuint, MirroredBuffer*> mirroredBuffers;
+  GLuint nextMirroredBuffer;
+  std::map<GLuint, SpriteBatch*> spriteBatches;
+  GLuint nextSpriteBatch;
+  std::map<GLuint, TextRenderer*> textRenderers;
+  GLuint nextTextRenderer;
+  std::map<GLuint, PathRenderer*> pathRenderers;
+  GLuint nextPathRenderer;
+  std::map<GLuint, TextureAtlas*> textureAtlases;
+  GLuint nextTextureAtlas;
+  TextureUploader textureUploader;
+  UploadScheduler uploadScheduler;
+  DynamicResolution dynamicResolution;
+  FrameFingerprint frameFingerprint;
   void preprocessTexImageData(void * pixels, int width, int height, int format, int type);
+  // Links library variants on first use and waits for pending asynchronous links.
+  void prepareProgram(GLuint program);
+  void detachMapping(GLenum target);
+
+  // Adds a prototype method whose calls the frame fingerprint sees.
+  static void SetMethod(Local<FunctionTemplate> ctor, const char* name, Nan::FunctionCallback callback);
+  static NAN_METHOD(Recorded);
 
   static NAN_METHOD(New);
 
@@ -176,8 +263,86 @@ protected:
 
   static NAN_METHOD(FrontFace);
 
-private:
-  static Persistent<Function> constructor_template;
+  static NAN_METHOD(EnableProgramCache);
+  static NAN_METHOD(EnableParallelShaderCompile);
+  static NAN_METHOD(MaxShaderCompilerThreads);
+  static NAN_METHOD(GetLibraryProgram);
+
+  static NAN_METHOD(CreateVertexArray);
+  static NAN_METHOD(DeleteVertexArray);
+  static NAN_METHOD(IsVertexArray);
+  static NAN_METHOD(BindVertexArray);
+
+  static NAN_METHOD(HasInstancedArrays);
+  static NAN_METHOD(DrawArraysInstanced);
+  static NAN_METHOD(DrawElementsInstanced);
+  static NAN_METHOD(VertexAttribDivisor);
+
+  static NAN_METHOD(CreateInstanceBatch);
+  static NAN_METHOD(GetInstanceBatchSize);
+  static NAN_METHOD(DrawInstanceBatch);
+  static NAN_METHOD(DeleteInstanceBatch);
+
+  static NAN_METHOD(CreateSpriteBatch);
+  static NAN_METHOD(GetSpriteBatchUnits);
+  static NAN_METHOD(DrawSpriteBatch);
+  static NAN_METHOD(DeleteSpriteBatch);
+
+  static NAN_METHOD(CreateTextRenderer);
+  static NAN_METHOD(LoadFont);
+  static NAN_METHOD(DeleteFont);
+  static NAN_METHOD(MeasureText);
+  static NAN_METHOD(DrawText);
+  static NAN_METHOD(DeleteTextRenderer);
+
+  static NAN_METHOD(CreatePathRenderer);
+  static NAN_METHOD(CreatePath);
+  static NAN_METHOD(SetPath);
+  static NAN_METHOD(DeletePath);
+  static NAN_METHOD(FillPath);
+  static NAN_METHOD(StrokePath);
+  static NAN_METHOD(PushClip);
+  static NAN_METHOD(PopClip);
+  static NAN_METHOD(ResetClip);
+  static NAN_METHOD(DeletePathRenderer);
+
+  static NAN_METHOD(CreateTextureAtlas);
+  static NAN_METHOD(AddAtlasImage);
+  static NAN_METHOD(RemoveAtlasImage);
+  static NAN_METHOD(LookupAtlasImage);
+  static NAN_METHOD(GetAtlasGeneration);
+  static NAN_METHOD(DeleteTextureAtlas);
+
+  static NAN_METHOD(MapBuffer);
+  static NAN_METHOD(UnmapBuffer);
+
+  static NAN_METHOD(CreateStreamingBuffer);
+  static NAN_METHOD(GetStreamingBufferObject);
+  static NAN_METHOD(StreamingBufferAllocate);
+  static NAN_METHOD(StreamingBufferWrite);
+  static NAN_METHOD(DeleteStreamingBuffer);
+
+  static NAN_METHOD(CreateMirroredBuffer);
+  static NAN_METHOD(GetMirroredBufferObject);
+  static NAN_METHOD(MirroredBufferMarkDirty);
+  static NAN_METHOD(FlushMirroredBuffer);
+  static NAN_METHOD(DeleteMirroredBuffer);
+
+  static NAN_METHOD(UploadTexture);
+  static NAN_METHOD(IsTextureUploadComplete);
+  static NAN_METHOD(FinishTextureUpload);
+
+  static NAN_METHOD(QueueTextureUpload);
+  static NAN_METHOD(QueueBufferUpload);
+  static NAN_METHOD(SetUploadBudget);
+  static NAN_METHOD(FlushUploads);
+  static NAN_METHOD(TakeCompletedUploads);
+
+  static NAN_METHOD(EnableDynamicResolution);
+  static NAN_METHOD(GetResolutionScale);
+
+  static NAN_METHOD(EnableFrameSkipping);
+  static NAN_METHOD(InvalidateFrame);
 };
 
 }
@@ -0,0 +1,745 @@
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "webgl2.h"
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+
+void WebGL2RenderingContext::Initialize (Handle<Object> target, Local<FunctionTemplate> parent) {
+  Nan::HandleScope scope;
+
+  // constructor
+  Local<FunctionTemplate> ctor = Nan::New<FunctionTemplate>(New);
+  ctor->InstanceTemplate()->SetInternalFieldCount(1);
+  ctor->SetClassName(JS_STR("WebGL2RenderingContext"));
+  ctor->Inherit(parent);
+
+  // prototype
+  SetMethod(ctor, "bindBufferBase", BindBufferBase);
+  SetMethod(ctor, "bindBufferRange", BindBufferRange);
+  SetMethod(ctor, "copyBufferSubData", CopyBufferSubData);
+  SetMethod(ctor, "getBufferSubData", GetBufferSubData);
+
+  SetMethod(ctor, "getUniformBlockIndex", GetUniformBlockIndex);
+  SetMethod(ctor, "uniformBlockBinding", UniformBlockBinding);
+  SetMethod(ctor, "getActiveUniformBlockParameter", GetActiveUniformBlockParameter);
+  SetMethod(ctor, "getActiveUniformBlockName", GetActiveUniformBlockName);
+
+  SetMethod(ctor, "vertexAttribIPointer", VertexAttribIPointer);
+  SetMethod(ctor, "vertexAttribI4i", VertexAttribI4i);
+  SetMethod(ctor, "vertexAttribI4ui", VertexAttribI4ui);
+  SetMethod(ctor, "uniformui", Uniformui);
+  SetMethod(ctor, "uniformuiv", Uniformuiv);
+
+  SetMethod(ctor, "drawRangeElements", DrawRangeElements);
+  SetMethod(ctor, "drawBuffers", DrawBuffers);
+  SetMethod(ctor, "readBuffer", ReadBuffer);
+
+  SetMethod(ctor, "fenceSync", FenceSync);
+  SetMethod(ctor, "deleteSync", DeleteSync);
+  SetMethod(ctor, "isSync", IsSync);
+  SetMethod(ctor, "clientWaitSync", ClientWaitSync);
+  SetMethod(ctor, "waitSync", WaitSync);
+  SetMethod(ctor, "getSyncParameter", GetSyncParameter);
+
+  SetMethod(ctor, "texStorage2D", TexStorage2D);
+  SetMethod(ctor, "texStorage3D", TexStorage3D);
+  SetMethod(ctor, "texImage3D", TexImage3D);
+  SetMethod(ctor, "texSubImage3D", TexSubImage3D);
+  SetMethod(ctor, "framebufferTextureLayer", FramebufferTextureLayer);
+
+  SetMethod(ctor, "createSampler", CreateSampler);
+  SetMethod(ctor, "deleteSampler", DeleteSampler);
+  SetMethod(ctor, "isSampler", IsSampler);
+  SetMethod(ctor, "bindSampler", BindSampler);
+  SetMethod(ctor, "samplerParameteri", SamplerParameteri);
+  SetMethod(ctor, "samplerParameterf", SamplerParameterf);
+
+  SetMethod(ctor, "blitFramebuffer", BlitFramebuffer);
+  SetMethod(ctor, "renderbufferStorageMultisample", RenderbufferStorageMultisample);
+  SetMethod(ctor, "invalidateFramebuffer", InvalidateFramebuffer);
+  SetMethod(ctor, "clearBufferfv", ClearBufferfv);
+  SetMethod(ctor, "clearBufferiv", ClearBufferiv);
+  SetMethod(ctor, "clearBufferuiv", ClearBufferuiv);
+  SetMethod(ctor, "clearBufferfi", ClearBufferfi);
+
+  Nan::Set(target, JS_STR("WebGL2RenderingContext"), ctor->GetFunction());
+}
+
+WebGL2RenderingContext::WebGL2RenderingContext() {
+  nextSync = 1;
+  supported = gl3.load(extensions);
+}
+
+NAN_METHOD(WebGL2RenderingContext::New) {
+  Nan::HandleScope scope;
+
+  WebGL2RenderingContext* obj = new WebGL2RenderingContext();
+  if (!obj->supported) {
+    delete obj;
+    return Nan::ThrowError("WebGL 2 needs an OpenGL ES 3.0 or OpenGL 3.3 context");
+  }
+  obj->Wrap(info.This());
+
+  info.GetReturnValue().Set(info.This());
+}
+
+// The sync objects that JS didn't delete.
+WebGL2RenderingContext::~WebGL2RenderingContext() {
+  for (map<GLuint, GLsync>::iterator it = syncs.begin(); it != syncs.end(); ++it) {
+    gl3.deleteSync(it->second);
+  }
+}
+
+GLsync WebGL2RenderingContext::getSync(Local<Value> id) {
+  map<GLuint, GLsync>::iterator it = syncs.find(id->Uint32Value());
+  return it == syncs.end() ? NULL : it->second;
+}
+
+// Without glTexStorage (desktop GL before 4.2), every level is allocated with
+// texImage and the levels beyond the requested ones are cut off.
+void WebGL2RenderingContext::texStorage(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth) {
+  bool is3D = (target == GL_TEXTURE_3D || target == GL_TEXTURE_2D_ARRAY);
+  if (is3D && gl3.texStorage3D) {
+    gl3.texStorage3D(target, levels, internalformat, width, height, depth);
+    return;
+  }
+  if (!is3D && gl3.texStorage2D) {
+    gl3.texStorage2D(target, levels, internalformat, width, height);
+    return;
+  }
+
+  GLenum format, type;
+  if (!GL3Functions::unsizedFormat(internalformat, format, type)) {
+    return;
+  }
+
+  for (GLsizei level = 0; level < levels; level++) {
+    if (is3D) {
+      gl3.texImage3D(target, level, internalformat, width, height, depth, 0, format, type, NULL);
+    } else if (target == GL_TEXTURE_CUBE_MAP) {
+      for (GLenum face = 0; face < 6; face++) {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, internalformat, width, height, 0, format, type, NULL);
+      }
+    } else {
+      glTexImage2D(target, level, internalformat, width, height, 0, format, type, NULL);
+    }
+    width = max(1, width / 2);
+    height = max(1, height / 2);
+    if (target == GL_TEXTURE_3D) {
+      depth = max(1, depth / 2);
+    }
+  }
+  glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+}
+
+NAN_METHOD(WebGL2RenderingContext::BindBufferBase) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+  GLuint index = info[1]->Uint32Value();
+  GLuint buffer = info[2]->Uint32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.bindBufferBase(target, index, buffer);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::BindBufferRange) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+  GLuint index = info[1]->Uint32Value();
+  GLuint buffer = info[2]->Uint32Value();
+  GLintptr offset = info[3]->IntegerValue();
+  GLsizeiptr size = info[4]->IntegerValue();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.bindBufferRange(target, index, buffer, offset, size);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::CopyBufferSubData) {
+  Nan::HandleScope scope;
+
+  GLenum readTarget = info[0]->Int32Value();
+  GLenum writeTarget = info[1]->Int32Value();
+  GLintptr readOffset = info[2]->IntegerValue();
+  GLintptr writeOffset = info[3]->IntegerValue();
+  GLsizeiptr size = info[4]->IntegerValue();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.copyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+// GLES has no glGetBufferSubData; the range is mapped instead. Reading a pixel
+// pack buffer after its fence has signalled doesn't stall.
+NAN_METHOD(WebGL2RenderingContext::GetBufferSubData) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+  GLintptr offset = info[1]->IntegerValue();
+  int num = 0;
+  BYTE* data = getArrayData<BYTE>(info[2], &num);
+  // Bytes of the view, which JS works out from its dstOffset and length.
+  GLintptr dstOffset = info[3]->IntegerValue();
+  GLsizeiptr length = info[4]->IntegerValue();
+
+  if (data && dstOffset >= 0 && length > 0 && dstOffset + length <= num) {
+    WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+    void* mapped = obj->gl3.mapBufferRange(target, offset, length, GL_MAP_READ_BIT);
+    if (mapped) {
+      memcpy(data + dstOffset, mapped, length);
+      obj->gl3.unmapBuffer(target);
+    }
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::GetUniformBlockIndex) {
+  Nan::HandleScope scope;
+
+  GLuint program = info[0]->Uint32Value();
+  Nan::Utf8String name(info[1]);
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->prepareProgram(program);
+  GLuint index = obj->gl3.getUniformBlockIndex(program, *name);
+
+  info.GetReturnValue().Set(Nan::New<Number>(index));
+}
+
+NAN_METHOD(WebGL2RenderingContext::UniformBlockBinding) {
+  Nan::HandleScope scope;
+
+  GLuint program = info[0]->Uint32Value();
+  GLuint blockIndex = info[1]->Uint32Value();
+  GLuint binding = info[2]->Uint32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->prepareProgram(program);
+  obj->gl3.uniformBlockBinding(program, blockIndex, binding);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::GetActiveUniformBlockParameter) {
+  Nan::HandleScope scope;
+
+  GLuint program = info[0]->Uint32Value();
+  GLuint blockIndex = info[1]->Uint32Value();
+  GLenum pname = info[2]->Int32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->prepareProgram(program);
+
+  switch (pname) {
+  case GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES: {
+    GLint count = 0;
+    obj->gl3.getActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &count);
+    vector<GLint> indices(max(count, 1));
+    obj->gl3.getActiveUniformBlockiv(program, blockIndex, pname, &indices[0]);
+    Local<Array> arr = Nan::New<Array>(count);
+    for (GLint i = 0; i < count; i++) {
+      arr->Set(i, JS_INT(indices[i]));
+    }
+    info.GetReturnValue().Set(arr);
+    break;
+  }
+  case GL_UNIFORM_BLOCK_REFERENCED_BY_VERTEX_SHADER:
+  case GL_UNIFORM_BLOCK_REFERENCED_BY_FRAGMENT_SHADER: {
+    GLint value = 0;
+    obj->gl3.getActiveUniformBlockiv(program, blockIndex, pname, &value);
+    info.GetReturnValue().Set(JS_BOOL(value != 0));
+    break;
+  }
+  default: {
+    GLint value = 0;
+    obj->gl3.getActiveUniformBlockiv(program, blockIndex, pname, &value);
+    info.GetReturnValue().Set(JS_INT(value));
+  }
+  }
+}
+
+NAN_METHOD(WebGL2RenderingContext::GetActiveUniformBlockName) {
+  Nan::HandleScope scope;
+
+  GLuint program = info[0]->Uint32Value();
+  GLuint blockIndex = info[1]->Uint32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->prepareProgram(program);
+
+  char name[1024];
+  GLsizei length = 0;
+  obj->gl3.getActiveUniformBlockName(program, blockIndex, sizeof(name), &length, name);
+
+  info.GetReturnValue().Set(JS_STR(name, length));
+}
+
+NAN_METHOD(WebGL2RenderingContext::VertexAttribIPointer) {
+  Nan::HandleScope scope;
+
+  GLuint index = info[0]->Uint32Value();
+  GLint size = info[1]->Int32Value();
+  GLenum type = info[2]->Int32Value();
+  GLsizei stride = info[3]->Int32Value();
+  GLintptr offset = info[4]->IntegerValue();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.vertexAttribIPointer(index, size, type, stride, reinterpret_cast<const GLvoid*>(offset));
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::VertexAttribI4i) {
+  Nan::HandleScope scope;
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.vertexAttribI4i(info[0]->Uint32Value(), info[1]->Int32Value(), info[2]->Int32Value(), info[3]->Int32Value(), info[4]->Int32Value());
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::VertexAttribI4ui) {
+  Nan::HandleScope scope;
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.vertexAttribI4ui(info[0]->Uint32Value(), info[1]->Uint32Value(), info[2]->Uint32Value(), info[3]->Uint32Value(), info[4]->Uint32Value());
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+// uniform[1234]ui(location, x[, y[, z[, w]]]); the component count follows
+// from the number of arguments.
+NAN_METHOD(WebGL2RenderingContext::Uniformui) {
+  Nan::HandleScope scope;
+
+  GLint location = info[0]->Int32Value();
+  int components = min(max(info.Length() - 1, 1), 4);
+  GLuint values[4];
+  for (int i = 0; i < components; i++) {
+    values[i] = info[i + 1]->Uint32Value();
+  }
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.uniformuiv[components - 1](location, 1, values);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+// uniform[1234]uiv(location, Uint32Array values, components).
+NAN_METHOD(WebGL2RenderingContext::Uniformuiv) {
+  Nan::HandleScope scope;
+
+  GLint location = info[0]->Int32Value();
+  int num = 0;
+  GLuint* ptr = getArrayData<GLuint>(info[1], &num);
+  int components = min(max(info[2]->Int32Value(), 1), 4);
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.uniformuiv[components - 1](location, num / components, ptr);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::DrawRangeElements) {
+  Nan::HandleScope scope;
+
+  GLenum mode = info[0]->Int32Value();
+  GLuint start = info[1]->Uint32Value();
+  GLuint end = info[2]->Uint32Value();
+  GLsizei count = info[3]->Int32Value();
+  GLenum type = info[4]->Int32Value();
+  GLintptr offset = info[5]->IntegerValue();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.drawRangeElements(mode, start, end, count, type, reinterpret_cast<const GLvoid*>(offset));
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::DrawBuffers) {
+  Nan::HandleScope scope;
+
+  Local<Array> array = Local<Array>::Cast(info[0]);
+  vector<GLenum> buffers(array->Length());
+  for (size_t i = 0; i < buffers.size(); i++) {
+    buffers[i] = array->Get(i)->Uint32Value();
+  }
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.drawBuffers(buffers.size(), buffers.empty() ? NULL : &buffers[0]);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::ReadBuffer) {
+  Nan::HandleScope scope;
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.readBuffer(info[0]->Int32Value());
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::FenceSync) {
+  Nan::HandleScope scope;
+
+  GLenum condition = info[0]->Int32Value();
+  GLbitfield flags = info[1]->Uint32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  GLsync sync = obj->gl3.fenceSync(condition, flags);
+  GLuint id = 0;
+  if (sync) {
+    id = obj->nextSync++;
+    obj->syncs[id] = sync;
+  }
+
+  info.GetReturnValue().Set(Nan::New<Number>(id));
+}
+
+NAN_METHOD(WebGL2RenderingContext::DeleteSync) {
+  Nan::HandleScope scope;
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  GLsync sync = obj->getSync(info[0]);
+  if (sync) {
+    obj->gl3.deleteSync(sync);
+    obj->syncs.erase(info[0]->Uint32Value());
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::IsSync) {
+  Nan::HandleScope scope;
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  info.GetReturnValue().Set(JS_BOOL(obj->getSync(info[0]) != NULL));
+}
+
+// The timeout is in nanoseconds.
+NAN_METHOD(WebGL2RenderingContext::ClientWaitSync) {
+  Nan::HandleScope scope;
+
+  GLbitfield flags = info[1]->Uint32Value();
+  double timeout = max(info[2]->NumberValue(), 0.0);
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  GLsync sync = obj->getSync(info[0]);
+  GLenum result = sync ? obj->gl3.clientWaitSync(sync, flags, (uint64_t) timeout) : GL_WAIT_FAILED;
+
+  info.GetReturnValue().Set(JS_INT(result));
+}
+
+NAN_METHOD(WebGL2RenderingContext::WaitSync) {
+  Nan::HandleScope scope;
+
+  GLbitfield flags = info[1]->Uint32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  GLsync sync = obj->getSync(info[0]);
+  if (sync) {
+    obj->gl3.waitSync(sync, flags, GL_TIMEOUT_IGNORED);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::GetSyncParameter) {
+  Nan::HandleScope scope;
+
+  GLenum pname = info[1]->Int32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  GLsync sync = obj->getSync(info[0]);
+  if (!sync) {
+    info.GetReturnValue().Set(Nan::Null());
+    return;
+  }
+
+  GLint value = 0;
+  GLsizei length = 0;
+  obj->gl3.getSynciv(sync, pname, 1, &length, &value);
+
+  info.GetReturnValue().Set(JS_INT(value));
+}
+
+NAN_METHOD(WebGL2RenderingContext::TexStorage2D) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+  GLsizei levels = info[1]->Int32Value();
+  GLenum internalformat = info[2]->Int32Value();
+  GLsizei width = info[3]->Int32Value();
+  GLsizei height = info[4]->Int32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->texStorage(target, levels, internalformat, width, height, 1);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::TexStorage3D) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+  GLsizei levels = info[1]->Int32Value();
+  GLenum internalformat = info[2]->Int32Value();
+  GLsizei width = info[3]->Int32Value();
+  GLsizei height = info[4]->Int32Value();
+  GLsizei depth = info[5]->Int32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->texStorage(target, levels, internalformat, width, height, depth);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::TexImage3D) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+  GLint level = info[1]->Int32Value();
+  GLint internalformat = info[2]->Int32Value();
+  GLsizei width = info[3]->Int32Value();
+  GLsizei height = info[4]->Int32Value();
+  GLsizei depth = info[5]->Int32Value();
+  GLint border = info[6]->Int32Value();
+  GLenum format = info[7]->Int32Value();
+  GLenum type = info[8]->Int32Value();
+  void *pixels = getImageData(info[9]);
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.texImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::TexSubImage3D) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+  GLint level = info[1]->Int32Value();
+  GLint xoffset = info[2]->Int32Value();
+  GLint yoffset = info[3]->Int32Value();
+  GLint zoffset = info[4]->Int32Value();
+  GLsizei width = info[5]->Int32Value();
+  GLsizei height = info[6]->Int32Value();
+  GLsizei depth = info[7]->Int32Value();
+  GLenum format = info[8]->Int32Value();
+  GLenum type = info[9]->Int32Value();
+  void *pixels = getImageData(info[10]);
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.texSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::FramebufferTextureLayer) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+  GLenum attachment = info[1]->Int32Value();
+  GLuint texture = info[2]->Uint32Value();
+  GLint level = info[3]->Int32Value();
+  GLint layer = info[4]->Int32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.framebufferTextureLayer(target, attachment, texture, level, layer);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::CreateSampler) {
+  Nan::HandleScope scope;
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  GLuint sampler = 0;
+  obj->gl3.genSamplers(1, &sampler);
+
+  info.GetReturnValue().Set(Nan::New<Number>(sampler));
+}
+
+NAN_METHOD(WebGL2RenderingContext::DeleteSampler) {
+  Nan::HandleScope scope;
+
+  GLuint sampler = info[0]->Uint32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.deleteSamplers(1, &sampler);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::IsSampler) {
+  Nan::HandleScope scope;
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  info.GetReturnValue().Set(JS_BOOL(obj->gl3.isSampler(info[0]->Uint32Value()) != GL_FALSE));
+}
+
+NAN_METHOD(WebGL2RenderingContext::BindSampler) {
+  Nan::HandleScope scope;
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.bindSampler(info[0]->Uint32Value(), info[1]->Uint32Value());
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::SamplerParameteri) {
+  Nan::HandleScope scope;
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.samplerParameteri(info[0]->Uint32Value(), info[1]->Int32Value(), info[2]->Int32Value());
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::SamplerParameterf) {
+  Nan::HandleScope scope;
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.samplerParameterf(info[0]->Uint32Value(), info[1]->Int32Value(), info[2]->NumberValue());
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::BlitFramebuffer) {
+  Nan::HandleScope scope;
+
+  GLint srcX0 = info[0]->Int32Value();
+  GLint srcY0 = info[1]->Int32Value();
+  GLint srcX1 = info[2]->Int32Value();
+  GLint srcY1 = info[3]->Int32Value();
+  GLint dstX0 = info[4]->Int32Value();
+  GLint dstY0 = info[5]->Int32Value();
+  GLint dstX1 = info[6]->Int32Value();
+  GLint dstY1 = info[7]->Int32Value();
+  GLbitfield mask = info[8]->Uint32Value();
+  GLenum filter = info[9]->Int32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.blitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::RenderbufferStorageMultisample) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+  GLsizei samples = info[1]->Int32Value();
+  GLenum internalformat = info[2]->Int32Value();
+  GLsizei width = info[3]->Int32Value();
+  GLsizei height = info[4]->Int32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.renderbufferStorageMultisample(target, samples, internalformat, width, height);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+// Tells tiled GPUs that the attachments needn't be written back to memory.
+NAN_METHOD(WebGL2RenderingContext::InvalidateFramebuffer) {
+  Nan::HandleScope scope;
+
+  GLenum target = info[0]->Int32Value();
+  Local<Array> array = Local<Array>::Cast(info[1]);
+  vector<GLenum> attachments(array->Length());
+  for (size_t i = 0; i < attachments.size(); i++) {
+    attachments[i] = array->Get(i)->Uint32Value();
+  }
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  // The default framebuffer's COLOR, DEPTH and STENCIL, when another stands in for it.
+  if (obj->dynamicResolution.isRedirecting() && target != GL_READ_FRAMEBUFFER) {
+    for (size_t i = 0; i < attachments.size(); i++) {
+      if (attachments[i] == 0x1800) {
+        attachments[i] = GL_COLOR_ATTACHMENT0;
+      } else if (attachments[i] == 0x1801) {
+        attachments[i] = GL_DEPTH_ATTACHMENT;
+      } else if (attachments[i] == 0x1802) {
+        attachments[i] = GL_STENCIL_ATTACHMENT;
+      }
+    }
+  }
+  if (obj->gl3.invalidateFramebuffer && !attachments.empty()) {
+    obj->gl3.invalidateFramebuffer(target, attachments.size(), &attachments[0]);
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::ClearBufferfv) {
+  Nan::HandleScope scope;
+
+  GLenum buffer = info[0]->Int32Value();
+  GLint drawbuffer = info[1]->Int32Value();
+  GLfloat* values = getArrayData<GLfloat>(info[2]);
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.clearBufferfv(buffer, drawbuffer, values);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::ClearBufferiv) {
+  Nan::HandleScope scope;
+
+  GLenum buffer = info[0]->Int32Value();
+  GLint drawbuffer = info[1]->Int32Value();
+  GLint* values = getArrayData<GLint>(info[2]);
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.clearBufferiv(buffer, drawbuffer, values);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::ClearBufferuiv) {
+  Nan::HandleScope scope;
+
+  GLenum buffer = info[0]->Int32Value();
+  GLint drawbuffer = info[1]->Int32Value();
+  GLuint* values = getArrayData<GLuint>(info[2]);
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.clearBufferuiv(buffer, drawbuffer, values);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(WebGL2RenderingContext::ClearBufferfi) {
+  Nan::HandleScope scope;
+
+  GLenum buffer = info[0]->Int32Value();
+  GLint drawbuffer = info[1]->Int32Value();
+  GLfloat depth = info[2]->NumberValue();
+  GLint stencil = info[3]->Int32Value();
+
+  WebGL2RenderingContext* obj = ObjectWrap::Unwrap<WebGL2RenderingContext>(info.Holder());
+  obj->gl3.clearBufferfi(buffer, drawbuffer, depth, stencil);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+} // end namespace webgl
@@ -0,0 +1,86 @@
+#ifndef WEBGL2_H_
+#define WEBGL2_H_
+
+#include <map>
+
+#include "webgl.h"
+#include "gl3.h"
+
+using namespace node;
+using namespace v8;
+
+namespace webgl {
+
+// The OpenGL ES 3.0 additions of WebGL 2, for contexts created with
+// init({version: 2}). Everything else is inherited from WebGLRenderingContext.
+class WebGL2RenderingContext : public WebGLRenderingContext {
+public:
+  explicit WebGL2RenderingContext();
+  virtual ~WebGL2RenderingContext();
+  static void Initialize (Handle<Object> target, Local<FunctionTemplate> parent);
+
+protected:
+  GL3Functions gl3;
+  bool supported;
+
+  // Sync objects are pointers, which are handed out to JS as ids.
+  std::map<GLuint, GLsync> syncs;
+  GLuint nextSync;
+
+  GLsync getSync(Local<Value> id);
+  void texStorage(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+
+  static NAN_METHOD(New);
+
+  static NAN_METHOD(BindBufferBase);
+  static NAN_METHOD(BindBufferRange);
+  static NAN_METHOD(CopyBufferSubData);
+  static NAN_METHOD(GetBufferSubData);
+
+  static NAN_METHOD(GetUniformBlockIndex);
+  static NAN_METHOD(UniformBlockBinding);
+  static NAN_METHOD(GetActiveUniformBlockParameter);
+  static NAN_METHOD(GetActiveUniformBlockName);
+
+  static NAN_METHOD(VertexAttribIPointer);
+  static NAN_METHOD(VertexAttribI4i);
+  static NAN_METHOD(VertexAttribI4ui);
+  static NAN_METHOD(Uniformui);
+  static NAN_METHOD(Uniformuiv);
+
+  static NAN_METHOD(DrawRangeElements);
+  static NAN_METHOD(DrawBuffers);
+  static NAN_METHOD(ReadBuffer);
+
+  static NAN_METHOD(FenceSync);
+  static NAN_METHOD(DeleteSync);
+  static NAN_METHOD(IsSync);
+  static NAN_METHOD(ClientWaitSync);
+  static NAN_METHOD(WaitSync);
+  static NAN_METHOD(GetSyncParameter);
+
+  static NAN_METHOD(TexStorage2D);
+  static NAN_METHOD(TexStorage3D);
+  static NAN_METHOD(TexImage3D);
+  static NAN_METHOD(TexSubImage3D);
+  static NAN_METHOD(FramebufferTextureLayer);
+
+  static NAN_METHOD(CreateSampler);
+  static NAN_METHOD(DeleteSampler);
+  static NAN_METHOD(IsSampler);
+  static NAN_METHOD(BindSampler);
+  static NAN_METHOD(SamplerParameteri);
+  static NAN_METHOD(SamplerParameterf);
+
+  static NAN_METHOD(BlitFramebuffer);
+  static NAN_METHOD(RenderbufferStorageMultisample);
+  static NAN_METHOD(InvalidateFramebuffer);
+  static NAN_METHOD(ClearBufferfv);
+  static NAN_METHOD(ClearBufferiv);
+  static NAN_METHOD(ClearBufferuiv);
+  static NAN_METHOD(ClearBufferfi);
+};
+
+}
+
+#endif /* WEBGL2_H_ */
@@ -6,6 +6,7 @@
 #include <cassert>
 
 #include "Nexus.h"
+#include "../eglconfig.h"
 
 namespace gles2impl {
 namespace BCMNexus {
@@ -60,26 +61,36 @@ namespace BCMNexus {
 #endif
     }
 
-    EGLTarget::EGLTarget(Backend &backend, int width, int height, bool fullScreen, const std::string& title)
-        : _backend(backend)
+    EGLTarget::EGLTarget(Backend &backend, int width, int height, bool fullScreen, const std::string& title, int glesVersion, bool offscreen,
+            const SurfaceConfig& config)
+        : _nativeWindow(nullptr)
+        , _backend(backend)
         , _width(width)
         , _height(height)
         , _fullscreen(fullScreen)
-        , _title(title) {
+        , _offscreen(offscreen)
+        , _title(title)
+        , _clientVersion(glesVersion >= 3 ? 3 : 2)
+        , _surfaceConfig(config)
+        , _eglDisplay(EGL_NO_DISPLAY)
+        , _eglContext(EGL_NO_CONTEXT)
+        , _eglSurface(EGL_NO_SURFACE) {
     }
 
-    std::string EGLTarget::constructTarget() {
+    std::string EGLTarget::constructTarget(EGLTarget* share) {
 
         // Get native window
-        NXPL_NativeWindowInfo windowInfo;
-        windowInfo.x = 0;
-        windowInfo.y = 0;
-        windowInfo.width = _width;
-        windowInfo.height = _height;
-        windowInfo.stretch = _fullscreen;
-        windowInfo.zOrder = 0;
-        windowInfo.clientID = 0; //TODO: do not use hardcoded
-        _nativeWindow = NXPL_CreateNativeWindow(&windowInfo);
+        if (!_offscreen) {
+            NXPL_NativeWindowInfo windowInfo;
+            windowInfo.x = 0;
+            windowInfo.y = 0;
+            windowInfo.width = _width;
+            windowInfo.height = _height;
+            windowInfo.stretch = _fullscreen;
+            windowInfo.zOrder = 0;
+            windowInfo.clientID = 0; //TODO: do not use hardcoded
+            _nativeWindow = NXPL_CreateNativeWindow(&windowInfo);
+        }
 
         //   Get the EGL display.
         _eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
@@ -97,34 +108,25 @@ namespace BCMNexus {
             std::cout << "eglInitialize() failed" << std::endl;
             return std::string("Unable to initialize EGL");
         }
-        //   Step 3 - Get the number of configurations to correctly size the array
-        //   used in step 4
-        static const EGLint attr[] = {
-            EGL_RED_SIZE, 8,
-            EGL_GREEN_SIZE, 8,
-            EGL_BLUE_SIZE, 8,
-            EGL_ALPHA_SIZE, 8,
-            EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
-            EGL_NONE
-        };
-
+        //   Step 3 - Pick the config that comes closest to the wanted one.
         EGLConfig eglConfig;
-        EGLint     num_config;
-
-        if ( !eglChooseConfig( _eglDisplay, attr, &eglConfig, 1, &num_config ) ) {
-            return std::string("Failed to choose config (eglError: ") + std::to_string(eglGetError()) + std::string(")");
+        EGLint renderableType = _clientVersion >= 3 ? EGL_OPENGL_ES3_BIT_KHR : EGL_OPENGL_ES2_BIT;
+        SurfaceConfig wanted = _surfaceConfig;
+        if (!chooseConfig(_eglDisplay, _offscreen ? EGL_PBUFFER_BIT : EGL_WINDOW_BIT, renderableType, wanted, eglConfig, _surfaceConfig)) {
+            if (_clientVersion >= 3) {
+                return std::string("OpenGL ES 3.0 is not supported");
+            }
+            return std::string("Found no suitable config (eglError: ") + std::to_string(eglGetError()) + std::string(")");
         }
 
-        if ( num_config != 1 ) {
-            return std::string("Didn't get exactly one config, but ") + std::to_string(num_config);
-        }
+        _eglConfig = eglConfig;
 
         // create an EGL rendering context
         EGLint ctxattr[] = {
-                EGL_CONTEXT_CLIENT_VERSION, 2,
+                EGL_CONTEXT_CLIENT_VERSION, _clientVersion,
                 EGL_NONE
         };
-        _eglContext = eglCreateContext ( _eglDisplay, eglConfig, EGL_NO_CONTEXT, ctxattr );
+        _eglContext = eglCreateContext ( _eglDisplay, eglConfig, share != nullptr ? share->_eglContext : EGL_NO_CONTEXT, ctxattr );
         if ( _eglContext == EGL_NO_CONTEXT ) {
             return std::string("Unable to create EGL context (eglError: ") + std::to_string(eglGetError()) + std::string(")");
         }
@@ -134,12 +136,25 @@ namespace BCMNexus {
         Use the config picked in the previous step and the native window
         handle to create a window surface.
         */
-        _eglSurface = eglCreateWindowSurface(_eglDisplay, eglConfig, _nativeWindow, NULL);
+        if (_offscreen) {
+            const EGLint pbufferattr[] = {
+                EGL_WIDTH, static_cast<EGLint>(_width),
+                EGL_HEIGHT, static_cast<EGLint>(_height),
+                EGL_NONE
+            };
+            _eglSurface = eglCreatePbufferSurface(_eglDisplay, eglConfig, pbufferattr);
+        } else {
+            _eglSurface = eglCreateWindowSurface(_eglDisplay, eglConfig, _nativeWindow, NULL);
+        }
         if (_eglSurface == EGL_NO_SURFACE)
         {
             std::cout << "eglCreateWindowSurface() failed" << std::endl;
             return std::string("Unable to create EGL surface (eglError: ") + std::to_string(eglGetError()) + std::string(")");
         }
+        if (_surfaceConfig.preserved) {
+            _surfaceConfig.preserved = eglSurfaceAttrib(_eglDisplay, _eglSurface, EGL_SWAP_BEHAVIOR, EGL_BUFFER_PRESERVED);
+        }
+        _damage.init(_eglDisplay, _eglConfig, _eglSurface, _offscreen, _surfaceConfig.preserved);
 
         eglBindAPI(EGL_OPENGL_ES_API);
 
@@ -163,11 +178,7 @@ namespace BCMNexus {
             eglDestroyContext(_eglDisplay, _eglContext);
             _eglContext = EGL_NO_CONTEXT;
         }
-        if (_eglDisplay != EGL_NO_DISPLAY) {
-            eglMakeCurrent(_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
-            eglTerminate(_eglDisplay);
-            _eglDisplay = EGL_NO_DISPLAY;
-        }
+        _eglDisplay = EGL_NO_DISPLAY;
 
         if (_nativeWindow != nullptr) {
             NXPL_DestroyNativeWindow(_nativeWindow);
@@ -177,9 +188,77 @@ namespace BCMNexus {
         std::cout << "cleanup" << std::endl;
     }
 
-    void EGLTarget::swapBuffer() {
+    bool EGLTarget::makeCurrent() {
+
+        return makeCurrent(_eglContext, _eglSurface);
+    }
+
+    void EGLTarget::swapBuffer(const int* damage, int rects) {
+
+        _damage.swapBuffers(damage, rects);
+    }
+
+    bool EGLTarget::createSharedContext(EGLContext& context, EGLSurface& surface) {
+
+        EGLConfig eglConfig = _eglConfig;
+        surface = EGL_NO_SURFACE;
+
+        const char* extensions = eglQueryString(_eglDisplay, EGL_EXTENSIONS);
+        if (!extensions || !strstr(extensions, "EGL_KHR_surfaceless_context")) {
+            // Without surfaceless contexts, a 1x1 pbuffer is needed to make it current.
+            const EGLint attr[] = {
+                EGL_RED_SIZE, 8,
+                EGL_GREEN_SIZE, 8,
+                EGL_BLUE_SIZE, 8,
+                EGL_ALPHA_SIZE, 8,
+                EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                EGL_RENDERABLE_TYPE, _clientVersion >= 3 ? EGL_OPENGL_ES3_BIT_KHR : EGL_OPENGL_ES2_BIT,
+                EGL_NONE
+            };
+            static const EGLint pbufferattr[] = {
+                EGL_WIDTH, 1,
+                EGL_HEIGHT, 1,
+                EGL_NONE
+            };
+
+            EGLint num_config;
+            if ( !eglChooseConfig( _eglDisplay, attr, &eglConfig, 1, &num_config ) || num_config != 1 ) {
+                return false;
+            }
+
+            surface = eglCreatePbufferSurface(_eglDisplay, eglConfig, pbufferattr);
+            if (surface == EGL_NO_SURFACE) {
+                return false;
+            }
+        }
+
+        EGLint ctxattr[] = {
+                EGL_CONTEXT_CLIENT_VERSION, _clientVersion,
+                EGL_NONE
+        };
+        context = eglCreateContext ( _eglDisplay, eglConfig, _eglContext, ctxattr );
+        if ( context == EGL_NO_CONTEXT ) {
+            if (surface != EGL_NO_SURFACE) {
+                eglDestroySurface(_eglDisplay, surface);
+                surface = EGL_NO_SURFACE;
+            }
+            return false;
+        }
+
+        return true;
+    }
+
+    void EGLTarget::destroySharedContext(EGLContext context, EGLSurface surface) {
+
+        eglDestroyContext(_eglDisplay, context);
+        if (surface != EGL_NO_SURFACE) {
+            eglDestroySurface(_eglDisplay, surface);
+        }
+    }
+
+    bool EGLTarget::makeCurrent(EGLContext context, EGLSurface surface) {
 
-        eglSwapBuffers (_eglDisplay, _eglSurface);
+        return makeCurrentES(_eglDisplay, surface, context);
     }
 
 } // BCMNexus
@@ -17,6 +17,13 @@
 #include  <GLES2/gl2.h>
 #include  <EGL/egl.h>
 
+#include "../gles2impl.h"
+#include "../eglsurface.h"
+
+#ifndef EGL_OPENGL_ES3_BIT_KHR
+#define EGL_OPENGL_ES3_BIT_KHR 0x00000040
+#endif
+
 namespace gles2impl {
 namespace BCMNexus {
 
@@ -49,12 +56,27 @@ namespace BCMNexus {
         EGLTarget& operator=(const EGLTarget&) = delete;
 
     public:
-        EGLTarget(Backend &backend, int width, int height, bool fullScreen, const std::string& title);
+        EGLTarget(Backend &backend, int width, int height, bool fullScreen, const std::string& title, int glesVersion, bool offscreen,
+            const SurfaceConfig& config);
         ~EGLTarget() {};
 
-        std::string constructTarget();
-        void swapBuffer();
+        // share is the target whose objects to share, or nullptr.
+        std::string constructTarget(EGLTarget* share);
+        // rects is the number of damaged rects, if damage isn't nullptr.
+        void swapBuffer(const int* damage, int rects);
+        // See gles2impl::bufferAge and setDamageRegion.
+        int bufferAge() { return _damage.bufferAge(); }
+        bool setDamageRegion(const int* damage, int rects) { return _damage.setDamageRegion(damage, rects); }
+        // Leaves the display initialized for the other targets.
         void destroyTarget();
+        bool makeCurrent();
+        // What was wanted until the target is constructed, then what was chosen.
+        const SurfaceConfig& surfaceConfig() const { return _surfaceConfig; }
+
+        // Offscreen context sharing objects with the target's context.
+        bool createSharedContext(EGLContext& context, EGLSurface& surface);
+        void destroySharedContext(EGLContext context, EGLSurface surface);
+        bool makeCurrent(EGLContext context, EGLSurface surface);
 
     private:
         void* _nativeWindow;
@@ -62,10 +84,15 @@ namespace BCMNexus {
         uint32_t _width;
         uint32_t _height;
         bool _fullscreen;
+        bool _offscreen;
         std::string _title;
+        EGLint _clientVersion;
+        SurfaceConfig _surfaceConfig;
         EGLDisplay  _eglDisplay;
+        EGLConfig   _eglConfig;
         EGLContext  _eglContext;
         EGLSurface  _eglSurface;
+        SurfaceDamage _damage;
     };
 
 } // BCMNexus
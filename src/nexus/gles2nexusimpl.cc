@@ -1,7 +1,9 @@
 #include <cstring>
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <cstdlib>
+#include <mutex>
 
 #include "../gles2impl.h"
 
@@ -11,41 +13,159 @@ using namespace std;
 
 namespace gles2impl {
 
-    BCMNexus::EGLTarget *eglTarget;
+    struct Context {
+        BCMNexus::EGLTarget* target;
+    };
 
-    string init(int width, int height, bool fullscreen, std::string title, unsigned int layer) {
-        cout << "initializing BCM NEXUS & EGL" << endl;
+    // Worker threads create their own contexts, so the list is shared between
+    // threads, while each thread has its own current context.
+    static mutex contextsMutex;
+    static vector<Context*> contexts;
+    static thread_local Context* current = nullptr;
+    static bool initialized = false;
 
-        eglTarget = new BCMNexus::EGLTarget(BCMNexus::Backend::getInstance(), width, height, fullscreen, title);
-        std::string result = eglTarget->constructTarget();
+    Context* createContext(int width, int height, bool fullscreen, std::string title, unsigned int layer,
+            int glesVersion, bool offscreen, const SurfaceConfig& config, Context* share, std::string& error) {
+        lock_guard<mutex> lock(contextsMutex);
+        if (!initialized) {
+            cout << "initializing BCM NEXUS & EGL" << endl;
+        }
+
+        BCMNexus::EGLTarget* target = new BCMNexus::EGLTarget(BCMNexus::Backend::getInstance(), width, height, fullscreen, title, glesVersion, offscreen, config);
+        error = target->constructTarget(share != nullptr ? share->target : nullptr);
+
+        if (!initialized) {
+            // This comment is taken from webkit
+            // EGL registers atexit handlers to cleanup its global display list.
+            // Since the global EGLTarget instance is created before,
+            // when the EGLTarget destructor is called, EGL has already removed the
+            // display from the list, causing eglTerminate() to crash. So, here we register
+            // our own atexit handler, after EGL has been initialized and after the global
+            // instance has been created to ensure we call eglTerminate() before the other
+            // EGL atexit handlers and the EGLTarget destructor.
+            std::atexit(cleanup);
+            initialized = true;
+        }
+
+        if (error.size()) {
+            target->destroyTarget();
+            delete target;
+            return nullptr;
+        }
+
+        Context* context = new Context();
+        context->target = target;
+        contexts.push_back(context);
+        current = context;
+        return context;
+    }
 
-        // This comment is taken from webkit
-        // EGL registers atexit handlers to cleanup its global display list.
-        // Since the global EGLTarget instance is created before,
-        // when the EGLTarget destructor is called, EGL has already removed the
-        // display from the list, causing eglTerminate() to crash. So, here we register
-        // our own atexit handler, after EGL has been initialized and after the global
-        // instance has been created to ensure we call eglTerminate() before the other
-        // EGL atexit handlers and the EGLTarget destructor.
-        std::atexit(cleanup);
+    void destroyContext(Context* context) {
+        if (context == current) {
+            makeContextCurrent(nullptr);
+        }
+        {
+            lock_guard<mutex> lock(contextsMutex);
+            contexts.erase(find(contexts.begin(), contexts.end(), context));
+        }
+        context->target->destroyTarget();
+        delete context->target;
+        delete context;
+    }
 
+    bool makeContextCurrent(Context* context) {
+        bool result;
+        if (context == nullptr) {
+            result = (current == nullptr) || current->target->makeCurrent(EGL_NO_CONTEXT, EGL_NO_SURFACE);
+        } else {
+            result = context->target->makeCurrent();
+        }
+        if (result) {
+            current = context;
+        }
         return result;
     }
 
-    void nextFrame(bool swapBuffers) {
-        if ((eglTarget != nullptr) && swapBuffers == true) {
-            eglTarget->swapBuffer();
+    Context* currentContext() {
+        return current;
+    }
+
+    SurfaceConfig surfaceConfig(Context* context) {
+        return context->target->surfaceConfig();
+    }
+
+    void nextFrame(Context* context, bool swapBuffers, const int* damage, int rects) {
+        if ((context != nullptr) && swapBuffers == true) {
+            context->target->swapBuffer(damage, rects);
         }
     }
 
+    int bufferAge(Context* context) {
+        return context->target->bufferAge();
+    }
+
+    bool setDamageRegion(Context* context, const int* damage, int rects) {
+        return context->target->setDamageRegion(damage, rects);
+    }
+
     void cleanup() {
-        cout << "Destroy EGL target" << endl;
+        cout << "Destroy EGL targets" << endl;
+
+        vector<Context*> remaining;
+        {
+            lock_guard<mutex> lock(contextsMutex);
+            remaining = contexts;
+        }
+        while (!remaining.empty()) {
+            destroyContext(remaining.back());
+            remaining.pop_back();
+        }
+
+        if (initialized) {
+            eglTerminate(eglGetDisplay(EGL_DEFAULT_DISPLAY));
+            initialized = false;
+        }
+    }
+
+    bool mainThreadOnly() {
+        return false;
+    }
+
+    void* getProcAddress(const char* name) {
+        return (void*) eglGetProcAddress(name);
+    }
+
+    struct SharedContext {
+        BCMNexus::EGLTarget* target;
+        EGLContext context;
+        EGLSurface surface;
+    };
+
+    SharedContext* createSharedContext(Context* parent) {
+        EGLContext context;
+        EGLSurface surface;
+
+        if (parent == nullptr || !parent->target->createSharedContext(context, surface)) {
+            return nullptr;
+        }
+
+        SharedContext* shared = new SharedContext();
+        shared->target = parent->target;
+        shared->context = context;
+        shared->surface = surface;
+        return shared;
+    }
+
+    void destroySharedContext(SharedContext* context) {
+        context->target->destroySharedContext(context->context, context->surface);
+        delete context;
+    }
 
-        if (eglTarget != nullptr) {
-            eglTarget->destroyTarget();
-            delete eglTarget;
-            eglTarget = nullptr;
+    bool makeCurrent(SharedContext* context) {
+        if (context == nullptr) {
+            return eglMakeCurrent(eglGetDisplay(EGL_DEFAULT_DISPLAY), EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
         }
+        return context->target->makeCurrent(context->context, context->surface);
     }
 
 } // end namespace gles2impl
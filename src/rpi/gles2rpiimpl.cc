@@ -1,30 +1,52 @@
 #include <cstring>
 #include <vector>
+#include <algorithm>
+#include <mutex>
 #include <iostream>
 #include <stdio.h>
 
 #include "../gles2impl.h"
+#include "../eglconfig.h"
+#include "../eglsurface.h"
 
 #include "bcm_host.h"
 
 #include  <GLES2/gl2.h>
 #include  <EGL/egl.h>
 
+#ifndef EGL_OPENGL_ES3_BIT_KHR
+#define EGL_OPENGL_ES3_BIT_KHR 0x00000040
+#endif
+
 using namespace std;
 
 namespace gles2impl {
 
-static EGL_DISPMANX_WINDOW_T nativewindow;
+struct Context {
+  // Must stay at the same address as long as the surface exists.
+  EGL_DISPMANX_WINDOW_T nativewindow;
+  DISPMANX_ELEMENT_HANDLE_T dispman_element;
+
+  EGLConfig   egl_config;
+  EGLContext  egl_context;
+  EGLSurface  egl_surface;
+  EGLint      egl_client_version;
+  SurfaceConfig surface_config;
+
+  // Partial updates, see bufferAge.
+  SurfaceDamage damage;
+};
 
-DISPMANX_ELEMENT_HANDLE_T dispman_element;
-DISPMANX_DISPLAY_HANDLE_T dispman_display;
-DISPMANX_UPDATE_HANDLE_T dispman_update;
+static DISPMANX_DISPLAY_HANDLE_T dispman_display;
+static EGLDisplay egl_display = EGL_NO_DISPLAY;
 
-EGLDisplay  egl_display;
-EGLContext  egl_context;
-EGLSurface  egl_surface;
+// Worker threads create their own contexts, so the display and the list are
+// shared between threads, while each thread has its own current context.
+static mutex contextsMutex;
+static vector<Context*> contexts;
+static thread_local Context* current = NULL;
 
-string init(int width, int height, bool fullscreen, std::string title, unsigned int layer) {
+static string initDisplay() {
   printf("initializing DISPMANX & EGL\n");
 
   bcm_host_init();
@@ -37,99 +59,293 @@ string init(int width, int height, bool fullscreen, std::string title, unsigned
 
   // initialize the EGL display connection
   if ( !eglInitialize( egl_display, NULL, NULL ) ) {
+  	egl_display = EGL_NO_DISPLAY;
   	return string("Unable to initialize EGL");
   }
 
-  static const EGLint attr[] =
+  dispman_display = vc_dispmanx_display_open( 0 /* LCD */);
+
+  return string("");
+}
+
+// Releases whatever was created of a context.
+static void release(Context* context) {
+  if ( context->egl_surface != EGL_NO_SURFACE ) {
+    eglDestroySurface ( egl_display, context->egl_surface );
+  }
+  if ( context->egl_context != EGL_NO_CONTEXT ) {
+    eglDestroyContext ( egl_display, context->egl_context );
+  }
+  if ( context->dispman_element ) {
+    DISPMANX_UPDATE_HANDLE_T dispman_update = vc_dispmanx_update_start( 0 );
+    vc_dispmanx_element_remove(dispman_update, context->dispman_element);
+    vc_dispmanx_update_submit_sync( dispman_update );
+  }
+  delete context;
+}
+
+static Context* fail(Context* context, std::string& error, const string& message) {
+  release(context);
+  error = message;
+  return NULL;
+}
+
+Context* createContext(int width, int height, bool fullscreen, std::string title, unsigned int layer,
+    int glesVersion, bool offscreen, const SurfaceConfig& config, Context* share, std::string& error) {
   {
-    EGL_RED_SIZE, 8,
-    EGL_GREEN_SIZE, 8,
-    EGL_BLUE_SIZE, 8,
-    EGL_ALPHA_SIZE, 8,
-    EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
-    EGL_NONE
-  };
+    lock_guard<mutex> lock(contextsMutex);
+    if ( egl_display == EGL_NO_DISPLAY ) {
+      error = initDisplay();
+      if ( error.size() ) {
+        return NULL;
+      }
+    }
+  }
+
+  Context* context = new Context();
+  context->dispman_element = 0;
+  context->egl_context = EGL_NO_CONTEXT;
+  context->egl_surface = EGL_NO_SURFACE;
+  context->egl_client_version = glesVersion >= 3 ? 3 : 2;
 
   // get an appropriate EGL frame buffer configuration
   EGLConfig  ecfg;
-  EGLint     num_config;
-  if ( !eglChooseConfig( egl_display, attr, &ecfg, 1, &num_config ) ) {
-  	return string("Failed to choose config (eglError: ") + to_string(eglGetError()) + string(")");
+  EGLint renderable_type = context->egl_client_version >= 3 ? EGL_OPENGL_ES3_BIT_KHR : EGL_OPENGL_ES2_BIT;
+  if ( !chooseConfig( egl_display, offscreen ? EGL_PBUFFER_BIT : EGL_WINDOW_BIT, renderable_type, config, ecfg, context->surface_config ) ) {
+    if ( context->egl_client_version >= 3 ) {
+      return fail(context, error, string("OpenGL ES 3.0 is not supported"));
+    }
+    return fail(context, error, string("Found no suitable config (eglError: ") + to_string(eglGetError()) + string(")"));
   }
 
-  if ( num_config != 1 ) {
-  	return string("Didn't get exactly one config, but ") + to_string(num_config);
-  }
+  context->egl_config = ecfg;
 
   eglBindAPI(EGL_OPENGL_ES_API);
 
   // create an EGL rendering context
   EGLint ctxattr[] = {
-      EGL_CONTEXT_CLIENT_VERSION, 2,
+      EGL_CONTEXT_CLIENT_VERSION, context->egl_client_version,
       EGL_NONE
   };
-  egl_context = eglCreateContext ( egl_display, ecfg, EGL_NO_CONTEXT, ctxattr );
-  if ( egl_context == EGL_NO_CONTEXT ) {
-  	return string("Unable to create EGL context (eglError: ") + to_string(eglGetError()) + string(")");
+  context->egl_context = eglCreateContext ( egl_display, ecfg, share ? share->egl_context : EGL_NO_CONTEXT, ctxattr );
+  if ( context->egl_context == EGL_NO_CONTEXT ) {
+  	return fail(context, error, string("Unable to create EGL context (eglError: ") + to_string(eglGetError()) + string(")"));
   }
 
-  // Dispmanx.
-  VC_RECT_T dst_rect;
-  VC_RECT_T src_rect;
+  if ( offscreen ) {
+    const EGLint pbufferattr[] =
+    {
+      EGL_WIDTH, width,
+      EGL_HEIGHT, height,
+      EGL_NONE
+    };
+    context->egl_surface = eglCreatePbufferSurface( egl_display, ecfg, pbufferattr );
+  } else {
+    // Dispmanx.
+    VC_RECT_T dst_rect;
+    VC_RECT_T src_rect;
 
-  uint32_t w, h;
+    uint32_t w, h;
 
-  graphics_get_display_size(0 /* LCD */, &w, &h);
+    graphics_get_display_size(0 /* LCD */, &w, &h);
 
-  dst_rect.x = 0;
-  dst_rect.y = 0;
-  dst_rect.width = w;
-  dst_rect.height = h;
+    dst_rect.x = 0;
+    dst_rect.y = 0;
+    dst_rect.width = w;
+    dst_rect.height = h;
 
-  src_rect.x = 0;
-  src_rect.y = 0;
-  src_rect.width = width << 16;
-  src_rect.height = height << 16;
+    src_rect.x = 0;
+    src_rect.y = 0;
+    src_rect.width = width << 16;
+    src_rect.height = height << 16;
 
-  dispman_display = vc_dispmanx_display_open( 0 /* LCD */);
-  dispman_update = vc_dispmanx_update_start( 0 );
+    DISPMANX_UPDATE_HANDLE_T dispman_update = vc_dispmanx_update_start( 0 );
 
-  dispman_element = vc_dispmanx_element_add ( dispman_update, dispman_display,
-    layer, &dst_rect, 0/*src*/,
-    &src_rect, DISPMANX_PROTECTION_NONE, 0 /*alpha*/, 0/*clamp*/, DISPMANX_NO_ROTATE/*transform*/);
+    context->dispman_element = vc_dispmanx_element_add ( dispman_update, dispman_display,
+      layer, &dst_rect, 0/*src*/,
+      &src_rect, DISPMANX_PROTECTION_NONE, 0 /*alpha*/, 0/*clamp*/, DISPMANX_NO_ROTATE/*transform*/);
 
-  nativewindow.element = dispman_element;
-  nativewindow.width = w;
-  nativewindow.height = h;
-  vc_dispmanx_update_submit_sync( dispman_update );
+    context->nativewindow.element = context->dispman_element;
+    context->nativewindow.width = w;
+    context->nativewindow.height = h;
+    vc_dispmanx_update_submit_sync( dispman_update );
 
-  egl_surface = eglCreateWindowSurface ( egl_display, ecfg, &nativewindow, NULL );
-  if ( egl_surface == EGL_NO_SURFACE ) {
-  	return string("Unable to create EGL surface (eglError: ") + to_string(eglGetError()) + string(")");
+    context->egl_surface = eglCreateWindowSurface ( egl_display, ecfg, &context->nativewindow, NULL );
+  }
+  if ( context->egl_surface == EGL_NO_SURFACE ) {
+  	return fail(context, error, string("Unable to create EGL surface (eglError: ") + to_string(eglGetError()) + string(")"));
   }
+  if ( context->surface_config.preserved ) {
+    context->surface_config.preserved = eglSurfaceAttrib( egl_display, context->egl_surface, EGL_SWAP_BEHAVIOR, EGL_BUFFER_PRESERVED );
+  }
+  context->damage.init( egl_display, ecfg, context->egl_surface, offscreen, context->surface_config.preserved );
 
   //// associate the egl-context with the egl-surface
-  if (!eglMakeCurrent( egl_display, egl_surface, egl_surface, egl_context )) {
-  	return string("Unable to make EGL display the current one (eglError: ") + to_string(eglGetError()) + string(")");
+  if (!eglMakeCurrent( egl_display, context->egl_surface, context->egl_surface, context->egl_context )) {
+  	return fail(context, error, string("Unable to make EGL display the current one (eglError: ") + to_string(eglGetError()) + string(")"));
   }
+  current = context;
 
-  return string("");
+  lock_guard<mutex> lock(contextsMutex);
+  contexts.push_back(context);
+  return context;
 }
 
-void nextFrame(bool swapBuffers) {
-  if (swapBuffers) {
-    eglSwapBuffers ( egl_display, egl_surface );  // get the rendered buffer to the screen
+void destroyContext(Context* context) {
+  if (context == current) {
+    makeContextCurrent(NULL);
   }
+  {
+    lock_guard<mutex> lock(contextsMutex);
+    contexts.erase(find(contexts.begin(), contexts.end(), context));
+  }
+  release(context);
+}
+
+bool makeContextCurrent(Context* context) {
+  if ( egl_display == EGL_NO_DISPLAY ) {
+    return false;
+  }
+
+  bool result;
+  if (!context) {
+    result = eglMakeCurrent( egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+  } else {
+    result = eglMakeCurrent( egl_display, context->egl_surface, context->egl_surface, context->egl_context );
+  }
+  if (result) {
+    current = context;
+  }
+  return result;
+}
+
+Context* currentContext() {
+  return current;
+}
+
+SurfaceConfig surfaceConfig(Context* context) {
+  return context->surface_config;
+}
+
+void nextFrame(Context* context, bool swapBuffers, const int* damage, int rects) {
+  if (!swapBuffers) {
+    return;
+  }
+
+  // get the rendered buffer to the screen
+  context->damage.swapBuffers( damage, rects );
+}
+
+int bufferAge(Context* context) {
+  return context->damage.bufferAge();
+}
+
+bool setDamageRegion(Context* context, const int* damage, int rects) {
+  return context->damage.setDamageRegion( damage, rects );
 }
 
 void cleanup() {
-  eglDestroyContext ( egl_display, egl_context );
-  eglDestroySurface ( egl_display, egl_surface );
-  eglTerminate      ( egl_display );
-  vc_dispmanx_element_remove(dispman_update, dispman_element);
-  vc_dispmanx_display_close(dispman_display);
+  vector<Context*> remaining;
+  {
+    lock_guard<mutex> lock(contextsMutex);
+    remaining = contexts;
+  }
+  while (!remaining.empty()) {
+    destroyContext(remaining.back());
+    remaining.pop_back();
+  }
+  if ( egl_display != EGL_NO_DISPLAY ) {
+    eglTerminate      ( egl_display );
+    vc_dispmanx_display_close(dispman_display);
+    egl_display = EGL_NO_DISPLAY;
+  }
 
   printf("cleanup\n");
 }
 
+bool mainThreadOnly() {
+  return false;
+}
+
+void* getProcAddress(const char* name) {
+  return (void*) eglGetProcAddress(name);
+}
+
+struct SharedContext {
+  EGLContext context;
+  EGLSurface surface;
+};
+
+SharedContext* createSharedContext(Context* parent) {
+  if (!parent) {
+    return NULL;
+  }
+
+  EGLConfig config = parent->egl_config;
+  EGLSurface surface = EGL_NO_SURFACE;
+
+  const char* extensions = eglQueryString(egl_display, EGL_EXTENSIONS);
+  if (!extensions || !strstr(extensions, "EGL_KHR_surfaceless_context")) {
+    // Without surfaceless contexts, a 1x1 pbuffer is needed to make it current.
+    const EGLint attr[] =
+    {
+      EGL_RED_SIZE, 8,
+      EGL_GREEN_SIZE, 8,
+      EGL_BLUE_SIZE, 8,
+      EGL_ALPHA_SIZE, 8,
+      EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+      EGL_RENDERABLE_TYPE, parent->egl_client_version >= 3 ? EGL_OPENGL_ES3_BIT_KHR : EGL_OPENGL_ES2_BIT,
+      EGL_NONE
+    };
+    static const EGLint pbufferattr[] =
+    {
+      EGL_WIDTH, 1,
+      EGL_HEIGHT, 1,
+      EGL_NONE
+    };
+
+    EGLint num_config;
+    if ( !eglChooseConfig( egl_display, attr, &config, 1, &num_config ) || num_config != 1 ) {
+      return NULL;
+    }
+
+    surface = eglCreatePbufferSurface( egl_display, config, pbufferattr );
+    if ( surface == EGL_NO_SURFACE ) {
+      return NULL;
+    }
+  }
+
+  EGLint ctxattr[] = {
+      EGL_CONTEXT_CLIENT_VERSION, parent->egl_client_version,
+      EGL_NONE
+  };
+  EGLContext shared = eglCreateContext ( egl_display, config, parent->egl_context, ctxattr );
+  if ( shared == EGL_NO_CONTEXT ) {
+    if ( surface != EGL_NO_SURFACE ) {
+      eglDestroySurface( egl_display, surface );
+    }
+    return NULL;
+  }
+
+  SharedContext* context = new SharedContext();
+  context->context = shared;
+  context->surface = surface;
+  return context;
+}
+
+void destroySharedContext(SharedContext* context) {
+  eglDestroyContext( egl_display, context->context );
+  if ( context->surface != EGL_NO_SURFACE ) {
+    eglDestroySurface( egl_display, context->surface );
+  }
+  delete context;
+}
+
+bool makeCurrent(SharedContext* context) {
+  if (!context) {
+    return makeCurrentES( egl_display, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+  }
+  return makeCurrentES( egl_display, context->surface, context->context );
+}
+
 } // end namespace gles2impl